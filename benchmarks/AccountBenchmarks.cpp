@@ -0,0 +1,93 @@
+#include <benchmark/benchmark.h>
+#include <memory>
+#include <vector>
+#include <map>
+#include <mutex>
+#include "models/Account.h"
+
+// Balance operations with every thread hitting the same accounts, so the
+// numbers include lock contention on account_mutex.
+
+namespace {
+    constexpr double kLargeBalance = 1e15;
+
+    std::shared_ptr<Account> sharedAccount() {
+        static auto account = std::make_shared<Account>(1, 1, AccountType::CHECKING, kLargeBalance);
+        return account;
+    }
+
+    // One pool per size, built on first use and shared by every thread
+    const std::vector<std::shared_ptr<Account>>& accountPool(std::size_t size) {
+        static std::map<std::size_t, std::vector<std::shared_ptr<Account>>> pools;
+        static std::mutex pools_mutex;
+        std::lock_guard<std::mutex> lock(pools_mutex);
+        auto& pool = pools[size];
+        if (pool.empty()) {
+            for (std::size_t i = 0; i < size; ++i) {
+                pool.push_back(std::make_shared<Account>(static_cast<int>(i + 1), 1, AccountType::CHECKING,
+                                                         kLargeBalance));
+            }
+        }
+        return pool;
+    }
+}
+
+static void BM_AccountDeposit(benchmark::State& state) {
+    auto account = sharedAccount();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(account->tryDeposit(1.0));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_AccountDeposit)->ThreadRange(1, 8)->UseRealTime();
+
+static void BM_AccountWithdraw(benchmark::State& state) {
+    auto account = sharedAccount();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(account->tryWithdraw(1.0));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_AccountWithdraw)->ThreadRange(1, 8)->UseRealTime();
+
+static void BM_AccountBalanceRead(benchmark::State& state) {
+    auto account = sharedAccount();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(account->getBalance());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_AccountBalanceRead)->ThreadRange(1, 8)->UseRealTime();
+
+// Arg: accounts in the pool. Two accounts means every transfer contends.
+static void BM_AccountTransfer(benchmark::State& state) {
+    const auto& pool = accountPool(static_cast<std::size_t>(state.range(0)));
+    std::size_t cursor = static_cast<std::size_t>(state.thread_index()) * 7919;
+    for (auto _ : state) {
+        const auto& from = pool[cursor % pool.size()];
+        const auto& to = pool[(cursor + 1) % pool.size()];
+        benchmark::DoNotOptimize(from->tryTransfer(to, 1.0));
+        ++cursor;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_AccountTransfer)->Arg(2)->Arg(64)->Arg(1024)->ThreadRange(1, 8)->UseRealTime();
+
+// Arg: legs per journal entry, all drawn from a 64-account pool
+static void BM_AccountJournalPost(benchmark::State& state) {
+    const auto& pool = accountPool(64);
+    std::size_t legs = static_cast<std::size_t>(state.range(0));
+    std::size_t cursor = static_cast<std::size_t>(state.thread_index()) * 13;
+    std::vector<JournalLeg> entry;
+    for (auto _ : state) {
+        entry.clear();
+        entry.emplace_back(pool[cursor % pool.size()], -static_cast<double>(legs - 1));
+        for (std::size_t i = 1; i < legs; ++i) {
+            entry.emplace_back(pool[(cursor + i) % pool.size()], 1.0);
+        }
+        ++cursor;
+        benchmark::DoNotOptimize(Account::tryPost(entry));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_AccountJournalPost)->Arg(3)->Arg(10)->ThreadRange(1, 4)->UseRealTime();
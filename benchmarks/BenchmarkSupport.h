@@ -0,0 +1,20 @@
+#ifndef BENCHMARK_SUPPORT_H
+#define BENCHMARK_SUPPORT_H
+
+#include "utils/Logger.h"
+
+// Turns the engine's logger off while alive, so fraud alerts and batch
+// reports cost only a level check inside the measured loops
+class ScopedSilence {
+public:
+    ScopedSilence() : saved(Logger::instance().getLevel()) { Logger::instance().setLevel(LogLevel::OFF); }
+    ~ScopedSilence() { Logger::instance().setLevel(saved); }
+
+    ScopedSilence(const ScopedSilence&) = delete;
+    ScopedSilence& operator=(const ScopedSilence&) = delete;
+
+private:
+    LogLevel saved;
+};
+
+#endif // BENCHMARK_SUPPORT_H
@@ -0,0 +1,31 @@
+#include <benchmark/benchmark.h>
+#include <memory>
+#include "models/Budget.h"
+
+// BudgetManager::recordExpense with every thread charging one manager.
+// Arg: categories the threads spread over (1 means all hit the same budget).
+
+namespace {
+    std::unique_ptr<BudgetManager> manager;
+
+    void setUp(const benchmark::State& state) {
+        if (state.thread_index() != 0) return;
+        manager = std::make_unique<BudgetManager>(1);
+        for (std::size_t i = 0; i < kTransactionCategoryCount; ++i) {
+            manager->addBudget(Budget(static_cast<int>(i + 1), 1, static_cast<TransactionCategory>(i), 1e12));
+        }
+    }
+}
+
+static void BM_BudgetRecordExpense(benchmark::State& state) {
+    setUp(state);
+    auto spread = static_cast<std::size_t>(state.range(0));
+    std::size_t step = static_cast<std::size_t>(state.thread_index());
+    for (auto _ : state) {
+        auto category = static_cast<TransactionCategory>(step++ % spread);
+        benchmark::DoNotOptimize(manager->recordExpense(category, 12.5));
+    }
+    state.SetItemsProcessed(state.iterations());
+    if (state.thread_index() == 0) manager.reset();
+}
+BENCHMARK(BM_BudgetRecordExpense)->Arg(1)->Arg(kTransactionCategoryCount)->ThreadRange(1, 8)->UseRealTime();
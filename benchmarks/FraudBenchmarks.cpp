@@ -0,0 +1,70 @@
+#include <benchmark/benchmark.h>
+#include <memory>
+#include <atomic>
+#include "models/Transaction.h"
+#include "services/FraudDetectionService.h"
+#include "utils/TimeZone.h"
+#include "BenchmarkSupport.h"
+
+// Fraud screening of routine traffic. Each account sees one transaction a
+// day at midday in a common location, so the rules run in full but should
+// not fire. The service's log output is switched off while it runs.
+
+namespace {
+    constexpr std::int64_t kFirstNoon = 1700000000 - 1700000000 % 86400 + 12 * 3600;
+
+    std::unique_ptr<FraudDetectionService> service;
+    std::atomic<std::uint64_t> sequence{0};
+    std::unique_ptr<ScopedSilence> silence;
+
+    std::shared_ptr<Transaction> nextTransaction(std::uint64_t accounts) {
+        std::uint64_t k = sequence.fetch_add(1, std::memory_order_relaxed);
+        int account_id = static_cast<int>(k % accounts) + 1;
+        auto day = static_cast<std::int64_t>(k / accounts);
+        auto transaction = std::make_shared<Transaction>(static_cast<int>(k), account_id,
+                                                         40.0 + static_cast<double>(k % 20),
+                                                         TransactionType::PAYMENT, TransactionCategory::FOOD);
+        transaction->setLocation("New York");
+        transaction->setTimestamp(std::chrono::system_clock::time_point(
+            std::chrono::seconds(kFirstNoon + day * 86400 + static_cast<std::int64_t>(k % 60))));
+        return transaction;
+    }
+
+    void setUp(const benchmark::State& state) {
+        if (state.thread_index() != 0) return;
+        silence = std::make_unique<ScopedSilence>(); // Any alert would otherwise be logged
+        service = std::make_unique<FraudDetectionService>();
+        service->setDefaultTimeZone(TimeZone::utc());
+        sequence = 0;
+    }
+
+    void tearDown(benchmark::State& state) {
+        state.SetItemsProcessed(state.iterations());
+        if (state.thread_index() != 0) return;
+        state.counters["flagged"] = static_cast<double>(service->getFlaggedTransactions().size());
+        service.reset();
+        silence.reset();
+    }
+}
+
+// Arg: distinct accounts, i.e. how many profiles the service keeps
+static void BM_FraudAnalyzeTransaction(benchmark::State& state) {
+    setUp(state);
+    auto accounts = static_cast<std::uint64_t>(state.range(0));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(service->analyzeTransaction(nextTransaction(accounts)));
+    }
+    tearDown(state);
+}
+BENCHMARK(BM_FraudAnalyzeTransaction)->Arg(100)->Arg(10000)->ThreadRange(1, 4)->UseRealTime();
+
+static void BM_FraudEvaluateTransaction(benchmark::State& state) {
+    setUp(state);
+    auto accounts = static_cast<std::uint64_t>(state.range(0));
+    for (auto _ : state) {
+        auto transaction = nextTransaction(accounts);
+        benchmark::DoNotOptimize(service->evaluateTransaction(*transaction));
+    }
+    tearDown(state);
+}
+BENCHMARK(BM_FraudEvaluateTransaction)->Arg(100)->Arg(10000)->ThreadRange(1, 4)->UseRealTime();
@@ -0,0 +1,94 @@
+#include <benchmark/benchmark.h>
+#include <memory>
+#include <map>
+#include <mutex>
+#include "models/Account.h"
+#include "services/TransactionService.h"
+
+// History reads at increasing ledger sizes (Arg: entries in the account).
+// Ledgers are built once per size and reused by every benchmark.
+
+namespace {
+    constexpr std::size_t kPageSize = 50;
+    constexpr std::size_t kServiceAccounts = 64;
+
+    std::shared_ptr<Account> ledger(std::size_t entries) {
+        static std::map<std::size_t, std::shared_ptr<Account>> ledgers;
+        static std::mutex ledgers_mutex;
+        std::lock_guard<std::mutex> lock(ledgers_mutex);
+        auto& account = ledgers[entries];
+        if (!account) {
+            account = std::make_shared<Account>(1, 1, AccountType::CHECKING, 0.0);
+            for (std::size_t i = 0; i < entries; ++i) {
+                account->deposit(1.0 + static_cast<double>(i % 100), "Ledger entry");
+            }
+        }
+        return account;
+    }
+
+    // A service whose completed log holds entries spread over kServiceAccounts
+    TransactionService& serviceLedger(std::size_t entries) {
+        static std::map<std::size_t, std::unique_ptr<TransactionService>> services;
+        static std::mutex services_mutex;
+        std::lock_guard<std::mutex> lock(services_mutex);
+        auto& service = services[entries];
+        if (!service) {
+            service = std::make_unique<TransactionService>();
+            std::vector<std::shared_ptr<Account>> accounts;
+            for (std::size_t i = 0; i < kServiceAccounts; ++i) {
+                accounts.push_back(std::make_shared<Account>(static_cast<int>(i + 1), 1, AccountType::CHECKING));
+            }
+            for (std::size_t i = 0; i < entries; ++i) {
+                service->processDeposit(accounts[i % kServiceAccounts], 1.0);
+            }
+        }
+        return *service;
+    }
+}
+
+static void BM_HistoryFullCopy(benchmark::State& state) {
+    auto account = ledger(static_cast<std::size_t>(state.range(0)));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(account->getTransactionHistory());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_HistoryFullCopy)->RangeMultiplier(16)->Range(1 << 10, 1 << 18);
+
+static void BM_HistoryNewestPage(benchmark::State& state) {
+    auto account = ledger(static_cast<std::size_t>(state.range(0)));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(account->getTransactionPage(TransactionPage::kNewest, kPageSize));
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(kPageSize));
+}
+BENCHMARK(BM_HistoryNewestPage)->RangeMultiplier(16)->Range(1 << 10, 1 << 18)->ThreadRange(1, 4)->UseRealTime();
+
+// The oldest entries, which larger ledgers keep in compressed segments
+static void BM_HistoryOldestPage(benchmark::State& state) {
+    auto account = ledger(static_cast<std::size_t>(state.range(0)));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(account->getTransactionPage(kPageSize, kPageSize));
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(kPageSize));
+}
+BENCHMARK(BM_HistoryOldestPage)->RangeMultiplier(16)->Range(1 << 10, 1 << 18);
+
+static void BM_HistorySummary(benchmark::State& state) {
+    auto account = ledger(static_cast<std::size_t>(state.range(0)));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(account->getHistorySummary());
+    }
+}
+BENCHMARK(BM_HistorySummary)->RangeMultiplier(16)->Range(1 << 10, 1 << 18);
+
+// TransactionService::getTransactionHistory scans the service's recent window,
+// which stops growing at kRecentCompleted records
+static void BM_ServiceHistory(benchmark::State& state) {
+    TransactionService& service = serviceLedger(static_cast<std::size_t>(state.range(0)));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(service.getTransactionHistory(1));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ServiceHistory)->RangeMultiplier(16)->Range(1 << 10, 1 << 18);
@@ -0,0 +1,178 @@
+#include <benchmark/benchmark.h>
+#include <memory>
+#include <string>
+#include <vector>
+#include "models/Account.h"
+#include "services/TransactionService.h"
+#include "BenchmarkSupport.h"
+
+// TransactionService entry points across thread counts. Each run gets a
+// fresh service so the completed-transaction log does not carry over.
+
+namespace {
+    constexpr std::size_t kAccounts = 64;
+    constexpr double kLargeBalance = 1e15;
+
+    std::unique_ptr<TransactionService> service;
+    std::vector<std::shared_ptr<Account>> accounts;
+
+    void setUp(const benchmark::State& state) {
+        if (state.thread_index() != 0) return;
+        service = std::make_unique<TransactionService>();
+        accounts.clear();
+        for (std::size_t i = 0; i < kAccounts; ++i) {
+            accounts.push_back(std::make_shared<Account>(static_cast<int>(i + 1), 1, AccountType::CHECKING,
+                                                         kLargeBalance));
+        }
+    }
+
+    void tearDown(benchmark::State& state) {
+        state.SetItemsProcessed(state.iterations());
+        if (state.thread_index() != 0) return;
+        service.reset();
+        accounts.clear();
+    }
+
+    // Spreads threads over the pool; Arg 1 instead pins them all to one account
+    const std::shared_ptr<Account>& pick(const benchmark::State& state, std::size_t step) {
+        std::size_t spread = static_cast<std::size_t>(state.range(0));
+        return accounts[(static_cast<std::size_t>(state.thread_index()) * 17 + step) % spread];
+    }
+}
+
+static void BM_ServiceDeposit(benchmark::State& state) {
+    setUp(state);
+    std::size_t step = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(service->processDeposit(pick(state, step++), 10.0, "Salary"));
+    }
+    tearDown(state);
+}
+BENCHMARK(BM_ServiceDeposit)->Arg(1)->Arg(kAccounts)->ThreadRange(1, 8)->UseRealTime();
+
+static void BM_ServiceWithdrawal(benchmark::State& state) {
+    setUp(state);
+    std::size_t step = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(service->processWithdrawal(pick(state, step++), 10.0, "Groceries", "New York",
+                                                            TransactionCategory::FOOD));
+    }
+    tearDown(state);
+}
+BENCHMARK(BM_ServiceWithdrawal)->Arg(1)->Arg(kAccounts)->ThreadRange(1, 8)->UseRealTime();
+
+static void BM_ServiceDeclinedWithdrawal(benchmark::State& state) {
+    setUp(state);
+    std::size_t step = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(service->processWithdrawal(pick(state, step++), 2 * kLargeBalance));
+    }
+    tearDown(state);
+}
+BENCHMARK(BM_ServiceDeclinedWithdrawal)->Arg(kAccounts)->ThreadRange(1, 8)->UseRealTime();
+
+static void BM_ServicePayment(benchmark::State& state) {
+    setUp(state);
+    std::size_t step = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(service->processPayment(pick(state, step++), 25.0, TransactionCategory::BILLS,
+                                                         "Electricity"));
+    }
+    tearDown(state);
+}
+BENCHMARK(BM_ServicePayment)->Arg(kAccounts)->ThreadRange(1, 8)->UseRealTime();
+
+static void BM_ServiceTransfer(benchmark::State& state) {
+    setUp(state);
+    std::size_t step = 0;
+    for (auto _ : state) {
+        const auto& from = pick(state, step);
+        const auto& to = accounts[static_cast<std::size_t>(from->getAccountId()) % static_cast<std::size_t>(state.range(0))];
+        benchmark::DoNotOptimize(service->processTransfer(from, to, 5.0));
+        ++step;
+    }
+    tearDown(state);
+}
+BENCHMARK(BM_ServiceTransfer)->Arg(2)->Arg(kAccounts)->ThreadRange(1, 8)->UseRealTime();
+
+// A fresh idempotency key per deposit: the cache miss and insert on top of
+// BM_ServiceDeposit, plus formatting the key
+static void BM_ServiceIdempotentDeposit(benchmark::State& state) {
+    setUp(state);
+    std::size_t step = 0;
+    std::string prefix = "client-" + std::to_string(state.thread_index()) + "-";
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(service->processDeposit(pick(state, step), 10.0, "Salary", "",
+                                                         prefix + std::to_string(step)));
+        ++step;
+    }
+    tearDown(state);
+}
+BENCHMARK(BM_ServiceIdempotentDeposit)->Arg(kAccounts)->ThreadRange(1, 8)->UseRealTime();
+
+// The same key every time: after the first call, every transfer is a replay
+static void BM_ServiceIdempotentRetry(benchmark::State& state) {
+    setUp(state);
+    std::string key = "retry-" + std::to_string(state.thread_index());
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(service->processTransfer(pick(state, 0), pick(state, 1), 5.0, "", key));
+    }
+    tearDown(state);
+}
+BENCHMARK(BM_ServiceIdempotentRetry)->Arg(kAccounts)->ThreadRange(1, 8)->UseRealTime();
+
+namespace {
+    void runBatch(benchmark::State& state, const std::vector<TransactionRequest>& requests) {
+        ScopedSilence silence; // Each batch logs its completion
+        std::vector<TransactionResult> results;
+        for (auto _ : state) {
+            results = service->processTransactionsBatch(requests);
+            benchmark::DoNotOptimize(results.data());
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+        std::size_t declined = 0;
+        for (const auto& result : results) {
+            if (!result) ++declined;
+        }
+        state.counters["declined"] = static_cast<double>(declined) / static_cast<double>(requests.size());
+        service.reset();
+        accounts.clear();
+    }
+}
+
+// Arg: requests per batch, a mix of deposits, withdrawals and transfers
+static void BM_ServiceBatch(benchmark::State& state) {
+    setUp(state);
+    std::vector<TransactionRequest> requests;
+    for (std::int64_t i = 0; i < state.range(0); ++i) {
+        const auto& account = accounts[static_cast<std::size_t>(i) % kAccounts];
+        const auto& other = accounts[static_cast<std::size_t>(i + 1) % kAccounts];
+        switch (i % 3) {
+            case 0: requests.emplace_back(account, 10.0, TransactionType::DEPOSIT); break;
+            case 1: requests.emplace_back(account, 5.0, TransactionType::WITHDRAWAL); break;
+            default: requests.emplace_back(account, other, 1.0); break;
+        }
+    }
+    runBatch(state, requests);
+}
+BENCHMARK(BM_ServiceBatch)->Arg(64)->Arg(1024)->UseRealTime();
+
+// As above, but seven requests in eight overdraw their account and decline,
+// so the batch is dominated by the decline path
+static void BM_ServiceBatchDeclined(benchmark::State& state) {
+    setUp(state);
+    std::vector<TransactionRequest> requests;
+    for (std::int64_t i = 0; i < state.range(0); ++i) {
+        const auto& account = accounts[static_cast<std::size_t>(i) % kAccounts];
+        const auto& other = accounts[static_cast<std::size_t>(i + 1) % kAccounts];
+        switch (i % 8) {
+            case 0: requests.emplace_back(account, 10.0, TransactionType::DEPOSIT); break;
+            case 1: case 2: case 3: case 4:
+                requests.emplace_back(account, 2 * kLargeBalance, TransactionType::WITHDRAWAL);
+                break;
+            default: requests.emplace_back(account, other, 2 * kLargeBalance); break;
+        }
+    }
+    runBatch(state, requests);
+}
+BENCHMARK(BM_ServiceBatchDeclined)->Arg(64)->Arg(1024)->UseRealTime();
@@ -4,19 +4,18 @@
 #include <vector>
 #include <iomanip>
 #include <limits>
-#include <map>
+#include <fstream>
 #include "models/User.h"
 #include "models/Account.h"
 #include "models/Transaction.h"
 #include "models/Budget.h"
 #include "services/TransactionService.h"
+#include "services/UserDirectory.h"
+#include "services/BatchCommandProcessor.h"
 #include "exceptions.h"
 
 // Global data structures (in production, these would be loaded from database)
-std::map<std::string, std::shared_ptr<User>> users_by_email;
-std::map<int, std::shared_ptr<Account>> accounts_by_id;
-int next_user_id = 1;
-int next_account_id = 1;
+UserDirectory user_directory;
 
 // Current session state
 std::shared_ptr<User> logged_in_user = nullptr;
@@ -61,18 +60,9 @@ std::string readStringInput(const std::string& prompt) {
     return value;
 }
 
-std::string hashPassword(const std::string& password) {
-    // Simple hash for demonstration - in production use bcrypt or similar
-    return "hashed_" + password;
-}
-
-bool verifyPassword(const std::string& input, const std::string& stored_hash) {
-    return hashPassword(input) == stored_hash;
-}
-
 // Display functions
 void displayAccounts(const std::shared_ptr<User>& user) {
-    auto accounts = user->getAccounts();
+    const auto& accounts = user->getAccounts();
     if (accounts.empty()) {
         std::cout << "\nNo accounts found.\n";
         return;
@@ -89,16 +79,14 @@ void displayAccounts(const std::shared_ptr<User>& user) {
 }
 
 void displayTransactionHistory(const std::shared_ptr<Account>& account) {
-    auto transactions = account->getTransactionHistory();
-    if (transactions.empty()) {
+    auto recent = account->getRecentTransactions(10);
+    if (recent.transactions.empty()) {
         std::cout << "\nNo transactions found.\n";
         return;
     }
     
     std::cout << "\n=== Transaction History ===\n";
-    int count = 0;
-    for (auto it = transactions.rbegin(); it != transactions.rend() && count < 10; ++it, ++count) {
-        auto tx = *it;
+    for (const Transaction* tx : recent.transactions) {
         std::cout << tx->getTimestampString() << " | "
                   << std::setw(12) << std::left << tx->getTypeString() << " | $"
                   << std::fixed << std::setprecision(2) << tx->getAmount() << " | "
@@ -114,7 +102,7 @@ void handleCreateUser() {
     std::string name = readStringInput("Enter your name: ");
     std::string email = readStringInput("Enter your email: ");
     
-    if (users_by_email.find(email) != users_by_email.end()) {
+    if (user_directory.hasEmail(email)) {
         std::cout << "Error: A user with this email already exists.\n";
         return;
     }
@@ -128,8 +116,7 @@ void handleCreateUser() {
     }
     
     try {
-        auto user = std::make_shared<User>(next_user_id++, name, email, hashPassword(password));
-        users_by_email[email] = user;
+        user_directory.createUser(name, email, User::hashPassword(password));
         std::cout << "✅ User created successfully! You can now log in.\n";
     } catch (const std::exception& e) {
         std::cout << "Error creating user: " << e.what() << "\n";
@@ -142,18 +129,18 @@ void handleLogin() {
     std::string email = readStringInput("Email: ");
     std::string password = readStringInput("Password: ");
     
-    auto it = users_by_email.find(email);
-    if (it == users_by_email.end()) {
+    auto user = user_directory.findUserByEmail(email);
+    if (!user) {
         std::cout << "Error: User not found.\n";
         return;
     }
     
-    if (!verifyPassword(password, it->second->getPasswordHash())) {
+    if (!user->verifyPassword(password)) {
         std::cout << "Error: Incorrect password.\n";
         return;
     }
     
-    logged_in_user = it->second;
+    logged_in_user = user;
     std::cout << "✅ Login successful! Welcome, " << logged_in_user->getName() << "!\n";
 }
 
@@ -177,9 +164,7 @@ void handleCreateAccount() {
     double initial_balance = readDoubleInput("Enter initial balance: $");
     
     try {
-        auto account = std::make_shared<Account>(next_account_id++, logged_in_user->getUserId(), type, initial_balance);
-        logged_in_user->addAccount(account);
-        accounts_by_id[account->getAccountId()] = account;
+        auto account = user_directory.createAccount(logged_in_user->getUserId(), type, initial_balance);
         std::cout << "✅ Account created successfully! Account ID: " << account->getAccountId() << "\n";
     } catch (const std::exception& e) {
         std::cout << "Error creating account: " << e.what() << "\n";
@@ -200,7 +185,11 @@ void handleDeposit() {
     std::string description = readStringInput("Description (optional): ");
     
     try {
-        transaction_service.processDeposit(account, amount, description);
+        auto result = transaction_service.processDeposit(account, amount, description);
+        if (!result) {
+            std::cout << "Error: " << result.reason << "\n";
+            return;
+        }
         std::cout << "✅ Deposit successful! New balance: $" << std::fixed << std::setprecision(2) << account->getBalance() << "\n";
     } catch (const std::exception& e) {
         std::cout << "Error: " << e.what() << "\n";
@@ -221,7 +210,11 @@ void handleWithdrawal() {
     std::string description = readStringInput("Description (optional): ");
     
     try {
-        transaction_service.processWithdrawal(account, amount, description);
+        auto result = transaction_service.processWithdrawal(account, amount, description);
+        if (!result) {
+            std::cout << "Error: " << result.reason << "\n";
+            return;
+        }
         std::cout << "✅ Withdrawal successful! New balance: $" << std::fixed << std::setprecision(2) << account->getBalance() << "\n";
     } catch (const std::exception& e) {
         std::cout << "Error: " << e.what() << "\n";
@@ -239,9 +232,9 @@ void handleTransfer() {
     }
     
     int to_id = readIntInput("Enter destination account ID: ");
-    auto to_account = accounts_by_id.find(to_id);
+    auto to_account = user_directory.findAccount(to_id);
     
-    if (to_account == accounts_by_id.end()) {
+    if (!to_account) {
         std::cout << "Error: Destination account not found.\n";
         return;
     }
@@ -250,10 +243,14 @@ void handleTransfer() {
     std::string description = readStringInput("Description (optional): ");
     
     try {
-        transaction_service.processTransfer(from_account, to_account->second, amount, description);
+        auto result = transaction_service.processTransfer(from_account, to_account, amount, description);
+        if (!result) {
+            std::cout << "Error: " << result.reason << "\n";
+            return;
+        }
         std::cout << "✅ Transfer successful!\n";
         std::cout << "From account balance: $" << std::fixed << std::setprecision(2) << from_account->getBalance() << "\n";
-        std::cout << "To account balance: $" << std::fixed << std::setprecision(2) << to_account->second->getBalance() << "\n";
+        std::cout << "To account balance: $" << std::fixed << std::setprecision(2) << to_account->getBalance() << "\n";
     } catch (const std::exception& e) {
         std::cout << "Error: " << e.what() << "\n";
     }
@@ -298,8 +295,47 @@ void displayLoggedInMenu() {
     std::cout << "──────────────────────────────────────\n";
 }
 
+// Command mode: FinTrack --batch [file|-] [--quiet]
+int runBatch(int argc, char* argv[]) {
+    std::string path = "-";
+    bool quiet = false;
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--quiet") {
+            quiet = true;
+        } else {
+            path = arg;
+        }
+    }
+
+    std::ios::sync_with_stdio(false);
+    std::cin.tie(nullptr);
+
+    BatchCommandProcessor processor(user_directory, transaction_service);
+    BatchStats stats;
+    if (path == "-") {
+        stats = processor.run(std::cin, std::cout, quiet);
+    } else {
+        std::ifstream input(path);
+        if (!input) {
+            std::cerr << "Error: cannot open " << path << "\n";
+            return 1;
+        }
+        stats = processor.run(input, std::cout, quiet);
+    }
+
+    std::cerr << stats.commands << " commands (" << stats.succeeded << " succeeded, " << stats.failed
+              << " failed) in " << std::fixed << std::setprecision(3) << stats.seconds << " s, "
+              << std::setprecision(0) << stats.opsPerSecond() << " ops/sec\n";
+    return stats.failed == 0 ? 0 : 2;
+}
+
 // Main application loop
-int main() {
+int main(int argc, char* argv[]) {
+    if (argc > 1 && std::string(argv[1]) == "--batch") {
+        return runBatch(argc, argv);
+    }
+    
     std::cout << "╔════════════════════════════════════╗\n";
     std::cout << "║  🏦 FinTrack - Personal Finance   ║\n";
     std::cout << "║      Management System             ║\n";
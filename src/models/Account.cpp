@@ -1,8 +1,13 @@
 #include "Account.h"
 #include "Transaction.h"
+#include "Ledger.h"
 #include "../exceptions.h"
+#include "../utils/Metrics.h"
 #include <algorithm>
-#include <numeric>
+#include <chrono>
+#include <cmath>
+
+static_assert(std::atomic<double>::is_always_lock_free, "Balance reads must not take a lock");
 
 Account::Account() : account_id(0), user_id(0), type(AccountType::CHECKING), balance(0.0) {}
 
@@ -25,8 +30,7 @@ AccountType Account::getType() const {
 }
 
 double Account::getBalance() const {
-    std::lock_guard<std::mutex> lock(account_mutex);
-    return balance;
+    return balance.load(std::memory_order_acquire);
 }
 
 std::string Account::getTypeString() const {
@@ -34,25 +38,92 @@ std::string Account::getTypeString() const {
 }
 
 std::vector<std::shared_ptr<Transaction>> Account::getTransactionHistory() const {
-    std::lock_guard<std::mutex> lock(account_mutex);
-    return transaction_history;
+    std::lock_guard<ProfiledMutex> lock(account_mutex);
+    return transaction_history.toVector();
+}
+
+std::size_t Account::getTransactionCount() const {
+    std::lock_guard<ProfiledMutex> lock(account_mutex);
+    return transaction_history.size();
+}
+
+TransactionPage Account::getRecentTransactions(std::size_t count) const {
+    return getTransactionPage(TransactionPage::kNewest, count);
+}
+
+TransactionPage Account::getTransactionPage(std::size_t cursor, std::size_t limit) const {
+    std::lock_guard<ProfiledMutex> lock(account_mutex);
+    return transaction_history.page(cursor, limit);
+}
+
+TransactionPage Account::getTransactionsBetween(std::chrono::system_clock::time_point from,
+                                                std::chrono::system_clock::time_point to, std::size_t limit,
+                                                std::size_t cursor) const {
+    std::lock_guard<ProfiledMutex> lock(account_mutex);
+    return transaction_history.range(from, to, cursor, limit);
+}
+
+void Account::setHistoryPolicy(const HistoryTieringPolicy& policy) {
+    std::lock_guard<ProfiledMutex> lock(account_mutex);
+    transaction_history.setPolicy(policy, "account_" + std::to_string(account_id));
+}
+
+std::size_t Account::compactHistory() {
+    std::lock_guard<ProfiledMutex> lock(account_mutex);
+    return transaction_history.compact();
+}
+
+HistorySummary Account::getHistorySummary() const {
+    std::lock_guard<ProfiledMutex> lock(account_mutex);
+    return transaction_history.summarize();
+}
+
+HistorySummary Account::getHistorySummary(std::chrono::system_clock::time_point from,
+                                          std::chrono::system_clock::time_point to) const {
+    std::lock_guard<ProfiledMutex> lock(account_mutex);
+    return transaction_history.summarize(from, to);
 }
 
 // Setters
 void Account::setBalance(double balance) {
-    std::lock_guard<std::mutex> lock(account_mutex);
-    this->balance = balance;
+    std::lock_guard<ProfiledMutex> lock(account_mutex);
+    this->balance.store(balance, std::memory_order_release);
+    recordEvent(LedgerEventType::ADJUSTMENT, balance, -1, std::chrono::system_clock::now());
 }
 
 bool Account::deposit(double amount, const std::string& description) {
-    if (amount <= 0) {
-        throw InvalidTransactionException("Deposit amount must be positive");
+    throwIfFailed(tryDeposit(amount, description));
+    return true;
+}
+
+bool Account::withdraw(double amount, const std::string& description) {
+    throwIfFailed(tryWithdraw(amount, description));
+    return true;
+}
+
+bool Account::transfer(std::shared_ptr<Account> to_account, double amount, const std::string& description) {
+    throwIfFailed(tryTransfer(to_account, amount, description));
+    return true;
+}
+
+std::vector<std::shared_ptr<Transaction>> Account::post(const std::vector<JournalLeg>& legs,
+                                                       const std::string& description) {
+    std::vector<std::shared_ptr<Transaction>> recorded;
+    throwIfFailed(tryPost(legs, description, &recorded));
+    return recorded;
+}
+
+TransactionResult Account::tryDeposit(double amount, const std::string& description,
+                                      std::shared_ptr<Transaction> record) {
+    if (!std::isfinite(amount) || amount <= 0) {
+        return TransactionResult::failure(TransactionOutcome::INVALID_AMOUNT, "Deposit amount must be positive and finite");
     }
 
-    std::lock_guard<std::mutex> lock(account_mutex);
-    balance += amount;
+    lockForUpdate();
+    std::lock_guard<ProfiledMutex> lock(account_mutex, std::adopt_lock);
+    addToBalance(amount);
     
-    auto transaction = std::make_shared<Transaction>(
+    auto transaction = record ? std::move(record) : std::make_shared<Transaction>(
         static_cast<int>(transaction_history.size() + 1),
         account_id,
         amount,
@@ -62,25 +133,28 @@ bool Account::deposit(double amount, const std::string& description) {
     );
     
     transaction->setStatus(TransactionStatus::COMPLETED);
-    transaction_history.push_back(transaction);
+    recordEvent(LedgerEventType::DEPOSIT, amount, -1, transaction->getTimestamp());
+    transaction_history.append(transaction);
     
-    return true;
+    return TransactionResult::success();
 }
 
-bool Account::withdraw(double amount, const std::string& description) {
-    if (amount <= 0) {
-        throw InvalidTransactionException("Withdrawal amount must be positive");
+TransactionResult Account::tryWithdraw(double amount, const std::string& description,
+                                       std::shared_ptr<Transaction> record) {
+    if (!std::isfinite(amount) || amount <= 0) {
+        return TransactionResult::failure(TransactionOutcome::INVALID_AMOUNT, "Withdrawal amount must be positive and finite");
     }
 
-    std::lock_guard<std::mutex> lock(account_mutex);
+    lockForUpdate();
+    std::lock_guard<ProfiledMutex> lock(account_mutex, std::adopt_lock);
     
-    if (type != AccountType::CREDIT && balance < amount) {
-        throw InsufficientFundsException("Insufficient funds for withdrawal");
+    if (type != AccountType::CREDIT && balance.load(std::memory_order_relaxed) < amount) {
+        return TransactionResult::failure(TransactionOutcome::INSUFFICIENT_FUNDS, "Insufficient funds for withdrawal");
     }
 
-    balance -= amount;
+    addToBalance(-amount);
     
-    auto transaction = std::make_shared<Transaction>(
+    auto transaction = record ? std::move(record) : std::make_shared<Transaction>(
         static_cast<int>(transaction_history.size() + 1),
         account_id,
         amount,
@@ -90,40 +164,40 @@ bool Account::withdraw(double amount, const std::string& description) {
     );
     
     transaction->setStatus(TransactionStatus::COMPLETED);
-    transaction_history.push_back(transaction);
+    recordEvent(LedgerEventType::WITHDRAWAL, -amount, -1, transaction->getTimestamp());
+    transaction_history.append(transaction);
     
-    return true;
+    return TransactionResult::success();
 }
 
-bool Account::transfer(std::shared_ptr<Account> to_account, double amount, const std::string& description) {
+TransactionResult Account::tryTransfer(const std::shared_ptr<Account>& to_account, double amount, 
+                                       const std::string& description, std::shared_ptr<Transaction> record) {
     if (!to_account) {
-        throw InvalidAccountException("Invalid destination account");
+        return TransactionResult::failure(TransactionOutcome::INVALID_ACCOUNT, "Invalid destination account");
     }
     
-    if (amount <= 0) {
-        throw InvalidTransactionException("Transfer amount must be positive");
+    if (!std::isfinite(amount) || amount <= 0) {
+        return TransactionResult::failure(TransactionOutcome::INVALID_AMOUNT, "Transfer amount must be positive and finite");
     }
     
     if (account_id == to_account->getAccountId()) {
-        throw InvalidTransactionException("Cannot transfer to the same account");
+        return TransactionResult::failure(TransactionOutcome::INVALID_ACCOUNT, "Cannot transfer to the same account");
     }
 
-    // Lock both accounts in consistent order to prevent deadlock
-    std::mutex* first_mutex = (account_id < to_account->getAccountId()) ? &account_mutex : &(to_account->account_mutex);
-    std::mutex* second_mutex = (account_id < to_account->getAccountId()) ? &(to_account->account_mutex) : &account_mutex;
+    // Lock both accounts in the global order to prevent deadlock
+    auto locks = lockInOrder({this, to_account.get()});
     
-    std::lock_guard<std::mutex> lock1(*first_mutex);
-    std::lock_guard<std::mutex> lock2(*second_mutex);
-    
-    if (type != AccountType::CREDIT && balance < amount) {
-        throw InsufficientFundsException("Insufficient funds for transfer");
+    if (type != AccountType::CREDIT && balance.load(std::memory_order_relaxed) < amount) {
+        return TransactionResult::failure(TransactionOutcome::INSUFFICIENT_FUNDS, "Insufficient funds for transfer");
     }
 
-    balance -= amount;
-    to_account->balance += amount;
+    // Both balances change under both locks, so writers still see the pair
+    // atomically; a lock-free reader sees each balance before or after
+    addToBalance(-amount);
+    to_account->addToBalance(amount);
     
     std::string transfer_desc = description.empty() ? "Transfer" : description;
-    auto out_transaction = std::make_shared<Transaction>(
+    auto out_transaction = record ? std::move(record) : std::make_shared<Transaction>(
         static_cast<int>(transaction_history.size() + 1),
         account_id,
         amount,
@@ -133,7 +207,8 @@ bool Account::transfer(std::shared_ptr<Account> to_account, double amount, const
     );
     out_transaction->setToAccountId(to_account->getAccountId());
     out_transaction->setStatus(TransactionStatus::COMPLETED);
-    transaction_history.push_back(out_transaction);
+    recordEvent(LedgerEventType::TRANSFER_OUT, -amount, to_account->getAccountId(), out_transaction->getTimestamp());
+    transaction_history.append(out_transaction);
     
     // Incoming transaction
     auto in_transaction = std::make_shared<Transaction>(
@@ -146,16 +221,148 @@ bool Account::transfer(std::shared_ptr<Account> to_account, double amount, const
     );
     in_transaction->setToAccountId(account_id);
     in_transaction->setStatus(TransactionStatus::COMPLETED);
-    to_account->transaction_history.push_back(in_transaction);
+    to_account->recordEvent(LedgerEventType::TRANSFER_IN, amount, account_id, in_transaction->getTimestamp());
+    to_account->transaction_history.append(in_transaction);
     
-    return true;
+    return TransactionResult::success();
+}
+
+TransactionResult Account::tryPost(const std::vector<JournalLeg>& legs, const std::string& description,
+                                   std::vector<std::shared_ptr<Transaction>>* recorded,
+                                   const std::vector<std::shared_ptr<Transaction>>* records) {
+    if (legs.size() < 2) {
+        return TransactionResult::failure(TransactionOutcome::UNBALANCED_ENTRY, "Journal entry needs at least two legs");
+    }
+    
+    // Balance is checked in cents so rounding noise cannot unbalance an entry
+    long long net_cents = 0;
+    std::vector<Account*> accounts;
+    accounts.reserve(legs.size());
+    for (const auto& leg : legs) {
+        if (!leg.account) {
+            return TransactionResult::failure(TransactionOutcome::INVALID_ACCOUNT, "Invalid account in journal entry");
+        }
+        if (!std::isfinite(leg.amount) || leg.amount == 0.0) {
+            return TransactionResult::failure(TransactionOutcome::INVALID_AMOUNT, "Journal leg amount must be non-zero");
+        }
+        net_cents += std::llround(leg.amount * 100.0);
+        accounts.push_back(leg.account.get());
+    }
+    if (net_cents != 0) {
+        return TransactionResult::failure(TransactionOutcome::UNBALANCED_ENTRY, "Journal entry is not balanced");
+    }
+    if (records && records->size() != legs.size()) {
+        return TransactionResult::failure(TransactionOutcome::UNBALANCED_ENTRY, "Journal entry needs one record per leg");
+    }
+    
+    auto locks = lockInOrder(accounts);
+    
+    // Validate every leg before touching any balance; an account appearing
+    // in several legs is checked against its net change
+    for (std::size_t i = 0; i < legs.size(); ++i) {
+        Account* account = legs[i].account.get();
+        if (account->type == AccountType::CREDIT) continue;
+        
+        bool first_leg_for_account = true;
+        double net = 0.0;
+        for (std::size_t j = 0; j < legs.size(); ++j) {
+            if (legs[j].account.get() != account) continue;
+            if (j < i) {
+                first_leg_for_account = false;
+                break;
+            }
+            net += legs[j].amount;
+        }
+        if (first_leg_for_account && account->balance.load(std::memory_order_relaxed) + net < 0.0) {
+            return TransactionResult::failure(TransactionOutcome::INSUFFICIENT_FUNDS, 
+                                              "Insufficient funds for journal entry");
+        }
+    }
+    
+    std::string entry_desc = description.empty() ? "Journal entry" : description;
+    if (recorded) {
+        recorded->reserve(recorded->size() + legs.size());
+    }
+    for (std::size_t i = 0; i < legs.size(); ++i) {
+        const JournalLeg& leg = legs[i];
+        Account& account = *leg.account;
+        account.addToBalance(leg.amount);
+        
+        auto transaction = records ? (*records)[i] : std::make_shared<Transaction>(
+            static_cast<int>(account.transaction_history.size() + 1),
+            account.account_id,
+            std::fabs(leg.amount),
+            leg.amount < 0 ? TransactionType::TRANSFER_OUT : TransactionType::TRANSFER_IN,
+            TransactionCategory::OTHER,
+            leg.description.empty() ? entry_desc : leg.description
+        );
+        transaction->setStatus(TransactionStatus::COMPLETED);
+        account.recordEvent(leg.amount < 0 ? LedgerEventType::TRANSFER_OUT : LedgerEventType::TRANSFER_IN,
+                            leg.amount, -1, transaction->getTimestamp());
+        account.transaction_history.append(transaction);
+        if (recorded) {
+            recorded->push_back(std::move(transaction));
+        }
+    }
+    
+    return TransactionResult::success();
 }
 
 void Account::addTransaction(std::shared_ptr<Transaction> transaction) {
     if (transaction && transaction->getAccountId() == account_id) {
-        std::lock_guard<std::mutex> lock(account_mutex);
-        transaction_history.push_back(transaction);
+        std::lock_guard<ProfiledMutex> lock(account_mutex);
+        transaction_history.append(transaction);
+    }
+}
+
+void Account::attachLedger(std::shared_ptr<Ledger> ledger) {
+    std::lock_guard<ProfiledMutex> lock(account_mutex);
+    if (this->ledger == ledger) return;
+    this->ledger = std::move(ledger);
+    if (!this->ledger) return;
+    
+    LedgerEvent opened;
+    opened.account_id = account_id;
+    opened.type = LedgerEventType::OPENED;
+    opened.amount = balance.load(std::memory_order_relaxed);
+    opened.related_id = user_id;
+    opened.account_type = type;
+    opened.timestamp_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    this->ledger->append(opened);
+}
+
+std::shared_ptr<Ledger> Account::getLedger() const {
+    std::lock_guard<ProfiledMutex> lock(account_mutex);
+    return ledger;
+}
+
+void Account::applyLedgerEvent(const LedgerEvent& event) {
+    static const TransactionType kHistoryTypes[] = {
+        TransactionType::DEPOSIT, TransactionType::DEPOSIT, TransactionType::WITHDRAWAL,
+        TransactionType::TRANSFER_OUT, TransactionType::TRANSFER_IN, TransactionType::DEPOSIT};
+    
+    std::lock_guard<ProfiledMutex> lock(account_mutex);
+    if (event.setsBalance()) {
+        balance.store(event.amount, std::memory_order_release);
+        return;
+    }
+    addToBalance(event.amount);
+    
+    auto transaction = std::make_shared<Transaction>(
+        static_cast<int>(transaction_history.size() + 1),
+        account_id,
+        std::fabs(event.amount),
+        kHistoryTypes[static_cast<int>(event.type)],
+        TransactionCategory::OTHER,
+        "Replayed " + Ledger::eventTypeToString(event.type)
+    );
+    if (event.related_id >= 0) {
+        transaction->setToAccountId(event.related_id);
     }
+    transaction->setTimestamp(event.getTimestamp());
+    transaction->setStatus(TransactionStatus::COMPLETED);
+    transaction_history.append(transaction);
 }
 
 void Account::displayAccountInfo() const {
@@ -164,21 +371,92 @@ void Account::displayAccountInfo() const {
 }
 
 double Account::calculateMonthlyAverage() const {
-    std::lock_guard<std::mutex> lock(account_mutex);
+    std::lock_guard<ProfiledMutex> lock(account_mutex);
     
     if (transaction_history.empty()) return 0.0;
     
-    double total = std::accumulate(transaction_history.begin(), transaction_history.end(), 0.0,
-        [](double sum, const std::shared_ptr<Transaction>& tx) {
-            return sum + tx->getAmount();
-        });
-    
-    return total / transaction_history.size();
+    // Archived segments contribute through their summaries
+    HistorySummary summary = transaction_history.summarize();
+    return summary.total_amount / summary.count;
 }
 
 bool Account::hasInsufficientFunds(double amount) const {
-    std::lock_guard<std::mutex> lock(account_mutex);
-    return (type != AccountType::CREDIT) && (balance < amount);
+    return (type != AccountType::CREDIT) && (getBalance() < amount);
+}
+
+// Private methods
+void Account::throwIfFailed(const TransactionResult& result) {
+    switch (result.outcome) {
+        case TransactionOutcome::SUCCESS:
+            return;
+        case TransactionOutcome::INSUFFICIENT_FUNDS:
+            throw InsufficientFundsException(result.reason);
+        case TransactionOutcome::INVALID_ACCOUNT:
+            throw InvalidAccountException(result.reason);
+        default:
+            throw InvalidTransactionException(result.reason);
+    }
+}
+
+std::vector<std::unique_lock<ProfiledMutex>> Account::lockInOrder(std::vector<Account*> accounts) {
+    std::sort(accounts.begin(), accounts.end(), [](const Account* a, const Account* b) {
+        return a->account_id != b->account_id ? a->account_id < b->account_id : a < b;
+    });
+    accounts.erase(std::unique(accounts.begin(), accounts.end()), accounts.end());
+    
+    std::vector<std::unique_lock<ProfiledMutex>> locks;
+    locks.reserve(accounts.size());
+    for (Account* account : accounts) {
+        account->lockForUpdate();
+        locks.emplace_back(account->account_mutex, std::adopt_lock);
+    }
+    return locks;
+}
+
+void Account::lockForUpdate() const {
+    // Balance-changing paths only; the uncontended case costs the same as
+    // lock() and reads no clock
+    static Counter& uncontended = MetricsRegistry::instance().counter(
+        "fintrack_account_lock_acquisitions_total", "Account lock acquisitions by balance updates.",
+        {{"contended", "false"}});
+    static Counter& contended = MetricsRegistry::instance().counter(
+        "fintrack_account_lock_acquisitions_total", "Account lock acquisitions by balance updates.",
+        {{"contended", "true"}});
+    static LatencySummary& wait = MetricsRegistry::instance().latency(
+        "fintrack_account_lock_wait_seconds", "Time balance updates waited for a contended account lock.");
+
+    if (account_mutex.try_lock()) {
+        uncontended.increment();
+        return;
+    }
+    if (!MetricsRegistry::isEnabled()) {
+        account_mutex.lock();
+        return;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    account_mutex.lock();
+    wait.record(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+    contended.increment();
+}
+
+void Account::recordEvent(LedgerEventType type, double amount, int related_id,
+                          std::chrono::system_clock::time_point timestamp) const {
+    if (!ledger) return;
+    
+    LedgerEvent event;
+    event.account_id = account_id;
+    event.type = type;
+    event.amount = amount;
+    event.related_id = related_id;
+    event.timestamp_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(timestamp.time_since_epoch()).count();
+    ledger->append(event);
+}
+
+void Account::addToBalance(double delta) {
+    // Writers are serialised by account_mutex, so a plain load/store pair
+    // suffices; release publishes the new value to lock-free readers
+    balance.store(balance.load(std::memory_order_relaxed) + delta, std::memory_order_release);
 }
 
 std::string Account::accountTypeToString(AccountType type) {
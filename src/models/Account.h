@@ -5,8 +5,11 @@
 #include <vector>
 #include <memory>
 #include <mutex>
-
-class Transaction;
+#include <atomic>
+#include <chrono>
+#include "Transaction.h"
+#include "TransactionHistory.h"
+#include "../utils/LockProfiler.h"
 
 enum class AccountType {
     SAVINGS,
@@ -15,14 +18,43 @@ enum class AccountType {
     INVESTMENT
 };
 
+class Account;
+class Ledger;
+struct LedgerEvent;
+enum class LedgerEventType;
+
+// One side of a journal entry: negative amounts debit the account, positive
+// amounts credit it
+struct JournalLeg {
+    std::shared_ptr<Account> account;
+    double amount;
+    std::string description;
+    
+    JournalLeg(std::shared_ptr<Account> acc, double amt, const std::string& desc = "")
+        : account(std::move(acc)), amount(amt), description(desc) {}
+};
+
 class Account {
 private:
     int account_id;
     int user_id;
     AccountType type;
-    double balance;
-    std::vector<std::shared_ptr<Transaction>> transaction_history;
-    mutable std::mutex account_mutex;  // For thread safety
+    TransactionHistory transaction_history;
+    mutable ProfiledMutex account_mutex{"Account::account_mutex", account_id}; // Keyed by the ID above
+    // Written only with account_mutex held, read without it. Kept on its own
+    // cache line so readers are not invalidated by traffic on the mutex.
+    alignas(64) std::atomic<double> balance;
+    std::shared_ptr<Ledger> ledger; // Receives every balance change; guarded by account_mutex
+    
+    void addToBalance(double delta); // Expects account_mutex to be held
+    void recordEvent(LedgerEventType type, double amount, int related_id,
+                     std::chrono::system_clock::time_point timestamp) const; // Expects account_mutex to be held
+    void lockForUpdate() const;      // Takes account_mutex, timing the wait when contended
+    
+    // Locks every distinct account in account_id order, the one global order
+    // all multi-account operations use
+    static std::vector<std::unique_lock<ProfiledMutex>> lockInOrder(std::vector<Account*> accounts);
+    static void throwIfFailed(const TransactionResult& result);
 
 public:
     // Constructors
@@ -36,25 +68,71 @@ public:
     int getAccountId() const;
     int getUserId() const;
     AccountType getType() const;
-    double getBalance() const;
+    double getBalance() const; // Wait-free
     std::string getTypeString() const;
-    std::vector<std::shared_ptr<Transaction>> getTransactionHistory() const;
+    std::vector<std::shared_ptr<Transaction>> getTransactionHistory() const; // Full copy; prefer the pages below
+    std::size_t getTransactionCount() const;
+    
+    // History pages, newest first. Cost depends on the page size, not on the
+    // length of the history; each page keeps its entries alive.
+    TransactionPage getRecentTransactions(std::size_t count) const;
+    TransactionPage getTransactionPage(std::size_t cursor, std::size_t limit) const; // cursor: TransactionPage::kNewest or a next_cursor
+    TransactionPage getTransactionsBetween(std::chrono::system_clock::time_point from,
+                                           std::chrono::system_clock::time_point to, std::size_t limit,
+                                           std::size_t cursor = TransactionPage::kNewest) const;
+    
+    // History tiering: older entries are archived into compressed segments
+    void setHistoryPolicy(const HistoryTieringPolicy& policy);
+    std::size_t compactHistory();
+    HistorySummary getHistorySummary() const;
+    HistorySummary getHistorySummary(std::chrono::system_clock::time_point from,
+                                     std::chrono::system_clock::time_point to) const;
     
     // Setters
     void setBalance(double balance);
     
-    // Transaction operations (thread-safe)
+    // Transaction operations (thread-safe). The try* forms report declines
+    // and invalid input in the result; the others throw on failure. Given a
+    // record (the caller's own, e.g. TransactionService's), a successful try*
+    // appends that object to the history instead of creating one, so later
+    // changes to it such as a fraud flag show in the history too.
+    TransactionResult tryDeposit(double amount, const std::string& description = "",
+                                 std::shared_ptr<Transaction> record = nullptr);
+    TransactionResult tryWithdraw(double amount, const std::string& description = "",
+                                  std::shared_ptr<Transaction> record = nullptr);
+    TransactionResult tryTransfer(const std::shared_ptr<Account>& to_account, double amount, 
+                                  const std::string& description = "",
+                                  std::shared_ptr<Transaction> record = nullptr); // The outgoing leg
     bool deposit(double amount, const std::string& description = "");
     bool withdraw(double amount, const std::string& description = "");
     bool transfer(std::shared_ptr<Account> to_account, double amount, const std::string& description = "");
     
+    // Applies a balanced N-leg journal entry atomically: all accounts are
+    // locked in one ordered pass and either every leg is applied or none is.
+    // recorded receives the history entry made for each leg, in leg order.
+    // Given records (one per leg, in leg order), those objects are appended
+    // instead, as with the single-account try* methods.
+    static TransactionResult tryPost(const std::vector<JournalLeg>& legs, const std::string& description = "",
+                                     std::vector<std::shared_ptr<Transaction>>* recorded = nullptr,
+                                     const std::vector<std::shared_ptr<Transaction>>* records = nullptr);
+    static std::vector<std::shared_ptr<Transaction>> post(const std::vector<JournalLeg>& legs,
+                                                          const std::string& description = "");
+    
     // Transaction management
     void addTransaction(std::shared_ptr<Transaction> transaction);
     
+    // Event sourcing. Attaching records the current balance as the opening
+    // event; every later change is appended to the ledger under the account
+    // lock. applyLedgerEvent replays one event without validation, adding
+    // the matching history entry, to rebuild an account from a log.
+    void attachLedger(std::shared_ptr<Ledger> ledger);
+    std::shared_ptr<Ledger> getLedger() const;
+    void applyLedgerEvent(const LedgerEvent& event);
+    
     // Utility functions
     void displayAccountInfo() const;
     double calculateMonthlyAverage() const;
-    bool hasInsufficientFunds(double amount) const;
+    bool hasInsufficientFunds(double amount) const; // Wait-free
     
     // Static utility functions
     static std::string accountTypeToString(AccountType type);
@@ -1,17 +1,57 @@
 #include "Budget.h"
+#include "../utils/TimeZone.h"
+#include "../utils/PeriodCalendar.h"
 #include <algorithm>
+#include <stdexcept>
+#include <cmath>
+
+namespace {
+    std::int64_t toCents(double amount) {
+        return static_cast<std::int64_t>(std::llround(amount * 100.0));
+    }
+    
+    double fromCents(std::int64_t cents) {
+        return static_cast<double>(cents) / 100.0;
+    }
+}
 
 // Budget class implementation
 Budget::Budget() 
     : budget_id(0), user_id(0), category(TransactionCategory::OTHER), 
-      monthly_limit(0.0), current_spent(0.0), alert_enabled(true), alert_threshold(0.8) {
-    updatePeriod();
+      limit_cents(0), alert_cents(0), period_spent(0), alert_enabled(true), alert_threshold(0.8),
+      calendar(PeriodCalendar::local().get()) {
+    resetBudget();
 }
 
 Budget::Budget(int budget_id, int user_id, TransactionCategory category, double monthly_limit, double alert_threshold)
-    : budget_id(budget_id), user_id(user_id), category(category), monthly_limit(monthly_limit), 
-      current_spent(0.0), alert_enabled(true), alert_threshold(alert_threshold) {
-    updatePeriod();
+    : budget_id(budget_id), user_id(user_id), category(category), limit_cents(toCents(monthly_limit)), 
+      alert_cents(0), period_spent(0), alert_enabled(true), alert_threshold(alert_threshold),
+      calendar(PeriodCalendar::local().get()) {
+    updateAlertCents();
+    resetBudget();
+}
+
+Budget::Budget(const Budget& other)
+    : budget_id(other.budget_id), user_id(other.user_id), category(other.category),
+      limit_cents(other.limit_cents.load(std::memory_order_relaxed)),
+      alert_cents(other.alert_cents.load(std::memory_order_relaxed)),
+      period_spent(other.period_spent.load(std::memory_order_relaxed)),
+      alert_enabled(other.alert_enabled.load(std::memory_order_relaxed)),
+      alert_threshold(other.alert_threshold), calendar(other.calendar.load(std::memory_order_acquire)) {}
+
+Budget& Budget::operator=(const Budget& other) {
+    if (this != &other) {
+        budget_id = other.budget_id;
+        user_id = other.user_id;
+        category = other.category;
+        limit_cents.store(other.limit_cents.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        alert_cents.store(other.alert_cents.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        period_spent.store(other.period_spent.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        alert_enabled.store(other.alert_enabled.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        alert_threshold = other.alert_threshold;
+        calendar.store(other.calendar.load(std::memory_order_acquire), std::memory_order_release);
+    }
+    return *this;
 }
 
 Budget::~Budget() {}
@@ -30,32 +70,43 @@ TransactionCategory Budget::getCategory() const {
 }
 
 double Budget::getMonthlyLimit() const {
-    return monthly_limit;
+    return fromCents(limit_cents.load(std::memory_order_relaxed));
 }
 
 double Budget::getCurrentSpent() const {
-    return current_spent;
+    return fromCents(spentCents());
 }
 
 double Budget::getRemainingBudget() const {
-    return monthly_limit - current_spent;
+    return fromCents(limit_cents.load(std::memory_order_relaxed) - spentCents());
 }
 
 double Budget::getSpentPercentage() const {
-    if (monthly_limit <= 0) return 0.0;
-    return current_spent / monthly_limit;
+    std::int64_t limit = limit_cents.load(std::memory_order_relaxed);
+    if (limit <= 0) return 0.0;
+    return static_cast<double>(spentCents()) / limit;
 }
 
 std::chrono::system_clock::time_point Budget::getStartDate() const {
-    return start_date;
+    const PeriodCalendar* current = calendar.load(std::memory_order_acquire);
+    return current->periodStart(current->currentPeriod());
 }
 
 std::chrono::system_clock::time_point Budget::getEndDate() const {
-    return end_date;
+    const PeriodCalendar* current = calendar.load(std::memory_order_acquire);
+    return current->periodEnd(current->currentPeriod());
+}
+
+std::uint32_t Budget::getPeriod() const {
+    return calendar.load(std::memory_order_acquire)->currentPeriod();
+}
+
+const PeriodCalendar& Budget::getCalendar() const {
+    return *calendar.load(std::memory_order_acquire);
 }
 
 bool Budget::isAlertEnabled() const {
-    return alert_enabled;
+    return alert_enabled.load(std::memory_order_relaxed);
 }
 
 double Budget::getAlertThreshold() const {
@@ -66,11 +117,12 @@ void Budget::setMonthlyLimit(double limit) {
     if (limit < 0) {
         throw std::invalid_argument("Monthly limit cannot be negative");
     }
-    this->monthly_limit = limit;
+    limit_cents.store(toCents(limit), std::memory_order_relaxed);
+    updateAlertCents();
 }
 
 void Budget::setAlertEnabled(bool enabled) {
-    this->alert_enabled = enabled;
+    alert_enabled.store(enabled, std::memory_order_relaxed);
 }
 
 void Budget::setAlertThreshold(double threshold) {
@@ -78,25 +130,80 @@ void Budget::setAlertThreshold(double threshold) {
         throw std::invalid_argument("Alert threshold must be between 0.0 and 1.0");
     }
     this->alert_threshold = threshold;
+    updateAlertCents();
+}
+
+void Budget::updateAlertCents() {
+    // Smallest spend for which getSpentPercentage() >= alert_threshold
+    double limit = static_cast<double>(limit_cents.load(std::memory_order_relaxed));
+    alert_cents.store(static_cast<std::int64_t>(std::ceil(limit * alert_threshold)), std::memory_order_relaxed);
+}
+
+void Budget::setTimeZone(std::shared_ptr<const TimeZone> time_zone) {
+    // Period numbers are shared by all zones, so spend already recorded
+    // this month stays with the budget
+    calendar.store(PeriodCalendar::forTimeZone(std::move(time_zone)).get(), std::memory_order_release);
+}
+
+std::shared_ptr<const TimeZone> Budget::getTimeZone() const {
+    return calendar.load(std::memory_order_acquire)->getTimeZone();
 }
 
-void Budget::addExpense(double amount) {
-    if (amount > 0) {
-        current_spent += amount;
+std::int64_t Budget::spentCents() const {
+    std::uint64_t packed = period_spent.load(std::memory_order_relaxed);
+    if ((packed >> kPeriodShift) < calendar.load(std::memory_order_acquire)->currentPeriod()) return 0;
+    return static_cast<std::int64_t>(packed & kCentsMask);
+}
+
+BudgetCrossing Budget::addExpense(double amount) {
+    if (amount <= 0) return BudgetCrossing::NONE;
+    
+    std::uint64_t cents = static_cast<std::uint64_t>(toCents(amount));
+    std::uint64_t period = calendar.load(std::memory_order_acquire)->currentPeriod();
+    std::uint64_t observed = period_spent.load(std::memory_order_relaxed);
+    std::int64_t before = -1;
+    
+    // First expense of a new period: whoever replaces the stale value starts
+    // the new total; anyone losing that race adds to it below
+    while ((observed >> kPeriodShift) < period) {
+        if (period_spent.compare_exchange_weak(observed, (period << kPeriodShift) | cents, 
+                                               std::memory_order_relaxed)) {
+            before = 0;
+            break;
+        }
+    }
+    
+    // The value before our add identifies the one caller that moves the total
+    // across a threshold, however many threads are spending concurrently
+    if (before < 0) {
+        before = static_cast<std::int64_t>(period_spent.fetch_add(cents, std::memory_order_relaxed) & kCentsMask);
+    }
+    std::int64_t after = before + static_cast<std::int64_t>(cents);
+    
+    std::int64_t limit = limit_cents.load(std::memory_order_relaxed);
+    if (before <= limit && after > limit) {
+        return BudgetCrossing::OVER_BUDGET;
+    }
+    
+    std::int64_t alert_at = alert_cents.load(std::memory_order_relaxed);
+    if (alert_enabled.load(std::memory_order_relaxed) && before < alert_at && after >= alert_at) {
+        return BudgetCrossing::APPROACHING_LIMIT;
     }
+    return BudgetCrossing::NONE;
 }
 
 void Budget::resetBudget() {
-    current_spent = 0.0;
-    updatePeriod();
+    std::uint64_t period = calendar.load(std::memory_order_acquire)->currentPeriod();
+    period_spent.store(period << kPeriodShift, std::memory_order_relaxed);
 }
 
 bool Budget::isOverBudget() const {
-    return current_spent > monthly_limit;
+    return spentCents() > limit_cents.load(std::memory_order_relaxed);
 }
 
 bool Budget::shouldAlert() const {
-    return alert_enabled && (getSpentPercentage() >= alert_threshold);
+    return alert_enabled.load(std::memory_order_relaxed) && 
+           spentCents() >= alert_cents.load(std::memory_order_relaxed);
 }
 
 void Budget::displayBudgetInfo() const {
@@ -122,113 +229,244 @@ std::string Budget::getCategoryString() const {
 
 // Date operations
 void Budget::updatePeriod() {
-    auto now = std::chrono::system_clock::now();
-    auto time_t = std::chrono::system_clock::to_time_t(now);
-    auto tm = *std::localtime(&time_t);
-    
-    // Set start to first day of current month
-    tm.tm_mday = 1;
-    tm.tm_hour = 0;
-    tm.tm_min = 0;
-    tm.tm_sec = 0;
-    start_date = std::chrono::system_clock::from_time_t(std::mktime(&tm));
-    
-    // Set end to last day of current month
-    tm.tm_mon += 1; // Next month
-    if (tm.tm_mon > 11) {
-        tm.tm_mon = 0;
-        tm.tm_year += 1;
+    std::uint64_t period = calendar.load(std::memory_order_acquire)->currentPeriod();
+    std::uint64_t observed = period_spent.load(std::memory_order_relaxed);
+    while ((observed >> kPeriodShift) < period &&
+           !period_spent.compare_exchange_weak(observed, period << kPeriodShift, std::memory_order_relaxed)) {
     }
-    tm.tm_mday = 0; // This will be the last day of the previous month
-    tm.tm_hour = 23;
-    tm.tm_min = 59;
-    tm.tm_sec = 59;
-    end_date = std::chrono::system_clock::from_time_t(std::mktime(&tm));
 }
 
 bool Budget::isCurrentPeriod() const {
-    auto now = std::chrono::system_clock::now();
-    return (now >= start_date && now <= end_date);
+    std::uint64_t period = calendar.load(std::memory_order_acquire)->currentPeriod();
+    return (period_spent.load(std::memory_order_relaxed) >> kPeriodShift) >= period;
+}
+
+// BudgetStatus implementation
+void BudgetStatus::load(std::uint16_t& over_mask, std::uint16_t& alert_mask) const {
+    std::uint64_t value = packed.load(std::memory_order_relaxed);
+    const PeriodCalendar* calendar = PeriodCalendar::byId(static_cast<std::uint16_t>(value >> 32));
+    if (!calendar || (value >> 48) < calendar->currentPeriod()) {
+        over_mask = 0;
+        alert_mask = 0;
+        return;
+    }
+    over_mask = static_cast<std::uint16_t>(value >> 16);
+    alert_mask = static_cast<std::uint16_t>(value);
+}
+
+void BudgetStatus::markCrossing(const PeriodCalendar& calendar, std::uint32_t period, 
+                                std::uint16_t bit, bool over_budget) {
+    std::uint64_t tag = (static_cast<std::uint64_t>(period) << 48) | 
+                        (static_cast<std::uint64_t>(calendar.getId()) << 32);
+    std::uint64_t flag = over_budget ? (static_cast<std::uint64_t>(bit) << 16) : bit;
+    std::uint64_t observed = packed.load(std::memory_order_relaxed);
+    
+    // Bits from an earlier period are dropped rather than merged
+    std::uint64_t desired;
+    do {
+        bool same_period = (observed & ~std::uint64_t(0xffffffff)) == tag;
+        desired = same_period ? (observed | flag) : (tag | flag);
+    } while (!packed.compare_exchange_weak(observed, desired, std::memory_order_relaxed));
+}
+
+void BudgetStatus::store(const PeriodCalendar* calendar, std::uint16_t over_mask, std::uint16_t alert_mask) {
+    if (!calendar) {
+        packed.store(0, std::memory_order_relaxed);
+        return;
+    }
+    packed.store((static_cast<std::uint64_t>(calendar->currentPeriod()) << 48) |
+                 (static_cast<std::uint64_t>(calendar->getId()) << 32) |
+                 (static_cast<std::uint64_t>(over_mask) << 16) | alert_mask, std::memory_order_relaxed);
 }
 
 // BudgetManager implementation
-BudgetManager::BudgetManager(int user_id) : user_id(user_id) {}
+BudgetManager::BudgetManager(int user_id) : present_mask(0), user_id(user_id), status(&own_status) {}
 
 BudgetManager::~BudgetManager() {}
 
+int BudgetManager::getUserId() const {
+    return user_id;
+}
+
+std::size_t BudgetManager::indexOf(TransactionCategory category) {
+    std::size_t index = static_cast<std::size_t>(category);
+    if (index >= kTransactionCategoryCount) {
+        throw std::invalid_argument("Unknown transaction category");
+    }
+    return index;
+}
+
 void BudgetManager::addBudget(const Budget& budget) {
     if (budget.getUserId() != user_id) {
         throw std::invalid_argument("Budget user ID doesn't match manager user ID");
     }
-    budgets[budget.getCategory()] = budget;
+    std::size_t index = indexOf(budget.getCategory());
+    
+    std::unique_lock<std::shared_mutex> lock(manager_mutex);
+    budgets[index] = budget;
+    present_mask |= static_cast<std::uint16_t>(1u << index);
+    refreshStatusLocked();
 }
 
 void BudgetManager::removeBudget(TransactionCategory category) {
-    auto it = budgets.find(category);
-    if (it == budgets.end()) {
+    std::size_t index = indexOf(category);
+    
+    std::unique_lock<std::shared_mutex> lock(manager_mutex);
+    if (!(present_mask & (1u << index))) {
         throw std::invalid_argument("Budget not found for specified category");
     }
-    budgets.erase(it);
+    present_mask &= static_cast<std::uint16_t>(~(1u << index));
+    budgets[index] = Budget();
+    refreshStatusLocked();
 }
 
 Budget* BudgetManager::getBudget(TransactionCategory category) {
-    auto it = budgets.find(category);
-    if (it != budgets.end()) {
-        return &(it->second);
+    std::size_t index = indexOf(category);
+    std::shared_lock<std::shared_mutex> lock(manager_mutex);
+    return (present_mask & (1u << index)) ? &budgets[index] : nullptr;
+}
+
+bool BudgetManager::hasBudget(TransactionCategory category) const {
+    std::size_t index = indexOf(category);
+    std::shared_lock<std::shared_mutex> lock(manager_mutex);
+    return (present_mask & (1u << index)) != 0;
+}
+
+void BudgetManager::updateBudgetLimit(TransactionCategory category, double monthly_limit) {
+    std::size_t index = indexOf(category);
+    
+    std::unique_lock<std::shared_mutex> lock(manager_mutex);
+    if (!(present_mask & (1u << index))) {
+        throw std::invalid_argument("Budget not found for specified category");
     }
-    return nullptr;
+    budgets[index].setMonthlyLimit(monthly_limit);
+    refreshStatusLocked();
 }
 
-void BudgetManager::recordExpense(TransactionCategory category, double amount) {
-    auto* budget = getBudget(category);
-    if (budget) {
-        budget->addExpense(amount);
+void BudgetManager::setTimeZone(std::shared_ptr<const TimeZone> time_zone) {
+    std::unique_lock<std::shared_mutex> lock(manager_mutex);
+    for (auto& budget : budgets) {
+        budget.setTimeZone(time_zone);
     }
+    refreshStatusLocked(); // Retag the masks with the new calendar
+}
+
+BudgetCrossing BudgetManager::recordExpense(TransactionCategory category, double amount) {
+    std::size_t index = static_cast<std::size_t>(category);
+    if (index >= kTransactionCategoryCount) return BudgetCrossing::NONE;
+    
+    BudgetAlert alert{user_id, category, BudgetCrossing::NONE, 0.0, 0.0};
+    BudgetAlertListener listener;
+    {
+        std::shared_lock<std::shared_mutex> lock(manager_mutex);
+        if (!(present_mask & (1u << index))) return BudgetCrossing::NONE;
+        
+        Budget& budget = budgets[index];
+        alert.crossing = budget.addExpense(amount);
+        if (alert.crossing == BudgetCrossing::NONE) return alert.crossing;
+        
+        status->markCrossing(budget.getCalendar(), budget.getPeriod(), static_cast<std::uint16_t>(1u << index),
+                             alert.crossing == BudgetCrossing::OVER_BUDGET);
+        
+        if (!alert_listener) return alert.crossing;
+        alert.current_spent = budget.getCurrentSpent();
+        alert.monthly_limit = budget.getMonthlyLimit();
+        listener = alert_listener;
+    }
+    
+    // Called without the lock so listeners may inspect or change budgets
+    listener(alert);
+    return alert.crossing;
+}
+
+void BudgetManager::setAlertListener(BudgetAlertListener listener) {
+    std::unique_lock<std::shared_mutex> lock(manager_mutex);
+    alert_listener = std::move(listener);
 }
 
 std::vector<Budget> BudgetManager::getOverBudgets() const {
+    std::shared_lock<std::shared_mutex> lock(manager_mutex);
     std::vector<Budget> over_budgets;
-    for (const auto& pair : budgets) {
-        if (pair.second.isOverBudget()) {
-            over_budgets.push_back(pair.second);
+    for (std::size_t i = 0; i < kTransactionCategoryCount; ++i) {
+        if ((present_mask & (1u << i)) && budgets[i].isOverBudget()) {
+            over_budgets.push_back(budgets[i]);
         }
     }
     return over_budgets;
 }
 
 std::vector<Budget> BudgetManager::getAlertsNeeded() const {
+    std::shared_lock<std::shared_mutex> lock(manager_mutex);
     std::vector<Budget> alert_budgets;
-    for (const auto& pair : budgets) {
-        if (pair.second.shouldAlert() && !pair.second.isOverBudget()) {
-            alert_budgets.push_back(pair.second);
+    for (std::size_t i = 0; i < kTransactionCategoryCount; ++i) {
+        if ((present_mask & (1u << i)) && budgets[i].shouldAlert() && !budgets[i].isOverBudget()) {
+            alert_budgets.push_back(budgets[i]);
         }
     }
     return alert_budgets;
 }
 
+std::uint16_t BudgetManager::getOverBudgetMask() const {
+    std::shared_lock<std::shared_mutex> lock(manager_mutex);
+    std::uint16_t over, alert;
+    status->load(over, alert);
+    return over;
+}
+
+std::uint16_t BudgetManager::getAlertMask() const {
+    std::shared_lock<std::shared_mutex> lock(manager_mutex);
+    std::uint16_t over, alert;
+    status->load(over, alert);
+    return static_cast<std::uint16_t>(alert & ~over);
+}
+
+void BudgetManager::refreshStatus() {
+    std::unique_lock<std::shared_mutex> lock(manager_mutex);
+    refreshStatusLocked();
+}
+
+void BudgetManager::refreshStatusLocked() {
+    // Tagged with the first budget's calendar; a user's budgets are expected
+    // to share a time zone
+    const PeriodCalendar* calendar = nullptr;
+    std::uint16_t over = 0;
+    std::uint16_t alert = 0;
+    for (std::size_t i = 0; i < kTransactionCategoryCount; ++i) {
+        if (!(present_mask & (1u << i))) continue;
+        if (!calendar) calendar = &budgets[i].getCalendar();
+        if (budgets[i].isOverBudget()) over |= static_cast<std::uint16_t>(1u << i);
+        if (budgets[i].shouldAlert()) alert |= static_cast<std::uint16_t>(1u << i);
+    }
+    status->store(calendar, over, alert);
+}
+
 void BudgetManager::displayAllBudgets() const {
     // This method is intentionally left for backwards compatibility
     // but should not be used in production. UI layer should handle display.
 }
 
 double BudgetManager::getTotalBudget() const {
+    std::shared_lock<std::shared_mutex> lock(manager_mutex);
     double total = 0.0;
-    for (const auto& pair : budgets) {
-        total += pair.second.getMonthlyLimit();
+    for (std::size_t i = 0; i < kTransactionCategoryCount; ++i) {
+        if (present_mask & (1u << i)) total += budgets[i].getMonthlyLimit();
     }
     return total;
 }
 
 double BudgetManager::getTotalSpent() const {
+    std::shared_lock<std::shared_mutex> lock(manager_mutex);
     double total = 0.0;
-    for (const auto& pair : budgets) {
-        total += pair.second.getCurrentSpent();
+    for (std::size_t i = 0; i < kTransactionCategoryCount; ++i) {
+        if (present_mask & (1u << i)) total += budgets[i].getCurrentSpent();
     }
     return total;
 }
 
 void BudgetManager::resetAllBudgets() {
-    for (auto& pair : budgets) {
-        pair.second.resetBudget();
+    std::unique_lock<std::shared_mutex> lock(manager_mutex);
+    for (std::size_t i = 0; i < kTransactionCategoryCount; ++i) {
+        if (present_mask & (1u << i)) budgets[i].resetBudget();
     }
+    refreshStatusLocked();
 }
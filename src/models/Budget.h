@@ -2,21 +2,60 @@
 #define BUDGET_H
 
 #include <string>
-#include <map>
+#include <array>
+#include <vector>
 #include <chrono>
+#include <memory>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <shared_mutex>
 #include "Transaction.h"
+#include "../utils/PeriodCalendar.h"
+
+// Threshold crossed by a single expense. Spending only grows within a period,
+// so each crossing is reported by exactly one addExpense call.
+enum class BudgetCrossing {
+    NONE,
+    APPROACHING_LIMIT, // Spent reached alert_threshold of the limit
+    OVER_BUDGET        // Spent exceeded the limit (supersedes APPROACHING_LIMIT)
+};
+
+struct BudgetAlert {
+    int user_id;
+    TransactionCategory category;
+    BudgetCrossing crossing;
+    double current_spent;
+    double monthly_limit;
+};
+
+using BudgetAlertListener = std::function<void(const BudgetAlert&)>;
 
 class Budget {
 private:
     int budget_id;
     int user_id;
     TransactionCategory category;
-    double monthly_limit;
-    double current_spent;
-    std::chrono::system_clock::time_point start_date;
-    std::chrono::system_clock::time_point end_date;
-    bool alert_enabled;
+    // Amounts are kept in cents so expenses can be added with a single
+    // atomic fetch_add from any thread
+    std::atomic<std::int64_t> limit_cents;
+    std::atomic<std::int64_t> alert_cents; // Spend at which shouldAlert() turns true
+    // Spend for one period: period number in the top 16 bits, cents below.
+    // A stale period number reads as zero spend, so month-end rollover is
+    // the calendar bumping its current period, not a pass over budgets.
+    std::atomic<std::uint64_t> period_spent;
+    std::atomic<bool> alert_enabled;
     double alert_threshold; // Percentage (0.0 to 1.0)
+    // Month boundaries in the budget's time zone. Calendars live for the
+    // process, so setTimeZone() can swap this while expenses are recorded.
+    std::atomic<const PeriodCalendar*> calendar;
+    
+    void updateAlertCents();
+    std::int64_t spentCents() const; // Zero if the stored period has ended
+    
+    static constexpr int kPeriodShift = 48;
+    static constexpr std::uint64_t kCentsMask = (std::uint64_t(1) << kPeriodShift) - 1;
 
 public:
     // Constructors
@@ -24,6 +63,9 @@ public:
     Budget(int budget_id, int user_id, TransactionCategory category, double monthly_limit, 
            double alert_threshold = 0.8);
     
+    Budget(const Budget& other);
+    Budget& operator=(const Budget& other);
+    
     // Destructor
     ~Budget();
     
@@ -37,6 +79,8 @@ public:
     double getSpentPercentage() const;
     std::chrono::system_clock::time_point getStartDate() const;
     std::chrono::system_clock::time_point getEndDate() const;
+    std::uint32_t getPeriod() const; // Current period of the budget's calendar
+    const PeriodCalendar& getCalendar() const;
     bool isAlertEnabled() const;
     double getAlertThreshold() const;
     
@@ -44,9 +88,11 @@ public:
     void setMonthlyLimit(double limit);
     void setAlertEnabled(bool enabled);
     void setAlertThreshold(double threshold);
+    void setTimeZone(std::shared_ptr<const TimeZone> time_zone);
+    std::shared_ptr<const TimeZone> getTimeZone() const;
     
     // Budget operations
-    void addExpense(double amount);
+    BudgetCrossing addExpense(double amount); // Thread-safe
     void resetBudget(); // Reset for new month
     bool isOverBudget() const;
     bool shouldAlert() const;
@@ -57,15 +103,39 @@ public:
     std::string getCategoryString() const;
     
     // Date operations
-    void updatePeriod(); // Update to current month
-    bool isCurrentPeriod() const;
+    void updatePeriod(); // Drop spend recorded in a period that has ended
+    bool isCurrentPeriod() const; // Stored spend belongs to the current period
+};
+
+// Over-budget / approaching-limit bits for one user, one bit per category.
+// Maintained at the moment of crossing so bulk queries never touch budgets.
+// The bits are tagged with the period and calendar they were set in and
+// read as clear once that calendar moves to a new period.
+struct BudgetStatus {
+    std::atomic<std::uint64_t> packed{0}; // period:16 | calendar id:16 | over:16 | alert:16
+    
+    void load(std::uint16_t& over_mask, std::uint16_t& alert_mask) const;
+    void markCrossing(const PeriodCalendar& calendar, std::uint32_t period, std::uint16_t bit, bool over_budget);
+    void store(const PeriodCalendar* calendar, std::uint16_t over_mask, std::uint16_t alert_mask);
 };
 
+static_assert(kTransactionCategoryCount <= 16, "BudgetStatus masks hold one bit per category");
+
 // Budget Manager class for handling multiple budgets
 class BudgetManager {
 private:
-    std::map<TransactionCategory, Budget> budgets;
+    std::array<Budget, kTransactionCategoryCount> budgets; // Indexed by category
+    std::uint16_t present_mask;                            // Bit set for each category with a budget
     int user_id;
+    BudgetAlertListener alert_listener;
+    BudgetStatus own_status;
+    BudgetStatus* status; // own_status, or a slot in the BudgetDirectory holding this manager
+    mutable std::shared_mutex manager_mutex; // Shared for expenses, exclusive for adding/removing budgets
+    
+    static std::size_t indexOf(TransactionCategory category);
+    void refreshStatusLocked();
+    
+    friend class BudgetDirectory;
 
 public:
     // Constructor
@@ -74,15 +144,28 @@ public:
     // Destructor
     ~BudgetManager();
     
+    BudgetManager(const BudgetManager&) = delete;
+    BudgetManager& operator=(const BudgetManager&) = delete;
+    
+    // Getters
+    int getUserId() const;
+    
     // Budget management
     void addBudget(const Budget& budget);
     void removeBudget(TransactionCategory category);
     Budget* getBudget(TransactionCategory category);
+    bool hasBudget(TransactionCategory category) const;
+    void updateBudgetLimit(TransactionCategory category, double monthly_limit);
+    void setTimeZone(std::shared_ptr<const TimeZone> time_zone); // Moves every budget held now
     
     // Expense tracking
-    void recordExpense(TransactionCategory category, double amount);
+    BudgetCrossing recordExpense(TransactionCategory category, double amount); // Notifies the listener on a crossing
+    void setAlertListener(BudgetAlertListener listener);
     std::vector<Budget> getOverBudgets() const;
     std::vector<Budget> getAlertsNeeded() const;
+    std::uint16_t getOverBudgetMask() const; // Bit (1 << category) per over-budget category
+    std::uint16_t getAlertMask() const;      // Approaching the limit but not over it
+    void refreshStatus(); // Recompute masks after editing a Budget obtained from getBudget()
     
     // Reports
     void displayAllBudgets() const;
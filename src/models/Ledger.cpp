@@ -0,0 +1,283 @@
+#include "Ledger.h"
+#include "../exceptions.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+
+namespace {
+    const char* kLogHeader = "sequence,timestamp_ns,account_id,type,amount,related_id,account_type";
+
+    std::vector<std::string> splitFields(const std::string& line) {
+        std::vector<std::string> fields;
+        std::size_t start = 0;
+        while (true) {
+            std::size_t comma = line.find(',', start);
+            fields.push_back(line.substr(start, comma == std::string::npos ? std::string::npos : comma - start));
+            if (comma == std::string::npos) break;
+            start = comma + 1;
+        }
+        return fields;
+    }
+
+    template <typename T>
+    bool parseInteger(const std::string& text, T& value) {
+        if (text.empty()) return false;
+        char* end = nullptr;
+        long long parsed = std::strtoll(text.c_str(), &end, 10);
+        if (*end != '\0') return false;
+        value = static_cast<T>(parsed);
+        return true;
+    }
+}
+
+std::chrono::system_clock::time_point LedgerEvent::getTimestamp() const {
+    return std::chrono::system_clock::time_point(
+        std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds(timestamp_ns)));
+}
+
+Ledger::Ledger() : next_sequence(1), event_count(0) {}
+
+std::uint64_t Ledger::append(LedgerEvent event) {
+    Shard& shard = shardFor(event.account_id);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    Stream& stream = shard.streams[event.account_id];
+    if (!stream.events.empty()) {
+        event.timestamp_ns = std::max(event.timestamp_ns, stream.events.back().timestamp_ns);
+    }
+    event.sequence = next_sequence.fetch_add(1, std::memory_order_relaxed);
+    appendToStream(stream, event);
+    event_count.fetch_add(1, std::memory_order_relaxed);
+    return event.sequence;
+}
+
+void Ledger::load(const std::vector<LedgerEvent>& events) {
+    std::uint64_t last_sequence = 0;
+    for (const auto& event : events) {
+        if (event.sequence <= last_sequence) {
+            throw std::invalid_argument("Ledger events must be in increasing sequence order");
+        }
+        last_sequence = event.sequence;
+
+        Shard& shard = shardFor(event.account_id);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        appendToStream(shard.streams[event.account_id], event);
+    }
+    event_count.fetch_add(events.size(), std::memory_order_relaxed);
+
+    std::uint64_t next = next_sequence.load(std::memory_order_relaxed);
+    while (next <= last_sequence &&
+           !next_sequence.compare_exchange_weak(next, last_sequence + 1, std::memory_order_relaxed)) {
+    }
+}
+
+std::size_t Ledger::compact(std::chrono::system_clock::time_point before) {
+    std::int64_t before_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(before.time_since_epoch()).count();
+    std::size_t dropped = 0;
+    for (auto& shard : shards) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        for (auto& entry : shard.streams) {
+            dropped += compactStream(entry.second, before_ns);
+        }
+    }
+    event_count.fetch_sub(dropped, std::memory_order_relaxed);
+    return dropped;
+}
+
+double Ledger::getBalanceAt(int account_id, std::chrono::system_clock::time_point at) const {
+    std::int64_t at_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(at.time_since_epoch()).count();
+
+    const Shard& shard = shardFor(account_id);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.streams.find(account_id);
+    if (it == shard.streams.end()) {
+        throw InvalidAccountException("Account " + std::to_string(account_id) + " has no ledger events");
+    }
+    const Stream& stream = it->second;
+
+    // Last checkpoint at or before the time, then the events after it
+    auto checkpoint = std::upper_bound(stream.checkpoints.begin(), stream.checkpoints.end(), at_ns,
+        [](std::int64_t time, const Checkpoint& c) { return time < c.timestamp_ns; });
+    double balance = 0.0;
+    std::size_t next = 0;
+    if (checkpoint != stream.checkpoints.begin()) {
+        --checkpoint;
+        balance = checkpoint->balance;
+        next = checkpoint->event_index + 1;
+    }
+    for (; next < stream.events.size() && stream.events[next].timestamp_ns <= at_ns; ++next) {
+        balance = stream.events[next].apply(balance);
+    }
+    return balance;
+}
+
+double Ledger::getBalance(int account_id) const {
+    const Shard& shard = shardFor(account_id);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.streams.find(account_id);
+    if (it == shard.streams.end()) {
+        throw InvalidAccountException("Account " + std::to_string(account_id) + " has no ledger events");
+    }
+    return it->second.balance;
+}
+
+// Getters
+std::size_t Ledger::getEventCount() const {
+    return event_count.load(std::memory_order_relaxed);
+}
+
+std::size_t Ledger::getAccountCount() const {
+    std::size_t total = 0;
+    for (const auto& shard : shards) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        total += shard.streams.size();
+    }
+    return total;
+}
+
+std::vector<LedgerEvent> Ledger::getEvents() const {
+    std::vector<LedgerEvent> events;
+    events.reserve(getEventCount());
+    for (const auto& shard : shards) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        for (const auto& entry : shard.streams) {
+            events.insert(events.end(), entry.second.events.begin(), entry.second.events.end());
+        }
+    }
+    std::sort(events.begin(), events.end(), [](const LedgerEvent& a, const LedgerEvent& b) {
+        return a.sequence < b.sequence;
+    });
+    return events;
+}
+
+std::vector<LedgerEvent> Ledger::getAccountEvents(int account_id) const {
+    const Shard& shard = shardFor(account_id);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.streams.find(account_id);
+    return it == shard.streams.end() ? std::vector<LedgerEvent>() : it->second.events;
+}
+
+void Ledger::writeLog(std::ostream& out) const {
+    out << kLogHeader << "\n";
+    char line[160];
+    for (const auto& event : getEvents()) {
+        // %.17g round-trips a double exactly
+        std::snprintf(line, sizeof(line), "%llu,%lld,%d,%s,%.17g,%d,%s\n",
+                      static_cast<unsigned long long>(event.sequence), static_cast<long long>(event.timestamp_ns),
+                      event.account_id, eventTypeToString(event.type).c_str(), event.amount, event.related_id,
+                      event.type == LedgerEventType::OPENED ? Account::accountTypeToString(event.account_type).c_str()
+                                                            : "");
+        out << line;
+    }
+}
+
+std::vector<LedgerEvent> Ledger::readLog(std::istream& in) {
+    std::vector<LedgerEvent> events;
+    std::string line;
+    std::size_t line_number = 0;
+    while (std::getline(in, line)) {
+        ++line_number;
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line.empty() || (line_number == 1 && line == kLogHeader)) continue;
+
+        std::vector<std::string> fields = splitFields(line);
+        LedgerEvent event;
+        char* end = nullptr;
+        bool valid = fields.size() == 7 && parseInteger(fields[0], event.sequence) &&
+                     parseInteger(fields[1], event.timestamp_ns) && parseInteger(fields[2], event.account_id) &&
+                     parseInteger(fields[5], event.related_id) && !fields[4].empty();
+        if (valid) {
+            event.amount = std::strtod(fields[4].c_str(), &end);
+            valid = *end == '\0';
+        }
+        try {
+            if (valid) {
+                event.type = stringToEventType(fields[3]);
+                if (event.type == LedgerEventType::OPENED) {
+                    event.account_type = Account::stringToAccountType(fields[6]);
+                }
+            }
+        } catch (const std::exception&) {
+            valid = false;
+        }
+        if (!valid) {
+            throw std::invalid_argument("Malformed ledger event on line " + std::to_string(line_number));
+        }
+        events.push_back(event);
+    }
+
+    std::stable_sort(events.begin(), events.end(), [](const LedgerEvent& a, const LedgerEvent& b) {
+        return a.sequence < b.sequence;
+    });
+    return events;
+}
+
+std::string Ledger::eventTypeToString(LedgerEventType type) {
+    switch (type) {
+        case LedgerEventType::OPENED: return "opened";
+        case LedgerEventType::DEPOSIT: return "deposit";
+        case LedgerEventType::WITHDRAWAL: return "withdrawal";
+        case LedgerEventType::TRANSFER_OUT: return "transfer_out";
+        case LedgerEventType::TRANSFER_IN: return "transfer_in";
+        case LedgerEventType::ADJUSTMENT: return "adjustment";
+        default: return "unknown";
+    }
+}
+
+LedgerEventType Ledger::stringToEventType(const std::string& text) {
+    if (text == "opened") return LedgerEventType::OPENED;
+    if (text == "deposit") return LedgerEventType::DEPOSIT;
+    if (text == "withdrawal") return LedgerEventType::WITHDRAWAL;
+    if (text == "transfer_out") return LedgerEventType::TRANSFER_OUT;
+    if (text == "transfer_in") return LedgerEventType::TRANSFER_IN;
+    if (text == "adjustment") return LedgerEventType::ADJUSTMENT;
+    throw std::invalid_argument("Unknown ledger event type: " + text);
+}
+
+// Private methods
+Ledger::Shard& Ledger::shardFor(int account_id) {
+    return shards[static_cast<unsigned>(account_id) % kShardCount];
+}
+
+const Ledger::Shard& Ledger::shardFor(int account_id) const {
+    return shards[static_cast<unsigned>(account_id) % kShardCount];
+}
+
+void Ledger::appendToStream(Stream& stream, const LedgerEvent& event) {
+    stream.balance = event.apply(stream.balance);
+    stream.events.push_back(event);
+    if (stream.events.size() % kCheckpointInterval == 0) {
+        stream.checkpoints.push_back({event.timestamp_ns, stream.events.size() - 1, stream.balance});
+    }
+}
+
+std::size_t Ledger::compactStream(Stream& stream, std::int64_t before_ns) {
+    auto checkpoint = std::upper_bound(stream.checkpoints.begin(), stream.checkpoints.end(), before_ns,
+        [](std::int64_t time, const Checkpoint& c) { return time < c.timestamp_ns; });
+    if (checkpoint == stream.checkpoints.begin()) return 0;
+    --checkpoint;
+    std::size_t folded = checkpoint->event_index;
+    if (folded == 0) return 0;
+
+    // The checkpoint's event becomes the new opening event, owned and typed
+    // as the account was when last opened
+    LedgerEvent base = stream.events[folded];
+    base.type = LedgerEventType::OPENED;
+    base.amount = checkpoint->balance;
+    for (std::size_t i = folded + 1; i-- > 0;) {
+        if (stream.events[i].type == LedgerEventType::OPENED) {
+            base.related_id = stream.events[i].related_id;
+            base.account_type = stream.events[i].account_type;
+            break;
+        }
+    }
+
+    stream.events.erase(stream.events.begin(), stream.events.begin() + static_cast<std::ptrdiff_t>(folded));
+    stream.events.front() = base;
+    stream.events.shrink_to_fit();
+    stream.checkpoints.erase(stream.checkpoints.begin(), checkpoint);
+    for (auto& kept : stream.checkpoints) {
+        kept.event_index -= folded;
+    }
+    return folded;
+}
@@ -0,0 +1,125 @@
+#ifndef LEDGER_H
+#define LEDGER_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+#include <istream>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "Account.h"
+
+enum class LedgerEventType {
+    OPENED,     // amount is the opening balance
+    DEPOSIT,
+    WITHDRAWAL,
+    TRANSFER_OUT,
+    TRANSFER_IN,
+    ADJUSTMENT  // amount is the balance set directly
+};
+
+// One balance change. Events are numbered in one global sequence; for any
+// single account that order is the order the balance changed in, so
+// applying an account's events in sequence order reproduces its balance
+// exactly, bit for bit.
+struct LedgerEvent {
+    std::uint64_t sequence = 0;
+    std::int64_t timestamp_ns = 0; // system_clock, since the epoch
+    int account_id = 0;
+    LedgerEventType type = LedgerEventType::DEPOSIT;
+    double amount = 0.0;   // Signed change, except for OPENED and ADJUSTMENT
+    int related_id = -1;   // Counterparty account for transfers, owning user for OPENED
+    AccountType account_type = AccountType::CHECKING; // OPENED only
+
+    bool setsBalance() const { return type == LedgerEventType::OPENED || type == LedgerEventType::ADJUSTMENT; }
+    double apply(double balance) const { return setsBalance() ? amount : balance + amount; }
+    std::chrono::system_clock::time_point getTimestamp() const;
+};
+
+// Append-only event stream of every balance change made to the accounts
+// attached to it, with a balance checkpoint every kCheckpointInterval
+// events per account. A point-in-time balance is a binary search for the
+// last checkpoint at or before the time plus a replay of at most
+// kCheckpointInterval - 1 events.
+//
+// Accounts append while holding their own lock, which keeps each account's
+// stream in balance order. Streams are spread over independently locked
+// shards by account ID.
+//
+// Events are kept until compact() folds the ones before a cutoff into each
+// account's checkpoint; write the log out first if the full history matters.
+class Ledger {
+public:
+    static constexpr std::size_t kShardCount = 16;
+    static constexpr std::size_t kCheckpointInterval = 64;
+
+    Ledger();
+
+    Ledger(const Ledger&) = delete;
+    Ledger& operator=(const Ledger&) = delete;
+
+    // Numbers the event and returns its sequence. Timestamps are clamped so
+    // they never go backwards within an account.
+    std::uint64_t append(LedgerEvent event);
+    // Rebuilds from a log, keeping its sequence numbers; events must be in
+    // sequence order (readLog returns them that way)
+    void load(const std::vector<LedgerEvent>& events);
+    // Replaces each account's events up to its last checkpoint at or before
+    // `before` with one OPENED event carrying the checkpoint balance, so
+    // logs written afterwards still replay to the same balances. Balances
+    // earlier than that checkpoint read as 0. Returns the events dropped.
+    std::size_t compact(std::chrono::system_clock::time_point before);
+
+    // Balance after every event up to and including `at`; 0 before the
+    // account was opened. Throws InvalidAccountException if it never was.
+    double getBalanceAt(int account_id, std::chrono::system_clock::time_point at) const;
+    double getBalance(int account_id) const;
+
+    // Getters
+    std::size_t getEventCount() const;
+    std::size_t getAccountCount() const;
+    std::vector<LedgerEvent> getEvents() const; // Sequence order
+    std::vector<LedgerEvent> getAccountEvents(int account_id) const;
+
+    // Log file: one CSV line per event, amounts printed so they read back
+    // exactly. readLog throws std::invalid_argument naming the bad line.
+    void writeLog(std::ostream& out) const;
+    static std::vector<LedgerEvent> readLog(std::istream& in);
+
+    static std::string eventTypeToString(LedgerEventType type);
+    static LedgerEventType stringToEventType(const std::string& text);
+
+private:
+    struct Checkpoint {
+        std::int64_t timestamp_ns;
+        std::size_t event_index; // Balance is after this event
+        double balance;
+    };
+
+    struct Stream {
+        std::vector<LedgerEvent> events;
+        std::vector<Checkpoint> checkpoints;
+        double balance = 0.0;
+    };
+
+    struct Shard {
+        mutable std::mutex mutex;
+        std::unordered_map<int, Stream> streams; // account_id -> stream
+    };
+
+    std::array<Shard, kShardCount> shards;
+    std::atomic<std::uint64_t> next_sequence;
+    std::atomic<std::size_t> event_count;
+
+    Shard& shardFor(int account_id);
+    const Shard& shardFor(int account_id) const;
+    static void appendToStream(Stream& stream, const LedgerEvent& event);
+    static std::size_t compactStream(Stream& stream, std::int64_t before_ns);
+};
+
+#endif // LEDGER_H
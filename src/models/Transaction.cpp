@@ -1,4 +1,5 @@
 #include "Transaction.h"
+#include "../utils/TimeZone.h"
 #include <sstream>
 #include <iomanip>
 
@@ -56,8 +57,11 @@ std::chrono::system_clock::time_point Transaction::getTimestamp() const {
 }
 
 std::string Transaction::getTimestampString() const {
-    auto time_t = std::chrono::system_clock::to_time_t(timestamp);
-    auto tm = *std::localtime(&time_t);
+    return getTimestampString(*TimeZone::local());
+}
+
+std::string Transaction::getTimestampString(const TimeZone& time_zone) const {
+    auto tm = time_zone.toLocalTm(timestamp);
     
     std::ostringstream oss;
     oss << std::put_time(&tm, "%Y-%m-%d %H:%M:%S");
@@ -68,7 +72,7 @@ bool Transaction::isSuspicious() const {
     return suspicious_flag;
 }
 
-std::string Transaction::getLocation() const {
+const std::string& Transaction::getLocation() const {
     return location;
 }
 
@@ -100,6 +104,10 @@ void Transaction::setCategory(TransactionCategory category) {
     this->category = category;
 }
 
+void Transaction::setTimestamp(std::chrono::system_clock::time_point timestamp) {
+    this->timestamp = timestamp;
+}
+
 void Transaction::displayTransaction() const {
     // This method is intentionally left for backwards compatibility
     // but should not be used in production. UI layer should handle display.
@@ -155,6 +163,18 @@ std::string Transaction::transactionStatusToString(TransactionStatus status) {
     }
 }
 
+std::string Transaction::transactionOutcomeToString(TransactionOutcome outcome) {
+    switch (outcome) {
+        case TransactionOutcome::SUCCESS: return "Success";
+        case TransactionOutcome::INSUFFICIENT_FUNDS: return "Insufficient Funds";
+        case TransactionOutcome::INVALID_AMOUNT: return "Invalid Amount";
+        case TransactionOutcome::INVALID_ACCOUNT: return "Invalid Account";
+        case TransactionOutcome::UNBALANCED_ENTRY: return "Unbalanced Entry";
+        case TransactionOutcome::IDEMPOTENCY_CONFLICT: return "Idempotency Conflict";
+        default: return "Unknown";
+    }
+}
+
 TransactionCategory Transaction::stringToCategory(const std::string& category_str) {
     if (category_str == "Food") return TransactionCategory::FOOD;
     if (category_str == "Travel") return TransactionCategory::TRAVEL;
@@ -5,6 +5,8 @@
 #include <chrono>
 #include <ctime>
 
+class TimeZone;
+
 enum class TransactionType {
     DEPOSIT,
     WITHDRAWAL,
@@ -26,6 +28,9 @@ enum class TransactionCategory {
     OTHER
 };
 
+// OTHER must remain the last category: dense per-category tables are sized from it
+constexpr std::size_t kTransactionCategoryCount = static_cast<std::size_t>(TransactionCategory::OTHER) + 1;
+
 enum class TransactionStatus {
     PENDING,
     COMPLETED,
@@ -33,6 +38,34 @@ enum class TransactionStatus {
     CANCELLED
 };
 
+enum class TransactionOutcome {
+    SUCCESS,
+    INSUFFICIENT_FUNDS,
+    INVALID_AMOUNT,
+    INVALID_ACCOUNT,
+    UNBALANCED_ENTRY,
+    IDEMPOTENCY_CONFLICT // Key already used for a different request
+};
+
+// Result of a balance-changing operation. Declines are routine, so they
+// are reported here instead of being thrown.
+struct TransactionResult {
+    TransactionOutcome outcome;
+    const char* reason;   // Static text; empty on success
+    int transaction_id;   // Service record for the attempt, -1 if none
+    bool replayed = false; // Stored result of an earlier request with the same idempotency key
+    
+    static TransactionResult success(int transaction_id = -1) {
+        return TransactionResult{TransactionOutcome::SUCCESS, "", transaction_id};
+    }
+    static TransactionResult failure(TransactionOutcome outcome, const char* reason, int transaction_id = -1) {
+        return TransactionResult{outcome, reason, transaction_id};
+    }
+    
+    bool ok() const { return outcome == TransactionOutcome::SUCCESS; }
+    explicit operator bool() const { return ok(); }
+};
+
 class Transaction {
 private:
     int transaction_id;
@@ -69,8 +102,9 @@ public:
     std::string getDescription() const;
     std::chrono::system_clock::time_point getTimestamp() const;
     std::string getTimestampString() const;
+    std::string getTimestampString(const TimeZone& time_zone) const;
     bool isSuspicious() const;
-    std::string getLocation() const;
+    const std::string& getLocation() const;
     std::string getIpAddress() const;
     
     // Setters
@@ -80,6 +114,7 @@ public:
     void setLocation(const std::string& location);
     void setIpAddress(const std::string& ip_address);
     void setCategory(TransactionCategory category);
+    void setTimestamp(std::chrono::system_clock::time_point timestamp);
     
     // Utility functions
     void displayTransaction() const;
@@ -91,6 +126,7 @@ public:
     static std::string transactionTypeToString(TransactionType type);
     static std::string transactionCategoryToString(TransactionCategory category);
     static std::string transactionStatusToString(TransactionStatus status);
+    static std::string transactionOutcomeToString(TransactionOutcome outcome);
     static TransactionCategory stringToCategory(const std::string& category_str);
     static TransactionType stringToType(const std::string& type_str);
 };
@@ -0,0 +1,557 @@
+#include "TransactionHistory.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace {
+    // Segment encoding: a varint entry count, then per entry a flags byte
+    // (type:3 | status:2 | suspicious:1 | raw amount:1), a category byte,
+    // zigzag deltas of transaction id, account ids and timestamp ticks
+    // against the previous entry, the amount (zigzag cents unless it is not
+    // a whole number of cents, then the raw double) and three strings, each
+    // either a back-reference into the segment's dictionary or a new literal.
+    constexpr std::uint8_t kSuspiciousFlag = 1u << 5;
+    constexpr std::uint8_t kRawAmountFlag = 1u << 6;
+
+    void putVarint(std::string& out, std::uint64_t value) {
+        while (value >= 0x80) {
+            out.push_back(static_cast<char>((value & 0x7f) | 0x80));
+            value >>= 7;
+        }
+        out.push_back(static_cast<char>(value));
+    }
+
+    std::uint64_t getVarint(const char*& cursor, const char* end) {
+        std::uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            if (cursor == end) break;
+            std::uint8_t byte = static_cast<std::uint8_t>(*cursor++);
+            value |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+            if (!(byte & 0x80)) return value;
+        }
+        throw std::runtime_error("Corrupt transaction history segment");
+    }
+
+    std::uint64_t zigzag(std::int64_t value) {
+        return (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63);
+    }
+
+    std::int64_t unzigzag(std::uint64_t value) {
+        return static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1);
+    }
+
+    // Spill files must not collide between histories with the same prefix,
+    // in this process or another sharing the directory
+    std::string spillStem(const std::string& prefix) {
+        static const std::string process_nonce = [] {
+            char buffer[16];
+            std::snprintf(buffer, sizeof(buffer), "%08x", static_cast<unsigned>(std::random_device()()));
+            return std::string(buffer);
+        }();
+        static std::atomic<std::uint64_t> next_instance{0};
+        return prefix + "_" + process_nonce + "_" + std::to_string(next_instance.fetch_add(1, std::memory_order_relaxed));
+    }
+
+    class SegmentWriter {
+    public:
+        explicit SegmentWriter(std::size_t entries) {
+            putVarint(out, entries);
+        }
+
+        void add(const Transaction& transaction) {
+            double amount = transaction.getAmount();
+            double cents = std::round(amount * 100.0);
+            bool raw_amount = cents / 100.0 != amount || std::fabs(cents) > 9.0e15;
+
+            std::uint8_t flags = static_cast<std::uint8_t>(transaction.getType()) |
+                                 static_cast<std::uint8_t>(static_cast<std::uint8_t>(transaction.getStatus()) << 3);
+            if (transaction.isSuspicious()) flags |= kSuspiciousFlag;
+            if (raw_amount) flags |= kRawAmountFlag;
+            out.push_back(static_cast<char>(flags));
+            out.push_back(static_cast<char>(transaction.getCategory()));
+
+            putDelta(previous_id, transaction.getTransactionId());
+            putDelta(previous_account, transaction.getAccountId());
+            putDelta(previous_to_account, transaction.getToAccountId());
+            if (raw_amount) {
+                char bytes[sizeof(double)];
+                std::memcpy(bytes, &amount, sizeof(double));
+                out.append(bytes, sizeof(double));
+            } else {
+                putVarint(out, zigzag(static_cast<std::int64_t>(cents)));
+            }
+            putDelta(previous_ticks, transaction.getTimestamp().time_since_epoch().count());
+
+            putString(transaction.getDescription());
+            putString(transaction.getLocation());
+            putString(transaction.getIpAddress());
+        }
+
+        std::string finish() {
+            return std::move(out);
+        }
+
+    private:
+        std::string out;
+        std::int64_t previous_id = 0;
+        std::int64_t previous_account = 0;
+        std::int64_t previous_to_account = 0;
+        std::int64_t previous_ticks = 0;
+        std::unordered_map<std::string, std::uint64_t> dictionary;
+
+        void putDelta(std::int64_t& previous, std::int64_t value) {
+            putVarint(out, zigzag(value - previous));
+            previous = value;
+        }
+
+        void putString(const std::string& value) {
+            auto it = dictionary.find(value);
+            if (it != dictionary.end()) {
+                putVarint(out, it->second);
+                return;
+            }
+            putVarint(out, 0);
+            putVarint(out, value.size());
+            out.append(value);
+            dictionary.emplace(value, dictionary.size() + 1);
+        }
+    };
+
+    std::vector<Transaction> decodeSegment(const std::string& data) {
+        const char* cursor = data.data();
+        const char* end = cursor + data.size();
+        std::size_t entries = static_cast<std::size_t>(getVarint(cursor, end));
+
+        std::vector<Transaction> transactions;
+        transactions.reserve(entries);
+        std::vector<std::string> dictionary;
+        std::int64_t id = 0, account = 0, to_account = 0, ticks = 0;
+
+        auto readDelta = [&](std::int64_t& previous) {
+            previous += unzigzag(getVarint(cursor, end));
+            return previous;
+        };
+        auto readString = [&]() -> const std::string& {
+            std::uint64_t reference = getVarint(cursor, end);
+            if (reference == 0) {
+                std::uint64_t length = getVarint(cursor, end);
+                if (length > static_cast<std::uint64_t>(end - cursor)) {
+                    throw std::runtime_error("Corrupt transaction history segment");
+                }
+                dictionary.emplace_back(cursor, static_cast<std::size_t>(length));
+                cursor += length;
+                return dictionary.back();
+            }
+            if (reference > dictionary.size()) {
+                throw std::runtime_error("Corrupt transaction history segment");
+            }
+            return dictionary[reference - 1];
+        };
+
+        for (std::size_t i = 0; i < entries; ++i) {
+            if (end - cursor < 2) {
+                throw std::runtime_error("Corrupt transaction history segment");
+            }
+            std::uint8_t flags = static_cast<std::uint8_t>(*cursor++);
+            auto category = static_cast<TransactionCategory>(static_cast<std::uint8_t>(*cursor++));
+
+            readDelta(id);
+            readDelta(account);
+            readDelta(to_account);
+            double amount;
+            if (flags & kRawAmountFlag) {
+                if (end - cursor < static_cast<std::ptrdiff_t>(sizeof(double))) {
+                    throw std::runtime_error("Corrupt transaction history segment");
+                }
+                std::memcpy(&amount, cursor, sizeof(double));
+                cursor += sizeof(double);
+            } else {
+                amount = static_cast<double>(unzigzag(getVarint(cursor, end))) / 100.0;
+            }
+            readDelta(ticks);
+
+            transactions.emplace_back(static_cast<int>(id), static_cast<int>(account), amount,
+                                      static_cast<TransactionType>(flags & 0x7), category, readString());
+            Transaction& transaction = transactions.back();
+            transaction.setLocation(readString());
+            transaction.setIpAddress(readString());
+            transaction.setToAccountId(static_cast<int>(to_account));
+            transaction.setStatus(static_cast<TransactionStatus>((flags >> 3) & 0x3));
+            transaction.setSuspiciousFlag((flags & kSuspiciousFlag) != 0);
+            transaction.setTimestamp(std::chrono::system_clock::time_point(
+                std::chrono::system_clock::duration(ticks)));
+        }
+        return transactions;
+    }
+}
+
+// HistorySummary implementation
+void HistorySummary::add(const Transaction& transaction) {
+    double amount = transaction.getAmount();
+    auto timestamp = transaction.getTimestamp();
+    if (count == 0 || timestamp < first_timestamp) first_timestamp = timestamp;
+    if (count == 0 || timestamp > last_timestamp) last_timestamp = timestamp;
+    ++count;
+    total_amount += amount;
+
+    std::size_t index = static_cast<std::size_t>(transaction.getCategory());
+    if (index < kTransactionCategoryCount) {
+        CategorySummary& category = categories[index];
+        category.min = (category.count == 0) ? amount : std::min(category.min, amount);
+        category.max = (category.count == 0) ? amount : std::max(category.max, amount);
+        category.sum += amount;
+        ++category.count;
+    }
+}
+
+void HistorySummary::merge(const HistorySummary& other) {
+    if (other.count == 0) return;
+    if (count == 0 || other.first_timestamp < first_timestamp) first_timestamp = other.first_timestamp;
+    if (count == 0 || other.last_timestamp > last_timestamp) last_timestamp = other.last_timestamp;
+    count += other.count;
+    total_amount += other.total_amount;
+
+    for (std::size_t i = 0; i < kTransactionCategoryCount; ++i) {
+        const CategorySummary& theirs = other.categories[i];
+        if (theirs.count == 0) continue;
+        CategorySummary& ours = categories[i];
+        ours.min = (ours.count == 0) ? theirs.min : std::min(ours.min, theirs.min);
+        ours.max = (ours.count == 0) ? theirs.max : std::max(ours.max, theirs.max);
+        ours.sum += theirs.sum;
+        ours.count += theirs.count;
+    }
+}
+
+// TransactionHistory implementation
+TransactionHistory::Segment::~Segment() {
+    if (!path.empty()) {
+        std::remove(path.c_str());
+    }
+}
+
+TransactionHistory::TransactionHistory()
+    : count(0), cold_end(0), time_ordered(true), next_segment_file(0),
+      cached_segment(static_cast<std::size_t>(-1)) {}
+
+TransactionHistory::~TransactionHistory() {}
+
+void TransactionHistory::append(std::shared_ptr<Transaction> transaction) {
+    if (count % kChunkSize == 0) {
+        chunks.push_back(std::make_shared<Chunk>());
+    }
+
+    time_point timestamp = transaction->getTimestamp();
+    if (count > 0 && timestamp < last_timestamp) {
+        time_ordered = false; // Out-of-order import; range queries fall back to scanning
+    }
+    last_timestamp = std::max(last_timestamp, timestamp);
+    hot_summary.add(*transaction);
+
+    (*chunks[count / kChunkSize])[count % kChunkSize] = std::move(transaction);
+    ++count;
+
+    if (policy.auto_compact && count - cold_end >= policy.hot_entries + segmentChunks() * kChunkSize) {
+        compactSegment();
+    }
+}
+
+void TransactionHistory::clear() {
+    chunks.clear();
+    segments.clear();
+    count = 0;
+    cold_end = 0;
+    time_ordered = true;
+    last_timestamp = time_point();
+    hot_summary = HistorySummary();
+    cached_segment = static_cast<std::size_t>(-1);
+    cached_entries.reset();
+}
+
+// Tiering
+void TransactionHistory::setPolicy(const HistoryTieringPolicy& policy, const std::string& segment_prefix) {
+    if (policy.segment_entries == 0) {
+        throw std::invalid_argument("Segment size must be positive");
+    }
+    this->policy = policy;
+    segment_stem = spillStem(segment_prefix);
+    if (policy.auto_compact) {
+        compact();
+    }
+}
+
+const HistoryTieringPolicy& TransactionHistory::getPolicy() const {
+    return policy;
+}
+
+std::size_t TransactionHistory::compact() {
+    std::size_t archived = 0;
+    std::size_t segment_size = segmentChunks() * kChunkSize;
+    while (count - cold_end >= policy.hot_entries + segment_size) {
+        compactSegment();
+        archived += segment_size;
+    }
+    return archived;
+}
+
+std::size_t TransactionHistory::archivedCount() const {
+    return cold_end;
+}
+
+std::size_t TransactionHistory::segmentCount() const {
+    return segments.size();
+}
+
+std::size_t TransactionHistory::archivedBytes() const {
+    std::size_t bytes = 0;
+    for (const auto& segment : segments) {
+        bytes += segment->encoded_size;
+    }
+    return bytes;
+}
+
+std::size_t TransactionHistory::size() const {
+    return count;
+}
+
+bool TransactionHistory::empty() const {
+    return count == 0;
+}
+
+TransactionPage TransactionHistory::page(std::size_t cursor, std::size_t limit) const {
+    TransactionPage result;
+    std::size_t end = std::min(cursor, count);
+    std::size_t begin = end - std::min(end, limit);
+
+    result.transactions.reserve(end - begin);
+    for (std::size_t i = end; i > begin; --i) {
+        result.transactions.push_back(entry(i - 1, &result));
+    }
+    result.next_cursor = begin;
+    result.has_more = begin > 0;
+    return result;
+}
+
+TransactionPage TransactionHistory::range(time_point from, time_point to, std::size_t cursor, std::size_t limit) const {
+    TransactionPage result;
+    std::size_t position = std::min(cursor, count);
+
+    if (time_ordered) {
+        // Matching entries are contiguous: skip straight to the newest one
+        position = upperBound(to, position);
+        while (position > 0 && result.transactions.size() < limit &&
+               entry(position - 1, nullptr)->getTimestamp() >= from) {
+            result.transactions.push_back(entry(--position, &result));
+        }
+        result.next_cursor = position;
+        result.has_more = position > 0 && entry(position - 1, nullptr)->getTimestamp() >= from;
+        return result;
+    }
+
+    while (position > 0 && result.transactions.size() < limit) {
+        --position;
+        time_point timestamp = entry(position, nullptr)->getTimestamp();
+        if (timestamp >= from && timestamp <= to) {
+            result.transactions.push_back(entry(position, &result));
+        }
+    }
+    result.next_cursor = position;
+    result.has_more = position > 0;
+    return result;
+}
+
+HistorySummary TransactionHistory::summarize() const {
+    HistorySummary summary;
+    for (const auto& segment : segments) {
+        summary.merge(segment->summary);
+    }
+    summary.merge(hot_summary);
+    return summary;
+}
+
+HistorySummary TransactionHistory::summarize(time_point from, time_point to) const {
+    HistorySummary summary;
+    auto addMatching = [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+            const Transaction* transaction = entry(i, nullptr);
+            if (transaction->getTimestamp() >= from && transaction->getTimestamp() <= to) {
+                summary.add(*transaction);
+            }
+        }
+    };
+
+    // Segments wholly inside or outside the range never need decoding
+    for (const auto& segment : segments) {
+        const HistorySummary& stored = segment->summary;
+        if (stored.count == 0 || stored.last_timestamp < from || stored.first_timestamp > to) continue;
+        if (stored.first_timestamp >= from && stored.last_timestamp <= to) {
+            summary.merge(stored);
+        } else {
+            addMatching(segment->begin, segment->end);
+        }
+    }
+
+    if (hot_summary.count > 0 && hot_summary.first_timestamp >= from && hot_summary.last_timestamp <= to) {
+        summary.merge(hot_summary);
+    } else if (hot_summary.count > 0 && hot_summary.last_timestamp >= from && hot_summary.first_timestamp <= to) {
+        addMatching(cold_end, count);
+    }
+    return summary;
+}
+
+std::vector<std::shared_ptr<Transaction>> TransactionHistory::toVector() const {
+    std::vector<std::shared_ptr<Transaction>> result;
+    result.reserve(count);
+    for (std::size_t i = 0; i < cold_end; ++i) {
+        result.push_back(std::make_shared<Transaction>(*entry(i, nullptr)));
+    }
+    for (std::size_t i = cold_end; i < count; ++i) {
+        result.push_back((*chunks[i / kChunkSize])[i % kChunkSize]);
+    }
+    return result;
+}
+
+// Private methods
+std::size_t TransactionHistory::segmentChunks() const {
+    return std::max<std::size_t>(1, (policy.segment_entries + kChunkSize - 1) / kChunkSize);
+}
+
+void TransactionHistory::compactSegment() {
+    std::size_t begin = cold_end;
+    std::size_t end = begin + segmentChunks() * kChunkSize;
+
+    auto segment = std::make_unique<Segment>();
+    segment->begin = begin;
+    segment->end = end;
+
+    SegmentWriter writer(end - begin);
+    for (std::size_t i = begin; i < end; ++i) {
+        const Transaction& transaction = *(*chunks[i / kChunkSize])[i % kChunkSize];
+        writer.add(transaction);
+        segment->summary.add(transaction);
+    }
+    segment->data = writer.finish();
+    segment->encoded_size = segment->data.size();
+
+    if (!policy.spill_directory.empty()) {
+        // Created exclusively, so a file left by anyone else is never
+        // overwritten (or later deleted by this segment); a taken name moves
+        // on to the next number. If the write fails the segment simply stays
+        // in memory.
+        std::string path;
+        std::FILE* file = nullptr;
+        for (int attempt = 0; attempt < 8 && !file; ++attempt) {
+            std::ostringstream name;
+            name << policy.spill_directory << "/" << segment_stem << "_" << next_segment_file++ << ".seg";
+            path = name.str();
+            file = std::fopen(path.c_str(), "wbx");
+        }
+        if (file) {
+            bool written = std::fwrite(segment->data.data(), 1, segment->data.size(), file) == segment->data.size();
+            written = std::fclose(file) == 0 && written;
+            if (written) {
+                segment->path = path;
+                segment->data.clear();
+                segment->data.shrink_to_fit();
+            } else {
+                std::remove(path.c_str());
+            }
+        }
+    }
+
+    // Pages may still pin these chunks; the objects go once they are dropped
+    for (std::size_t c = begin / kChunkSize; c < end / kChunkSize; ++c) {
+        chunks[c].reset();
+    }
+    segments.push_back(std::move(segment));
+    cold_end = end;
+
+    hot_summary = HistorySummary();
+    for (std::size_t i = cold_end; i < count; ++i) {
+        hot_summary.add(*(*chunks[i / kChunkSize])[i % kChunkSize]);
+    }
+}
+
+std::shared_ptr<const TransactionHistory::Decoded> TransactionHistory::decode(std::size_t segment_index) const {
+    if (cached_entries && cached_segment == segment_index) {
+        return cached_entries;
+    }
+
+    const Segment& segment = *segments[segment_index];
+    std::shared_ptr<const Decoded> decoded;
+    if (segment.path.empty()) {
+        decoded = std::make_shared<const Decoded>(decodeSegment(segment.data));
+    } else {
+        std::ifstream file(segment.path, std::ios::binary);
+        std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        if (!file.good() && !file.eof()) {
+            throw std::runtime_error("Cannot read transaction history segment " + segment.path);
+        }
+        decoded = std::make_shared<const Decoded>(decodeSegment(data));
+    }
+    if (decoded->size() != segment.end - segment.begin) {
+        throw std::runtime_error("Corrupt transaction history segment");
+    }
+
+    cached_segment = segment_index;
+    cached_entries = decoded;
+    return decoded;
+}
+
+std::size_t TransactionHistory::segmentFor(std::size_t position) const {
+    auto it = std::upper_bound(segments.begin(), segments.end(), position,
+        [](std::size_t value, const std::unique_ptr<Segment>& segment) {
+            return value < segment->begin;
+        });
+    return static_cast<std::size_t>(it - segments.begin()) - 1;
+}
+
+const Transaction* TransactionHistory::entry(std::size_t position, TransactionPage* page) const {
+    if (position >= cold_end) {
+        const std::shared_ptr<Chunk>& chunk = chunks[position / kChunkSize];
+        if (page && (page->pins.empty() || page->pins.back().get() != chunk.get())) {
+            page->pins.push_back(chunk);
+        }
+        return (*chunk)[position % kChunkSize].get();
+    }
+
+    std::size_t index = segmentFor(position);
+    std::shared_ptr<const Decoded> decoded = decode(index);
+    if (page && (page->pins.empty() || page->pins.back().get() != decoded.get())) {
+        page->pins.push_back(decoded);
+    }
+    return &(*decoded)[position - segments[index]->begin];
+}
+
+std::size_t TransactionHistory::upperBound(time_point timestamp, std::size_t end) const {
+    // Narrow to one segment (or the hot tier) from the summaries first, so
+    // at most one segment is decoded
+    std::size_t low = cold_end;
+    std::size_t high = end;
+    auto it = std::upper_bound(segments.begin(), segments.end(), timestamp,
+        [](time_point value, const std::unique_ptr<Segment>& segment) {
+            return value < segment->summary.last_timestamp;
+        });
+    if (it != segments.end()) {
+        low = (*it)->begin;
+        high = std::min((*it)->end, end);
+    }
+    if (low >= end) return end;
+
+    while (low < high) {
+        std::size_t middle = low + (high - low) / 2;
+        if (entry(middle, nullptr)->getTimestamp() <= timestamp) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return low;
+}
@@ -0,0 +1,138 @@
+#ifndef TRANSACTION_HISTORY_H
+#define TRANSACTION_HISTORY_H
+
+#include <vector>
+#include <array>
+#include <memory>
+#include <string>
+#include <chrono>
+#include <cstddef>
+#include "Transaction.h"
+
+// One page of history, newest first. Recent entries are borrowed from the
+// account's in-memory chunks and archived ones are decoded into storage the
+// page shares; either way the page pins what its pointers refer to (one
+// reference per chunk or segment, none per entry), so they stay valid for
+// the page's lifetime even if the history is compacted meanwhile.
+struct TransactionPage {
+    static constexpr std::size_t kNewest = static_cast<std::size_t>(-1); // Cursor for the first page
+
+    std::vector<const Transaction*> transactions;
+    std::size_t next_cursor = 0; // Pass back to continue with older entries
+    bool has_more = false;
+    std::vector<std::shared_ptr<const void>> pins;
+};
+
+struct CategorySummary {
+    std::size_t count = 0;
+    double sum = 0.0;
+    double min = 0.0;
+    double max = 0.0;
+};
+
+// Aggregates over a stretch of history; archived segments keep one each so
+// totals never require decompression
+struct HistorySummary {
+    std::size_t count = 0;
+    double total_amount = 0.0;
+    std::chrono::system_clock::time_point first_timestamp{};
+    std::chrono::system_clock::time_point last_timestamp{};
+    std::array<CategorySummary, kTransactionCategoryCount> categories{};
+
+    void add(const Transaction& transaction);
+    void merge(const HistorySummary& other);
+};
+
+// When older history leaves memory as live objects
+struct HistoryTieringPolicy {
+    std::size_t hot_entries = 8192;     // Newest entries always kept as live objects
+    std::size_t segment_entries = 4096; // Entries per archived segment, rounded up to whole chunks
+    bool auto_compact = true;           // Compact on append once a full segment is past hot_entries
+    std::string spill_directory;        // Write segments here instead of keeping them in memory
+};
+
+// Append-only transaction log in two tiers. Recent entries live in
+// fixed-size chunks of Transaction objects that never move, so any page is
+// found by position in O(1). Older chunks are compacted into immutable,
+// compressed segments (delta/varint fields plus a per-segment string
+// dictionary), kept in memory or spilled to disk, each with a summary.
+// Not synchronised; the owning Account guards it with its mutex.
+class TransactionHistory {
+public:
+    using time_point = std::chrono::system_clock::time_point;
+
+    static constexpr std::size_t kChunkSize = 256;
+
+    TransactionHistory();
+    ~TransactionHistory();
+
+    TransactionHistory(const TransactionHistory&) = delete;
+    TransactionHistory& operator=(const TransactionHistory&) = delete;
+
+    void append(std::shared_ptr<Transaction> transaction);
+    void clear();
+
+    // Tiering
+    void setPolicy(const HistoryTieringPolicy& policy, const std::string& segment_prefix);
+    const HistoryTieringPolicy& getPolicy() const;
+    std::size_t compact(); // Archives everything beyond hot_entries; returns entries archived
+    std::size_t archivedCount() const;
+    std::size_t segmentCount() const;
+    std::size_t archivedBytes() const; // Compressed size, in memory or on disk
+
+    std::size_t size() const;
+    bool empty() const;
+
+    // Pages walk backwards from the cursor (exclusive), newest first
+    TransactionPage page(std::size_t cursor, std::size_t limit) const;
+    // Entries with from <= timestamp <= to, newest first, continuing from the cursor
+    TransactionPage range(time_point from, time_point to, std::size_t cursor, std::size_t limit) const;
+
+    // Aggregates; whole segments answer from their summaries
+    HistorySummary summarize() const;
+    HistorySummary summarize(time_point from, time_point to) const;
+
+    std::vector<std::shared_ptr<Transaction>> toVector() const; // Full copy, oldest first
+
+private:
+    using Chunk = std::array<std::shared_ptr<Transaction>, kChunkSize>;
+    using Decoded = std::vector<Transaction>;
+
+    struct Segment {
+        std::size_t begin;
+        std::size_t end;
+        HistorySummary summary;
+        std::string data; // Encoded entries; empty once spilled
+        std::string path; // File holding the entries when spilled
+        std::size_t encoded_size;
+
+        ~Segment();
+    };
+
+    std::vector<std::shared_ptr<Chunk>> chunks; // Null below the hot tier
+    std::vector<std::unique_ptr<Segment>> segments;
+    std::size_t count;
+    std::size_t cold_end; // Entries before this position are archived
+    bool time_ordered;    // Timestamps non-decreasing in append order; enables binary search
+    time_point last_timestamp;
+    HistorySummary hot_summary;
+
+    HistoryTieringPolicy policy;
+    std::string segment_stem; // Caller's prefix, a process nonce and an instance number: unique per history
+    std::size_t next_segment_file;
+
+    // Most recently decoded segment; histories are only touched under the account lock
+    mutable std::size_t cached_segment;
+    mutable std::shared_ptr<const Decoded> cached_entries;
+
+    std::size_t segmentChunks() const;
+    void compactSegment();
+    std::shared_ptr<const Decoded> decode(std::size_t segment_index) const;
+    std::size_t segmentFor(std::size_t position) const;
+
+    // Entry at position, pinning its storage into page if given
+    const Transaction* entry(std::size_t position, TransactionPage* page) const;
+    std::size_t upperBound(time_point timestamp, std::size_t end) const; // First position in [0, end) later than timestamp
+};
+
+#endif // TRANSACTION_HISTORY_H
@@ -1,8 +1,7 @@
 #include "User.h"
 #include "Account.h"
 #include "../exceptions.h"
-#include <algorithm>
-#include <regex>
+#include "../utils/EmailValidator.h"
 
 User::User() : user_id(0), name(""), email(""), password_hash("") {}
 
@@ -28,7 +27,7 @@ std::string User::getPasswordHash() const {
     return password_hash;
 }
 
-std::vector<std::shared_ptr<Account>> User::getAccounts() const {
+const std::vector<std::shared_ptr<Account>>& User::getAccounts() const {
     return accounts;
 }
 
@@ -54,31 +53,34 @@ void User::addAccount(std::shared_ptr<Account> account) {
     if (account->getUserId() != user_id) {
         throw InvalidAccountException("Account user ID mismatch");
     }
+    if (!account_index.insert(account->getAccountId(), accounts.size())) {
+        throw InvalidAccountException("Account already belongs to this user");
+    }
     accounts.push_back(account);
 }
 
 void User::removeAccount(int account_id) {
-    auto it = std::find_if(accounts.begin(), accounts.end(),
-        [account_id](const std::shared_ptr<Account>& acc) {
-            return acc->getAccountId() == account_id;
-        });
-    
-    if (it == accounts.end()) {
+    const std::size_t* position = account_index.find(account_id);
+    if (!position) {
         throw InvalidAccountException("Account not found");
     }
-    accounts.erase(it);
-}
-
-std::shared_ptr<Account> User::getAccount(int account_id) {
-    auto it = std::find_if(accounts.begin(), accounts.end(),
-        [account_id](const std::shared_ptr<Account>& acc) {
-            return acc->getAccountId() == account_id;
-        });
     
-    if (it != accounts.end()) {
-        return *it;
+    // Keep creation order; only the accounts after the removed one move
+    std::size_t index = *position;
+    accounts.erase(accounts.begin() + index);
+    account_index.erase(account_id);
+    for (std::size_t i = index; i < accounts.size(); ++i) {
+        account_index.insertOrAssign(accounts[i]->getAccountId(), i);
     }
-    return nullptr;
+}
+
+std::shared_ptr<Account> User::getAccount(int account_id) const {
+    const std::size_t* position = account_index.find(account_id);
+    return position ? accounts[*position] : nullptr;
+}
+
+bool User::hasAccount(int account_id) const {
+    return account_index.contains(account_id);
 }
 
 void User::displayUserInfo() const {
@@ -87,6 +89,14 @@ void User::displayUserInfo() const {
 }
 
 bool User::validateEmail(const std::string& email) const {
-    const std::regex pattern(R"([a-zA-Z0-9._%+-]+@[a-zA-Z0-9.-]+\.[a-zA-Z]{2,})");
-    return std::regex_match(email, pattern);
+    return EmailValidator::isValid(email);
+}
+
+std::string User::hashPassword(const std::string& password) {
+    // Simple hash for demonstration - in production use bcrypt or similar
+    return "hashed_" + password;
+}
+
+bool User::verifyPassword(const std::string& password) const {
+    return hashPassword(password) == password_hash;
 }
@@ -4,6 +4,7 @@
 #include <string>
 #include <vector>
 #include <memory>
+#include "../utils/OpenAddressingMap.h"
 
 class Account;
 
@@ -13,7 +14,8 @@ private:
     std::string name;
     std::string email;
     std::string password_hash;
-    std::vector<std::shared_ptr<Account>> accounts;
+    std::vector<std::shared_ptr<Account>> accounts;                // In the order they were added
+    OpenAddressingMap<int, std::size_t> account_index;             // account_id -> position in accounts
 
 public:
     // Constructors
@@ -28,7 +30,7 @@ public:
     std::string getName() const;
     std::string getEmail() const;
     std::string getPasswordHash() const;
-    std::vector<std::shared_ptr<Account>> getAccounts() const;
+    const std::vector<std::shared_ptr<Account>>& getAccounts() const;
     
     // Setters
     void setName(const std::string& name);
@@ -38,13 +40,18 @@ public:
     // Account management
     void addAccount(std::shared_ptr<Account> account);
     void removeAccount(int account_id);
-    std::shared_ptr<Account> getAccount(int account_id);
+    std::shared_ptr<Account> getAccount(int account_id) const;
+    bool hasAccount(int account_id) const;
     
     // Display
     void displayUserInfo() const;
     
     // Validation
     bool validateEmail(const std::string& email) const;
+    
+    // Password hashing shared by every frontend
+    static std::string hashPassword(const std::string& password);
+    bool verifyPassword(const std::string& password) const;
 };
 
 #endif // USER_H
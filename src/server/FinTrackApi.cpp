@@ -0,0 +1,465 @@
+#include "FinTrackApi.h"
+#include "../models/Account.h"
+#include "../exceptions.h"
+#include "../utils/Json.h"
+#include "../utils/EmailValidator.h"
+#include "../utils/Metrics.h"
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+
+namespace {
+    std::int64_t toEpochSeconds(std::chrono::system_clock::time_point timestamp) {
+        return std::chrono::duration_cast<std::chrono::seconds>(timestamp.time_since_epoch()).count();
+    }
+
+    HttpResponse created(JsonWriter& writer) {
+        return HttpResponse::json(201, writer.take());
+    }
+
+    HttpResponse ok(JsonWriter& writer) {
+        return HttpResponse::json(200, writer.take());
+    }
+}
+
+FinTrackApi::FinTrackApi(UserDirectory& user_directory, TransactionService& transaction_service,
+                         FraudDetectionService& fraud_service)
+    : user_directory(user_directory), transaction_service(transaction_service), fraud_service(fraud_service) {}
+
+HttpResponse FinTrackApi::handle(const HttpRequest& request) {
+    try {
+        return route(request, splitPath(request.path));
+    } catch (const InvalidAccountException& e) {
+        return HttpResponse::error(404, e.what());
+    } catch (const std::invalid_argument& e) {
+        return HttpResponse::error(400, e.what());
+    }
+}
+
+HttpResponse FinTrackApi::route(const HttpRequest& request, const std::vector<std::string>& segments) {
+    const std::string& method = request.method;
+    bool get = method == "GET";
+    bool post = method == "POST";
+    std::size_t depth = segments.size();
+    const std::string root = depth > 0 ? segments[0] : "";
+
+    if (depth == 1 && root == "health") {
+        return get ? health() : HttpResponse::error(405, "Use GET");
+    }
+
+    if (depth == 1 && root == "metrics") {
+        return get ? metrics() : HttpResponse::error(405, "Use GET");
+    }
+
+    if (root == "users") {
+        if (depth == 1) return post ? createUser(request) : HttpResponse::error(405, "Use POST");
+        int user_id = parseId(segments[1]);
+        if (user_id < 0) return HttpResponse::error(404, "Unknown user");
+        if (depth == 2) return get ? getUser(user_id) : HttpResponse::error(405, "Use GET");
+        if (depth == 3 && segments[2] == "accounts") {
+            return get ? getUserAccounts(user_id) : HttpResponse::error(405, "Use GET");
+        }
+    }
+
+    if (root == "accounts") {
+        if (depth == 1) return post ? createAccount(request) : HttpResponse::error(405, "Use POST");
+        int account_id = parseId(segments[1]);
+        if (account_id < 0) return HttpResponse::error(404, "Unknown account");
+        if (depth == 2) return get ? getAccount(account_id) : HttpResponse::error(405, "Use GET");
+        if (depth == 3) {
+            const std::string& action = segments[2];
+            if (action == "deposit") return post ? deposit(account_id, request) : HttpResponse::error(405, "Use POST");
+            if (action == "withdraw") return post ? withdraw(account_id, request) : HttpResponse::error(405, "Use POST");
+            if (action == "transactions") {
+                return get ? getTransactions(account_id, request) : HttpResponse::error(405, "Use GET");
+            }
+        }
+    }
+
+    if (depth == 1 && root == "transfers") {
+        return post ? transfer(request) : HttpResponse::error(405, "Use POST");
+    }
+
+    if (depth == 2 && root == "fraud") {
+        if (!get) return HttpResponse::error(405, "Use GET");
+        if (segments[1] == "flagged") return getFlagged(request);
+        if (segments[1] == "statistics") return getFraudStatistics();
+        if (segments[1] == "rings") return getFraudRings();
+    }
+
+    return HttpResponse::error(404, "No such endpoint");
+}
+
+// Handlers
+HttpResponse FinTrackApi::health() {
+    JsonWriter writer;
+    writer.beginObject()
+          .field("status", "ok")
+          .field("users", static_cast<std::uint64_t>(user_directory.userCount()))
+          .field("accounts", static_cast<std::uint64_t>(user_directory.accountCount()))
+          .endObject();
+    return ok(writer);
+}
+
+HttpResponse FinTrackApi::metrics() {
+    HttpResponse response;
+    response.content_type = MetricsRegistry::kPrometheusContentType;
+    response.body = MetricsRegistry::instance().renderPrometheus();
+    return response;
+}
+
+HttpResponse FinTrackApi::createUser(const HttpRequest& request) {
+    JsonObject body = JsonObject::parse(request.body);
+    std::string name = body.getString("name");
+    std::string email = body.getString("email");
+    std::string password = body.getString("password");
+    if (name.empty() || password.empty()) {
+        return HttpResponse::error(400, "name and password are required");
+    }
+    if (!EmailValidator::isValid(email)) {
+        return HttpResponse::error(400, "Invalid email format");
+    }
+    if (user_directory.hasEmail(email)) {
+        return HttpResponse::error(409, "A user with this email already exists");
+    }
+
+    std::shared_ptr<User> user;
+    try {
+        user = user_directory.createUser(name, email, User::hashPassword(password));
+    } catch (const std::invalid_argument& e) {
+        return HttpResponse::error(409, e.what()); // Lost a race for the same email
+    }
+
+    JsonWriter writer;
+    writeUser(writer, *user);
+    return created(writer);
+}
+
+HttpResponse FinTrackApi::getUser(int user_id) {
+    auto user = user_directory.findUser(user_id);
+    if (!user) return HttpResponse::error(404, "Unknown user");
+
+    JsonWriter writer;
+    writeUser(writer, *user);
+    return ok(writer);
+}
+
+HttpResponse FinTrackApi::getUserAccounts(int user_id) {
+    auto user = user_directory.findUser(user_id);
+    if (!user) return HttpResponse::error(404, "Unknown user");
+
+    JsonWriter writer;
+    writer.beginObject().key("accounts").beginArray();
+    for (const auto& account : user_directory.getUserAccounts(user_id)) {
+        writeAccount(writer, *account);
+    }
+    writer.endArray().endObject();
+    return ok(writer);
+}
+
+HttpResponse FinTrackApi::createAccount(const HttpRequest& request) {
+    JsonObject body = JsonObject::parse(request.body);
+    int user_id = body.getInt("user_id");
+    std::string type_name = body.getString("type", "Checking");
+    double initial_balance = body.getNumber("initial_balance", 0.0);
+
+    AccountType type = Account::stringToAccountType(type_name);
+    if (Account::accountTypeToString(type) != type_name) {
+        return HttpResponse::error(400, "type must be Savings, Checking, Credit or Investment");
+    }
+    if (initial_balance < 0) {
+        return HttpResponse::error(400, "initial_balance cannot be negative");
+    }
+    if (!user_directory.findUser(user_id)) {
+        return HttpResponse::error(404, "Unknown user");
+    }
+
+    auto account = user_directory.createAccount(user_id, type, initial_balance);
+    JsonWriter writer;
+    writeAccount(writer, *account);
+    return created(writer);
+}
+
+HttpResponse FinTrackApi::getAccount(int account_id) {
+    auto account = user_directory.findAccount(account_id);
+    if (!account) return HttpResponse::error(404, "Unknown account");
+
+    JsonWriter writer;
+    writeAccount(writer, *account);
+    return ok(writer);
+}
+
+HttpResponse FinTrackApi::deposit(int account_id, const HttpRequest& request) {
+    auto account = user_directory.findAccount(account_id);
+    if (!account) return HttpResponse::error(404, "Unknown account");
+
+    JsonObject body = JsonObject::parse(request.body);
+    double amount = body.getNumber("amount");
+    std::string description = body.getString("description");
+    std::string location = body.getString("location");
+
+    std::shared_ptr<Transaction> record;
+    TransactionResult result = transaction_service.processDeposit(account, amount, description, location,
+                                                                   request.header("idempotency-key"), &record);
+    if (!result) return declined(result);
+
+    bool flagged = screen(record);
+
+    JsonWriter writer;
+    writer.beginObject()
+          .field("transaction_id", result.transaction_id)
+          .field("account_id", account_id)
+          .field("balance", account->getBalance());
+    writeScreening(writer, result, flagged);
+    writer.endObject();
+    return ok(writer);
+}
+
+HttpResponse FinTrackApi::withdraw(int account_id, const HttpRequest& request) {
+    auto account = user_directory.findAccount(account_id);
+    if (!account) return HttpResponse::error(404, "Unknown account");
+
+    JsonObject body = JsonObject::parse(request.body);
+    double amount = body.getNumber("amount");
+    std::string description = body.getString("description");
+    std::string location = body.getString("location");
+    TransactionCategory category = Transaction::stringToCategory(body.getString("category", "Other"));
+
+    std::shared_ptr<Transaction> record;
+    TransactionResult result = transaction_service.processWithdrawal(account, amount, description, location, category,
+                                                                      request.header("idempotency-key"), &record);
+    if (!result) return declined(result);
+
+    bool flagged = screen(record);
+
+    JsonWriter writer;
+    writer.beginObject()
+          .field("transaction_id", result.transaction_id)
+          .field("account_id", account_id)
+          .field("balance", account->getBalance());
+    writeScreening(writer, result, flagged);
+    writer.endObject();
+    return ok(writer);
+}
+
+HttpResponse FinTrackApi::transfer(const HttpRequest& request) {
+    JsonObject body = JsonObject::parse(request.body);
+    int from_id = body.getInt("from_account_id");
+    int to_id = body.getInt("to_account_id");
+    double amount = body.getNumber("amount");
+    std::string description = body.getString("description");
+
+    auto from_account = user_directory.findAccount(from_id);
+    auto to_account = user_directory.findAccount(to_id);
+    if (!from_account || !to_account) return HttpResponse::error(404, "Unknown account");
+
+    std::shared_ptr<Transaction> record;
+    TransactionResult result = transaction_service.processTransfer(from_account, to_account, amount, description,
+                                                                    request.header("idempotency-key"), &record);
+    if (!result) return declined(result);
+
+    bool flagged = screen(record);
+
+    JsonWriter writer;
+    writer.beginObject()
+          .field("transaction_id", result.transaction_id)
+          .field("from_account_id", from_id)
+          .field("to_account_id", to_id)
+          .field("from_balance", from_account->getBalance())
+          .field("to_balance", to_account->getBalance());
+    writeScreening(writer, result, flagged);
+    writer.endObject();
+    return ok(writer);
+}
+
+HttpResponse FinTrackApi::getTransactions(int account_id, const HttpRequest& request) {
+    auto account = user_directory.findAccount(account_id);
+    if (!account) return HttpResponse::error(404, "Unknown account");
+
+    std::size_t limit = kDefaultPageSize;
+    std::string limit_text = request.queryParam("limit");
+    if (!limit_text.empty()) {
+        int parsed = parseId(limit_text);
+        if (parsed <= 0) return HttpResponse::error(400, "limit must be a positive integer");
+        limit = std::min<std::size_t>(static_cast<std::size_t>(parsed), kMaxPageSize);
+    }
+
+    std::size_t cursor = TransactionPage::kNewest;
+    std::string cursor_text = request.queryParam("cursor");
+    if (!cursor_text.empty()) {
+        if (cursor_text.find_first_not_of("0123456789") != std::string::npos || cursor_text.size() > 18) {
+            return HttpResponse::error(400, "cursor must be a value returned as next_cursor");
+        }
+        cursor = static_cast<std::size_t>(std::stoull(cursor_text));
+    }
+
+    TransactionPage page = account->getTransactionPage(cursor, limit);
+
+    JsonWriter writer;
+    writer.beginObject().key("transactions").beginArray();
+    for (const Transaction* transaction : page.transactions) {
+        writeTransaction(writer, *transaction);
+    }
+    writer.endArray().field("has_more", page.has_more);
+    if (page.has_more) {
+        writer.field("next_cursor", static_cast<std::uint64_t>(page.next_cursor));
+    } else {
+        writer.key("next_cursor").null();
+    }
+    writer.endObject();
+    return ok(writer);
+}
+
+HttpResponse FinTrackApi::getFlagged(const HttpRequest& request) {
+    std::string account_text = request.queryParam("account_id");
+    std::vector<std::shared_ptr<Transaction>> flagged;
+    if (account_text.empty()) {
+        flagged = fraud_service.getFlaggedTransactions();
+    } else {
+        int account_id = parseId(account_text);
+        if (account_id < 0) return HttpResponse::error(400, "account_id must be a positive integer");
+        flagged = fraud_service.getFlaggedTransactionsByAccount(account_id);
+    }
+
+    JsonWriter writer;
+    writer.beginObject().key("transactions").beginArray();
+    for (const auto& transaction : flagged) {
+        writeTransaction(writer, *transaction);
+    }
+    writer.endArray().endObject();
+    return ok(writer);
+}
+
+HttpResponse FinTrackApi::getFraudStatistics() {
+    FraudStatistics statistics = fraud_service.getFraudStatistics();
+
+    JsonWriter writer;
+    writer.beginObject()
+          .field("transactions_scored", statistics.transactions_scored)
+          .field("transactions_flagged", statistics.transactions_flagged)
+          .field("confirmed_fraud", statistics.confirmed_fraud)
+          .field("confirmed_legitimate", statistics.confirmed_legitimate)
+          .field("missed_fraud", statistics.missed_fraud)
+          .field("fraud_rate", statistics.fraud_rate)
+          .key("rules").beginArray();
+    for (const auto& rule : statistics.rules) {
+        writer.beginObject()
+              .field("rule", rule.rule_name)
+              .field("check", FraudDetectionService::fraudCheckToString(rule.check))
+              .field("evaluated", rule.evaluated)
+              .field("triggered", rule.triggered)
+              .field("true_positives", rule.true_positives)
+              .field("false_positives", rule.false_positives)
+              .field("trigger_rate", rule.triggerRate())
+              .field("precision", rule.precision())
+              .endObject();
+    }
+    writer.endArray().endObject();
+    return ok(writer);
+}
+
+HttpResponse FinTrackApi::getFraudRings() {
+    JsonWriter writer;
+    writer.beginObject().key("alerts").beginArray();
+    for (const auto& alert : fraud_service.getFraudRingAlerts()) {
+        writeRingAlert(writer, alert);
+    }
+    writer.endArray().endObject();
+    return ok(writer);
+}
+
+bool FinTrackApi::screen(const std::shared_ptr<Transaction>& record) {
+    return record && fraud_service.analyzeTransaction(record);
+}
+
+HttpResponse FinTrackApi::declined(const TransactionResult& result) {
+    int status = result.outcome == TransactionOutcome::INSUFFICIENT_FUNDS ? 422
+               : result.outcome == TransactionOutcome::IDEMPOTENCY_CONFLICT ? 409 : 400;
+
+    JsonWriter writer;
+    writer.beginObject()
+          .field("error", result.reason)
+          .field("outcome", Transaction::transactionOutcomeToString(result.outcome))
+          .field("transaction_id", result.transaction_id)
+          .field("replayed", result.replayed)
+          .endObject();
+    return HttpResponse::json(status, writer.take());
+}
+
+// Serialisation
+void FinTrackApi::writeScreening(JsonWriter& writer, const TransactionResult& result, bool flagged) {
+    // A replay was not screened again, so it has no verdict to report
+    if (!result.replayed) {
+        writer.field("flagged", flagged);
+    }
+    writer.field("replayed", result.replayed);
+}
+
+void FinTrackApi::writeUser(JsonWriter& writer, const User& user) {
+    writer.beginObject()
+          .field("id", user.getUserId())
+          .field("name", user.getName())
+          .field("email", user.getEmail())
+          .endObject();
+}
+
+void FinTrackApi::writeAccount(JsonWriter& writer, const Account& account) {
+    writer.beginObject()
+          .field("id", account.getAccountId())
+          .field("user_id", account.getUserId())
+          .field("type", account.getTypeString())
+          .field("balance", account.getBalance())
+          .field("transaction_count", static_cast<std::uint64_t>(account.getTransactionCount()))
+          .endObject();
+}
+
+void FinTrackApi::writeTransaction(JsonWriter& writer, const Transaction& transaction) {
+    writer.beginObject()
+          .field("id", transaction.getTransactionId())
+          .field("account_id", transaction.getAccountId());
+    if (transaction.getToAccountId() >= 0) {
+        writer.field("to_account_id", transaction.getToAccountId());
+    }
+    writer.field("amount", transaction.getAmount())
+          .field("type", transaction.getTypeString())
+          .field("category", transaction.getCategoryString())
+          .field("status", transaction.getStatusString())
+          .field("description", transaction.getDescription())
+          .field("location", transaction.getLocation())
+          .field("timestamp", toEpochSeconds(transaction.getTimestamp()))
+          .field("suspicious", transaction.isSuspicious())
+          .endObject();
+}
+
+void FinTrackApi::writeRingAlert(JsonWriter& writer, const FraudRingAlert& alert) {
+    writer.beginObject()
+          .field("pattern", TransferGraph::patternToString(alert.pattern))
+          .key("account_ids").beginArray();
+    for (int account_id : alert.account_ids) {
+        writer.value(account_id);
+    }
+    writer.endArray()
+          .field("total_amount", alert.total_amount)
+          .field("first_seen", alert.first_seen_epoch)
+          .field("last_seen", alert.last_seen_epoch)
+          .endObject();
+}
+
+std::vector<std::string> FinTrackApi::splitPath(const std::string& path) {
+    std::vector<std::string> segments;
+    std::size_t position = 0;
+    while (position < path.size()) {
+        std::size_t end = path.find('/', position);
+        if (end == std::string::npos) end = path.size();
+        if (end > position) segments.push_back(path.substr(position, end - position));
+        position = end + 1;
+    }
+    return segments;
+}
+
+int FinTrackApi::parseId(const std::string& text) {
+    if (text.empty() || text.size() > 9 || text.find_first_not_of("0123456789") != std::string::npos) {
+        return -1;
+    }
+    return std::stoi(text);
+}
@@ -0,0 +1,89 @@
+#ifndef FINTRACK_API_H
+#define FINTRACK_API_H
+
+#include <string>
+#include <vector>
+#include "HttpServer.h"
+#include "../services/UserDirectory.h"
+#include "../services/TransactionService.h"
+#include "../services/FraudDetectionService.h"
+
+class JsonWriter;
+
+// JSON routes over the engine, for HttpServer:
+//
+//   GET  /health
+//   GET  /metrics                    Prometheus text format
+//   POST /users                      {"name", "email", "password"}
+//   GET  /users/{id}
+//   GET  /users/{id}/accounts
+//   POST /accounts                   {"user_id", "type", "initial_balance"}
+//   GET  /accounts/{id}
+//   POST /accounts/{id}/deposit      {"amount", "description", "location"}
+//   POST /accounts/{id}/withdraw     {"amount", "description", "location", "category"}
+//   POST /transfers                  {"from_account_id", "to_account_id", "amount", "description"}
+//   GET  /accounts/{id}/transactions ?limit=&cursor=
+//   GET  /fraud/flagged              ?account_id=
+//   GET  /fraud/statistics
+//   GET  /fraud/rings
+//
+// Every completed deposit, withdrawal and transfer is screened by the fraud
+// service before the response is sent. Declines answer 422 with the
+// outcome; handle() is safe to call from many worker threads at once.
+//
+// Deposits, withdrawals and transfers honour an Idempotency-Key header: a
+// retry with the same key gets the original transaction_id or decline back
+// with "replayed": true, moves no money and is not screened again, so the
+// replayed response has no "flagged" field. Reusing a key for a different
+// request answers 409.
+class FinTrackApi {
+public:
+    static constexpr std::size_t kDefaultPageSize = 50;
+    static constexpr std::size_t kMaxPageSize = 500;
+
+    FinTrackApi(UserDirectory& user_directory, TransactionService& transaction_service,
+                FraudDetectionService& fraud_service);
+
+    HttpResponse handle(const HttpRequest& request);
+
+private:
+    UserDirectory& user_directory;
+    TransactionService& transaction_service;
+    FraudDetectionService& fraud_service;
+
+    HttpResponse route(const HttpRequest& request, const std::vector<std::string>& segments);
+
+    // Handlers
+    HttpResponse health();
+    HttpResponse metrics();
+    HttpResponse createUser(const HttpRequest& request);
+    HttpResponse getUser(int user_id);
+    HttpResponse getUserAccounts(int user_id);
+    HttpResponse createAccount(const HttpRequest& request);
+    HttpResponse getAccount(int account_id);
+    HttpResponse deposit(int account_id, const HttpRequest& request);
+    HttpResponse withdraw(int account_id, const HttpRequest& request);
+    HttpResponse transfer(const HttpRequest& request);
+    HttpResponse getTransactions(int account_id, const HttpRequest& request);
+    HttpResponse getFlagged(const HttpRequest& request);
+    HttpResponse getFraudStatistics();
+    HttpResponse getFraudRings();
+
+    // Runs the service's record of a completed operation past the fraud
+    // rules; true if flagged. Null (a replay) is not screened.
+    bool screen(const std::shared_ptr<Transaction>& record);
+    HttpResponse declined(const TransactionResult& result);
+
+    // Serialisation
+    // "flagged" (left out of replays, which are not screened) and "replayed"
+    static void writeScreening(JsonWriter& writer, const TransactionResult& result, bool flagged);
+    static void writeUser(JsonWriter& writer, const User& user);
+    static void writeAccount(JsonWriter& writer, const Account& account);
+    static void writeTransaction(JsonWriter& writer, const Transaction& transaction);
+    static void writeRingAlert(JsonWriter& writer, const FraudRingAlert& alert);
+
+    static std::vector<std::string> splitPath(const std::string& path);
+    static int parseId(const std::string& text); // -1 unless a positive decimal ID
+};
+
+#endif // FINTRACK_API_H
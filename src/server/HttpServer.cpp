@@ -0,0 +1,620 @@
+#include "HttpServer.h"
+#include "../utils/Json.h"
+#include "../utils/Metrics.h"
+#include <stdexcept>
+#include <algorithm>
+#include <chrono>
+#include <cctype>
+#include <cerrno>
+#include <cstring>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <netdb.h>
+#include <unistd.h>
+
+namespace {
+    constexpr std::size_t kReadBufferSize = 16 * 1024;
+    constexpr int kMaxEvents = 256;
+
+    std::int64_t nowSeconds() {
+        return std::chrono::duration_cast<std::chrono::seconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    std::string toLower(std::string text) {
+        for (char& c : text) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        return text;
+    }
+
+    std::string trim(const std::string& text) {
+        std::size_t begin = text.find_first_not_of(" \t");
+        if (begin == std::string::npos) return "";
+        std::size_t end = text.find_last_not_of(" \t");
+        return text.substr(begin, end - begin + 1);
+    }
+
+    struct ServerMetrics {
+        Gauge* open_connections;
+        Gauge* queued_requests;
+        Counter* rejected;
+        LatencySummary* handler_duration;
+    };
+
+    const ServerMetrics& serverMetrics() {
+        static const ServerMetrics metrics = [] {
+            MetricsRegistry& registry = MetricsRegistry::instance();
+            return ServerMetrics{
+                &registry.gauge("fintrack_http_open_connections", "Client connections currently open."),
+                &registry.gauge("fintrack_http_queued_requests", "Parsed requests waiting for a worker."),
+                &registry.counter("fintrack_http_rejected_total", "Requests answered 503 because the queue was full."),
+                &registry.latency("fintrack_http_handler_duration_seconds", "Time workers spent in the request handler.")};
+        }();
+        return metrics;
+    }
+
+    int hexValue(char c) {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    }
+
+    std::string urlDecode(const std::string& text) {
+        std::string result;
+        result.reserve(text.size());
+        for (std::size_t i = 0; i < text.size(); ++i) {
+            if (text[i] == '+') {
+                result.push_back(' ');
+            } else if (text[i] == '%' && i + 2 < text.size() && hexValue(text[i + 1]) >= 0 &&
+                       hexValue(text[i + 2]) >= 0) {
+                result.push_back(static_cast<char>(hexValue(text[i + 1]) * 16 + hexValue(text[i + 2])));
+                i += 2;
+            } else {
+                result.push_back(text[i]);
+            }
+        }
+        return result;
+    }
+}
+
+// HttpRequest implementation
+std::string HttpRequest::header(const std::string& name) const {
+    for (const auto& entry : headers) {
+        if (entry.first == name) return entry.second;
+    }
+    return "";
+}
+
+std::string HttpRequest::queryParam(const std::string& name, const std::string& fallback) const {
+    std::size_t position = 0;
+    while (position <= query.size()) {
+        std::size_t end = query.find('&', position);
+        if (end == std::string::npos) end = query.size();
+        std::string pair = query.substr(position, end - position);
+        std::size_t equals = pair.find('=');
+        if (urlDecode(pair.substr(0, equals)) == name) {
+            return equals == std::string::npos ? "" : urlDecode(pair.substr(equals + 1));
+        }
+        position = end + 1;
+    }
+    return fallback;
+}
+
+// HttpResponse implementation
+HttpResponse HttpResponse::json(int status, std::string body) {
+    HttpResponse response;
+    response.status = status;
+    response.body = std::move(body);
+    return response;
+}
+
+HttpResponse HttpResponse::error(int status, const std::string& message) {
+    JsonWriter writer;
+    writer.beginObject().field("error", message).endObject();
+    return json(status, writer.take());
+}
+
+const char* HttpResponse::reasonPhrase(int status) {
+    switch (status) {
+        case 200: return "OK";
+        case 201: return "Created";
+        case 204: return "No Content";
+        case 400: return "Bad Request";
+        case 404: return "Not Found";
+        case 405: return "Method Not Allowed";
+        case 409: return "Conflict";
+        case 413: return "Payload Too Large";
+        case 422: return "Unprocessable Entity";
+        case 431: return "Request Header Fields Too Large";
+        case 500: return "Internal Server Error";
+        case 501: return "Not Implemented";
+        case 503: return "Service Unavailable";
+        case 505: return "HTTP Version Not Supported";
+        default: return "Unknown";
+    }
+}
+
+// HttpServer implementation
+HttpServer::HttpServer(const HttpServerOptions& options, HttpHandler handler)
+    : options(options), handler(std::move(handler)), listen_fd(-1), epoll_fd(-1), wake_fd(-1),
+      bound_port(0), running(false), next_generation(1), connections_accepted(0),
+      requests_handled(0), requests_rejected(0), open_connections(0) {
+    if (!this->handler) {
+        throw std::invalid_argument("HTTP handler cannot be empty");
+    }
+    if (this->options.queue_capacity == 0) {
+        throw std::invalid_argument("Queue capacity must be positive");
+    }
+}
+
+HttpServer::~HttpServer() {
+    stop();
+}
+
+void HttpServer::start() {
+    if (running) return;
+
+    addrinfo hints{};
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_PASSIVE;
+    addrinfo* address = nullptr;
+    std::string port = std::to_string(options.port);
+    int status = getaddrinfo(options.host.empty() ? nullptr : options.host.c_str(), port.c_str(), &hints, &address);
+    if (status != 0) {
+        throw std::runtime_error("Cannot resolve " + options.host + ": " + gai_strerror(status));
+    }
+
+    listen_fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    int enable = 1;
+    if (listen_fd < 0 ||
+        setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable)) < 0 ||
+        bind(listen_fd, address->ai_addr, address->ai_addrlen) < 0 ||
+        listen(listen_fd, SOMAXCONN) < 0) {
+        std::string reason = std::strerror(errno);
+        freeaddrinfo(address);
+        if (listen_fd >= 0) close(listen_fd);
+        listen_fd = -1;
+        throw std::runtime_error("Cannot listen on " + options.host + ":" + port + ": " + reason);
+    }
+    freeaddrinfo(address);
+
+    sockaddr_in bound{};
+    socklen_t bound_length = sizeof(bound);
+    getsockname(listen_fd, reinterpret_cast<sockaddr*>(&bound), &bound_length);
+    bound_port = ntohs(bound.sin_port);
+
+    epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (epoll_fd < 0 || wake_fd < 0) {
+        std::string reason = std::strerror(errno);
+        close(listen_fd);
+        if (epoll_fd >= 0) close(epoll_fd);
+        if (wake_fd >= 0) close(wake_fd);
+        listen_fd = epoll_fd = wake_fd = -1;
+        throw std::runtime_error("Cannot create event loop: " + reason);
+    }
+
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.fd = listen_fd;
+    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, listen_fd, &event);
+    event.data.fd = wake_fd;
+    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, wake_fd, &event);
+
+    unsigned int worker_count = options.worker_threads;
+    if (worker_count == 0) {
+        worker_count = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    running = true;
+    for (unsigned int i = 0; i < worker_count; ++i) {
+        workers.emplace_back(&HttpServer::workerLoop, this);
+    }
+    io_thread = std::thread(&HttpServer::ioLoop, this);
+}
+
+void HttpServer::stop() {
+    if (!running.exchange(false)) return;
+
+    std::uint64_t one = 1;
+    ssize_t written = write(wake_fd, &one, sizeof(one));
+    (void)written;
+    {
+        std::lock_guard<std::mutex> lock(jobs_mutex);
+        serverMetrics().queued_requests->add(-static_cast<double>(jobs.size()));
+        jobs.clear();
+    }
+    jobs_cv.notify_all();
+
+    if (io_thread.joinable()) io_thread.join();
+    for (auto& worker : workers) {
+        if (worker.joinable()) worker.join();
+    }
+    workers.clear();
+
+    close(listen_fd);
+    close(epoll_fd);
+    close(wake_fd);
+    listen_fd = epoll_fd = wake_fd = -1;
+    completions.clear();
+}
+
+bool HttpServer::isRunning() const {
+    return running;
+}
+
+std::uint16_t HttpServer::getPort() const {
+    return bound_port;
+}
+
+HttpServerStats HttpServer::getStats() const {
+    return HttpServerStats{connections_accepted.load(), requests_handled.load(),
+                           requests_rejected.load(), open_connections.load()};
+}
+
+void HttpServer::ioLoop() {
+    epoll_event events[kMaxEvents];
+    std::int64_t last_sweep = nowSeconds();
+
+    while (running) {
+        int ready = epoll_wait(epoll_fd, events, kMaxEvents, 1000);
+        if (ready < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+
+        for (int i = 0; i < ready; ++i) {
+            int fd = events[i].data.fd;
+            if (fd == listen_fd) {
+                acceptConnections();
+                continue;
+            }
+            if (fd == wake_fd) {
+                std::uint64_t count;
+                ssize_t drained = read(wake_fd, &count, sizeof(count));
+                (void)drained;
+                drainCompletions();
+                continue;
+            }
+
+            auto it = connections.find(fd);
+            if (it == connections.end()) continue;
+            Connection& connection = *it->second;
+
+            if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+                closeConnection(fd);
+                continue;
+            }
+            if ((events[i].events & EPOLLOUT) && !flush(connection)) continue;
+            if (events[i].events & EPOLLIN) readFrom(connection);
+        }
+
+        std::int64_t now = nowSeconds();
+        if (now != last_sweep) {
+            closeIdle(now);
+            last_sweep = now;
+        }
+    }
+
+    std::vector<int> open;
+    for (const auto& entry : connections) open.push_back(entry.first);
+    for (int fd : open) closeConnection(fd);
+}
+
+void HttpServer::workerLoop() {
+    while (true) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(jobs_mutex);
+            jobs_cv.wait(lock, [this] { return !jobs.empty() || !running; });
+            if (!running) return;
+            job = std::move(jobs.front());
+            jobs.pop_front();
+            serverMetrics().queued_requests->add(-1);
+        }
+
+        HttpResponse response;
+        try {
+            ScopedLatency timer(*serverMetrics().handler_duration);
+            response = handler(job.request);
+        } catch (const std::exception& e) {
+            response = HttpResponse::error(500, e.what());
+        } catch (...) {
+            response = HttpResponse::error(500, "Internal server error");
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(completions_mutex);
+            completions.push_back(Completion{job.fd, job.generation,
+                                             serialize(response, job.request.keep_alive),
+                                             job.request.keep_alive});
+        }
+        std::uint64_t one = 1;
+        ssize_t written = write(wake_fd, &one, sizeof(one));
+        (void)written;
+    }
+}
+
+void HttpServer::acceptConnections() {
+    while (true) {
+        int fd = accept4(listen_fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR) continue;
+            return; // EAGAIN, or out of descriptors until some close
+        }
+        if (connections.size() >= options.max_connections) {
+            close(fd);
+            continue;
+        }
+
+        int enable = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.fd = fd;
+        if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event) < 0) {
+            close(fd);
+            continue;
+        }
+
+        auto connection = std::make_unique<Connection>();
+        connection->fd = fd;
+        connection->generation = next_generation++;
+        connection->last_active = nowSeconds();
+        connections[fd] = std::move(connection);
+        ++connections_accepted;
+        ++open_connections;
+        serverMetrics().open_connections->add(1);
+    }
+}
+
+void HttpServer::readFrom(Connection& connection) {
+    char buffer[kReadBufferSize];
+    while (true) {
+        ssize_t received = recv(connection.fd, buffer, sizeof(buffer), 0);
+        if (received > 0) {
+            connection.input.append(buffer, static_cast<std::size_t>(received));
+            continue;
+        }
+        if (received < 0 && errno == EINTR) continue;
+        if (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+        closeConnection(connection.fd); // Peer closed or failed
+        return;
+    }
+
+    connection.last_active = nowSeconds();
+    // Data piling up behind an unfinished request is a misbehaving client
+    if (connection.input.size() > options.max_header_bytes + options.max_body_bytes) {
+        closeConnection(connection.fd);
+        return;
+    }
+    dispatch(connection);
+}
+
+void HttpServer::dispatch(Connection& connection) {
+    while (!connection.busy && !connection.close_after_write) {
+        HttpRequest request;
+        HttpResponse error_response;
+        ParseStatus status = parseRequest(connection, request, error_response);
+        if (status == ParseStatus::INCOMPLETE) return;
+        if (status == ParseStatus::ERROR) {
+            respondDirectly(connection, error_response, false);
+            return;
+        }
+
+        bool keep_alive = request.keep_alive;
+        bool queued = false;
+        {
+            std::lock_guard<std::mutex> lock(jobs_mutex);
+            if (jobs.size() < options.queue_capacity) {
+                jobs.push_back(Job{connection.fd, connection.generation, std::move(request)});
+                serverMetrics().queued_requests->add(1);
+                queued = true;
+            }
+        }
+
+        if (queued) {
+            connection.busy = true;
+            jobs_cv.notify_one();
+        } else {
+            ++requests_rejected;
+            serverMetrics().rejected->increment();
+            if (!respondDirectly(connection, HttpResponse::error(503, "Server busy"), keep_alive)) return;
+        }
+    }
+}
+
+void HttpServer::drainCompletions() {
+    std::vector<Completion> ready;
+    {
+        std::lock_guard<std::mutex> lock(completions_mutex);
+        ready.swap(completions);
+    }
+
+    for (auto& completion : ready) {
+        ++requests_handled;
+        auto it = connections.find(completion.fd);
+        if (it == connections.end() || it->second->generation != completion.generation) {
+            continue; // Client went away while the request was being handled
+        }
+
+        Connection& connection = *it->second;
+        connection.busy = false;
+        connection.last_active = nowSeconds();
+        connection.output.append(completion.bytes);
+        if (!completion.keep_alive) connection.close_after_write = true;
+        if (flush(connection)) dispatch(connection); // Pipelined requests already buffered
+    }
+}
+
+bool HttpServer::flush(Connection& connection) {
+    while (connection.output_offset < connection.output.size()) {
+        ssize_t sent = send(connection.fd, connection.output.data() + connection.output_offset,
+                            connection.output.size() - connection.output_offset, MSG_NOSIGNAL);
+        if (sent > 0) {
+            connection.output_offset += static_cast<std::size_t>(sent);
+            continue;
+        }
+        if (sent < 0 && errno == EINTR) continue;
+        if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            updateInterest(connection, true);
+            return true;
+        }
+        closeConnection(connection.fd);
+        return false;
+    }
+
+    connection.output.clear();
+    connection.output_offset = 0;
+    if (connection.want_write) updateInterest(connection, false);
+    if (connection.close_after_write && !connection.busy) {
+        closeConnection(connection.fd);
+        return false;
+    }
+    return true;
+}
+
+void HttpServer::closeConnection(int fd) {
+    auto it = connections.find(fd);
+    if (it == connections.end()) return;
+    epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+    close(fd);
+    connections.erase(it);
+    --open_connections;
+    serverMetrics().open_connections->add(-1);
+}
+
+void HttpServer::closeIdle(std::int64_t now) {
+    std::vector<int> idle;
+    for (const auto& entry : connections) {
+        const Connection& connection = *entry.second;
+        if (!connection.busy && connection.output.empty() &&
+            now - connection.last_active >= options.idle_timeout_seconds) {
+            idle.push_back(entry.first);
+        }
+    }
+    for (int fd : idle) closeConnection(fd);
+}
+
+void HttpServer::updateInterest(Connection& connection, bool want_write) {
+    if (connection.want_write == want_write) return;
+    epoll_event event{};
+    event.events = EPOLLIN | (want_write ? EPOLLOUT : 0u);
+    event.data.fd = connection.fd;
+    epoll_ctl(epoll_fd, EPOLL_CTL_MOD, connection.fd, &event);
+    connection.want_write = want_write;
+}
+
+bool HttpServer::respondDirectly(Connection& connection, const HttpResponse& response, bool keep_alive) {
+    connection.output.append(serialize(response, keep_alive));
+    if (!keep_alive) connection.close_after_write = true;
+    return flush(connection);
+}
+
+HttpServer::ParseStatus HttpServer::parseRequest(Connection& connection, HttpRequest& request,
+                                                 HttpResponse& error_response) {
+    const std::string& input = connection.input;
+    std::size_t header_end = input.find("\r\n\r\n");
+    if (header_end == std::string::npos) {
+        if (input.size() > options.max_header_bytes) {
+            error_response = HttpResponse::error(431, "Request headers too large");
+            return ParseStatus::ERROR;
+        }
+        return ParseStatus::INCOMPLETE;
+    }
+    if (header_end + 4 > options.max_header_bytes) {
+        error_response = HttpResponse::error(431, "Request headers too large");
+        return ParseStatus::ERROR;
+    }
+
+    // Request line: METHOD SP target SP HTTP/1.x
+    std::size_t line_end = input.find("\r\n");
+    std::size_t first_space = input.find(' ');
+    std::size_t second_space = first_space == std::string::npos ? std::string::npos : input.find(' ', first_space + 1);
+    if (first_space == std::string::npos || second_space == std::string::npos || second_space > line_end ||
+        first_space == 0 || second_space == first_space + 1) {
+        error_response = HttpResponse::error(400, "Malformed request line");
+        return ParseStatus::ERROR;
+    }
+    std::string version = input.substr(second_space + 1, line_end - second_space - 1);
+    if (version != "HTTP/1.1" && version != "HTTP/1.0") {
+        error_response = HttpResponse::error(505, "Only HTTP/1.0 and HTTP/1.1 are supported");
+        return ParseStatus::ERROR;
+    }
+
+    // Headers
+    std::vector<std::pair<std::string, std::string>> headers;
+    std::size_t content_length = 0;
+    std::string connection_header;
+    std::size_t position = line_end + 2;
+    while (position < header_end) {
+        std::size_t end = input.find("\r\n", position);
+        std::size_t colon = input.find(':', position);
+        if (colon == std::string::npos || colon >= end || colon == position) {
+            error_response = HttpResponse::error(400, "Malformed header");
+            return ParseStatus::ERROR;
+        }
+        std::string name = toLower(input.substr(position, colon - position));
+        std::string value = trim(input.substr(colon + 1, end - colon - 1));
+
+        if (name == "content-length") {
+            if (value.empty() || value.size() > 18 || value.find_first_not_of("0123456789") != std::string::npos) {
+                error_response = HttpResponse::error(400, "Invalid Content-Length");
+                return ParseStatus::ERROR;
+            }
+            content_length = std::stoull(value);
+        } else if (name == "transfer-encoding") {
+            error_response = HttpResponse::error(501, "Chunked request bodies are not supported");
+            return ParseStatus::ERROR;
+        } else if (name == "connection") {
+            connection_header = toLower(value);
+        }
+        headers.emplace_back(std::move(name), std::move(value));
+        position = end + 2;
+    }
+
+    if (content_length > options.max_body_bytes) {
+        error_response = HttpResponse::error(413, "Request body too large");
+        return ParseStatus::ERROR;
+    }
+    std::size_t total = header_end + 4 + content_length;
+    if (input.size() < total) return ParseStatus::INCOMPLETE;
+
+    request.method = input.substr(0, first_space);
+    std::string target = input.substr(first_space + 1, second_space - first_space - 1);
+    std::size_t question = target.find('?');
+    request.path = target.substr(0, question);
+    if (question != std::string::npos) request.query = target.substr(question + 1);
+    request.headers = std::move(headers);
+    request.body = input.substr(header_end + 4, content_length);
+    if (version == "HTTP/1.1") {
+        request.keep_alive = connection_header.find("close") == std::string::npos;
+    } else {
+        request.keep_alive = connection_header.find("keep-alive") != std::string::npos;
+    }
+
+    connection.input.erase(0, total);
+    return ParseStatus::READY;
+}
+
+std::string HttpServer::serialize(const HttpResponse& response, bool keep_alive) {
+    std::string out;
+    out.reserve(response.body.size() + 128);
+    out.append("HTTP/1.1 ");
+    out.append(std::to_string(response.status));
+    out.push_back(' ');
+    out.append(HttpResponse::reasonPhrase(response.status));
+    out.append("\r\nContent-Type: ");
+    out.append(response.content_type);
+    out.append("\r\nContent-Length: ");
+    out.append(std::to_string(response.body.size()));
+    out.append(keep_alive ? "\r\nConnection: keep-alive\r\n\r\n" : "\r\nConnection: close\r\n\r\n");
+    out.append(response.body);
+    return out;
+}
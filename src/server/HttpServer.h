@@ -0,0 +1,154 @@
+#ifndef HTTP_SERVER_H
+#define HTTP_SERVER_H
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <unordered_map>
+#include <memory>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <cstdint>
+
+struct HttpRequest {
+    std::string method;
+    std::string path;  // Without the query string
+    std::string query; // Raw text after '?'
+    std::vector<std::pair<std::string, std::string>> headers; // Names lower-cased
+    std::string body;
+    bool keep_alive = true;
+
+    std::string header(const std::string& name) const; // Empty when absent; name in lower case
+    std::string queryParam(const std::string& name, const std::string& fallback = "") const;
+};
+
+struct HttpResponse {
+    int status = 200;
+    std::string content_type = "application/json";
+    std::string body;
+
+    static HttpResponse json(int status, std::string body);
+    static HttpResponse error(int status, const std::string& message); // {"error": message}
+    static const char* reasonPhrase(int status);
+};
+
+using HttpHandler = std::function<HttpResponse(const HttpRequest&)>;
+
+struct HttpServerOptions {
+    std::string host = "127.0.0.1";
+    std::uint16_t port = 8080;              // 0 picks a free port; see getPort()
+    unsigned int worker_threads = 0;        // 0 means hardware threads
+    std::size_t queue_capacity = 1024;      // Requests waiting for a worker; beyond this, 503
+    std::size_t max_header_bytes = 16 * 1024;
+    std::size_t max_body_bytes = 1024 * 1024;
+    std::size_t max_connections = 10000;
+    int idle_timeout_seconds = 60;          // Keep-alive connections idle this long are closed
+};
+
+struct HttpServerStats {
+    std::uint64_t connections_accepted;
+    std::uint64_t requests_handled;
+    std::uint64_t requests_rejected; // 503s from a full queue
+    std::size_t open_connections;
+};
+
+// HTTP/1.1 server for JSON APIs (Linux, epoll). One I/O thread owns every
+// socket: it accepts, reads and parses requests and writes responses, all
+// non-blocking. Parsed requests go to a bounded queue served by a fixed
+// pool of workers running the handler; finished responses come back to the
+// I/O thread through an eventfd. Connections stay open between requests
+// unless the client asks otherwise, and handle one request at a time, so
+// pipelined requests are answered in order.
+class HttpServer {
+public:
+    HttpServer(const HttpServerOptions& options, HttpHandler handler);
+    ~HttpServer();
+
+    HttpServer(const HttpServer&) = delete;
+    HttpServer& operator=(const HttpServer&) = delete;
+
+    void start(); // Binds and starts the threads; throws std::runtime_error
+    void stop();  // Closes every connection; requests still queued are dropped
+
+    bool isRunning() const;
+    std::uint16_t getPort() const;
+    HttpServerStats getStats() const;
+
+private:
+    struct Connection {
+        int fd;
+        std::uint64_t generation; // Distinguishes reuses of the same fd
+        std::string input;
+        std::string output;
+        std::size_t output_offset = 0;
+        bool busy = false;        // A request is with the workers
+        bool close_after_write = false;
+        bool want_write = false;  // Registered for EPOLLOUT
+        std::int64_t last_active = 0;
+    };
+
+    struct Job {
+        int fd;
+        std::uint64_t generation;
+        HttpRequest request;
+    };
+
+    struct Completion {
+        int fd;
+        std::uint64_t generation;
+        std::string bytes;
+        bool keep_alive;
+    };
+
+    enum class ParseStatus { INCOMPLETE, READY, ERROR };
+
+    HttpServerOptions options;
+    HttpHandler handler;
+
+    int listen_fd;
+    int epoll_fd;
+    int wake_fd; // eventfd: completions ready or stop requested
+    std::uint16_t bound_port;
+    std::atomic<bool> running;
+
+    std::thread io_thread;
+    std::vector<std::thread> workers;
+
+    // Worker queue
+    std::deque<Job> jobs;
+    std::mutex jobs_mutex;
+    std::condition_variable jobs_cv;
+
+    // Responses on their way back to the I/O thread
+    std::vector<Completion> completions;
+    std::mutex completions_mutex;
+
+    // Owned by the I/O thread
+    std::unordered_map<int, std::unique_ptr<Connection>> connections;
+    std::uint64_t next_generation;
+
+    std::atomic<std::uint64_t> connections_accepted;
+    std::atomic<std::uint64_t> requests_handled;
+    std::atomic<std::uint64_t> requests_rejected;
+    std::atomic<std::size_t> open_connections;
+
+    void ioLoop();
+    void workerLoop();
+    void acceptConnections();
+    void readFrom(Connection& connection);
+    void dispatch(Connection& connection); // Hands the next complete request to the workers
+    void drainCompletions();
+    bool flush(Connection& connection); // False once the connection is closed
+    void closeConnection(int fd);
+    void closeIdle(std::int64_t now);
+    void updateInterest(Connection& connection, bool want_write);
+    bool respondDirectly(Connection& connection, const HttpResponse& response, bool keep_alive);
+
+    ParseStatus parseRequest(Connection& connection, HttpRequest& request, HttpResponse& error_response);
+    static std::string serialize(const HttpResponse& response, bool keep_alive);
+};
+
+#endif // HTTP_SERVER_H
@@ -0,0 +1,254 @@
+#include "BatchCommandProcessor.h"
+#include "../models/Account.h"
+#include "../exceptions.h"
+#include <istream>
+#include <ostream>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+
+namespace {
+    constexpr std::size_t kFlushThreshold = 64 * 1024;
+
+    bool isSpace(char c) {
+        return c == ' ' || c == '\t' || c == '\r';
+    }
+
+    // Splits off up to max_tokens leading tokens; rest receives the remainder
+    std::vector<std::string_view> tokenize(std::string_view line, std::size_t max_tokens, std::string_view& rest) {
+        std::vector<std::string_view> tokens;
+        std::size_t position = 0;
+        while (tokens.size() < max_tokens) {
+            while (position < line.size() && isSpace(line[position])) ++position;
+            if (position == line.size()) break;
+            std::size_t start = position;
+            while (position < line.size() && !isSpace(line[position])) ++position;
+            tokens.push_back(line.substr(start, position - start));
+        }
+        while (position < line.size() && isSpace(line[position])) ++position;
+        std::size_t end = line.size();
+        while (end > position && isSpace(line[end - 1])) --end;
+        rest = line.substr(position, end - position);
+        return tokens;
+    }
+
+    int parseId(std::string_view text) {
+        std::string value(text);
+        char* end = nullptr;
+        long id = std::strtol(value.c_str(), &end, 10);
+        if (value.empty() || *end != '\0' || id <= 0 || id > 2147483647L) {
+            throw std::invalid_argument("Invalid ID '" + value + "'");
+        }
+        return static_cast<int>(id);
+    }
+
+    double parseAmount(std::string_view text) {
+        std::string value(text);
+        char* end = nullptr;
+        double amount = std::strtod(value.c_str(), &end);
+        if (value.empty() || *end != '\0' || !std::isfinite(amount)) {
+            throw std::invalid_argument("Invalid amount '" + value + "'");
+        }
+        return amount;
+    }
+
+    void appendMoney(std::string& out, double amount) {
+        char buffer[32];
+        int length = std::snprintf(buffer, sizeof(buffer), "%.2f", amount);
+        out.append(buffer, static_cast<std::size_t>(length));
+    }
+
+    void requireArgs(const std::vector<std::string_view>& args, std::size_t minimum, const char* usage) {
+        if (args.size() < minimum) {
+            throw std::invalid_argument(std::string("Usage: ") + usage);
+        }
+    }
+}
+
+BatchCommandProcessor::BatchCommandProcessor(UserDirectory& user_directory, TransactionService& transaction_service)
+    : user_directory(user_directory), transaction_service(transaction_service) {}
+
+BatchStats BatchCommandProcessor::run(std::istream& input, std::ostream& output, bool quiet) {
+    BatchStats stats;
+    std::string line;
+    std::string result;
+    std::string pending; // Output collected between flushes
+    std::size_t line_number = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    while (std::getline(input, line)) {
+        ++line_number;
+        std::size_t first = line.find_first_not_of(" \t\r");
+        if (first == std::string::npos || line[first] == '#') continue;
+
+        result.clear();
+        bool ok = execute(line, line_number, result);
+        ++stats.commands;
+        if (ok) {
+            ++stats.succeeded;
+        } else {
+            ++stats.failed;
+        }
+        if (!ok || !quiet) {
+            pending.append(result);
+        }
+        if (pending.size() >= kFlushThreshold) {
+            output.write(pending.data(), static_cast<std::streamsize>(pending.size()));
+            pending.clear();
+        }
+    }
+    output.write(pending.data(), static_cast<std::streamsize>(pending.size()));
+    output.flush();
+
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return stats;
+}
+
+bool BatchCommandProcessor::execute(std::string_view line, std::size_t line_number, std::string& out) {
+    std::string_view rest;
+    std::vector<std::string_view> command = tokenize(line, 1, rest);
+    if (command.empty()) return true;
+    std::string_view name = command[0];
+
+    try {
+        TransactionResult result = TransactionResult::success();
+        std::string_view description;
+        if (name == "create-user") {
+            createUser(tokenize(rest, 3, description), out);
+        } else if (name == "open-account") {
+            openAccount(tokenize(rest, 3, description), out);
+        } else if (name == "deposit") {
+            auto args = tokenize(rest, 2, description);
+            result = deposit(args, description, out);
+        } else if (name == "withdraw") {
+            auto args = tokenize(rest, 2, description);
+            result = withdraw(args, description, out);
+        } else if (name == "transfer") {
+            auto args = tokenize(rest, 3, description);
+            result = transfer(args, description, out);
+        } else if (name == "balance") {
+            balance(tokenize(rest, 1, description), out);
+        } else if (name == "history") {
+            history(tokenize(rest, 2, description), out);
+        } else {
+            throw std::invalid_argument("Unknown command '" + std::string(name) + "'");
+        }
+
+        if (!result) {
+            out.append("declined ").append(std::to_string(line_number)).append(": ").append(result.reason).push_back('\n');
+            return false;
+        }
+        return true;
+    } catch (const std::exception& e) {
+        out.append("error ").append(std::to_string(line_number)).append(": ").append(e.what()).push_back('\n');
+        return false;
+    }
+}
+
+void BatchCommandProcessor::createUser(const std::vector<std::string_view>& args, std::string& out) {
+    requireArgs(args, 3, "create-user <name> <email> <password>");
+    auto user = user_directory.createUser(std::string(args[0]), std::string(args[1]),
+                                          User::hashPassword(std::string(args[2])));
+    out.append("user ").append(std::to_string(user->getUserId())).push_back('\n');
+}
+
+void BatchCommandProcessor::openAccount(const std::vector<std::string_view>& args, std::string& out) {
+    requireArgs(args, 2, "open-account <user_id> <type> [balance]");
+    int user_id = parseId(args[0]);
+    std::string type_name(args[1]);
+    AccountType type = Account::stringToAccountType(type_name);
+    if (Account::accountTypeToString(type) != type_name) {
+        throw std::invalid_argument("Account type must be Savings, Checking, Credit or Investment");
+    }
+    double initial_balance = args.size() > 2 ? parseAmount(args[2]) : 0.0;
+    if (initial_balance < 0) {
+        throw std::invalid_argument("Initial balance cannot be negative");
+    }
+
+    auto account = user_directory.createAccount(user_id, type, initial_balance);
+    out.append("account ").append(std::to_string(account->getAccountId())).push_back('\n');
+}
+
+TransactionResult BatchCommandProcessor::deposit(const std::vector<std::string_view>& args,
+                                                 std::string_view description, std::string& out) {
+    requireArgs(args, 2, "deposit <account_id> <amount> [description]");
+    auto account = requireAccount(args[0]);
+    TransactionResult result = transaction_service.processDeposit(account, parseAmount(args[1]),
+                                                                  std::string(description));
+    if (result) {
+        out.append("ok ").append(args[0]).push_back(' ');
+        appendMoney(out, account->getBalance());
+        out.push_back('\n');
+    }
+    return result;
+}
+
+TransactionResult BatchCommandProcessor::withdraw(const std::vector<std::string_view>& args,
+                                                  std::string_view description, std::string& out) {
+    requireArgs(args, 2, "withdraw <account_id> <amount> [description]");
+    auto account = requireAccount(args[0]);
+    TransactionResult result = transaction_service.processWithdrawal(account, parseAmount(args[1]),
+                                                                     std::string(description));
+    if (result) {
+        out.append("ok ").append(args[0]).push_back(' ');
+        appendMoney(out, account->getBalance());
+        out.push_back('\n');
+    }
+    return result;
+}
+
+TransactionResult BatchCommandProcessor::transfer(const std::vector<std::string_view>& args,
+                                                  std::string_view description, std::string& out) {
+    requireArgs(args, 3, "transfer <from_id> <to_id> <amount> [description]");
+    auto from_account = requireAccount(args[0]);
+    auto to_account = requireAccount(args[1]);
+    TransactionResult result = transaction_service.processTransfer(from_account, to_account, parseAmount(args[2]),
+                                                                   std::string(description));
+    if (result) {
+        out.append("ok ");
+        appendMoney(out, from_account->getBalance());
+        out.push_back(' ');
+        appendMoney(out, to_account->getBalance());
+        out.push_back('\n');
+    }
+    return result;
+}
+
+void BatchCommandProcessor::balance(const std::vector<std::string_view>& args, std::string& out) {
+    requireArgs(args, 1, "balance <account_id>");
+    auto account = requireAccount(args[0]);
+    out.append("balance ").append(args[0]).push_back(' ');
+    appendMoney(out, account->getBalance());
+    out.push_back('\n');
+}
+
+void BatchCommandProcessor::history(const std::vector<std::string_view>& args, std::string& out) {
+    requireArgs(args, 1, "history <account_id> [limit]");
+    auto account = requireAccount(args[0]);
+    std::size_t limit = args.size() > 1 ? static_cast<std::size_t>(parseId(args[1])) : 10;
+
+    TransactionPage page = account->getRecentTransactions(limit);
+    out.append("history ").append(args[0]).push_back(' ');
+    out.append(std::to_string(page.transactions.size())).push_back('\n');
+    for (const Transaction* transaction : page.transactions) {
+        out.append("  ").append(std::to_string(transaction->getTransactionId())).push_back(' ');
+        out.append(transaction->getTimestampString()).push_back(' ');
+        out.append(transaction->getTypeString()).push_back(' ');
+        appendMoney(out, transaction->getAmount());
+        if (!transaction->getDescription().empty()) {
+            out.push_back(' ');
+            out.append(transaction->getDescription());
+        }
+        out.push_back('\n');
+    }
+}
+
+std::shared_ptr<Account> BatchCommandProcessor::requireAccount(std::string_view id_text) const {
+    auto account = user_directory.findAccount(parseId(id_text));
+    if (!account) {
+        throw InvalidAccountException("Account " + std::string(id_text) + " not found");
+    }
+    return account;
+}
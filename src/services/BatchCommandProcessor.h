@@ -0,0 +1,63 @@
+#ifndef BATCH_COMMAND_PROCESSOR_H
+#define BATCH_COMMAND_PROCESSOR_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <iosfwd>
+#include <cstddef>
+#include "UserDirectory.h"
+#include "TransactionService.h"
+
+struct BatchStats {
+    std::size_t commands = 0;
+    std::size_t succeeded = 0;
+    std::size_t failed = 0; // Declines and invalid commands
+    double seconds = 0.0;
+
+    double opsPerSecond() const { return seconds > 0 ? commands / seconds : 0.0; }
+};
+
+// Runs line-oriented commands against the engine without prompts, for
+// scripting and end-to-end throughput runs. One command per line; blank
+// lines and lines starting with '#' are skipped. IDs are the ones the
+// engine assigns, starting at 1 in a fresh directory.
+//
+//   create-user <name> <email> <password>      -> user <id>
+//   open-account <user_id> <type> [balance]    -> account <id>
+//   deposit <account_id> <amount> [description]  -> ok <account_id> <balance>
+//   withdraw <account_id> <amount> [description] -> ok <account_id> <balance>
+//   transfer <from_id> <to_id> <amount> [description] -> ok <from_balance> <to_balance>
+//   balance <account_id>                       -> balance <account_id> <balance>
+//   history <account_id> [limit]               -> history <account_id> <count>, then one line per entry
+//
+// Failures print "declined <line>: <reason>" or "error <line>: <message>"
+// and processing continues.
+class BatchCommandProcessor {
+public:
+    BatchCommandProcessor(UserDirectory& user_directory, TransactionService& transaction_service);
+
+    // quiet suppresses the per-command results but still reports failures
+    BatchStats run(std::istream& input, std::ostream& output, bool quiet = false);
+
+    // Executes one line, appending its result to out; false on failure
+    bool execute(std::string_view line, std::size_t line_number, std::string& out);
+
+private:
+    UserDirectory& user_directory;
+    TransactionService& transaction_service;
+
+    // Handlers append their result line on success. Invalid commands throw;
+    // declines come back in the result.
+    void createUser(const std::vector<std::string_view>& args, std::string& out);
+    void openAccount(const std::vector<std::string_view>& args, std::string& out);
+    TransactionResult deposit(const std::vector<std::string_view>& args, std::string_view description, std::string& out);
+    TransactionResult withdraw(const std::vector<std::string_view>& args, std::string_view description, std::string& out);
+    TransactionResult transfer(const std::vector<std::string_view>& args, std::string_view description, std::string& out);
+    void balance(const std::vector<std::string_view>& args, std::string& out);
+    void history(const std::vector<std::string_view>& args, std::string& out);
+
+    std::shared_ptr<Account> requireAccount(std::string_view id_text) const; // Throws InvalidAccountException
+};
+
+#endif // BATCH_COMMAND_PROCESSOR_H
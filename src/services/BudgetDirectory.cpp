@@ -0,0 +1,140 @@
+#include "BudgetDirectory.h"
+#include <stdexcept>
+#include <mutex>
+#include <algorithm>
+
+BudgetDirectory::BudgetDirectory() {}
+
+BudgetDirectory::~BudgetDirectory() {
+    // Hand the status bits back before the chunks they point into go away
+    std::unique_lock<std::shared_mutex> lock(directory_mutex);
+    for (const auto& pair : user_slots) {
+        BudgetManager& manager = *managers[pair.second];
+        std::unique_lock<std::shared_mutex> manager_lock(manager.manager_mutex);
+        manager.status = &manager.own_status;
+        manager.refreshStatusLocked();
+    }
+}
+
+void BudgetDirectory::addManager(std::shared_ptr<BudgetManager> budget_manager) {
+    if (!budget_manager) {
+        throw std::invalid_argument("Budget manager cannot be null");
+    }
+
+    std::unique_lock<std::shared_mutex> lock(directory_mutex);
+    int user_id = budget_manager->getUserId();
+    if (user_slots.count(user_id)) {
+        throw std::invalid_argument("A budget manager is already registered for this user");
+    }
+
+    {
+        std::shared_lock<std::shared_mutex> manager_lock(budget_manager->manager_mutex);
+        if (budget_manager->status != &budget_manager->own_status) {
+            throw std::invalid_argument("Budget manager already belongs to a directory");
+        }
+    }
+
+    std::uint32_t slot;
+    if (!free_slots.empty()) {
+        slot = free_slots.back();
+        free_slots.pop_back();
+    } else {
+        slot = static_cast<std::uint32_t>(managers.size());
+        if (slot % kChunkSize == 0) {
+            auto chunk = std::make_unique<Chunk>();
+            chunk->user_ids.fill(-1);
+            chunks.push_back(std::move(chunk));
+        }
+        managers.emplace_back();
+    }
+
+    {
+        std::unique_lock<std::shared_mutex> manager_lock(budget_manager->manager_mutex);
+        budget_manager->status = &statusAt(slot);
+        budget_manager->refreshStatusLocked();
+    }
+
+    chunks[slot / kChunkSize]->user_ids[slot % kChunkSize] = user_id;
+    managers[slot] = std::move(budget_manager);
+    user_slots.emplace(user_id, slot);
+}
+
+void BudgetDirectory::removeManager(int user_id) {
+    std::unique_lock<std::shared_mutex> lock(directory_mutex);
+    auto it = user_slots.find(user_id);
+    if (it == user_slots.end()) return;
+
+    std::uint32_t slot = it->second;
+    BudgetManager& manager = *managers[slot];
+    {
+        std::unique_lock<std::shared_mutex> manager_lock(manager.manager_mutex);
+        manager.status = &manager.own_status;
+        manager.refreshStatusLocked();
+    }
+
+    statusAt(slot).store(nullptr, 0, 0);
+    chunks[slot / kChunkSize]->user_ids[slot % kChunkSize] = -1;
+    managers[slot].reset();
+    free_slots.push_back(slot);
+    user_slots.erase(it);
+}
+
+std::shared_ptr<BudgetManager> BudgetDirectory::getManager(int user_id) const {
+    std::shared_lock<std::shared_mutex> lock(directory_mutex);
+    auto it = user_slots.find(user_id);
+    return (it != user_slots.end()) ? managers[it->second] : nullptr;
+}
+
+std::size_t BudgetDirectory::size() const {
+    std::shared_lock<std::shared_mutex> lock(directory_mutex);
+    return user_slots.size();
+}
+
+BudgetCrossing BudgetDirectory::recordExpense(int user_id, TransactionCategory category, double amount) {
+    // The shared lock keeps the manager registered (and its status slot
+    // valid) for the duration of the expense
+    std::shared_lock<std::shared_mutex> lock(directory_mutex);
+    auto it = user_slots.find(user_id);
+    if (it == user_slots.end()) return BudgetCrossing::NONE;
+    return managers[it->second]->recordExpense(category, amount);
+}
+
+std::vector<int> BudgetDirectory::getUsersOverBudget() const {
+    return scan(0xffff, 0);
+}
+
+std::vector<int> BudgetDirectory::getUsersOverBudget(TransactionCategory category) const {
+    std::size_t index = static_cast<std::size_t>(category);
+    if (index >= kTransactionCategoryCount) {
+        throw std::invalid_argument("Unknown transaction category");
+    }
+    return scan(static_cast<std::uint16_t>(1u << index), 0);
+}
+
+std::vector<int> BudgetDirectory::getUsersNeedingAlerts() const {
+    return scan(0, 0xffff);
+}
+
+// Private methods
+BudgetStatus& BudgetDirectory::statusAt(std::uint32_t slot) const {
+    return chunks[slot / kChunkSize]->status[slot % kChunkSize];
+}
+
+std::vector<int> BudgetDirectory::scan(std::uint16_t over_bits, std::uint16_t alert_bits) const {
+    std::shared_lock<std::shared_mutex> lock(directory_mutex);
+    std::vector<int> user_ids;
+
+    std::size_t remaining = managers.size();
+    for (const auto& chunk : chunks) {
+        std::size_t count = std::min(remaining, kChunkSize);
+        for (std::size_t i = 0; i < count; ++i) {
+            std::uint16_t over, alert;
+            chunk->status[i].load(over, alert);
+            if ((over & over_bits) || (alert & ~over & alert_bits)) {
+                user_ids.push_back(chunk->user_ids[i]);
+            }
+        }
+        remaining -= count;
+    }
+    return user_ids;
+}
@@ -0,0 +1,57 @@
+#ifndef BUDGET_DIRECTORY_H
+#define BUDGET_DIRECTORY_H
+
+#include <vector>
+#include <memory>
+#include <array>
+#include <unordered_map>
+#include <shared_mutex>
+#include <cstdint>
+#include "../models/Budget.h"
+
+// Registry of every user's BudgetManager. Each registered manager publishes
+// its over-budget / approaching-limit bits into a slot of a chunked,
+// contiguous status table, so "which users are over budget" is a linear scan
+// over a few bytes per user instead of a walk over every user's budgets.
+class BudgetDirectory {
+private:
+    static constexpr std::size_t kChunkSize = 4096;
+
+    struct Chunk {
+        std::array<int, kChunkSize> user_ids;     // -1 for a free slot
+        std::array<BudgetStatus, kChunkSize> status;
+    };
+
+    std::unordered_map<int, std::uint32_t> user_slots; // user_id -> slot
+    std::vector<std::shared_ptr<BudgetManager>> managers; // Indexed by slot
+    std::vector<std::unique_ptr<Chunk>> chunks;          // Stable addresses for the managers' status pointers
+    std::vector<std::uint32_t> free_slots;
+    mutable std::shared_mutex directory_mutex;
+
+    BudgetStatus& statusAt(std::uint32_t slot) const;
+    std::vector<int> scan(std::uint16_t over_bits, std::uint16_t alert_bits) const;
+
+public:
+    // Constructor and Destructor
+    BudgetDirectory();
+    ~BudgetDirectory();
+
+    BudgetDirectory(const BudgetDirectory&) = delete;
+    BudgetDirectory& operator=(const BudgetDirectory&) = delete;
+
+    // Registration
+    void addManager(std::shared_ptr<BudgetManager> budget_manager);
+    void removeManager(int user_id);
+    std::shared_ptr<BudgetManager> getManager(int user_id) const;
+    std::size_t size() const;
+
+    // Expense tracking
+    BudgetCrossing recordExpense(int user_id, TransactionCategory category, double amount);
+
+    // Bulk queries, answered from the status table alone
+    std::vector<int> getUsersOverBudget() const;
+    std::vector<int> getUsersOverBudget(TransactionCategory category) const;
+    std::vector<int> getUsersNeedingAlerts() const; // Approaching a limit, not yet over it
+};
+
+#endif // BUDGET_DIRECTORY_H
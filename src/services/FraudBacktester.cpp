@@ -0,0 +1,426 @@
+#include "FraudBacktester.h"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <deque>
+#include <iomanip>
+#include <mutex>
+#include <stdexcept>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+
+namespace {
+    using RecordBatch = std::vector<BacktestRecord>;
+
+    // Blocking single-consumer queue with a fixed capacity; the reader stalls
+    // when a worker falls behind instead of buffering without limit.
+    class BatchQueue {
+    private:
+        std::deque<RecordBatch> batches;
+        std::size_t capacity;
+        bool closed;
+        std::mutex queue_mutex;
+        std::condition_variable not_empty;
+        std::condition_variable not_full;
+
+    public:
+        explicit BatchQueue(std::size_t capacity) : capacity(std::max<std::size_t>(capacity, 1)), closed(false) {}
+
+        void push(RecordBatch batch) {
+            std::unique_lock<std::mutex> lock(queue_mutex);
+            not_full.wait(lock, [this] { return batches.size() < capacity; });
+            batches.push_back(std::move(batch));
+            not_empty.notify_one();
+        }
+
+        bool pop(RecordBatch& batch) {
+            std::unique_lock<std::mutex> lock(queue_mutex);
+            not_empty.wait(lock, [this] { return !batches.empty() || closed; });
+            if (batches.empty()) return false;
+            batch = std::move(batches.front());
+            batches.pop_front();
+            not_full.notify_one();
+            return true;
+        }
+
+        void close() {
+            std::lock_guard<std::mutex> lock(queue_mutex);
+            closed = true;
+            not_empty.notify_all();
+        }
+    };
+
+    struct WorkerState {
+        std::vector<std::unique_ptr<FraudDetectionService>> services;
+        std::vector<RuleSetResult> results;
+        std::vector<std::vector<std::uint64_t>> overlap;
+        std::uint64_t rows = 0;
+        std::uint64_t labeled = 0;
+        std::uint64_t fraud_labels = 0;
+    };
+
+    void evaluateBatch(const RecordBatch& batch, WorkerState& state) {
+        const std::size_t set_count = state.services.size();
+
+        for (const auto& record : batch) {
+            Transaction transaction(record.transaction_id, record.account_id, record.amount,
+                                    record.type, record.category);
+            transaction.setToAccountId(record.to_account_id);
+            transaction.setLocation(record.location);
+            transaction.setTimestamp(std::chrono::system_clock::time_point(
+                std::chrono::duration_cast<std::chrono::system_clock::duration>(
+                    std::chrono::seconds(record.epoch_seconds))));
+
+            state.rows++;
+            if (record.label != ReviewLabel::UNLABELED) state.labeled++;
+            if (record.label == ReviewLabel::FRAUD) state.fraud_labels++;
+
+            std::uint32_t flagged_sets = 0;
+            for (std::size_t i = 0; i < set_count; ++i) {
+                FraudEvaluation evaluation = state.services[i]->evaluateTransaction(transaction);
+                RuleSetResult& result = state.results[i];
+
+                if (evaluation.isSuspicious()) {
+                    flagged_sets |= 1u << i;
+                    result.flagged++;
+                    for (std::size_t c = 0; c < kFraudCheckCount; ++c) {
+                        if (evaluation.triggered(static_cast<FraudCheck>(c))) result.check_triggers[c]++;
+                    }
+                    if (record.label == ReviewLabel::FRAUD) result.true_positives++;
+                    else if (record.label == ReviewLabel::LEGITIMATE) result.false_positives++;
+                } else {
+                    if (record.label == ReviewLabel::FRAUD) result.false_negatives++;
+                    else if (record.label == ReviewLabel::LEGITIMATE) result.true_negatives++;
+                }
+            }
+
+            for (std::size_t i = 0; i < set_count && flagged_sets; ++i) {
+                if (!(flagged_sets & (1u << i))) continue;
+                for (std::size_t j = 0; j < set_count; ++j) {
+                    if (flagged_sets & (1u << j)) state.overlap[i][j]++;
+                }
+            }
+        }
+    }
+
+    std::string_view trimView(std::string_view text) {
+        while (!text.empty() && (text.front() == ' ' || text.front() == '\t')) text.remove_prefix(1);
+        while (!text.empty() && (text.back() == ' ' || text.back() == '\t' || text.back() == '\r')) text.remove_suffix(1);
+        return text;
+    }
+
+    std::string trim(const std::string& text) {
+        return std::string(trimView(text));
+    }
+
+    // strtoll/strtod need a terminated buffer; fields are short so copy to the stack
+    template <typename T>
+    bool parseNumber(std::string_view text, T& value) {
+        text = trimView(text);
+        char buffer[64];
+        if (text.empty() || text.size() >= sizeof(buffer)) return false;
+        text.copy(buffer, text.size());
+        buffer[text.size()] = '\0';
+
+        char* end = nullptr;
+        if constexpr (std::is_floating_point<T>::value) {
+            value = std::strtod(buffer, &end);
+        } else {
+            value = std::strtoll(buffer, &end, 10);
+        }
+        return end == buffer + text.size();
+    }
+}
+
+double RuleSetResult::precision() const {
+    std::uint64_t reviewed = true_positives + false_positives;
+    return reviewed ? static_cast<double>(true_positives) / reviewed : 0.0;
+}
+
+double RuleSetResult::recall() const {
+    std::uint64_t fraud = true_positives + false_negatives;
+    return fraud ? static_cast<double>(true_positives) / fraud : 0.0;
+}
+
+double BacktestReport::rowsPerSecond() const {
+    return elapsed_seconds > 0.0 ? rows_processed / elapsed_seconds : 0.0;
+}
+
+FraudBacktester::FraudBacktester(std::vector<FraudRuleSet> rule_sets, BacktestOptions options)
+    : rule_sets(std::move(rule_sets)), options(std::move(options)) {
+    if (this->rule_sets.empty()) {
+        throw std::invalid_argument("At least one rule set is required");
+    }
+    if (this->rule_sets.size() > kMaxRuleSets) {
+        throw std::invalid_argument("Too many rule sets (max " + std::to_string(kMaxRuleSets) + ")");
+    }
+    if (this->options.worker_count == 0) {
+        this->options.worker_count = std::max(1u, std::thread::hardware_concurrency());
+    }
+    if (this->options.batch_size == 0) {
+        this->options.batch_size = 1;
+    }
+    if (!this->options.time_zone) {
+        this->options.time_zone = TimeZone::utc();
+    }
+}
+
+BacktestReport FraudBacktester::run(std::istream& input) {
+    auto start = std::chrono::steady_clock::now();
+    const unsigned worker_count = options.worker_count;
+    const std::size_t set_count = rule_sets.size();
+
+    std::vector<WorkerState> states(worker_count);
+    std::vector<std::unique_ptr<BatchQueue>> queues;
+    for (auto& state : states) {
+        for (const auto& rule_set : rule_sets) {
+            auto service = std::make_unique<FraudDetectionService>(rule_set.rules);
+            service->setDefaultTimeZone(options.time_zone);
+            state.services.push_back(std::move(service));
+
+            RuleSetResult result;
+            result.name = rule_set.name;
+            state.results.push_back(result);
+        }
+        state.overlap.assign(set_count, std::vector<std::uint64_t>(set_count, 0));
+        queues.push_back(std::make_unique<BatchQueue>(options.queue_depth));
+    }
+
+    std::vector<std::thread> workers;
+    for (unsigned w = 0; w < worker_count; ++w) {
+        workers.emplace_back([&states, &queues, w]() {
+            RecordBatch batch;
+            while (queues[w]->pop(batch)) {
+                evaluateBatch(batch, states[w]);
+            }
+        });
+    }
+
+    // Stream the ledger, routing each row to the worker that owns its account
+    BacktestReport report;
+    std::vector<RecordBatch> pending(worker_count);
+    std::string line;
+    BacktestRecord record;
+    bool first_line = true;
+
+    while (std::getline(input, line)) {
+        if (first_line) {
+            first_line = false;
+            if (line.compare(0, 14, "transaction_id") == 0) continue;
+        }
+        if (line.empty() || line[0] == '#') continue;
+
+        if (!parseRecord(line, record)) {
+            report.malformed_rows++;
+            continue;
+        }
+
+        unsigned w = static_cast<unsigned>(record.account_id) % worker_count;
+        pending[w].push_back(std::move(record));
+        if (pending[w].size() >= options.batch_size) {
+            queues[w]->push(std::move(pending[w]));
+            pending[w] = RecordBatch();
+            pending[w].reserve(options.batch_size);
+        }
+    }
+
+    for (unsigned w = 0; w < worker_count; ++w) {
+        if (!pending[w].empty()) queues[w]->push(std::move(pending[w]));
+        queues[w]->close();
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    // Merge per-worker tallies
+    report.rule_sets = states[0].results;
+    report.overlap.assign(set_count, std::vector<std::uint64_t>(set_count, 0));
+    for (unsigned w = 0; w < worker_count; ++w) {
+        const WorkerState& state = states[w];
+        report.rows_processed += state.rows;
+        report.labeled_rows += state.labeled;
+        report.fraud_labels += state.fraud_labels;
+
+        for (std::size_t i = 0; i < set_count; ++i) {
+            for (std::size_t j = 0; j < set_count; ++j) {
+                report.overlap[i][j] += state.overlap[i][j];
+            }
+            if (w == 0) continue;
+
+            RuleSetResult& merged = report.rule_sets[i];
+            const RuleSetResult& part = state.results[i];
+            merged.flagged += part.flagged;
+            merged.true_positives += part.true_positives;
+            merged.false_positives += part.false_positives;
+            merged.false_negatives += part.false_negatives;
+            merged.true_negatives += part.true_negatives;
+            for (std::size_t c = 0; c < kFraudCheckCount; ++c) {
+                merged.check_triggers[c] += part.check_triggers[c];
+            }
+        }
+    }
+
+    report.elapsed_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return report;
+}
+
+FraudRuleSet FraudBacktester::parseRuleSet(const std::string& spec) {
+    FraudRuleSet rule_set;
+    rule_set.rules = FraudDetectionService::defaultFraudRules();
+
+    std::size_t colon = spec.find(':');
+    rule_set.name = trim(spec.substr(0, colon));
+    if (rule_set.name.empty()) {
+        throw std::invalid_argument("Rule set needs a name: " + spec);
+    }
+    if (colon == std::string::npos) {
+        return rule_set;
+    }
+
+    std::string overrides = spec.substr(colon + 1);
+    std::size_t pos = 0;
+    while (pos <= overrides.size()) {
+        std::size_t comma = overrides.find(',', pos);
+        std::string item = overrides.substr(pos, comma == std::string::npos ? std::string::npos : comma - pos);
+        pos = (comma == std::string::npos) ? overrides.size() + 1 : comma + 1;
+        if (trim(item).empty()) continue;
+
+        std::size_t equals = item.find('=');
+        if (equals == std::string::npos) {
+            throw std::invalid_argument("Expected 'Rule Name=value' in rule set: " + item);
+        }
+        std::string rule_name = trim(item.substr(0, equals));
+        std::string value = trim(item.substr(equals + 1));
+
+        auto it = std::find_if(rule_set.rules.begin(), rule_set.rules.end(),
+            [&rule_name](const FraudRule& rule) { return rule.rule_name == rule_name; });
+        if (it == rule_set.rules.end()) {
+            throw std::invalid_argument("Unknown fraud rule: " + rule_name);
+        }
+
+        if (value == "off") {
+            it->enabled = false;
+        } else if (value == "on") {
+            it->enabled = true;
+        } else {
+            char* end = nullptr;
+            double threshold = std::strtod(value.c_str(), &end);
+            if (value.empty() || !end || *end != '\0') {
+                throw std::invalid_argument("Invalid threshold for " + rule_name + ": " + value);
+            }
+            FraudDetectionService::validateRule(rule_name, threshold);
+            it->threshold_value = threshold;
+            it->enabled = true;
+        }
+    }
+    return rule_set;
+}
+
+bool FraudBacktester::parseRecord(const std::string& line, BacktestRecord& record) {
+    // Locate the first seven separators; the label follows the last comma and
+    // anything in between is the location, which may itself contain commas.
+    std::size_t separators[7];
+    std::size_t pos = 0;
+    for (std::size_t i = 0; i < 7; ++i) {
+        pos = line.find(',', pos);
+        if (pos == std::string::npos) return false;
+        separators[i] = pos++;
+    }
+    std::size_t last = line.rfind(',');
+    if (last <= separators[6]) return false;
+
+    auto field = [&](std::size_t index) {
+        std::size_t begin = (index == 0) ? 0 : separators[index - 1] + 1;
+        return std::string_view(line).substr(begin, separators[index] - begin);
+    };
+
+    long long tx_id = 0, account_id = 0, to_account_id = -1, timestamp = 0;
+    double amount = 0.0;
+    if (!parseNumber(field(0), tx_id) || !parseNumber(field(1), account_id) ||
+        !parseNumber(field(3), amount) || !parseNumber(field(6), timestamp)) {
+        return false;
+    }
+    std::string_view to_field = trimView(field(2));
+    if (!to_field.empty() && !parseNumber(to_field, to_account_id)) {
+        return false;
+    }
+
+    std::string_view label = trimView(std::string_view(line).substr(last + 1));
+    if (label == "fraud" || label == "1") {
+        record.label = ReviewLabel::FRAUD;
+    } else if (label == "legitimate" || label == "legit" || label == "0") {
+        record.label = ReviewLabel::LEGITIMATE;
+    } else if (label.empty()) {
+        record.label = ReviewLabel::UNLABELED;
+    } else {
+        return false;
+    }
+
+    record.transaction_id = static_cast<int>(tx_id);
+    record.account_id = static_cast<int>(account_id);
+    record.to_account_id = static_cast<int>(to_account_id);
+    record.amount = amount;
+    record.type = Transaction::stringToType(std::string(trimView(field(4))));
+    record.category = Transaction::stringToCategory(std::string(trimView(field(5))));
+    record.epoch_seconds = timestamp;
+    record.location.assign(trimView(std::string_view(line).substr(separators[6] + 1, last - separators[6] - 1)));
+    return true;
+}
+
+void FraudBacktester::printReport(const BacktestReport& report, std::ostream& out) {
+    out << "\n=== FRAUD RULE BACKTEST ===\n";
+    out << "Rows: " << report.rows_processed
+        << " (labeled: " << report.labeled_rows
+        << ", fraud: " << report.fraud_labels
+        << ", malformed: " << report.malformed_rows << ")\n";
+    out << "Elapsed: " << std::fixed << std::setprecision(2) << report.elapsed_seconds << "s ("
+        << std::setprecision(0) << report.rowsPerSecond() << " rows/s)\n\n";
+
+    out << std::left << std::setw(16) << "Rule Set"
+        << std::right << std::setw(12) << "Flagged"
+        << std::setw(10) << "Rate %"
+        << std::setw(10) << "TP"
+        << std::setw(10) << "FP"
+        << std::setw(10) << "FN"
+        << std::setw(11) << "Precision"
+        << std::setw(9) << "Recall" << "\n";
+    for (const auto& result : report.rule_sets) {
+        double rate = report.rows_processed ? 100.0 * result.flagged / report.rows_processed : 0.0;
+        out << std::left << std::setw(16) << result.name
+            << std::right << std::setw(12) << result.flagged
+            << std::setw(10) << std::setprecision(2) << rate
+            << std::setw(10) << result.true_positives
+            << std::setw(10) << result.false_positives
+            << std::setw(10) << result.false_negatives
+            << std::setw(11) << std::setprecision(3) << result.precision()
+            << std::setw(9) << result.recall() << "\n";
+    }
+
+    out << "\nTriggers by check:\n";
+    for (const auto& result : report.rule_sets) {
+        out << "  " << result.name << ":";
+        for (std::size_t c = 0; c < kFraudCheckCount; ++c) {
+            out << " " << FraudDetectionService::fraudCheckToString(static_cast<FraudCheck>(c))
+                << "=" << result.check_triggers[c];
+        }
+        out << "\n";
+    }
+
+    if (report.rule_sets.size() > 1) {
+        out << "\nOverlap (rows flagged by both):\n" << std::setw(16) << "";
+        for (const auto& result : report.rule_sets) {
+            out << std::setw(14) << result.name.substr(0, 13);
+        }
+        out << "\n";
+        for (std::size_t i = 0; i < report.rule_sets.size(); ++i) {
+            out << std::left << std::setw(16) << report.rule_sets[i].name << std::right;
+            for (std::size_t j = 0; j < report.rule_sets.size(); ++j) {
+                out << std::setw(14) << report.overlap[i][j];
+            }
+            out << "\n";
+        }
+    }
+    out << "===========================\n";
+}
@@ -0,0 +1,94 @@
+#ifndef FRAUD_BACKTESTER_H
+#define FRAUD_BACKTESTER_H
+
+#include <string>
+#include <vector>
+#include <array>
+#include <memory>
+#include <istream>
+#include <ostream>
+#include <cstdint>
+#include "FraudDetectionService.h"
+
+enum class ReviewLabel {
+    UNLABELED,
+    LEGITIMATE,
+    FRAUD
+};
+
+// One row of a historical ledger export:
+// transaction_id,account_id,to_account_id,amount,type,category,timestamp,location,label
+// timestamp is in epoch seconds; label is "fraud", "legitimate" or empty and
+// carries the outcome of markTransactionAsFraud / markTransactionAsLegitimate.
+struct BacktestRecord {
+    int transaction_id;
+    int account_id;
+    int to_account_id;
+    double amount;
+    TransactionType type;
+    TransactionCategory category;
+    std::int64_t epoch_seconds;
+    std::string location;
+    ReviewLabel label;
+};
+
+struct FraudRuleSet {
+    std::string name;
+    std::vector<FraudRule> rules;
+};
+
+struct RuleSetResult {
+    std::string name;
+    std::uint64_t flagged = 0;
+    std::uint64_t true_positives = 0;
+    std::uint64_t false_positives = 0;
+    std::uint64_t false_negatives = 0;
+    std::uint64_t true_negatives = 0;
+    std::array<std::uint64_t, kFraudCheckCount> check_triggers{};
+
+    double precision() const;
+    double recall() const;
+};
+
+struct BacktestReport {
+    std::uint64_t rows_processed = 0;
+    std::uint64_t malformed_rows = 0;
+    std::uint64_t labeled_rows = 0;
+    std::uint64_t fraud_labels = 0;
+    double elapsed_seconds = 0.0;
+    std::vector<RuleSetResult> rule_sets;
+    std::vector<std::vector<std::uint64_t>> overlap; // [i][j] = rows flagged by both sets
+
+    double rowsPerSecond() const;
+};
+
+struct BacktestOptions {
+    unsigned worker_count = 0;      // 0 = one per hardware thread
+    std::size_t batch_size = 4096;  // Rows handed to a worker at a time
+    std::size_t queue_depth = 4;    // Batches buffered per worker
+    std::shared_ptr<const TimeZone> time_zone; // Null = UTC
+};
+
+// Replays a ledger through isolated FraudDetectionService instances, one per
+// candidate rule set, in a single streaming pass. Rows are sharded by account
+// so each worker owns complete account profiles, and the bounded per-worker
+// queues cap memory regardless of ledger length.
+class FraudBacktester {
+private:
+    std::vector<FraudRuleSet> rule_sets;
+    BacktestOptions options;
+
+public:
+    static constexpr std::size_t kMaxRuleSets = 32;
+
+    FraudBacktester(std::vector<FraudRuleSet> rule_sets, BacktestOptions options = BacktestOptions());
+
+    BacktestReport run(std::istream& input);
+
+    // "name:Rule Name=threshold,Other Rule=off" applied on top of the default rules
+    static FraudRuleSet parseRuleSet(const std::string& spec);
+    static bool parseRecord(const std::string& line, BacktestRecord& record);
+    static void printReport(const BacktestReport& report, std::ostream& out);
+};
+
+#endif // FRAUD_BACKTESTER_H
@@ -1,14 +1,147 @@
 #include "FraudDetectionService.h"
-#include "TransactionService.h"
+#include "../utils/Metrics.h"
 #include <iostream>
+#include <iomanip>
 #include <algorithm>
+#include <functional>
 #include <random>
+#include <cmath>
+#include <stdexcept>
 
-FraudDetectionService::FraudDetectionService() : running(false) {
+namespace {
+    // Profiles with fewer samples than this are too sparse to score reliably
+    constexpr std::uint64_t kMinProfileSamples = 5;
+    constexpr std::size_t kMaxRingAlerts = 1024;
+    constexpr std::int64_t kVelocityWindowSeconds = 3600;
+
+    std::int64_t toEpochSeconds(std::chrono::system_clock::time_point timestamp) {
+        return std::chrono::duration_cast<std::chrono::seconds>(timestamp.time_since_epoch()).count();
+    }
+
+    const char* checkLabel(FraudCheck check) {
+        switch (check) {
+            case FraudCheck::HIGH_VALUE: return "high_value";
+            case FraudCheck::UNUSUAL_LOCATION: return "unusual_location";
+            case FraudCheck::RAPID_TRANSACTIONS: return "rapid_transactions";
+            case FraudCheck::UNUSUAL_TIME: return "unusual_time";
+            case FraudCheck::ANOMALY_SCORE: return "anomaly_score";
+            default: return "unknown";
+        }
+    }
+
+    struct EvaluationMetrics {
+        LatencySummary* duration;
+        Counter* flagged;
+        std::array<Counter*, kFraudCheckCount> triggers;
+    };
+
+    const EvaluationMetrics& evaluationMetrics() {
+        static const EvaluationMetrics metrics = [] {
+            MetricsRegistry& registry = MetricsRegistry::instance();
+            EvaluationMetrics result;
+            result.duration = &registry.latency("fintrack_fraud_evaluation_seconds",
+                                                "Time to run every enabled fraud rule against one transaction.");
+            result.flagged = &registry.counter("fintrack_fraud_flagged_total",
+                                               "Transactions that triggered at least one fraud rule.");
+            for (std::size_t i = 0; i < kFraudCheckCount; ++i) {
+                result.triggers[i] = &registry.counter("fintrack_fraud_rule_triggers_total",
+                                                       "Fraud rule hits by check.",
+                                                       {{"check", checkLabel(static_cast<FraudCheck>(i))}});
+            }
+            return result;
+        }();
+        return metrics;
+    }
+}
+
+// AccountProfile implementation
+double AccountProfile::amountStdDev() const {
+    if (transaction_count < 2) return 0.0;
+    return std::sqrt(amount_m2 / static_cast<double>(transaction_count - 1));
+}
+
+std::uint32_t AccountProfile::locationCount(std::size_t location_hash) const {
+    for (std::size_t i = 0; i < location_slots_used; ++i) {
+        if (locations[i].location_hash == location_hash) {
+            return locations[i].count;
+        }
+    }
+    return 0;
+}
+
+int AccountProfile::transactionsWithin(std::int64_t epoch_seconds, std::int64_t window_seconds) const {
+    std::size_t filled = static_cast<std::size_t>(
+        std::min<std::uint64_t>(transaction_count, kRecentWindowSize));
+    int count = 0;
+    for (std::size_t i = 0; i < filled; ++i) {
+        std::int64_t ts = recent_timestamps[i];
+        if (ts <= epoch_seconds && ts > epoch_seconds - window_seconds) {
+            count++;
+        }
+    }
+    return count;
+}
+
+void AccountProfile::recordTransaction(double amount, const std::string& location, int hour, std::int64_t epoch_seconds) {
+    transaction_count++;
+    double delta = amount - average_transaction_amount;
+    average_transaction_amount += delta / static_cast<double>(transaction_count);
+    amount_m2 += delta * (amount - average_transaction_amount);
+    
+    if (amount > max_transaction_amount) {
+        max_transaction_amount = amount;
+    }
+    
+    if (!location.empty()) {
+        std::size_t location_hash = std::hash<std::string>{}(location);
+        std::size_t slot = location_slots_used;
+        for (std::size_t i = 0; i < location_slots_used; ++i) {
+            if (locations[i].location_hash == location_hash) {
+                slot = i;
+                break;
+            }
+        }
+        
+        if (slot == location_slots_used) {
+            if (location_slots_used < kMaxTrackedLocations) {
+                location_slots_used++;
+            } else {
+                // Table full: evict the least frequently seen location
+                slot = 0;
+                for (std::size_t i = 1; i < kMaxTrackedLocations; ++i) {
+                    if (locations[i].count < locations[slot].count) slot = i;
+                }
+            }
+            locations[slot] = LocationStat{location_hash, 0};
+        }
+        
+        locations[slot].count++;
+        max_location_count = std::max(max_location_count, locations[slot].count);
+    }
+    
+    if (hour >= 0 && hour < 24) {
+        hour_histogram[hour]++;
+    }
+    
+    recent_timestamps[recent_head] = epoch_seconds;
+    recent_head = (recent_head + 1) % kRecentWindowSize;
+    daily_transaction_count++;
+}
+
+FraudDetectionService::FraudDetectionService() 
+    : default_time_zone(TimeZone::local()), running(false) {
     // Initialize default fraud rules
-    addFraudRule(FraudRule("High Value Transaction", 5000.0));
-    addFraudRule(FraudRule("Rapid Transactions", 10.0));
-    addFraudRule(FraudRule("Unusual Location", 1.0));
+    fraud_rules = defaultFraudRules();
+    resolveCheckRules();
+    logDebug("fraud_rules_loaded", "Loaded default fraud rules", {{"count", fraud_rules.size()}});
+}
+
+FraudDetectionService::FraudDetectionService(const std::vector<FraudRule>& rules)
+    : fraud_rules(rules), default_time_zone(TimeZone::local()), running(false) {
+    for (const auto& rule : fraud_rules) {
+        validateRule(rule.rule_name, rule.threshold_value);
+    }
+    resolveCheckRules();
 }
 
 FraudDetectionService::~FraudDetectionService() {
@@ -19,29 +152,44 @@ void FraudDetectionService::startService() {
     if (!running) {
         running = true;
         background_thread = std::thread(&FraudDetectionService::backgroundFraudDetection, this);
-        std::cout << "🔍 Fraud Detection Service started" << std::endl;
+        logInfo("fraud_service_started", "Fraud Detection Service started");
     }
 }
 
 void FraudDetectionService::stopService() {
     if (running) {
-        running = false;
+        {
+            std::lock_guard<std::mutex> lock(background_mutex);
+            running = false;
+        }
+        background_cv.notify_all();
         if (background_thread.joinable()) {
             background_thread.join();
         }
-        std::cout << "🔍 Fraud Detection Service stopped" << std::endl;
+        logInfo("fraud_service_stopped", "Fraud Detection Service stopped");
+    }
+}
+
+void FraudDetectionService::validateRule(const std::string& rule_name, double threshold) {
+    // The check counts the account's last kRecentWindowSize transactions plus
+    // the current one, so a higher count could never trigger
+    if (rule_name == ruleNameForCheck(FraudCheck::RAPID_TRANSACTIONS) && threshold > kMaxRapidThreshold) {
+        throw std::invalid_argument("Rapid Transactions threshold cannot exceed " +
+                                    std::to_string(static_cast<int>(kMaxRapidThreshold)));
     }
 }
 
 void FraudDetectionService::addFraudRule(const FraudRule& rule) {
-    std::lock_guard<std::mutex> lock(service_mutex);
+    validateRule(rule.rule_name, rule.threshold_value);
+    std::lock_guard<ProfiledMutex> lock(service_mutex);
     fraud_rules.push_back(rule);
-    std::cout << "Added fraud rule: " << rule.rule_name 
-              << " (threshold: " << rule.threshold_value << ")" << std::endl;
+    resolveCheckRules();
+    logInfo("fraud_rule_added", "Added fraud rule",
+            {{"rule", rule.rule_name}, {"threshold", rule.threshold_value}});
 }
 
 void FraudDetectionService::removeFraudRule(const std::string& rule_name) {
-    std::lock_guard<std::mutex> lock(service_mutex);
+    std::lock_guard<ProfiledMutex> lock(service_mutex);
     auto it = std::find_if(fraud_rules.begin(), fraud_rules.end(),
         [&rule_name](const FraudRule& rule) {
             return rule.rule_name == rule_name;
@@ -49,12 +197,14 @@ void FraudDetectionService::removeFraudRule(const std::string& rule_name) {
     
     if (it != fraud_rules.end()) {
         fraud_rules.erase(it);
-        std::cout << "Removed fraud rule: " << rule_name << std::endl;
+        resolveCheckRules();
+        logInfo("fraud_rule_removed", "Removed fraud rule", {{"rule", rule_name}});
     }
 }
 
 void FraudDetectionService::updateFraudRule(const std::string& rule_name, double new_threshold) {
-    std::lock_guard<std::mutex> lock(service_mutex);
+    validateRule(rule_name, new_threshold);
+    std::lock_guard<ProfiledMutex> lock(service_mutex);
     auto it = std::find_if(fraud_rules.begin(), fraud_rules.end(),
         [&rule_name](FraudRule& rule) {
             return rule.rule_name == rule_name;
@@ -62,82 +212,153 @@ void FraudDetectionService::updateFraudRule(const std::string& rule_name, double
     
     if (it != fraud_rules.end()) {
         it->threshold_value = new_threshold;
-        std::cout << "Updated fraud rule: " << rule_name 
-                  << " (new threshold: " << new_threshold << ")" << std::endl;
+        logInfo("fraud_rule_updated", "Updated fraud rule",
+                {{"rule", rule_name}, {"threshold", new_threshold}});
     }
 }
 
 std::vector<FraudRule> FraudDetectionService::getFraudRules() const {
-    std::lock_guard<std::mutex> lock(service_mutex);
+    std::lock_guard<ProfiledMutex> lock(service_mutex);
     return fraud_rules;
 }
 
-bool FraudDetectionService::analyzeTransaction(std::shared_ptr<Transaction> transaction) {
-    if (!transaction) return false;
-    
-    bool is_suspicious = false;
-    std::vector<std::string> triggered_rules;
-    
-    // Check all fraud detection rules
-    if (checkHighValueTransaction(transaction)) {
-        triggered_rules.push_back("High Value");
-        is_suspicious = true;
+std::vector<FraudRule> FraudDetectionService::defaultFraudRules() {
+    return {
+        FraudRule("High Value Transaction", 5000.0),
+        FraudRule("Rapid Transactions", 10.0),
+        FraudRule("Unusual Location", 1.0),
+        FraudRule("Unusual Time", 1.0),
+        FraudRule("Anomaly Score", 0.75)
+    };
+}
+
+std::string FraudDetectionService::fraudCheckToString(FraudCheck check) {
+    switch (check) {
+        case FraudCheck::HIGH_VALUE: return "High Value";
+        case FraudCheck::UNUSUAL_LOCATION: return "Unusual Location";
+        case FraudCheck::RAPID_TRANSACTIONS: return "Rapid Transactions";
+        case FraudCheck::UNUSUAL_TIME: return "Unusual Time";
+        case FraudCheck::ANOMALY_SCORE: return "Anomaly Score";
+        default: return "Unknown";
     }
-    
-    if (checkUnusualLocation(transaction)) {
-        triggered_rules.push_back("Unusual Location");
-        is_suspicious = true;
+}
+
+std::string FraudDetectionService::ruleNameForCheck(FraudCheck check) {
+    switch (check) {
+        case FraudCheck::HIGH_VALUE: return "High Value Transaction";
+        case FraudCheck::UNUSUAL_LOCATION: return "Unusual Location";
+        case FraudCheck::RAPID_TRANSACTIONS: return "Rapid Transactions";
+        case FraudCheck::UNUSUAL_TIME: return "Unusual Time";
+        case FraudCheck::ANOMALY_SCORE: return "Anomaly Score";
+        default: return "Unknown";
     }
-    
-    if (checkRapidTransactions(transaction)) {
-        triggered_rules.push_back("Rapid Transactions");
-        is_suspicious = true;
+}
+
+void FraudDetectionService::setAnomalyWeights(const AnomalyWeights& weights) {
+    if (weights.amount < 0.0 || weights.location < 0.0 ||
+        weights.time_of_day < 0.0 || weights.velocity < 0.0) {
+        throw std::invalid_argument("Anomaly weights cannot be negative");
     }
-    
-    if (checkUnusualTime(transaction)) {
-        triggered_rules.push_back("Unusual Time");
-        is_suspicious = true;
+    if (weights.amount + weights.location + weights.time_of_day + weights.velocity <= 0.0) {
+        throw std::invalid_argument("At least one anomaly weight must be positive");
     }
     
+    std::lock_guard<ProfiledMutex> lock(service_mutex);
+    anomaly_weights = weights;
+}
+
+AnomalyWeights FraudDetectionService::getAnomalyWeights() const {
+    std::lock_guard<ProfiledMutex> lock(service_mutex);
+    return anomaly_weights;
+}
+
+bool FraudDetectionService::analyzeTransaction(std::shared_ptr<Transaction> transaction) {
+    if (!transaction) return false;
+    
+    recordTransfer(*transaction);
+    
+    std::lock_guard<ProfiledMutex> lock(service_mutex);
+    FraudEvaluation evaluation = evaluateLocked(*transaction);
+    markScored(transaction->getTransactionId());
+    
     // Mark transaction as suspicious if any rules triggered
-    if (is_suspicious) {
+    if (evaluation.isSuspicious()) {
         transaction->setSuspiciousFlag(true);
-        
-        std::lock_guard<std::mutex> lock(service_mutex);
         flagged_transactions.push_back(transaction);
+        pending_review[transaction->getTransactionId()] = evaluation.triggered_checks;
         
         // Send alert
-        sendFraudAlert(transaction);
-        
-        std::cout << "🚨 FRAUD ALERT: Transaction " << transaction->getTransactionId()
-                  << " flagged for: ";
-        for (size_t i = 0; i < triggered_rules.size(); ++i) {
-            std::cout << triggered_rules[i];
-            if (i < triggered_rules.size() - 1) std::cout << ", ";
+        sendFraudAlert(transaction, evaluation.triggered_checks);
+    }
+    
+    return evaluation.isSuspicious();
+}
+
+void FraudDetectionService::recordTransfer(const Transaction& transaction) {
+    if (transaction.getType() != TransactionType::TRANSFER_OUT || transaction.getToAccountId() < 0) return;
+    
+    transfer_graph.recordTransfer(transaction.getAccountId(), transaction.getToAccountId(),
+                                  transaction.getAmount(), toEpochSeconds(transaction.getTimestamp()));
+}
+
+std::vector<FraudRingAlert> FraudDetectionService::detectFraudRings() {
+    std::vector<FraudRingAlert> alerts = transfer_graph.detect();
+    if (alerts.empty()) return alerts;
+    
+    {
+        std::lock_guard<ProfiledMutex> lock(service_mutex);
+        for (const auto& alert : alerts) {
+            ring_alerts.push_back(alert);
         }
-        std::cout << std::endl;
+        while (ring_alerts.size() > kMaxRingAlerts) {
+            ring_alerts.pop_front();
+        }
+    }
+    
+    for (const auto& alert : alerts) {
+        sendFraudRingAlert(alert);
     }
+    return alerts;
+}
+
+std::vector<FraudRingAlert> FraudDetectionService::getFraudRingAlerts() const {
+    std::lock_guard<ProfiledMutex> lock(service_mutex);
+    return std::vector<FraudRingAlert>(ring_alerts.begin(), ring_alerts.end());
+}
+
+const TransferGraph& FraudDetectionService::getTransferGraph() const {
+    return transfer_graph;
+}
+
+FraudEvaluation FraudDetectionService::evaluateTransaction(const Transaction& transaction) {
+    std::lock_guard<ProfiledMutex> lock(service_mutex);
+    return evaluateLocked(transaction);
+}
+
+double FraudDetectionService::scoreTransaction(std::shared_ptr<Transaction> transaction) {
+    if (!transaction) return 0.0;
     
-    // Update account profile
-    updateAccountProfile(transaction);
+    std::lock_guard<ProfiledMutex> lock(service_mutex);
+    const AccountProfile* profile = getAccountProfile(transaction->getAccountId());
+    if (!profile) return 0.0;
     
-    return is_suspicious;
+    return calculateTransactionAnomaly(*transaction, *profile);
 }
 
 void FraudDetectionService::analyzeTransactionBatch(const std::vector<std::shared_ptr<Transaction>>& transactions) {
     for (const auto& transaction : transactions) {
         analyzeTransaction(transaction);
     }
-    std::cout << "Analyzed batch of " << transactions.size() << " transactions" << std::endl;
+    logInfo("fraud_batch_analyzed", "Analyzed transaction batch", {{"transactions", transactions.size()}});
 }
 
 std::vector<std::shared_ptr<Transaction>> FraudDetectionService::getFlaggedTransactions() const {
-    std::lock_guard<std::mutex> lock(service_mutex);
+    std::lock_guard<ProfiledMutex> lock(service_mutex);
     return flagged_transactions;
 }
 
 std::vector<std::shared_ptr<Transaction>> FraudDetectionService::getFlaggedTransactionsByAccount(int account_id) const {
-    std::lock_guard<std::mutex> lock(service_mutex);
+    std::lock_guard<ProfiledMutex> lock(service_mutex);
     std::vector<std::shared_ptr<Transaction>> account_flagged;
     
     for (const auto& transaction : flagged_transactions) {
@@ -150,7 +371,7 @@ std::vector<std::shared_ptr<Transaction>> FraudDetectionService::getFlaggedTrans
 }
 
 void FraudDetectionService::generateFraudReport() const {
-    std::lock_guard<std::mutex> lock(service_mutex);
+    std::lock_guard<ProfiledMutex> lock(service_mutex);
     
     std::cout << "\n=== FRAUD DETECTION REPORT ===" << std::endl;
     std::cout << "Total Flagged Transactions: " << flagged_transactions.size() << std::endl;
@@ -177,209 +398,346 @@ void FraudDetectionService::generateFraudReport() const {
 }
 
 double FraudDetectionService::getFraudRate() const {
-    // This would need integration with TransactionService to get total transaction count
-    // For now, return a simplified calculation
-    std::lock_guard<std::mutex> lock(service_mutex);
-    if (flagged_transactions.empty()) return 0.0;
+    std::uint64_t scored = transactions_scored.load(std::memory_order_relaxed);
+    if (scored == 0) return 0.0;
     
-    // Assume 100 total transactions for demo purposes
-    return (static_cast<double>(flagged_transactions.size()) / 100.0) * 100.0;
+    return (static_cast<double>(transactions_flagged.load(std::memory_order_relaxed)) / scored) * 100.0;
+}
+
+FraudStatistics FraudDetectionService::getFraudStatistics() const {
+    FraudStatistics stats;
+    stats.transactions_scored = transactions_scored.load(std::memory_order_relaxed);
+    stats.transactions_flagged = transactions_flagged.load(std::memory_order_relaxed);
+    stats.confirmed_fraud = confirmed_fraud.load(std::memory_order_relaxed);
+    stats.confirmed_legitimate = confirmed_legitimate.load(std::memory_order_relaxed);
+    stats.missed_fraud = missed_fraud.load(std::memory_order_relaxed);
+    stats.fraud_rate = stats.transactions_scored 
+        ? (static_cast<double>(stats.transactions_flagged) / stats.transactions_scored) * 100.0 
+        : 0.0;
+    
+    stats.rules.reserve(kFraudCheckCount);
+    for (std::size_t i = 0; i < kFraudCheckCount; ++i) {
+        const RuleCounters& counters = rule_counters[i];
+        FraudRuleStats rule;
+        rule.check = static_cast<FraudCheck>(i);
+        rule.rule_name = ruleNameForCheck(rule.check);
+        rule.evaluated = counters.evaluated.load(std::memory_order_relaxed);
+        rule.triggered = counters.triggered.load(std::memory_order_relaxed);
+        rule.true_positives = counters.true_positives.load(std::memory_order_relaxed);
+        rule.false_positives = counters.false_positives.load(std::memory_order_relaxed);
+        stats.rules.push_back(rule);
+    }
+    
+    return stats;
 }
 
 void FraudDetectionService::displayFraudStatistics() const {
-    std::lock_guard<std::mutex> lock(service_mutex);
+    FraudStatistics stats = getFraudStatistics();
     
     std::cout << "\n=== FRAUD STATISTICS ===" << std::endl;
-    std::cout << "Total Suspicious Transactions: " << flagged_transactions.size() << std::endl;
-    std::cout << "Fraud Rate: " << std::fixed << std::setprecision(2) << getFraudRate() << "%" << std::endl;
-    std::cout << "Active Rules: " << fraud_rules.size() << std::endl;
-    
-    // Count by rule type (simplified)
-    int high_value_count = 0, location_count = 0, rapid_count = 0;
-    for (const auto& tx : flagged_transactions) {
-        if (tx->getAmount() > 2000) high_value_count++;
-        if (tx->getLocation() != "New York") location_count++;
-        // Add more sophisticated counting logic here
+    std::cout << "Transactions Scored: " << stats.transactions_scored << std::endl;
+    std::cout << "Total Suspicious Transactions: " << stats.transactions_flagged << std::endl;
+    std::cout << "Fraud Rate: " << std::fixed << std::setprecision(2) << stats.fraud_rate << "%" << std::endl;
+    std::cout << "Confirmed Fraud: " << stats.confirmed_fraud
+              << " (missed by rules: " << stats.missed_fraud << ")" << std::endl;
+    std::cout << "Confirmed Legitimate: " << stats.confirmed_legitimate << std::endl;
+    
+    for (const auto& rule : stats.rules) {
+        std::cout << rule.rule_name << " Alerts: " << rule.triggered 
+                  << " of " << rule.evaluated
+                  << " (TP: " << rule.true_positives 
+                  << ", FP: " << rule.false_positives << ")" << std::endl;
     }
-    
-    std::cout << "High Value Alerts: " << high_value_count << std::endl;
-    std::cout << "Location Alerts: " << location_count << std::endl;
-    std::cout << "Rapid Transaction Alerts: " << rapid_count << std::endl;
     std::cout << "========================" << std::endl;
 }
 
 void FraudDetectionService::buildAccountProfile(int account_id, const std::vector<std::shared_ptr<Transaction>>& history) {
     AccountProfile profile(account_id);
     
-    if (history.empty()) {
-        account_profiles[account_id] = profile;
-        return;
+    std::lock_guard<ProfiledMutex> lock(service_mutex);
+    if (const AccountProfile* existing = getAccountProfile(account_id)) {
+        profile.time_zone = existing->time_zone;
     }
     
-    // Calculate average transaction amount
-    double total_amount = 0.0;
-    double max_amount = 0.0;
-    
+    const TimeZone& zone = timeZoneFor(&profile);
     for (const auto& tx : history) {
-        total_amount += tx->getAmount();
-        if (tx->getAmount() > max_amount) {
-            max_amount = tx->getAmount();
-        }
-        
-        // Track common locations
-        std::string location = tx->getLocation();
-        if (!location.empty()) {
-            auto it = std::find(profile.common_locations.begin(), profile.common_locations.end(), location);
-            if (it == profile.common_locations.end()) {
-                profile.common_locations.push_back(location);
-            }
-        }
+        profile.recordTransaction(tx->getAmount(), tx->getLocation(),
+                                  zone.hourOfDay(tx->getTimestamp()), toEpochSeconds(tx->getTimestamp()));
     }
     
-    profile.average_transaction_amount = total_amount / history.size();
-    profile.max_transaction_amount = max_amount;
-    profile.daily_transaction_count = static_cast<int>(history.size());
+    account_profiles.insert_or_assign(account_id, profile);
     
-    account_profiles[account_id] = profile;
+    if (history.empty()) {
+        return;
+    }
     
-    std::cout << "Built profile for account " << account_id 
-              << " (avg: $" << profile.average_transaction_amount 
-              << ", max: $" << profile.max_transaction_amount << ")" << std::endl;
+    logDebug("fraud_profile_built", "Built account profile",
+             {{"account_id", account_id}, {"average_amount", profile.average_transaction_amount},
+              {"max_amount", profile.max_transaction_amount}});
 }
 
-void FraudDetectionService::updateAllProfiles(TransactionService* transaction_service) {
-    // This would integrate with TransactionService to update all profiles
-    std::cout << "Profile update requested (integration with TransactionService needed)" << std::endl;
+void FraudDetectionService::setAccountTimeZone(int account_id, std::shared_ptr<const TimeZone> time_zone) {
+    std::lock_guard<ProfiledMutex> lock(service_mutex);
+    auto it = account_profiles.find(account_id);
+    if (it == account_profiles.end()) {
+        it = account_profiles.emplace(account_id, AccountProfile(account_id)).first;
+    }
+    it->second.time_zone = std::move(time_zone);
+}
+
+void FraudDetectionService::setDefaultTimeZone(std::shared_ptr<const TimeZone> time_zone) {
+    if (!time_zone) {
+        throw std::invalid_argument("Default time zone cannot be null");
+    }
+    std::lock_guard<ProfiledMutex> lock(service_mutex);
+    default_time_zone = std::move(time_zone);
 }
 
 void FraudDetectionService::markTransactionAsLegitimate(int transaction_id) {
-    std::lock_guard<std::mutex> lock(service_mutex);
+    std::lock_guard<ProfiledMutex> lock(service_mutex);
+    // Each transaction counts once, and only if it was scored here
+    if (reviewed_transactions.count(transaction_id) ||
+        (!pending_review.count(transaction_id) && !wasScored(transaction_id))) {
+        logDebug("fraud_review_ignored", "Transaction already reviewed or never scored",
+                 {{"transaction_id", transaction_id}});
+        return;
+    }
+    reviewed_transactions.insert(transaction_id);
+    
+    auto review = pending_review.find(transaction_id);
+    if (review != pending_review.end()) {
+        recordReviewOutcome(review->second, false);
+        pending_review.erase(review);
+    } else {
+        // A transaction the rules let through, confirmed legitimate
+        confirmed_legitimate.fetch_add(1, std::memory_order_relaxed);
+    }
     
     auto it = std::find_if(flagged_transactions.begin(), flagged_transactions.end(),
         [transaction_id](const std::shared_ptr<Transaction>& tx) {
             return tx->getTransactionId() == transaction_id;
         });
-    
     if (it != flagged_transactions.end()) {
         (*it)->setSuspiciousFlag(false);
         flagged_transactions.erase(it);
-        std::cout << "Transaction " << transaction_id << " marked as legitimate" << std::endl;
     }
+    logInfo("fraud_review_legitimate", "Transaction marked as legitimate", {{"transaction_id", transaction_id}});
 }
 
 void FraudDetectionService::markTransactionAsFraud(int transaction_id) {
-    std::cout << "Transaction " << transaction_id << " confirmed as fraud - taking appropriate action" << std::endl;
+    {
+        std::lock_guard<ProfiledMutex> lock(service_mutex);
+        // Each transaction counts once, and only if it was scored here
+        if (reviewed_transactions.count(transaction_id) ||
+            (!pending_review.count(transaction_id) && !wasScored(transaction_id))) {
+            logDebug("fraud_review_ignored", "Transaction already reviewed or never scored",
+                     {{"transaction_id", transaction_id}});
+            return;
+        }
+        reviewed_transactions.insert(transaction_id);
+        
+        auto review = pending_review.find(transaction_id);
+        if (review != pending_review.end()) {
+            recordReviewOutcome(review->second, true);
+            pending_review.erase(review);
+        } else {
+            // Fraud the rules never flagged counts against recall, not any single rule
+            missed_fraud.fetch_add(1, std::memory_order_relaxed);
+            confirmed_fraud.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    
+    logWarn("fraud_review_confirmed", "Transaction confirmed as fraud", {{"transaction_id", transaction_id}});
     // In a real system, this would trigger account freezing, notifications, etc.
 }
 
-void FraudDetectionService::sendFraudAlert(std::shared_ptr<Transaction> transaction) const {
+void FraudDetectionService::markScored(int transaction_id) {
+    if (transaction_id < 0) return;
+    scored_transactions[transaction_id / kScoredChunkIds].set(transaction_id % kScoredChunkIds);
+}
+
+bool FraudDetectionService::wasScored(int transaction_id) const {
+    if (transaction_id < 0) return false;
+    auto chunk = scored_transactions.find(transaction_id / kScoredChunkIds);
+    return chunk != scored_transactions.end() && chunk->second.test(transaction_id % kScoredChunkIds);
+}
+
+void FraudDetectionService::recordReviewOutcome(std::uint32_t triggered_checks, bool is_fraud) {
+    (is_fraud ? confirmed_fraud : confirmed_legitimate).fetch_add(1, std::memory_order_relaxed);
+    
+    for (std::size_t i = 0; i < kFraudCheckCount; ++i) {
+        if (!(triggered_checks & (1u << i))) continue;
+        RuleCounters& counters = rule_counters[i];
+        (is_fraud ? counters.true_positives : counters.false_positives).fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void FraudDetectionService::sendFraudAlert(std::shared_ptr<Transaction> transaction,
+                                           std::uint32_t triggered_checks) const {
     // In a real system, this would send emails, SMS, push notifications, etc.
-    std::cout << "🚨 FRAUD ALERT sent for Transaction " << transaction->getTransactionId()
-              << " - Amount: $" << transaction->getAmount() 
-              << " - Location: " << transaction->getLocation() << std::endl;
+    Logger& logger = Logger::instance();
+    std::uint64_t suppressed = 0;
+    if (!logger.isEnabled(LogLevel::WARN) || !alert_limiter.tryAcquire(suppressed)) return;
+    
+    std::string checks;
+    for (std::size_t i = 0; i < kFraudCheckCount; ++i) {
+        if (!(triggered_checks & (1u << i))) continue;
+        if (!checks.empty()) checks += ", ";
+        checks += fraudCheckToString(static_cast<FraudCheck>(i));
+    }
+    logger.log(LogLevel::WARN, "fraud_alert", "Transaction flagged",
+               {{"transaction_id", transaction->getTransactionId()}, {"account_id", transaction->getAccountId()},
+                {"amount", transaction->getAmount()}, {"location", transaction->getLocation()},
+                {"checks", checks}, {"suppressed", suppressed}});
+}
+
+void FraudDetectionService::sendFraudRingAlert(const FraudRingAlert& alert) const {
+    if (!Logger::instance().isEnabled(LogLevel::WARN)) return;
+    
+    std::string accounts;
+    for (std::size_t i = 0; i < alert.account_ids.size(); ++i) {
+        if (i > 0) accounts += (alert.pattern == FraudRingPattern::FAN_IN || 
+                                alert.pattern == FraudRingPattern::FAN_OUT ? ", " : " -> ");
+        accounts += std::to_string(alert.account_ids[i]);
+    }
+    logWarn("fraud_ring_alert", "Fraud ring detected",
+            {{"pattern", TransferGraph::patternToString(alert.pattern)}, {"amount", alert.total_amount},
+             {"accounts", accounts}});
 }
 
 // Private methods
-bool FraudDetectionService::checkHighValueTransaction(std::shared_ptr<Transaction> transaction) {
+// Rule checks and profile updates expect service_mutex to be held by the caller.
+const FraudRule* FraudDetectionService::findEnabledRule(const std::string& rule_name) const {
     auto it = std::find_if(fraud_rules.begin(), fraud_rules.end(),
-        [](const FraudRule& rule) {
-            return rule.rule_name == "High Value Transaction" && rule.enabled;
+        [&rule_name](const FraudRule& rule) {
+            return rule.rule_name == rule_name && rule.enabled;
         });
     
-    if (it != fraud_rules.end()) {
-        return transaction->getAmount() > it->threshold_value;
+    return (it != fraud_rules.end()) ? &(*it) : nullptr;
+}
+
+const FraudRule* FraudDetectionService::ruleForCheck(FraudCheck check) const {
+    int index = check_rules[static_cast<std::size_t>(check)];
+    return index >= 0 ? &fraud_rules[static_cast<std::size_t>(index)] : nullptr;
+}
+
+void FraudDetectionService::resolveCheckRules() {
+    for (std::size_t i = 0; i < kFraudCheckCount; ++i) {
+        const FraudRule* rule = findEnabledRule(ruleNameForCheck(static_cast<FraudCheck>(i)));
+        check_rules[i] = rule ? static_cast<int>(rule - fraud_rules.data()) : -1;
+    }
+}
+
+FraudEvaluation FraudDetectionService::evaluateLocked(const Transaction& transaction) {
+    const EvaluationMetrics& metrics = evaluationMetrics();
+    ScopedLatency timer(*metrics.duration);
+    FraudEvaluation evaluation;
+    
+    // Look the profile up once; every profile-based check shares it
+    AccountProfile* profile = getAccountProfile(transaction.getAccountId());
+    
+    for (std::size_t i = 0; i < kFraudCheckCount; ++i) {
+        FraudCheck check = static_cast<FraudCheck>(i);
+        const FraudRule* rule = ruleForCheck(check);
+        if (!rule) continue;
+        
+        bool triggered = false;
+        switch (check) {
+            case FraudCheck::HIGH_VALUE:
+                triggered = checkHighValueTransaction(transaction, *rule);
+                break;
+            case FraudCheck::UNUSUAL_LOCATION:
+                triggered = checkUnusualLocation(transaction);
+                break;
+            case FraudCheck::RAPID_TRANSACTIONS:
+                triggered = checkRapidTransactions(transaction, profile, *rule);
+                break;
+            case FraudCheck::UNUSUAL_TIME:
+                triggered = checkUnusualTime(transaction, profile);
+                break;
+            case FraudCheck::ANOMALY_SCORE:
+                triggered = checkAnomalyScore(transaction, profile, *rule, evaluation.anomaly_score);
+                break;
+            default:
+                break;
+        }
+        
+        evaluation.evaluated_checks |= 1u << i;
+        rule_counters[i].evaluated.fetch_add(1, std::memory_order_relaxed);
+        if (triggered) {
+            evaluation.triggered_checks |= 1u << i;
+            rule_counters[i].triggered.fetch_add(1, std::memory_order_relaxed);
+            metrics.triggers[i]->increment();
+        }
+    }
+    
+    transactions_scored.fetch_add(1, std::memory_order_relaxed);
+    if (evaluation.isSuspicious()) {
+        transactions_flagged.fetch_add(1, std::memory_order_relaxed);
+        metrics.flagged->increment();
     }
     
-    return false;
+    updateAccountProfile(transaction, profile);
+    return evaluation;
+}
+
+bool FraudDetectionService::checkHighValueTransaction(const Transaction& transaction, const FraudRule& rule) {
+    return transaction.getAmount() > rule.threshold_value;
 }
 
-bool FraudDetectionService::checkUnusualLocation(std::shared_ptr<Transaction> transaction) {
+bool FraudDetectionService::checkUnusualLocation(const Transaction& transaction) {
     // Simple location check - in reality, this would be more sophisticated
-    std::string location = transaction->getLocation();
-    
+
     // Consider non-common locations as unusual
-    std::vector<std::string> common_locations = {"New York", "Chicago", "Los Angeles", "Boston"};
+    static const std::string common_locations[] = {"New York", "Chicago", "Los Angeles", "Boston"};
     
-    return std::find(common_locations.begin(), common_locations.end(), location) == common_locations.end();
+    return std::find(std::begin(common_locations), std::end(common_locations), 
+                     transaction.getLocation()) == std::end(common_locations);
 }
 
-bool FraudDetectionService::checkRapidTransactions(std::shared_ptr<Transaction> transaction) {
-    // Simple implementation - check if there have been many recent transactions
-    // In a real system, this would check transaction velocity per account
-    
-    std::lock_guard<std::mutex> lock(service_mutex);
-    int recent_count = 0;
-    auto current_time = transaction->getTimestamp();
+bool FraudDetectionService::checkRapidTransactions(const Transaction& transaction, const AccountProfile* profile,
+                                                   const FraudRule& rule) {
+    // Counts the account's own transactions in the last hour using the profile's
+    // recent-timestamp window, so at most kRecentWindowSize prior transactions are seen.
+    if (!profile) return false;
     
-    for (const auto& flagged_tx : flagged_transactions) {
-        if (flagged_tx->getAccountId() == transaction->getAccountId()) {
-            auto time_diff = std::chrono::duration_cast<std::chrono::minutes>(
-                current_time - flagged_tx->getTimestamp()
-            ).count();
-            
-            if (time_diff < 60) { // Within last hour
-                recent_count++;
-            }
-        }
-    }
+    int recent_count = profile->transactionsWithin(toEpochSeconds(transaction.getTimestamp()),
+                                                   kVelocityWindowSeconds);
     
-    return recent_count >= 3; // 3 or more transactions in an hour
+    return recent_count + 1 >= rule.threshold_value;
 }
 
-bool FraudDetectionService::checkUnusualTime(std::shared_ptr<Transaction> transaction) {
-    auto time_t = std::chrono::system_clock::to_time_t(transaction->getTimestamp());
-    auto tm = *std::localtime(&time_t);
-    int hour = tm.tm_hour;
+bool FraudDetectionService::checkUnusualTime(const Transaction& transaction, const AccountProfile* profile) {
+    // Evaluated in the account's own time zone when one has been set
+    const TimeZone& zone = timeZoneFor(profile);
+    int hour = zone.hourOfDay(transaction.getTimestamp());
     
     // Consider transactions between 11 PM and 5 AM as unusual
     return (hour >= 23 || hour <= 5);
 }
 
-bool FraudDetectionService::checkVelocityPattern(std::shared_ptr<Transaction> transaction) {
-    // Placeholder for velocity pattern detection
-    return false;
+bool FraudDetectionService::checkAnomalyScore(const Transaction& transaction, const AccountProfile* profile, 
+                                              const FraudRule& rule, double& anomaly_score) {
+    if (!profile) return false;
+    
+    anomaly_score = calculateTransactionAnomaly(transaction, *profile);
+    return anomaly_score >= rule.threshold_value;
 }
 
-void FraudDetectionService::updateAccountProfile(std::shared_ptr<Transaction> transaction) {
-    int account_id = transaction->getAccountId();
+void FraudDetectionService::updateAccountProfile(const Transaction& transaction, AccountProfile* profile) {
+    int account_id = transaction.getAccountId();
     
-    auto it = account_profiles.find(account_id);
-    if (it == account_profiles.end()) {
-        // Create new profile
-        AccountProfile profile(account_id);
-        profile.average_transaction_amount = transaction->getAmount();
-        profile.max_transaction_amount = transaction->getAmount();
-        profile.daily_transaction_count = 1;
-        
-        if (!transaction->getLocation().empty()) {
-            profile.common_locations.push_back(transaction->getLocation());
-        }
-        
-        account_profiles[account_id] = profile;
-    } else {
-        // Update existing profile
-        AccountProfile& profile = it->second;
-        
-        // Update running averages (simplified)
-        profile.average_transaction_amount = 
-            (profile.average_transaction_amount + transaction->getAmount()) / 2.0;
-        
-        if (transaction->getAmount() > profile.max_transaction_amount) {
-            profile.max_transaction_amount = transaction->getAmount();
-        }
-        
-        profile.daily_transaction_count++;
-        
-        // Add location if not already present
-        std::string location = transaction->getLocation();
-        if (!location.empty()) {
-            auto loc_it = std::find(profile.common_locations.begin(), 
-                                  profile.common_locations.end(), location);
-            if (loc_it == profile.common_locations.end()) {
-                profile.common_locations.push_back(location);
-            }
+    if (!profile) {
+        auto it = account_profiles.find(account_id);
+        if (it == account_profiles.end()) {
+            it = account_profiles.emplace(account_id, AccountProfile(account_id)).first;
         }
+        profile = &it->second;
     }
+    
+    profile->recordTransaction(transaction.getAmount(), transaction.getLocation(),
+                               timeZoneFor(profile).hourOfDay(transaction.getTimestamp()),
+                               toEpochSeconds(transaction.getTimestamp()));
 }
 
 AccountProfile* FraudDetectionService::getAccountProfile(int account_id) {
@@ -387,27 +745,77 @@ AccountProfile* FraudDetectionService::getAccountProfile(int account_id) {
     return (it != account_profiles.end()) ? &(it->second) : nullptr;
 }
 
+const TimeZone& FraudDetectionService::timeZoneFor(const AccountProfile* profile) const {
+    return (profile && profile->time_zone) ? *profile->time_zone : *default_time_zone;
+}
+
+double FraudDetectionService::calculateTransactionAnomaly(const Transaction& transaction, const AccountProfile& profile) const {
+    if (profile.transaction_count < kMinProfileSamples) {
+        return 0.0;
+    }
+    
+    // Amount: one-sided z-score against the running mean, mapped onto [0, 1).
+    // The deviation is floored so that very regular accounts don't score every
+    // cent of variation as extreme.
+    double stddev = std::max({profile.amountStdDev(), 0.05 * profile.average_transaction_amount, 1.0});
+    double z_score = (transaction.getAmount() - profile.average_transaction_amount) / stddev;
+    double amount_score = (z_score > 0.0) ? 1.0 - std::exp(-z_score / 3.0) : 0.0;
+    
+    double location_score = calculateLocationRisk(transaction.getLocation(), profile);
+    
+    // Hour of day: Laplace-smoothed likelihood relative to a uniform spread.
+    int hour = timeZoneFor(&profile).hourOfDay(transaction.getTimestamp());
+    double hour_likelihood = (profile.hour_histogram[hour] + 1.0) / 
+                             (static_cast<double>(profile.transaction_count) + 24.0);
+    double time_score = std::min(1.0, std::max(0.0, 1.0 - 24.0 * hour_likelihood));
+    
+    // Velocity: recent activity relative to the "Rapid Transactions" limit.
+    const FraudRule* rapid_rule = ruleForCheck(FraudCheck::RAPID_TRANSACTIONS);
+    double velocity_limit = (rapid_rule && rapid_rule->threshold_value > 0.0) ? rapid_rule->threshold_value : 10.0;
+    int recent_count = profile.transactionsWithin(toEpochSeconds(transaction.getTimestamp()), kVelocityWindowSeconds);
+    double velocity_score = std::min(1.0, (recent_count + 1) / velocity_limit);
+    
+    const AnomalyWeights& w = anomaly_weights;
+    double weight_sum = w.amount + w.location + w.time_of_day + w.velocity;
+    if (weight_sum <= 0.0) return 0.0;
+    
+    return (w.amount * amount_score + w.location * location_score +
+            w.time_of_day * time_score + w.velocity * velocity_score) / weight_sum;
+}
+
+double FraudDetectionService::calculateLocationRisk(const std::string& location, const AccountProfile& profile) const {
+    // Unknown locations carry no information either way
+    if (location.empty() || profile.max_location_count == 0) {
+        return 0.5;
+    }
+    
+    std::uint32_t count = profile.locationCount(std::hash<std::string>{}(location));
+    return 1.0 - static_cast<double>(count) / profile.max_location_count;
+}
+
 void FraudDetectionService::backgroundFraudDetection() {
-    std::cout << "Background fraud detection thread started" << std::endl;
+    logDebug("fraud_background_started", "Background fraud detection thread started");
     
     while (running) {
-        std::this_thread::sleep_for(std::chrono::seconds(5));
-        
-        // Perform background analysis
-        std::lock_guard<std::mutex> lock(service_mutex);
+        {
+            std::unique_lock<std::mutex> lock(background_mutex);
+            background_cv.wait_for(lock, std::chrono::seconds(5), [this] { return !running; });
+        }
+        if (!running) break;
         
-        // In a real system, this would:
-        // 1. Check for pattern anomalies
-        // 2. Update risk scores
-        // 3. Generate periodic reports
-        // 4. Clean up old data
+        // Only accounts touched since the last pass are examined
+        detectFraudRings();
         
-        if (!flagged_transactions.empty()) {
-            // Simulate some background processing
-            std::cout << "Background scan: " << flagged_transactions.size() 
-                      << " suspicious transactions under review" << std::endl;
+        std::size_t under_review;
+        {
+            std::lock_guard<ProfiledMutex> lock(service_mutex);
+            under_review = flagged_transactions.size();
+        }
+        if (under_review > 0) {
+            logInfo("fraud_background_scan", "Suspicious transactions under review",
+                    {{"under_review", under_review}});
         }
     }
     
-    std::cout << "Background fraud detection thread stopped" << std::endl;
+    logDebug("fraud_background_stopped", "Background fraud detection thread stopped");
 }
@@ -4,13 +4,24 @@
 #include <vector>
 #include <memory>
 #include <map>
+#include <unordered_map>
+#include <unordered_set>
+#include <bitset>
+#include <array>
+#include <cstdint>
 #include <thread>
 #include <chrono>
 #include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
 #include "../models/Transaction.h"
+#include "../utils/TimeZone.h"
+#include "../utils/Logger.h"
+#include "../utils/LockProfiler.h"
+#include "TransferGraph.h"
 
 class Account;
-class TransactionService;
 
 struct FraudRule {
     std::string rule_name;
@@ -21,37 +32,173 @@ struct FraudRule {
         : rule_name(name), threshold_value(threshold), enabled(is_enabled) {}
 };
 
+// Built-in checks, in evaluation order. Used as bit positions in FraudEvaluation.
+enum class FraudCheck {
+    HIGH_VALUE,
+    UNUSUAL_LOCATION,
+    RAPID_TRANSACTIONS,
+    UNUSUAL_TIME,
+    ANOMALY_SCORE,
+    COUNT
+};
+
+constexpr std::size_t kFraudCheckCount = static_cast<std::size_t>(FraudCheck::COUNT);
+
+// Outcome of running every enabled rule against one transaction
+struct FraudEvaluation {
+    std::uint32_t triggered_checks;
+    double anomaly_score;
+    
+    std::uint32_t evaluated_checks;
+    
+    FraudEvaluation() : triggered_checks(0), anomaly_score(0.0), evaluated_checks(0) {}
+    
+    bool isSuspicious() const { return triggered_checks != 0; }
+    bool triggered(FraudCheck check) const {
+        return (triggered_checks & (1u << static_cast<unsigned>(check))) != 0;
+    }
+};
+
+// Snapshot of the live counters for one built-in check
+struct FraudRuleStats {
+    FraudCheck check;
+    std::string rule_name;
+    std::uint64_t evaluated;
+    std::uint64_t triggered;
+    std::uint64_t true_positives;  // Triggered on a transaction later confirmed as fraud
+    std::uint64_t false_positives; // Triggered on a transaction later marked legitimate
+    
+    double triggerRate() const { return evaluated ? static_cast<double>(triggered) / evaluated : 0.0; }
+    double precision() const {
+        std::uint64_t reviewed = true_positives + false_positives;
+        return reviewed ? static_cast<double>(true_positives) / reviewed : 0.0;
+    }
+};
+
+struct FraudStatistics {
+    std::uint64_t transactions_scored;
+    std::uint64_t transactions_flagged;
+    std::uint64_t confirmed_fraud;
+    std::uint64_t confirmed_legitimate;
+    std::uint64_t missed_fraud; // Confirmed fraud that no rule flagged
+    double fraud_rate;          // Percentage of scored transactions flagged
+    std::vector<FraudRuleStats> rules;
+};
+
+// Relative weights used to blend the individual anomaly components into a
+// single score in [0, 1]. Weights are normalised by their sum when scoring.
+struct AnomalyWeights {
+    double amount;
+    double location;
+    double time_of_day;
+    double velocity;
+    
+    AnomalyWeights(double amount_weight = 0.4, double location_weight = 0.25,
+                   double time_weight = 0.15, double velocity_weight = 0.2)
+        : amount(amount_weight), location(location_weight), 
+          time_of_day(time_weight), velocity(velocity_weight) {}
+};
+
+// Running per-account statistics. Every field is fixed-size so that scoring
+// and updating a profile never allocates.
 struct AccountProfile {
+    static constexpr std::size_t kMaxTrackedLocations = 16;
+    static constexpr std::size_t kRecentWindowSize = 16;
+    
+    struct LocationStat {
+        std::size_t location_hash;
+        std::uint32_t count;
+    };
+    
     int account_id;
     double average_transaction_amount;
     double max_transaction_amount;
-    std::vector<std::string> common_locations;
-    std::chrono::hours typical_transaction_hours[24];
+    double amount_m2;  // Sum of squared deviations (Welford)
+    std::uint64_t transaction_count;
+    
+    std::array<LocationStat, kMaxTrackedLocations> locations;
+    std::size_t location_slots_used;
+    std::uint32_t max_location_count;
+    
+    std::array<std::uint32_t, 24> hour_histogram;
+    
+    std::array<std::int64_t, kRecentWindowSize> recent_timestamps;  // Epoch seconds, ring buffer
+    std::size_t recent_head;
     int daily_transaction_count;
+    std::shared_ptr<const TimeZone> time_zone;  // Null means the service default
     
     AccountProfile(int id) : account_id(id), average_transaction_amount(0.0), 
-                           max_transaction_amount(0.0), daily_transaction_count(0) {}
+                           max_transaction_amount(0.0), amount_m2(0.0), transaction_count(0),
+                           locations{}, location_slots_used(0), max_location_count(0),
+                           hour_histogram{}, recent_timestamps{}, recent_head(0),
+                           daily_transaction_count(0) {}
+    
+    double amountStdDev() const;
+    std::uint32_t locationCount(std::size_t location_hash) const;
+    int transactionsWithin(std::int64_t epoch_seconds, std::int64_t window_seconds) const;
+    void recordTransaction(double amount, const std::string& location, int hour, std::int64_t epoch_seconds);
 };
 
 class FraudDetectionService {
 private:
     std::vector<FraudRule> fraud_rules;
-    std::map<int, AccountProfile> account_profiles; // account_id -> profile
+    std::array<int, kFraudCheckCount> check_rules; // Index into fraud_rules of each check's enabled rule, -1 if none
+    std::unordered_map<int, AccountProfile> account_profiles; // account_id -> profile
     std::vector<std::shared_ptr<Transaction>> flagged_transactions;
-    std::mutex service_mutex;
+    std::unordered_map<int, std::uint32_t> pending_review; // transaction_id -> triggered checks
+    std::unordered_set<int> reviewed_transactions; // Ids already confirmed either way; later reviews are ignored
+    // Ids analyzeTransaction has scored, one bit each in chunks of kScoredChunkIds
+    static constexpr int kScoredChunkIds = 4096;
+    std::unordered_map<int, std::bitset<kScoredChunkIds>> scored_transactions;
+    AnomalyWeights anomaly_weights;
+    std::shared_ptr<const TimeZone> default_time_zone;
+    mutable ProfiledMutex service_mutex{"FraudDetectionService::service_mutex"};
     std::thread background_thread;
-    bool running;
+    std::atomic<bool> running;
+    std::mutex background_mutex;
+    std::condition_variable background_cv; // Wakes the background thread early on stop
+    
+    // Transfer relationships, locked independently of service_mutex
+    TransferGraph transfer_graph;
+    std::deque<FraudRingAlert> ring_alerts; // Most recent kMaxRingAlerts, guarded by service_mutex
+    
+    // Live counters, readable without taking service_mutex
+    struct RuleCounters {
+        std::atomic<std::uint64_t> evaluated{0};
+        std::atomic<std::uint64_t> triggered{0};
+        std::atomic<std::uint64_t> true_positives{0};
+        std::atomic<std::uint64_t> false_positives{0};
+    };
+    std::array<RuleCounters, kFraudCheckCount> rule_counters;
+    std::atomic<std::uint64_t> transactions_scored{0};
+    std::atomic<std::uint64_t> transactions_flagged{0};
+    std::atomic<std::uint64_t> confirmed_fraud{0};
+    std::atomic<std::uint64_t> confirmed_legitimate{0};
+    std::atomic<std::uint64_t> missed_fraud{0};
+    
+    // Caps fraud_alert lines so a flood of flags cannot swamp the log
+    mutable LogRateLimiter alert_limiter{50.0, 200.0};
+    
+    void recordReviewOutcome(std::uint32_t triggered_checks, bool is_fraud);
+    void markScored(int transaction_id);
+    bool wasScored(int transaction_id) const;
     
     // Fraud detection algorithms
-    bool checkHighValueTransaction(std::shared_ptr<Transaction> transaction);
-    bool checkUnusualLocation(std::shared_ptr<Transaction> transaction);
-    bool checkRapidTransactions(std::shared_ptr<Transaction> transaction);
-    bool checkUnusualTime(std::shared_ptr<Transaction> transaction);
-    bool checkVelocityPattern(std::shared_ptr<Transaction> transaction);
+    bool checkHighValueTransaction(const Transaction& transaction, const FraudRule& rule);
+    bool checkUnusualLocation(const Transaction& transaction);
+    bool checkRapidTransactions(const Transaction& transaction, const AccountProfile* profile, const FraudRule& rule);
+    bool checkUnusualTime(const Transaction& transaction, const AccountProfile* profile);
+    bool checkAnomalyScore(const Transaction& transaction, const AccountProfile* profile, 
+                           const FraudRule& rule, double& anomaly_score);
+    const FraudRule* findEnabledRule(const std::string& rule_name) const;
+    const FraudRule* ruleForCheck(FraudCheck check) const;
+    void resolveCheckRules(); // After any change to fraud_rules
+    FraudEvaluation evaluateLocked(const Transaction& transaction);
     
     // Profile management
-    void updateAccountProfile(std::shared_ptr<Transaction> transaction);
+    void updateAccountProfile(const Transaction& transaction, AccountProfile* profile = nullptr);
     AccountProfile* getAccountProfile(int account_id);
+    const TimeZone& timeZoneFor(const AccountProfile* profile) const;
     
     // Background processing
     void backgroundFraudDetection();
@@ -59,22 +206,41 @@ private:
 public:
     // Constructor and Destructor
     FraudDetectionService();
+    explicit FraudDetectionService(const std::vector<FraudRule>& rules);
     ~FraudDetectionService();
     
     // Service control
     void startService();
     void stopService();
     
-    // Rule management
+    // Rule management. Thresholds the checks cannot reach (a "Rapid
+    // Transactions" count above kMaxRapidThreshold) throw std::invalid_argument.
+    static constexpr double kMaxRapidThreshold = AccountProfile::kRecentWindowSize + 1;
+    static void validateRule(const std::string& rule_name, double threshold);
     void addFraudRule(const FraudRule& rule);
     void removeFraudRule(const std::string& rule_name);
     void updateFraudRule(const std::string& rule_name, double new_threshold);
     std::vector<FraudRule> getFraudRules() const;
+    static std::vector<FraudRule> defaultFraudRules();
+    static std::string fraudCheckToString(FraudCheck check);
+    static std::string ruleNameForCheck(FraudCheck check);
+    
+    // Anomaly scoring configuration
+    void setAnomalyWeights(const AnomalyWeights& weights);
+    AnomalyWeights getAnomalyWeights() const;
     
     // Fraud detection
     bool analyzeTransaction(std::shared_ptr<Transaction> transaction);
+    double scoreTransaction(std::shared_ptr<Transaction> transaction);
+    FraudEvaluation evaluateTransaction(const Transaction& transaction); // Updates profiles, never flags or alerts
     void analyzeTransactionBatch(const std::vector<std::shared_ptr<Transaction>>& transactions);
     
+    // Fraud ring detection over the transfer graph
+    void recordTransfer(const Transaction& transaction);
+    std::vector<FraudRingAlert> detectFraudRings(); // Also run by the background thread
+    std::vector<FraudRingAlert> getFraudRingAlerts() const;
+    const TransferGraph& getTransferGraph() const;
+    
     // Query operations
     std::vector<std::shared_ptr<Transaction>> getFlaggedTransactions() const;
     std::vector<std::shared_ptr<Transaction>> getFlaggedTransactionsByAccount(int account_id) const;
@@ -82,24 +248,27 @@ public:
     // Analytics and reporting
     void generateFraudReport() const;
     double getFraudRate() const; // Percentage of transactions flagged
+    FraudStatistics getFraudStatistics() const;
     void displayFraudStatistics() const;
     
     // Account profiling
     void buildAccountProfile(int account_id, const std::vector<std::shared_ptr<Transaction>>& history);
-    void updateAllProfiles(TransactionService* transaction_service);
+    void setAccountTimeZone(int account_id, std::shared_ptr<const TimeZone> time_zone);
+    void setDefaultTimeZone(std::shared_ptr<const TimeZone> time_zone);
     
     // Manual review
     void markTransactionAsLegitimate(int transaction_id);
     void markTransactionAsFraud(int transaction_id);
     
     // Alert system
-    void sendFraudAlert(std::shared_ptr<Transaction> transaction) const;
+    void sendFraudAlert(std::shared_ptr<Transaction> transaction, std::uint32_t triggered_checks) const;
+    void sendFraudRingAlert(const FraudRingAlert& alert) const;
     
 private:
     // Helper functions
-    double calculateTransactionAnomaly(std::shared_ptr<Transaction> transaction, const AccountProfile& profile);
+    double calculateTransactionAnomaly(const Transaction& transaction, const AccountProfile& profile) const;
     bool isWithinBusinessHours(std::chrono::system_clock::time_point timestamp);
-    double calculateLocationRisk(const std::string& location, const AccountProfile& profile);
+    double calculateLocationRisk(const std::string& location, const AccountProfile& profile) const;
 };
 
 #endif // FRAUD_DETECTION_SERVICE_H
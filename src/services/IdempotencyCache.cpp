@@ -0,0 +1,205 @@
+#include "IdempotencyCache.h"
+#include "../utils/Metrics.h"
+#include <functional>
+
+namespace {
+    struct CacheMetrics {
+        Counter* hits;
+        Counter* misses;
+        Counter* bypassed;
+        Counter* conflicts;
+        Counter* evictions;
+    };
+
+    const CacheMetrics& cacheMetrics() {
+        static const CacheMetrics metrics = [] {
+            MetricsRegistry& registry = MetricsRegistry::instance();
+            const char* help = "Idempotency key lookups by result.";
+            return CacheMetrics{
+                &registry.counter("fintrack_idempotency_lookups_total", help, {{"result", "hit"}}),
+                &registry.counter("fintrack_idempotency_lookups_total", help, {{"result", "miss"}}),
+                &registry.counter("fintrack_idempotency_lookups_total", help, {{"result", "bypass"}}),
+                &registry.counter("fintrack_idempotency_lookups_total", help, {{"result", "conflict"}}),
+                &registry.counter("fintrack_idempotency_evictions_total",
+                                  "Unexpired idempotency keys evicted to make room.")};
+        }();
+        return metrics;
+    }
+
+    std::int64_t steadyNowNs() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    std::size_t bucketsPerShard(std::size_t capacity) {
+        std::size_t needed = (capacity + IdempotencyCache::kShardCount * IdempotencyCache::kWays - 1) /
+                             (IdempotencyCache::kShardCount * IdempotencyCache::kWays);
+        std::size_t buckets = 1;
+        while (buckets < needed) buckets <<= 1;
+        return buckets;
+    }
+}
+
+IdempotencyCache::IdempotencyCache(std::size_t capacity, std::chrono::seconds ttl)
+    : bucket_count(bucketsPerShard(capacity)),
+      ttl_ns(std::chrono::duration_cast<std::chrono::nanoseconds>(ttl).count()),
+      hits(0), misses(0), evictions(0), bypassed(0), conflicts(0) {
+    static_assert(sizeof(Bucket) == kWays * kSlotBytes, "Bucket layout sets the cache's memory per key");
+}
+
+void IdempotencyCache::resize(std::size_t capacity, std::chrono::seconds ttl) {
+    clear();
+    bucket_count = bucketsPerShard(capacity);
+    ttl_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(ttl).count();
+}
+
+void IdempotencyCache::clear() {
+    for (auto& shard : shards) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.buckets.reset();
+    }
+}
+
+// Getters
+IdempotencyStats IdempotencyCache::getStats() const {
+    IdempotencyStats stats;
+    stats.hits = hits.load(std::memory_order_relaxed);
+    stats.misses = misses.load(std::memory_order_relaxed);
+    stats.evictions = evictions.load(std::memory_order_relaxed);
+    stats.bypassed = bypassed.load(std::memory_order_relaxed);
+    stats.conflicts = conflicts.load(std::memory_order_relaxed);
+    stats.capacity = getCapacity();
+    for (const auto& shard : shards) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        if (shard.buckets) {
+            stats.memory_bytes += bucket_count * sizeof(Bucket);
+        }
+    }
+    return stats;
+}
+
+std::size_t IdempotencyCache::getCapacity() const {
+    return kShardCount * bucket_count * kWays;
+}
+
+std::chrono::seconds IdempotencyCache::getTtl() const {
+    return std::chrono::duration_cast<std::chrono::seconds>(std::chrono::nanoseconds(ttl_ns));
+}
+
+// Private methods
+IdempotencyCache::KeyHash IdempotencyCache::hashKey(const std::string& key, std::uint64_t request) {
+    std::uint64_t tag = 14695981039346656037ULL; // FNV-1a
+    for (unsigned char c : key) {
+        tag = (tag ^ c) * 1099511628211ULL;
+    }
+    std::uint64_t check = static_cast<std::uint64_t>(std::hash<std::string>()(key)) ^
+                          (request * 0x9E3779B97F4A7C15ULL);
+    return KeyHash{tag ? tag : 1, check};
+}
+
+IdempotencyCache::Shard& IdempotencyCache::shardFor(const KeyHash& hash) {
+    return shards[hash.tag % kShardCount];
+}
+
+IdempotencyCache::Bucket& IdempotencyCache::bucketFor(Shard& shard, const KeyHash& hash) const {
+    return shard.buckets[(hash.tag / kShardCount) & (bucket_count - 1)];
+}
+
+// The key is identified by its tag alone; check then says whether the
+// request matches
+int IdempotencyCache::findWay(const Bucket& bucket, std::uint64_t tag) {
+    for (std::size_t way = 0; way < kWays; ++way) {
+        if (bucket.tags[way] == tag) {
+            return static_cast<int>(way);
+        }
+    }
+    return -1;
+}
+
+IdempotencyCache::Claim IdempotencyCache::claim(const KeyHash& hash, TransactionResult& stored) {
+    Shard& shard = shardFor(hash);
+    std::unique_lock<std::mutex> lock(shard.mutex);
+    if (!shard.buckets) {
+        shard.buckets.reset(new Bucket[bucket_count]()); // Zeroed: every way empty
+    }
+    Bucket& bucket = bucketFor(shard, hash);
+
+    int way = findWay(bucket, hash.tag);
+    while (way >= 0 && bucket.entries[way].pending) {
+        shard.completed.wait(lock); // The original is still running
+        way = findWay(bucket, hash.tag);
+    }
+
+    std::int64_t now = steadyNowNs();
+    if (way >= 0) {
+        const Entry& entry = bucket.entries[way];
+        if (entry.expires_ns > now && entry.check != hash.check) {
+            conflicts.fetch_add(1, std::memory_order_relaxed);
+            cacheMetrics().conflicts->increment();
+            return Claim::CONFLICT;
+        }
+        if (entry.expires_ns > now) {
+            stored = TransactionResult{static_cast<TransactionOutcome>(entry.outcome), entry.reason,
+                                       entry.transaction_id, true};
+            hits.fetch_add(1, std::memory_order_relaxed);
+            cacheMetrics().hits->increment();
+            return Claim::REPLAY;
+        }
+    } else {
+        // Empty way, else the oldest finished entry (expired ones are oldest)
+        for (std::size_t i = 0; i < kWays && way < 0; ++i) {
+            if (bucket.tags[i] == 0) way = static_cast<int>(i);
+        }
+        if (way < 0) {
+            for (std::size_t i = 0; i < kWays; ++i) {
+                const Entry& entry = bucket.entries[i];
+                if (!entry.pending && (way < 0 || entry.expires_ns < bucket.entries[way].expires_ns)) {
+                    way = static_cast<int>(i);
+                }
+            }
+            if (way < 0) {
+                bypassed.fetch_add(1, std::memory_order_relaxed);
+                cacheMetrics().bypassed->increment();
+                return Claim::BYPASS;
+            }
+            if (bucket.entries[way].expires_ns > now) {
+                evictions.fetch_add(1, std::memory_order_relaxed);
+                cacheMetrics().evictions->increment();
+            }
+        }
+    }
+
+    bucket.tags[way] = hash.tag;
+    bucket.entries[way] = Entry{hash.check, now + ttl_ns, "", -1, 0, true};
+    misses.fetch_add(1, std::memory_order_relaxed);
+    cacheMetrics().misses->increment();
+    return Claim::EXECUTE;
+}
+
+void IdempotencyCache::complete(const KeyHash& hash, const TransactionResult& result) {
+    Shard& shard = shardFor(hash);
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        int way = shard.buckets ? findWay(bucketFor(shard, hash), hash.tag) : -1;
+        Entry* entry = way >= 0 ? &bucketFor(shard, hash).entries[way] : nullptr;
+        if (entry && entry->pending && entry->check == hash.check) {
+            entry->reason = result.reason;
+            entry->transaction_id = result.transaction_id;
+            entry->outcome = static_cast<std::uint8_t>(result.outcome);
+            entry->pending = false;
+        }
+    }
+    shard.completed.notify_all();
+}
+
+void IdempotencyCache::abandon(const KeyHash& hash) {
+    Shard& shard = shardFor(hash);
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        int way = shard.buckets ? findWay(bucketFor(shard, hash), hash.tag) : -1;
+        if (way >= 0 && bucketFor(shard, hash).entries[way].pending) {
+            bucketFor(shard, hash).tags[way] = 0;
+        }
+    }
+    shard.completed.notify_all();
+}
@@ -0,0 +1,150 @@
+#ifndef IDEMPOTENCY_CACHE_H
+#define IDEMPOTENCY_CACHE_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include "../models/Transaction.h"
+
+struct IdempotencyStats {
+    std::uint64_t hits = 0;      // Retries answered with the stored result
+    std::uint64_t misses = 0;    // New keys (or expired ones) that ran the operation
+    std::uint64_t evictions = 0; // Unexpired keys dropped for space; non-zero means the cache is too small for its TTL
+    std::uint64_t bypassed = 0;  // Ran without deduplication because every slot in reach was still executing
+    std::uint64_t conflicts = 0; // Keys reused for a different request; nothing ran
+    std::size_t capacity = 0;
+    std::size_t memory_bytes = 0; // Slots allocated so far; at most capacity * kSlotBytes
+
+    double hitRate() const { return hits + misses ? static_cast<double>(hits) / (hits + misses) : 0.0; }
+};
+
+// Remembers the result of each operation run under a client idempotency
+// key, so a retry gets the original result back without running again.
+//
+// Keys are hashed to 128 bits and stored in fixed-size slots: kShardCount
+// independently locked shards, each an array of kWays-slot buckets. A
+// bucket keeps its kWays tags in its first cache line, so a lookup reads
+// that line plus the matching entry. Memory never grows past
+// capacity * kSlotBytes (allocated per shard on first use). Entries expire
+// ttl after the key was first seen; a full bucket evicts an expired entry
+// first, then the oldest.
+//
+// A retry that arrives while the original is still running waits for it
+// rather than running a second time. Each entry also holds a fingerprint of
+// the request (operation, accounts, amount); a key reused within the TTL
+// for a different request is refused with IDEMPOTENCY_CONFLICT.
+class IdempotencyCache {
+public:
+    static constexpr std::size_t kShardCount = 64;
+    static constexpr std::size_t kWays = 8;
+    static constexpr std::size_t kDefaultCapacity = std::size_t(1) << 20;
+    static constexpr std::chrono::seconds kDefaultTtl{24 * 60 * 60};
+    static constexpr std::size_t kSlotBytes = 40; // Memory per key
+
+    explicit IdempotencyCache(std::size_t capacity = kDefaultCapacity, std::chrono::seconds ttl = kDefaultTtl);
+
+    IdempotencyCache(const IdempotencyCache&) = delete;
+    IdempotencyCache& operator=(const IdempotencyCache&) = delete;
+
+    // Runs execute() once per key and returns its result, or the stored
+    // result (marked replayed) for a key seen within the TTL with the same
+    // request fingerprint. An empty key always runs.
+    template <typename Execute>
+    TransactionResult run(const std::string& key, std::uint64_t request, Execute&& execute);
+
+    // Both drop every entry; call while idle
+    void resize(std::size_t capacity, std::chrono::seconds ttl);
+    void clear();
+
+    // Getters
+    IdempotencyStats getStats() const;
+    std::size_t getCapacity() const;
+    std::chrono::seconds getTtl() const;
+
+private:
+    struct KeyHash {
+        std::uint64_t tag;   // Never 0, which marks an empty slot
+        std::uint64_t check; // Second key hash mixed with the request fingerprint
+    };
+
+    struct Entry {
+        std::uint64_t check;
+        std::int64_t expires_ns; // steady_clock
+        const char* reason;
+        std::int32_t transaction_id;
+        std::uint8_t outcome;
+        bool pending;
+    };
+
+    struct alignas(64) Bucket {
+        std::uint64_t tags[kWays]; // 0 marks an empty way
+        Entry entries[kWays];
+    };
+
+    enum class Claim {
+        EXECUTE, // Caller runs the operation, then complete() or abandon()
+        REPLAY,
+        CONFLICT,
+        BYPASS
+    };
+
+    struct Shard {
+        mutable std::mutex mutex;
+        std::condition_variable completed; // Signalled when a pending slot resolves
+        std::unique_ptr<Bucket[]> buckets; // bucket_count of them, allocated on first claim
+    };
+
+    std::array<Shard, kShardCount> shards;
+    std::size_t bucket_count; // Per shard, a power of two
+    std::int64_t ttl_ns;
+
+    std::atomic<std::uint64_t> hits;
+    std::atomic<std::uint64_t> misses;
+    std::atomic<std::uint64_t> evictions;
+    std::atomic<std::uint64_t> bypassed;
+    std::atomic<std::uint64_t> conflicts;
+
+    static KeyHash hashKey(const std::string& key, std::uint64_t request);
+    Shard& shardFor(const KeyHash& hash);
+    Bucket& bucketFor(Shard& shard, const KeyHash& hash) const;
+    static int findWay(const Bucket& bucket, std::uint64_t tag);
+
+    Claim claim(const KeyHash& hash, TransactionResult& stored);
+    void complete(const KeyHash& hash, const TransactionResult& result);
+    void abandon(const KeyHash& hash);
+};
+
+template <typename Execute>
+TransactionResult IdempotencyCache::run(const std::string& key, std::uint64_t request, Execute&& execute) {
+    if (key.empty()) {
+        return execute();
+    }
+
+    KeyHash hash = hashKey(key, request);
+    TransactionResult result = TransactionResult::success();
+    switch (claim(hash, result)) {
+        case Claim::REPLAY: return result;
+        case Claim::CONFLICT:
+            return TransactionResult::failure(TransactionOutcome::IDEMPOTENCY_CONFLICT,
+                                              "Idempotency key already used for a different request");
+        case Claim::BYPASS: return execute();
+        default: break;
+    }
+
+    try {
+        result = execute();
+    } catch (...) {
+        abandon(hash); // Let a retry run it
+        throw;
+    }
+    complete(hash, result);
+    return result;
+}
+
+#endif // IDEMPOTENCY_CACHE_H
@@ -0,0 +1,120 @@
+#include "LedgerReplayer.h"
+#include <algorithm>
+#include <cstring>
+#include <future>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+namespace {
+    constexpr std::uint64_t kFnvOffset = 1469598103934665603ULL;
+    constexpr std::uint64_t kFnvPrime = 1099511628211ULL;
+
+    void mix(std::uint64_t& hash, std::uint64_t value) {
+        for (int i = 0; i < 8; ++i) {
+            hash ^= (value >> (i * 8)) & 0xff;
+            hash *= kFnvPrime;
+        }
+    }
+
+    std::size_t shardFor(int account_id) {
+        return static_cast<unsigned>(account_id) % LedgerReplayer::kShardCount;
+    }
+}
+
+LedgerReplayResult LedgerReplayer::replay(const std::vector<LedgerEvent>& events, unsigned int worker_count) {
+    if (worker_count == 0) {
+        worker_count = std::max(1u, std::thread::hardware_concurrency());
+    }
+    worker_count = static_cast<unsigned int>(std::min<std::size_t>(worker_count, kShardCount));
+
+    // Phase 1: each worker splits a slice of the log by shard; concatenating
+    // the slices in order keeps every shard in sequence order
+    std::vector<std::vector<std::vector<const LedgerEvent*>>> partitions(
+        worker_count, std::vector<std::vector<const LedgerEvent*>>(kShardCount));
+    std::size_t slice = (events.size() + worker_count - 1) / worker_count;
+    std::vector<std::future<void>> futures;
+
+    for (unsigned int t = 0; t < worker_count; ++t) {
+        futures.push_back(std::async(std::launch::async, [&, t]() {
+            std::size_t begin = std::min(events.size(), t * slice);
+            std::size_t end = std::min(events.size(), begin + slice);
+            for (std::size_t i = begin; i < end; ++i) {
+                partitions[t][shardFor(events[i].account_id)].push_back(&events[i]);
+            }
+        }));
+    }
+    for (auto& future : futures) {
+        future.get();
+    }
+    futures.clear();
+
+    // Phase 2: each worker owns a disjoint set of shards and replays them
+    std::vector<std::vector<std::shared_ptr<Account>>> rebuilt(kShardCount);
+    for (unsigned int t = 0; t < worker_count; ++t) {
+        futures.push_back(std::async(std::launch::async, [&, t]() {
+            for (std::size_t s = t; s < kShardCount; s += worker_count) {
+                std::unordered_map<int, std::shared_ptr<Account>> accounts;
+                for (const auto& partition : partitions) {
+                    for (const LedgerEvent* event : partition[s]) {
+                        auto it = accounts.find(event->account_id);
+                        if (it == accounts.end()) {
+                            if (event->type != LedgerEventType::OPENED) {
+                                throw std::invalid_argument("Ledger event " + std::to_string(event->sequence) +
+                                                            " is for account " + std::to_string(event->account_id) +
+                                                            ", which was never opened");
+                            }
+                            accounts.emplace(event->account_id,
+                                             std::make_shared<Account>(event->account_id, event->related_id,
+                                                                       event->account_type, event->amount));
+                            continue;
+                        }
+                        it->second->applyLedgerEvent(*event);
+                    }
+                }
+                for (auto& entry : accounts) {
+                    rebuilt[s].push_back(std::move(entry.second));
+                }
+            }
+        }));
+    }
+    for (auto& future : futures) {
+        future.get();
+    }
+
+    LedgerReplayResult result;
+    result.events = events.size();
+    for (auto& shard : rebuilt) {
+        for (auto& account : shard) {
+            result.accounts.push_back(std::move(account));
+        }
+    }
+    std::sort(result.accounts.begin(), result.accounts.end(),
+              [](const std::shared_ptr<Account>& a, const std::shared_ptr<Account>& b) {
+                  return a->getAccountId() < b->getAccountId();
+              });
+    for (const auto& account : result.accounts) {
+        result.total_balance += account->getBalance();
+    }
+    result.digest = stateDigest(result.accounts);
+    return result;
+}
+
+std::uint64_t LedgerReplayer::stateDigest(std::vector<std::shared_ptr<Account>> accounts) {
+    std::sort(accounts.begin(), accounts.end(), [](const std::shared_ptr<Account>& a, const std::shared_ptr<Account>& b) {
+        return a->getAccountId() < b->getAccountId();
+    });
+
+    std::uint64_t hash = kFnvOffset;
+    for (const auto& account : accounts) {
+        double balance = account->getBalance();
+        std::uint64_t bits = 0;
+        std::memcpy(&bits, &balance, sizeof(bits));
+        mix(hash, static_cast<std::uint64_t>(account->getAccountId()));
+        mix(hash, static_cast<std::uint64_t>(account->getUserId()));
+        mix(hash, static_cast<std::uint64_t>(account->getType()));
+        mix(hash, bits);
+    }
+    return hash;
+}
@@ -0,0 +1,36 @@
+#ifndef LEDGER_REPLAYER_H
+#define LEDGER_REPLAYER_H
+
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+#include "../models/Account.h"
+#include "../models/Ledger.h"
+
+struct LedgerReplayResult {
+    std::vector<std::shared_ptr<Account>> accounts; // Ascending account ID
+    std::size_t events = 0;
+    double total_balance = 0.0;
+    std::uint64_t digest = 0; // LedgerReplayer::stateDigest(accounts)
+};
+
+// Rebuilds accounts from a ledger event log. Accounts are spread over
+// kShardCount shards by ID and each worker replays whole shards, applying
+// every account's events in sequence order, so the result is the same
+// bit for bit whatever the worker count.
+class LedgerReplayer {
+public:
+    static constexpr std::size_t kShardCount = 64;
+
+    // Events must be in sequence order (as Ledger::readLog and
+    // Ledger::getEvents return them). Throws std::invalid_argument for an
+    // event on an account that was never opened.
+    static LedgerReplayResult replay(const std::vector<LedgerEvent>& events, unsigned int worker_count = 0);
+
+    // Fingerprint of account IDs, owners, types and exact balances; equal
+    // for a live set of accounts and its replay
+    static std::uint64_t stateDigest(std::vector<std::shared_ptr<Account>> accounts);
+};
+
+#endif // LEDGER_REPLAYER_H
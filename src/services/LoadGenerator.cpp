@@ -0,0 +1,411 @@
+#include "LoadGenerator.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <limits>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include "UserDirectory.h"
+#include "TransactionService.h"
+#include "FraudDetectionService.h"
+#include "models/User.h"
+#include "utils/LockProfiler.h"
+#include "LedgerReplayer.h"
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    // The std distributions are implementation-defined, so draws are done by
+    // hand on top of mt19937_64 (whose output sequence is fixed by the
+    // standard) to keep schedules identical across standard libraries
+    class ScheduleRandom {
+    private:
+        std::mt19937_64 engine;
+
+    public:
+        explicit ScheduleRandom(std::uint64_t seed) : engine(seed) {}
+
+        double uniform() { // [0, 1)
+            return static_cast<double>(engine() >> 11) * (1.0 / 9007199254740992.0);
+        }
+
+        std::uint64_t below(std::uint64_t bound) {
+            return engine() % bound;
+        }
+
+        double exponential() { // Mean 1
+            return -std::log1p(-uniform());
+        }
+    };
+
+    std::uint64_t mixFingerprint(std::uint64_t hash, std::uint64_t value) {
+        hash ^= value;
+        return hash * 1099511628211ULL;
+    }
+
+    // Home cities are the ones the fraud rules treat as usual; the last entry
+    // is not, so remote operations exercise the location check
+    const std::string kLocations[] = {"New York", "Chicago", "Los Angeles", "Boston", "Lagos"};
+    constexpr std::size_t kHomeLocationCount = 4;
+
+    struct WorkerResult {
+        std::array<LatencyHistogram, kLoadOperationCount> response_times;
+        LatencyHistogram service_times;
+        std::uint64_t completed = 0;
+        std::uint64_t declined = 0;
+        std::uint64_t flagged = 0;
+        Clock::time_point finished;
+    };
+}
+
+double LoadReport::achievedRate() const {
+    return elapsed_seconds > 0 ? (completed + declined) / elapsed_seconds : 0.0;
+}
+
+LoadGenerator::LoadGenerator(LoadProfile profile) : profile(std::move(profile)), fingerprint(0) {
+    const LoadProfile& p = this->profile;
+    if (p.users == 0 || p.accounts_per_user == 0) {
+        throw std::invalid_argument("Load profile needs at least one user and account");
+    }
+    if (p.users * p.accounts_per_user > std::numeric_limits<std::uint32_t>::max()) {
+        throw std::invalid_argument("Too many accounts in load profile");
+    }
+    double mix_total = 0.0;
+    for (double weight : p.mix) {
+        if (!(weight >= 0.0)) {
+            throw std::invalid_argument("Operation mix weights cannot be negative");
+        }
+        mix_total += weight;
+    }
+    if (mix_total <= 0.0) {
+        throw std::invalid_argument("Operation mix needs a positive weight");
+    }
+    if (p.mix[static_cast<std::size_t>(LoadOperation::TRANSFER)] > 0.0 && p.users * p.accounts_per_user < 2) {
+        throw std::invalid_argument("Transfers need at least two accounts");
+    }
+    if (!(p.min_amount > 0.0) || !(p.max_amount >= p.min_amount)) {
+        throw std::invalid_argument("Amount range must be positive and ordered");
+    }
+    if (p.remote_share < 0.0 || p.remote_share > 1.0) {
+        throw std::invalid_argument("Remote share must be within [0, 1]");
+    }
+    if (!(p.rate > 0.0) || !(p.zipf_exponent >= 0.0)) {
+        throw std::invalid_argument("Rate must be positive and Zipf exponent non-negative");
+    }
+    if (p.operations == 0 && !(p.duration_seconds > 0.0)) {
+        throw std::invalid_argument("Load profile needs a duration or an operation count");
+    }
+    if (!(p.burst_factor > 0.0) || !(p.burst_period_seconds > 0.0) || p.burst_duty < 0.0 || p.burst_duty > 1.0) {
+        throw std::invalid_argument("Burst factor and period must be positive and duty within [0, 1]");
+    }
+
+    buildSchedule();
+}
+
+void LoadGenerator::buildSchedule() {
+    ScheduleRandom random(profile.seed);
+    const std::size_t account_count = profile.users * profile.accounts_per_user;
+
+    // Popularity rank -> account, so the hottest accounts are spread across
+    // users rather than all belonging to the first one
+    std::vector<std::uint32_t> ranked_accounts(account_count);
+    for (std::size_t i = 0; i < account_count; ++i) {
+        ranked_accounts[i] = static_cast<std::uint32_t>(i);
+    }
+    for (std::size_t i = account_count - 1; i > 0; --i) {
+        std::swap(ranked_accounts[i], ranked_accounts[random.below(i + 1)]);
+    }
+
+    std::vector<double> popularity(account_count); // Cumulative Zipf weights by rank
+    double cumulative = 0.0;
+    for (std::size_t rank = 0; rank < account_count; ++rank) {
+        cumulative += 1.0 / std::pow(static_cast<double>(rank + 1), profile.zipf_exponent);
+        popularity[rank] = cumulative;
+    }
+    auto pickAccount = [&]() {
+        auto it = std::upper_bound(popularity.begin(), popularity.end(), random.uniform() * cumulative);
+        std::size_t rank = std::min(static_cast<std::size_t>(it - popularity.begin()), account_count - 1);
+        return ranked_accounts[rank];
+    };
+
+    std::array<double, kLoadOperationCount> mix_cumulative;
+    double mix_total = 0.0;
+    for (std::size_t i = 0; i < kLoadOperationCount; ++i) {
+        mix_total += profile.mix[i];
+        mix_cumulative[i] = mix_total;
+    }
+    const double amount_span = std::log(profile.max_amount / profile.min_amount);
+
+    // Arrivals are Poisson with a rate that steps between the quiet and burst
+    // levels; quiet_rate is chosen so the long-run mean is profile.rate
+    const bool bursty = profile.burst_factor != 1.0 && profile.burst_duty > 0.0 && profile.burst_duty < 1.0;
+    const double quiet_rate = bursty
+        ? profile.rate / (profile.burst_duty * profile.burst_factor + (1.0 - profile.burst_duty))
+        : profile.rate;
+    std::uint64_t cycle = 0;
+    bool in_burst = bursty;
+    double phase_end = bursty ? profile.burst_duty * profile.burst_period_seconds
+                              : std::numeric_limits<double>::infinity();
+
+    schedule.clear();
+    if (profile.operations > 0) {
+        schedule.reserve(profile.operations);
+    }
+    fingerprint = 14695981039346656037ULL;
+    double now = 0.0;
+
+    while (true) {
+        // Spend one unit-rate exponential gap across as many phases as it covers
+        double gap = random.exponential();
+        while (true) {
+            double phase_rate = in_burst ? quiet_rate * profile.burst_factor : quiet_rate;
+            double available = phase_rate * (phase_end - now);
+            if (gap <= available) {
+                now += gap / phase_rate;
+                break;
+            }
+            gap -= available;
+            now = phase_end;
+            if (in_burst) {
+                in_burst = false;
+                phase_end = (cycle + 1) * profile.burst_period_seconds;
+            } else {
+                ++cycle;
+                in_burst = true;
+                phase_end = (cycle + profile.burst_duty) * profile.burst_period_seconds;
+            }
+        }
+
+        if (profile.operations > 0 ? schedule.size() >= profile.operations : now >= profile.duration_seconds) {
+            break;
+        }
+
+        ScheduledOperation op;
+        op.offset_ns = static_cast<std::int64_t>(now * 1e9);
+        double choice = random.uniform() * mix_total;
+        std::size_t kind = 0;
+        while (kind + 1 < kLoadOperationCount && choice >= mix_cumulative[kind]) {
+            ++kind;
+        }
+        op.operation = static_cast<LoadOperation>(kind);
+        op.account_index = pickAccount();
+        op.to_account_index = op.account_index;
+        if (op.operation == LoadOperation::TRANSFER) {
+            while (op.to_account_index == op.account_index) {
+                op.to_account_index = pickAccount();
+            }
+        }
+        op.location = random.uniform() < profile.remote_share
+            ? static_cast<std::uint8_t>(kHomeLocationCount)
+            : static_cast<std::uint8_t>(op.account_index % kHomeLocationCount);
+        op.amount = std::round(profile.min_amount * std::exp(random.uniform() * amount_span) * 100.0) / 100.0;
+        op.amount = std::max(op.amount, 0.01);
+        schedule.push_back(op);
+
+        fingerprint = mixFingerprint(fingerprint, static_cast<std::uint64_t>(op.offset_ns));
+        fingerprint = mixFingerprint(fingerprint, static_cast<std::uint64_t>(kind));
+        fingerprint = mixFingerprint(fingerprint, op.account_index);
+        fingerprint = mixFingerprint(fingerprint, op.to_account_index);
+        fingerprint = mixFingerprint(fingerprint, op.location);
+        fingerprint = mixFingerprint(fingerprint, static_cast<std::uint64_t>(std::llround(op.amount * 100.0)));
+    }
+}
+
+LoadReport LoadGenerator::run() {
+    UserDirectory user_directory;
+    TransactionService transaction_service;
+    FraudDetectionService fraud_service;
+    user_directory.setLedger(ledger);
+
+    std::vector<std::shared_ptr<Account>> accounts;
+    accounts.reserve(profile.users * profile.accounts_per_user);
+    std::string password_hash = User::hashPassword("load-test");
+    for (std::size_t u = 0; u < profile.users; ++u) {
+        auto user = user_directory.createUser("Load User " + std::to_string(u + 1),
+                                              "load.user" + std::to_string(u + 1) + "@example.com", password_hash);
+        for (std::size_t a = 0; a < profile.accounts_per_user; ++a) {
+            accounts.push_back(user_directory.createAccount(user->getUserId(), AccountType::CHECKING,
+                                                            profile.initial_balance));
+        }
+    }
+
+    LockProfiler::instance().reset(); // Profile the measured phase, not the setup
+
+    unsigned worker_count = profile.worker_count;
+    if (worker_count == 0) {
+        worker_count = std::max(1u, std::thread::hardware_concurrency());
+    }
+    worker_count = static_cast<unsigned>(std::max<std::size_t>(1, std::min<std::size_t>(worker_count, schedule.size())));
+
+    std::vector<WorkerResult> results(worker_count);
+    // Leave the workers time to start before the first arrival
+    const Clock::time_point start = Clock::now() + std::chrono::milliseconds(5);
+
+    auto work = [&](unsigned worker) {
+        WorkerResult& result = results[worker];
+        for (std::size_t i = worker; i < schedule.size(); i += worker_count) {
+            const ScheduledOperation& op = schedule[i];
+            const Clock::time_point intended = start + std::chrono::nanoseconds(op.offset_ns);
+
+            // Sleep most of the way, then yield up to the start time, so
+            // timer slack is not billed to the engine
+            if (intended - Clock::now() > std::chrono::microseconds(200)) {
+                std::this_thread::sleep_until(intended - std::chrono::microseconds(100));
+            }
+            while (Clock::now() < intended) {
+                std::this_thread::yield();
+            }
+
+            const Clock::time_point began = Clock::now();
+            const auto& account = accounts[op.account_index];
+            const std::string& location = kLocations[op.location];
+            TransactionResult outcome = TransactionResult::success();
+            TransactionType type = TransactionType::DEPOSIT;
+            int to_account_id = -1;
+            switch (op.operation) {
+                case LoadOperation::DEPOSIT:
+                    outcome = transaction_service.processDeposit(account, op.amount, "Load deposit", location);
+                    break;
+                case LoadOperation::WITHDRAWAL:
+                    type = TransactionType::WITHDRAWAL;
+                    outcome = transaction_service.processWithdrawal(account, op.amount, "Load withdrawal", location);
+                    break;
+                case LoadOperation::TRANSFER:
+                    type = TransactionType::TRANSFER_OUT;
+                    to_account_id = accounts[op.to_account_index]->getAccountId();
+                    outcome = transaction_service.processTransfer(account, accounts[op.to_account_index],
+                                                                  op.amount, "Load transfer");
+                    break;
+            }
+
+            if (outcome) {
+                ++result.completed;
+                if (profile.fraud_screening) {
+                    auto transaction = std::make_shared<Transaction>(outcome.transaction_id, account->getAccountId(),
+                                                                     op.amount, type, TransactionCategory::OTHER,
+                                                                     "Load operation");
+                    transaction->setToAccountId(to_account_id);
+                    transaction->setLocation(location);
+                    transaction->setStatus(TransactionStatus::COMPLETED);
+                    if (fraud_service.analyzeTransaction(transaction)) {
+                        ++result.flagged;
+                    }
+                }
+            } else {
+                ++result.declined;
+            }
+
+            const Clock::time_point finished = Clock::now();
+            result.response_times[static_cast<std::size_t>(op.operation)].record(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(finished - intended).count());
+            result.service_times.record(std::chrono::duration_cast<std::chrono::nanoseconds>(finished - began).count());
+            result.finished = finished;
+        }
+    };
+
+    std::vector<std::thread> workers;
+    workers.reserve(worker_count);
+    for (unsigned w = 0; w < worker_count; ++w) {
+        workers.emplace_back(work, w);
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    LoadReport report;
+    report.scheduled = schedule.size();
+    report.schedule_fingerprint = fingerprint;
+    for (const auto& op : schedule) {
+        ++report.operation_counts[static_cast<std::size_t>(op.operation)];
+    }
+    if (!schedule.empty()) {
+        double span = schedule.back().offset_ns / 1e9;
+        report.offered_rate = span > 0 ? schedule.size() / span : 0.0;
+    }
+
+    Clock::time_point finished = start;
+    for (const auto& result : results) {
+        report.completed += result.completed;
+        report.declined += result.declined;
+        report.flagged += result.flagged;
+        for (std::size_t i = 0; i < kLoadOperationCount; ++i) {
+            report.response_times[i].merge(result.response_times[i]);
+            report.all_response_times.merge(result.response_times[i]);
+        }
+        report.service_times.merge(result.service_times);
+        finished = std::max(finished, result.finished);
+    }
+    report.elapsed_seconds = std::chrono::duration<double>(finished - start).count();
+    if (ledger) {
+        report.ledger_events = ledger->getEventCount();
+        report.state_digest = LedgerReplayer::stateDigest(accounts);
+    }
+    return report;
+}
+
+void LoadGenerator::setLedger(std::shared_ptr<Ledger> ledger) {
+    this->ledger = std::move(ledger);
+}
+
+std::size_t LoadGenerator::getScheduledCount() const {
+    return schedule.size();
+}
+
+std::uint64_t LoadGenerator::getScheduleFingerprint() const {
+    return fingerprint;
+}
+
+const char* LoadGenerator::loadOperationToString(LoadOperation operation) {
+    switch (operation) {
+        case LoadOperation::DEPOSIT: return "Deposit";
+        case LoadOperation::WITHDRAWAL: return "Withdrawal";
+        case LoadOperation::TRANSFER: return "Transfer";
+        default: return "Unknown";
+    }
+}
+
+void LoadGenerator::printReport(const LoadReport& report, std::ostream& out) {
+    auto printRow = [&out](const char* name, const LatencyHistogram& histogram) {
+        out << std::left << std::setw(16) << name
+            << std::right << std::setw(10) << histogram.count()
+            << std::fixed << std::setprecision(1);
+        for (double percentile : {50.0, 90.0, 99.0, 99.9}) {
+            out << std::setw(11) << histogram.valueAtPercentile(percentile) / 1000.0;
+        }
+        out << std::setw(11) << histogram.max() / 1000.0 << "\n";
+    };
+
+    out << "\n=== LOAD TEST ===\n";
+    out << "Schedule: " << report.scheduled << " operations (fingerprint " << std::hex << std::setw(16)
+        << std::setfill('0') << report.schedule_fingerprint << std::dec << std::setfill(' ') << ")\n";
+    out << "Mix:";
+    for (std::size_t i = 0; i < kLoadOperationCount; ++i) {
+        out << " " << loadOperationToString(static_cast<LoadOperation>(i)) << "=" << report.operation_counts[i];
+    }
+    out << "\nOutcome: " << report.completed << " completed, " << report.declined << " declined, "
+        << report.flagged << " flagged\n";
+    if (report.ledger_events > 0) {
+        out << "Ledger: " << report.ledger_events << " events (state digest " << std::hex << std::setw(16)
+            << std::setfill('0') << report.state_digest << std::dec << std::setfill(' ') << ")\n";
+    }
+    out << "Throughput: " << std::fixed << std::setprecision(0) << report.offered_rate << " ops/s offered, "
+        << report.achievedRate() << " ops/s achieved over " << std::setprecision(2) << report.elapsed_seconds << "s\n\n";
+
+    out << std::left << std::setw(16) << "Latency (us)"
+        << std::right << std::setw(10) << "Count"
+        << std::setw(11) << "p50"
+        << std::setw(11) << "p90"
+        << std::setw(11) << "p99"
+        << std::setw(11) << "p99.9"
+        << std::setw(11) << "Max" << "\n";
+    for (std::size_t i = 0; i < kLoadOperationCount; ++i) {
+        printRow(loadOperationToString(static_cast<LoadOperation>(i)), report.response_times[i]);
+    }
+    printRow("All", report.all_response_times);
+    printRow("Service time", report.service_times);
+    out << "=================\n";
+}
@@ -0,0 +1,110 @@
+#ifndef LOAD_GENERATOR_H
+#define LOAD_GENERATOR_H
+
+#include <array>
+#include <memory>
+#include <vector>
+#include <ostream>
+#include <cstdint>
+#include <cstddef>
+#include "utils/LatencyHistogram.h"
+
+class Ledger;
+
+enum class LoadOperation {
+    DEPOSIT,
+    WITHDRAWAL,
+    TRANSFER
+};
+
+constexpr std::size_t kLoadOperationCount = 3;
+
+struct LoadProfile {
+    // Population
+    std::size_t users = 1000;
+    std::size_t accounts_per_user = 2;
+    double initial_balance = 5000.0;
+    double zipf_exponent = 1.1; // Account popularity skew; 0 = uniform
+
+    // Traffic
+    std::array<double, kLoadOperationCount> mix = {0.4, 0.35, 0.25}; // Relative weights, by LoadOperation
+    double min_amount = 1.0;   // Amounts are log-uniform between these
+    double max_amount = 500.0;
+    double remote_share = 0.02; // Operations made away from the account's home city
+    double rate = 20000.0;     // Mean offered operations per second, bursts included
+    double duration_seconds = 10.0;
+    std::uint64_t operations = 0; // Non-zero = schedule exactly this many instead of a duration
+
+    // Bursts: the arrival rate is burst_factor times the quiet rate for the
+    // first burst_duty of every burst_period_seconds
+    double burst_factor = 1.0;
+    double burst_period_seconds = 1.0;
+    double burst_duty = 0.2;
+
+    unsigned worker_count = 0;  // 0 = one per hardware thread
+    bool fraud_screening = true;
+    std::uint64_t seed = 1;
+};
+
+struct LoadReport {
+    std::uint64_t scheduled = 0;
+    std::uint64_t completed = 0; // Operations the engine accepted
+    std::uint64_t declined = 0;
+    std::uint64_t flagged = 0;   // Accepted operations the fraud rules flagged
+    std::array<std::uint64_t, kLoadOperationCount> operation_counts{};
+    double offered_rate = 0.0;
+    double elapsed_seconds = 0.0;
+    std::uint64_t schedule_fingerprint = 0; // Equal for equal profiles; compare before comparing runs
+    std::uint64_t ledger_events = 0;        // Balance changes recorded, when a ledger was set
+    std::uint64_t state_digest = 0;         // LedgerReplayer::stateDigest of the final accounts
+
+    // Response time runs from the scheduled start, so time spent waiting
+    // behind a slow operation counts; service time runs from the actual start
+    std::array<LatencyHistogram, kLoadOperationCount> response_times;
+    LatencyHistogram all_response_times;
+    LatencyHistogram service_times;
+
+    double achievedRate() const;
+};
+
+// Drives TransactionService and FraudDetectionService open-loop: the whole
+// arrival schedule is generated up front from the seed and every operation is
+// issued at its scheduled time whether or not earlier ones have finished, so
+// a stall shows up in the latency percentiles instead of quietly lowering
+// the offered load. Operation i runs on worker i % worker_count.
+//
+// The schedule (arrival times, operations, accounts, amounts) depends only
+// on the profile. Outcomes can still vary between runs with more than one
+// worker, since withdrawals race with deposits on the same hot accounts.
+class LoadGenerator {
+private:
+    struct ScheduledOperation {
+        std::int64_t offset_ns; // From the start of the run
+        LoadOperation operation;
+        std::uint32_t account_index;
+        std::uint32_t to_account_index;
+        std::uint8_t location; // Index into the generator's location table
+        double amount;
+    };
+
+    LoadProfile profile;
+    std::vector<ScheduledOperation> schedule;
+    std::uint64_t fingerprint;
+    std::shared_ptr<Ledger> ledger;
+
+    void buildSchedule();
+
+public:
+    explicit LoadGenerator(LoadProfile profile); // Throws std::invalid_argument for an unusable profile
+
+    LoadReport run();
+    void setLedger(std::shared_ptr<Ledger> ledger); // Records every balance change of the next run
+
+    std::size_t getScheduledCount() const;
+    std::uint64_t getScheduleFingerprint() const;
+
+    static const char* loadOperationToString(LoadOperation operation);
+    static void printReport(const LoadReport& report, std::ostream& out);
+};
+
+#endif // LOAD_GENERATOR_H
@@ -0,0 +1,271 @@
+#include "SpendingRollups.h"
+#include <algorithm>
+#include <cmath>
+#include <future>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+namespace {
+    std::int64_t toCents(double amount) {
+        return static_cast<std::int64_t>(std::llround(amount * 100.0));
+    }
+
+    double fromCents(std::int64_t cents) {
+        return static_cast<double>(cents) / 100.0;
+    }
+
+    // A ledger row reduced to what the rollups need
+    struct RollupEntry {
+        int user_id;
+        std::uint32_t period;
+        std::uint32_t category;
+        std::int64_t cents;
+    };
+}
+
+SpendingRollups::SpendingRollups(std::shared_ptr<const PeriodCalendar> calendar)
+    : calendar(std::move(calendar)) {
+    if (!this->calendar) {
+        throw std::invalid_argument("Period calendar cannot be null");
+    }
+}
+
+bool SpendingRollups::isSpending(TransactionType type) {
+    return type == TransactionType::WITHDRAWAL || type == TransactionType::PAYMENT;
+}
+
+// Incremental maintenance
+void SpendingRollups::record(int user_id, TransactionCategory category, double amount,
+                             std::chrono::system_clock::time_point timestamp) {
+    std::size_t index = static_cast<std::size_t>(category);
+    if (amount <= 0 || index >= kTransactionCategoryCount) return;
+
+    std::uint32_t period = calendar->periodAt(timestamp);
+    Shard& shard = shards[shardFor(user_id)];
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    addTo(shard.users[user_id], period, index, toCents(amount));
+}
+
+void SpendingRollups::removeUser(int user_id) {
+    Shard& shard = shards[shardFor(user_id)];
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    shard.users.erase(user_id);
+}
+
+void SpendingRollups::clear() {
+    for (auto& shard : shards) {
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        shard.users.clear();
+    }
+}
+
+std::size_t SpendingRollups::rebuild(const std::vector<std::shared_ptr<Transaction>>& ledger,
+                                     const std::unordered_map<int, int>& account_owners,
+                                     unsigned int thread_count) {
+    if (thread_count == 0) {
+        thread_count = std::max(1u, std::thread::hardware_concurrency());
+    }
+    thread_count = static_cast<unsigned int>(std::min<std::size_t>(thread_count, kShardCount));
+
+    // Phase 1: each thread filters a slice of the ledger and sorts its rows by shard
+    std::vector<std::vector<std::vector<RollupEntry>>> partitions(
+        thread_count, std::vector<std::vector<RollupEntry>>(kShardCount));
+    std::size_t slice = (ledger.size() + thread_count - 1) / thread_count;
+    std::vector<std::future<std::size_t>> futures;
+
+    for (unsigned int t = 0; t < thread_count; ++t) {
+        futures.push_back(std::async(std::launch::async, [&, t]() {
+            std::size_t begin = std::min(ledger.size(), t * slice);
+            std::size_t end = std::min(ledger.size(), begin + slice);
+            std::size_t counted = 0;
+            for (std::size_t i = begin; i < end; ++i) {
+                const Transaction* transaction = ledger[i].get();
+                if (!transaction || !isSpending(transaction->getType()) ||
+                    transaction->getStatus() != TransactionStatus::COMPLETED ||
+                    transaction->getAmount() <= 0) {
+                    continue;
+                }
+                auto owner = account_owners.find(transaction->getAccountId());
+                if (owner == account_owners.end()) continue;
+
+                partitions[t][shardFor(owner->second)].push_back(RollupEntry{
+                    owner->second,
+                    calendar->periodAt(transaction->getTimestamp()),
+                    static_cast<std::uint32_t>(transaction->getCategory()),
+                    toCents(transaction->getAmount())
+                });
+                ++counted;
+            }
+            return counted;
+        }));
+    }
+
+    std::size_t counted = 0;
+    for (auto& future : futures) {
+        counted += future.get();
+    }
+    futures.clear();
+
+    // Phase 2: each thread owns a disjoint set of shards, aggregates them off
+    // to the side and swaps the result in, so readers only wait for the swap
+    for (unsigned int t = 0; t < thread_count; ++t) {
+        futures.push_back(std::async(std::launch::async, [&, t]() {
+            for (std::size_t s = t; s < kShardCount; s += thread_count) {
+                std::unordered_map<int, UserRollup> users;
+                for (const auto& partition : partitions) {
+                    for (const RollupEntry& entry : partition[s]) {
+                        addTo(users[entry.user_id], entry.period, entry.category, entry.cents);
+                    }
+                }
+                std::unique_lock<std::shared_mutex> lock(shards[s].mutex);
+                shards[s].users.swap(users);
+            }
+            return std::size_t(0);
+        }));
+    }
+    for (auto& future : futures) {
+        future.get();
+    }
+    return counted;
+}
+
+// Trend queries
+std::vector<double> SpendingRollups::getTrend(int user_id, TransactionCategory category, std::size_t months) const {
+    return getTrend(user_id, category, months, calendar->currentPeriod());
+}
+
+std::vector<double> SpendingRollups::getTrend(int user_id, TransactionCategory category, std::size_t months,
+                                              std::uint32_t last_period) const {
+    std::size_t index = static_cast<std::size_t>(category);
+    if (index >= kTransactionCategoryCount) {
+        throw std::invalid_argument("Unknown transaction category");
+    }
+    return trend(user_id, months, last_period, index, index + 1);
+}
+
+std::vector<double> SpendingRollups::getTotalTrend(int user_id, std::size_t months) const {
+    return trend(user_id, months, calendar->currentPeriod(), 0, kTransactionCategoryCount);
+}
+
+SpendingRollups::CategoryTotals SpendingRollups::getPeriodTotals(int user_id, std::uint32_t period) const {
+    CategoryTotals totals{};
+    const Shard& shard = shards[shardFor(user_id)];
+    std::shared_lock<std::shared_mutex> lock(shard.mutex);
+    auto it = shard.users.find(user_id);
+    if (it == shard.users.end()) return totals;
+
+    forEachPeriod(it->second, period, period, [&](const PeriodCell& cell) {
+        for (std::size_t c = 0; c < kTransactionCategoryCount; ++c) {
+            totals[c] = fromCents(cell.cents[c]);
+        }
+    });
+    return totals;
+}
+
+SpendingRollups::CategoryTotals SpendingRollups::getCategoryTotals(int user_id, std::size_t months) const {
+    CategoryTotals totals{};
+    if (months == 0) return totals;
+
+    std::uint32_t last = calendar->currentPeriod();
+    std::uint32_t first = (months - 1 >= last) ? 0 : static_cast<std::uint32_t>(last - (months - 1));
+    std::array<std::int64_t, kTransactionCategoryCount> cents{};
+
+    const Shard& shard = shards[shardFor(user_id)];
+    std::shared_lock<std::shared_mutex> lock(shard.mutex);
+    auto it = shard.users.find(user_id);
+    if (it == shard.users.end()) return totals;
+
+    forEachPeriod(it->second, first, last, [&](const PeriodCell& cell) {
+        for (std::size_t c = 0; c < kTransactionCategoryCount; ++c) {
+            cents[c] += cell.cents[c];
+        }
+    });
+    for (std::size_t c = 0; c < kTransactionCategoryCount; ++c) {
+        totals[c] = fromCents(cents[c]);
+    }
+    return totals;
+}
+
+// Getters
+const PeriodCalendar& SpendingRollups::getCalendar() const {
+    return *calendar;
+}
+
+std::size_t SpendingRollups::userCount() const {
+    std::size_t count = 0;
+    for (const auto& shard : shards) {
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        count += shard.users.size();
+    }
+    return count;
+}
+
+// Private methods
+std::size_t SpendingRollups::shardFor(int user_id) {
+    // Sequential user ids land in different shards
+    std::uint32_t hash = static_cast<std::uint32_t>(user_id) * 2654435761u;
+    return (hash >> 16) % kShardCount;
+}
+
+void SpendingRollups::addTo(UserRollup& rollup, std::uint32_t period, std::size_t category, std::int64_t cents) {
+    if (!rollup.empty() && period + kRetainedPeriods <= rollup.back().period) {
+        return; // Older than anything retained
+    }
+    auto cell = std::lower_bound(rollup.begin(), rollup.end(), period,
+        [](const PeriodCell& c, std::uint32_t p) { return c.period < p; });
+    if (cell == rollup.end() || cell->period != period) {
+        PeriodCell row;
+        row.period = period;
+        cell = rollup.insert(cell, row);
+    }
+    cell->cents[category] += cents;
+
+    // Rows that a newer period has pushed out of retention
+    std::uint32_t newest = rollup.back().period;
+    auto retained = std::find_if(rollup.begin(), rollup.end(),
+        [newest](const PeriodCell& c) { return c.period + kRetainedPeriods > newest; });
+    rollup.erase(rollup.begin(), retained);
+}
+
+template <typename Visitor>
+void SpendingRollups::forEachPeriod(const UserRollup& rollup, std::uint32_t first, std::uint32_t last, Visitor visit) {
+    if (last - first >= kRetainedPeriods) {
+        first = last - static_cast<std::uint32_t>(kRetainedPeriods - 1);
+    }
+    auto cell = std::lower_bound(rollup.begin(), rollup.end(), first,
+        [](const PeriodCell& c, std::uint32_t p) { return c.period < p; });
+    for (; cell != rollup.end() && cell->period <= last; ++cell) {
+        visit(*cell);
+    }
+}
+
+std::vector<double> SpendingRollups::trend(int user_id, std::size_t months, std::uint32_t last_period,
+                                           std::size_t category_begin, std::size_t category_end) const {
+    std::vector<double> values(months, 0.0);
+    if (months == 0) return values;
+
+    std::vector<std::int64_t> cents(months, 0);
+    std::uint32_t first = (months - 1 >= last_period) ? 0 : static_cast<std::uint32_t>(last_period - (months - 1));
+    std::size_t offset = months - 1 - (last_period - first); // Slots before period 0 stay zero
+
+    {
+        const Shard& shard = shards[shardFor(user_id)];
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        auto it = shard.users.find(user_id);
+        if (it == shard.users.end()) return values;
+
+        forEachPeriod(it->second, first, last_period, [&](const PeriodCell& cell) {
+            std::int64_t sum = 0;
+            for (std::size_t c = category_begin; c < category_end; ++c) {
+                sum += cell.cents[c];
+            }
+            cents[offset + (cell.period - first)] = sum;
+        });
+    }
+
+    for (std::size_t i = 0; i < months; ++i) {
+        values[i] = fromCents(cents[i]);
+    }
+    return values;
+}
@@ -0,0 +1,89 @@
+#ifndef SPENDING_ROLLUPS_H
+#define SPENDING_ROLLUPS_H
+
+#include <vector>
+#include <array>
+#include <memory>
+#include <unordered_map>
+#include <shared_mutex>
+#include <cstdint>
+#include "../models/Transaction.h"
+#include "../utils/PeriodCalendar.h"
+
+// Per-user spending totals for the last kRetainedPeriods months, one cell per
+// (period, category). Completed debits are added as they happen, so trend
+// queries read at most a few hundred integers instead of rescanning the
+// ledger. A user holds a row only for months they spent in, so a mostly
+// idle user costs one row rather than kRetainedPeriods. Users are spread
+// over independently locked shards.
+class SpendingRollups {
+public:
+    static constexpr std::size_t kRetainedPeriods = 24;
+    static constexpr std::size_t kShardCount = 64;
+
+    using CategoryTotals = std::array<double, kTransactionCategoryCount>;
+
+    explicit SpendingRollups(std::shared_ptr<const PeriodCalendar> calendar = PeriodCalendar::local());
+
+    SpendingRollups(const SpendingRollups&) = delete;
+    SpendingRollups& operator=(const SpendingRollups&) = delete;
+
+    // Only withdrawals and payments count as spending
+    static bool isSpending(TransactionType type);
+
+    // Incremental maintenance
+    void record(int user_id, TransactionCategory category, double amount,
+                std::chrono::system_clock::time_point timestamp);
+    void removeUser(int user_id);
+    void clear();
+
+    // Replaces every rollup with totals recomputed from completed spending
+    // in the ledger. account_owners maps account_id -> user_id; transactions
+    // on unknown accounts are skipped. Returns the number of transactions counted.
+    std::size_t rebuild(const std::vector<std::shared_ptr<Transaction>>& ledger,
+                        const std::unordered_map<int, int>& account_owners,
+                        unsigned int thread_count = 0);
+
+    // Trend queries; periods end at the calendar's current period unless
+    // given, and periods with no spending (or beyond retention) read as zero
+    std::vector<double> getTrend(int user_id, TransactionCategory category, std::size_t months) const;
+    std::vector<double> getTrend(int user_id, TransactionCategory category, std::size_t months,
+                                 std::uint32_t last_period) const; // Oldest first
+    std::vector<double> getTotalTrend(int user_id, std::size_t months) const;
+    CategoryTotals getPeriodTotals(int user_id, std::uint32_t period) const;
+    CategoryTotals getCategoryTotals(int user_id, std::size_t months) const; // Summed over the last months
+
+    // Getters
+    const PeriodCalendar& getCalendar() const;
+    std::size_t userCount() const;
+
+private:
+    struct PeriodCell {
+        std::uint32_t period = 0;
+        std::array<std::int64_t, kTransactionCategoryCount> cents{};
+    };
+
+    // Rows for periods with spending, ascending, none older than
+    // kRetainedPeriods before the newest
+    using UserRollup = std::vector<PeriodCell>;
+
+    struct Shard {
+        std::unordered_map<int, UserRollup> users;
+        mutable std::shared_mutex mutex;
+    };
+
+    std::shared_ptr<const PeriodCalendar> calendar;
+    std::array<Shard, kShardCount> shards;
+
+    static std::size_t shardFor(int user_id);
+    static void addTo(UserRollup& rollup, std::uint32_t period, std::size_t category, std::int64_t cents);
+
+    // Calls visit(period_cell) for each retained period in [first, last]; expects the shard lock held
+    template <typename Visitor>
+    static void forEachPeriod(const UserRollup& rollup, std::uint32_t first, std::uint32_t last, Visitor visit);
+
+    std::vector<double> trend(int user_id, std::size_t months, std::uint32_t last_period,
+                              std::size_t category_begin, std::size_t category_end) const;
+};
+
+#endif // SPENDING_ROLLUPS_H
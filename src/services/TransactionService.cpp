@@ -1,156 +1,339 @@
 #include "TransactionService.h"
 #include "../models/Transaction.h"
 #include "../models/Account.h"
+#include "../utils/Metrics.h"
+#include "../utils/Logger.h"
 #include <iostream>
 #include <thread>
 #include <future>
 #include <algorithm>
+#include <iomanip>
+#include <cmath>
+#include <atomic>
+#include <array>
+#include <cstring>
 
-TransactionService::TransactionService() : next_transaction_id(1) {}
+namespace {
+    enum class ServiceOperation {
+        DEPOSIT,
+        WITHDRAWAL,
+        PAYMENT,
+        TRANSFER,
+        JOURNAL
+    };
+
+    constexpr std::size_t kOutcomeCount = static_cast<std::size_t>(TransactionOutcome::IDEMPOTENCY_CONFLICT) + 1;
+
+    struct OperationMetrics {
+        LatencySummary* duration;
+        std::array<Counter*, kOutcomeCount> outcomes;
+    };
+
+    const char* outcomeLabel(TransactionOutcome outcome) {
+        switch (outcome) {
+            case TransactionOutcome::SUCCESS: return "success";
+            case TransactionOutcome::INSUFFICIENT_FUNDS: return "insufficient_funds";
+            case TransactionOutcome::INVALID_AMOUNT: return "invalid_amount";
+            case TransactionOutcome::INVALID_ACCOUNT: return "invalid_account";
+            case TransactionOutcome::UNBALANCED_ENTRY: return "unbalanced_entry";
+            case TransactionOutcome::IDEMPOTENCY_CONFLICT: return "idempotency_conflict";
+            default: return "unknown";
+        }
+    }
+
+    OperationMetrics registerOperation(const char* operation) {
+        MetricsRegistry& registry = MetricsRegistry::instance();
+        OperationMetrics metrics;
+        metrics.duration = &registry.latency("fintrack_transaction_duration_seconds",
+                                             "Time spent in TransactionService operations.",
+                                             {{"operation", operation}});
+        for (std::size_t i = 0; i < kOutcomeCount; ++i) {
+            metrics.outcomes[i] = &registry.counter("fintrack_transactions_total",
+                                                    "TransactionService operations by outcome.",
+                                                    {{"operation", operation},
+                                                     {"outcome", outcomeLabel(static_cast<TransactionOutcome>(i))}});
+        }
+        return metrics;
+    }
+
+    const OperationMetrics& operationMetrics(ServiceOperation operation) {
+        static const std::array<OperationMetrics, 5> metrics = {
+            registerOperation("deposit"), registerOperation("withdrawal"), registerOperation("payment"),
+            registerOperation("transfer"), registerOperation("journal")};
+        return metrics[static_cast<std::size_t>(operation)];
+    }
+
+    // What a request asks for, stored with its idempotency key so that the
+    // key reused for another operation, account or amount is a conflict
+    std::uint64_t requestFingerprint(ServiceOperation operation, const std::shared_ptr<Account>& account,
+                                     const std::shared_ptr<Account>& to_account, double amount) {
+        std::uint64_t amount_bits = 0;
+        std::memcpy(&amount_bits, &amount, sizeof(amount_bits));
+        const std::uint64_t fields[] = {
+            static_cast<std::uint64_t>(operation),
+            static_cast<std::uint32_t>(account ? account->getAccountId() : -1),
+            static_cast<std::uint32_t>(to_account ? to_account->getAccountId() : -1),
+            amount_bits};
+        std::uint64_t hash = 14695981039346656037ULL;
+        for (std::uint64_t field : fields) {
+            hash = (hash ^ field) * 1099511628211ULL;
+            hash ^= hash >> 29;
+        }
+        return hash;
+    }
+
+    // Times one public operation and counts its outcome on the way out
+    class OperationScope {
+    private:
+        const OperationMetrics& metrics;
+        ScopedLatency timer;
+
+    public:
+        explicit OperationScope(ServiceOperation operation)
+            : metrics(operationMetrics(operation)), timer(*metrics.duration) {}
+
+        TransactionResult finish(TransactionResult result) {
+            metrics.outcomes[static_cast<std::size_t>(result.outcome)]->increment();
+            return result;
+        }
+    };
+}
+
+TransactionService::TransactionService()
+    : completed_count(0), completed_volume(0.0), next_transaction_id(1), failed_transaction_count(0) {}
 
 TransactionService::~TransactionService() {}
 
-bool TransactionService::processDeposit(std::shared_ptr<Account> account, double amount, 
-                                       const std::string& description, const std::string& location) {
+TransactionResult TransactionService::processDeposit(std::shared_ptr<Account> account, double amount, 
+                                                    const std::string& description, const std::string& location,
+                                                    const std::string& idempotency_key,
+                                                    std::shared_ptr<Transaction>* recorded) {
+    if (!idempotency_key.empty()) {
+        std::uint64_t request = requestFingerprint(ServiceOperation::DEPOSIT, account, nullptr, amount);
+        return idempotency_cache.run(idempotency_key, request, [&]() {
+            return processDeposit(account, amount, description, location, "", recorded);
+        });
+    }
+    
+    OperationScope scope(ServiceOperation::DEPOSIT);
     if (!account) {
-        std::cerr << "Error: Invalid account for deposit" << std::endl;
-        return false;
+        return scope.finish(TransactionResult::failure(TransactionOutcome::INVALID_ACCOUNT, "Invalid account for deposit"));
     }
 
-    // Create transaction
-    auto transaction = std::make_shared<Transaction>(
-        getNextTransactionId(),
-        account->getAccountId(),
-        amount,
-        TransactionType::DEPOSIT,
-        TransactionCategory::OTHER,
-        description
-    );
+    auto transaction = beginTransaction(account->getAccountId(), amount, TransactionType::DEPOSIT,
+                                        TransactionCategory::OTHER, description, location);
     
-    transaction->setLocation(location);
-    transaction->setStatus(TransactionStatus::PENDING);
+    // Process the deposit
+    TransactionResult result = account->tryDeposit(amount, description, transaction);
+    finishTransaction(transaction, result.ok());
+    if (result.ok() && recorded) *recorded = transaction;
     
-    // Add to pending transactions
-    {
-        std::lock_guard<std::mutex> lock(service_mutex);
-        pending_transactions.push_back(transaction);
+    result.transaction_id = transaction->getTransactionId();
+    return scope.finish(result);
+}
+
+TransactionResult TransactionService::processWithdrawal(std::shared_ptr<Account> account, double amount, 
+                                                       const std::string& description, const std::string& location,
+                                                       TransactionCategory category, const std::string& idempotency_key,
+                                                       std::shared_ptr<Transaction>* recorded) {
+    return processDebit(account, amount, TransactionType::WITHDRAWAL, category, description, location, idempotency_key,
+                        recorded);
+}
+
+TransactionResult TransactionService::processPayment(std::shared_ptr<Account> account, double amount, 
+                                                    TransactionCategory category,
+                                                    const std::string& description, const std::string& location,
+                                                    const std::string& idempotency_key,
+                                                    std::shared_ptr<Transaction>* recorded) {
+    return processDebit(account, amount, TransactionType::PAYMENT, category, description, location, idempotency_key,
+                        recorded);
+}
+
+TransactionResult TransactionService::processDebit(std::shared_ptr<Account> account, double amount, TransactionType type,
+                                                  TransactionCategory category, const std::string& description, 
+                                                  const std::string& location, const std::string& idempotency_key,
+                                                  std::shared_ptr<Transaction>* recorded) {
+    if (!idempotency_key.empty()) {
+        std::uint64_t request = requestFingerprint(
+            type == TransactionType::PAYMENT ? ServiceOperation::PAYMENT : ServiceOperation::WITHDRAWAL,
+            account, nullptr, amount);
+        return idempotency_cache.run(idempotency_key, request, [&]() {
+            return processDebit(account, amount, type, category, description, location, "", recorded);
+        });
     }
     
-    // Process the deposit
-    bool success = account->deposit(amount, description);
+    OperationScope scope(type == TransactionType::PAYMENT ? ServiceOperation::PAYMENT : ServiceOperation::WITHDRAWAL);
+    if (!account) {
+        return scope.finish(TransactionResult::failure(TransactionOutcome::INVALID_ACCOUNT, 
+            type == TransactionType::PAYMENT ? "Invalid account for payment" : "Invalid account for withdrawal"));
+    }
+
+    auto transaction = beginTransaction(account->getAccountId(), amount, type, category, description, location);
     
-    // Update transaction status
-    transaction->setStatus(success ? TransactionStatus::COMPLETED : TransactionStatus::FAILED);
+    // Process the withdrawal; a decline comes back as a result, not an exception
+    TransactionResult result = account->tryWithdraw(amount, description, transaction);
+    finishTransaction(transaction, result.ok());
+    if (result.ok() && recorded) *recorded = transaction;
     
-    if (success) {
-        std::lock_guard<std::mutex> lock(service_mutex);
-        completed_transactions.push_back(transaction);
-        // Remove from pending
-        pending_transactions.erase(
-            std::remove(pending_transactions.begin(), pending_transactions.end(), transaction),
-            pending_transactions.end()
-        );
+    if (result.ok()) {
+        // One atomic add on the user's budget; crossings notify the
+        // BudgetManager's listener, never a scan
+        budget_directory.recordExpense(account->getUserId(), category, amount);
+        spending_rollups.record(account->getUserId(), category, amount, transaction->getTimestamp());
     }
     
-    return success;
+    result.transaction_id = transaction->getTransactionId();
+    return scope.finish(result);
 }
 
-bool TransactionService::processWithdrawal(std::shared_ptr<Account> account, double amount, 
-                                         const std::string& description, const std::string& location) {
-    if (!account) {
-        std::cerr << "Error: Invalid account for withdrawal" << std::endl;
-        return false;
+TransactionResult TransactionService::processTransfer(std::shared_ptr<Account> from_account, 
+                                                     std::shared_ptr<Account> to_account, 
+                                                     double amount, const std::string& description,
+                                                     const std::string& idempotency_key,
+                                                     std::shared_ptr<Transaction>* recorded) {
+    if (!idempotency_key.empty()) {
+        std::uint64_t request = requestFingerprint(ServiceOperation::TRANSFER, from_account, to_account, amount);
+        return idempotency_cache.run(idempotency_key, request, [&]() {
+            return processTransfer(from_account, to_account, amount, description, "", recorded);
+        });
     }
-
-    // Create transaction
-    auto transaction = std::make_shared<Transaction>(
-        getNextTransactionId(),
-        account->getAccountId(),
-        amount,
-        TransactionType::WITHDRAWAL,
-        TransactionCategory::OTHER,
-        description
-    );
     
-    transaction->setLocation(location);
-    transaction->setStatus(TransactionStatus::PENDING);
-    
-    // Add to pending transactions
-    {
-        std::lock_guard<std::mutex> lock(service_mutex);
-        pending_transactions.push_back(transaction);
+    OperationScope scope(ServiceOperation::TRANSFER);
+    if (!from_account || !to_account) {
+        return scope.finish(TransactionResult::failure(TransactionOutcome::INVALID_ACCOUNT, "Invalid accounts for transfer"));
     }
+
+    auto transaction = beginTransaction(from_account->getAccountId(), amount, TransactionType::TRANSFER_OUT,
+                                        TransactionCategory::OTHER, description, "");
+    transaction->setToAccountId(to_account->getAccountId());
     
-    // Process the withdrawal
-    bool success = account->withdraw(amount, description);
+    // Process the transfer
+    TransactionResult result = from_account->tryTransfer(to_account, amount, description, transaction);
+    finishTransaction(transaction, result.ok());
+    if (result.ok() && recorded) *recorded = transaction;
     
-    // Update transaction status
-    transaction->setStatus(success ? TransactionStatus::COMPLETED : TransactionStatus::FAILED);
+    result.transaction_id = transaction->getTransactionId();
+    return scope.finish(result);
+}
+
+TransactionResult TransactionService::postJournalEntry(const std::vector<JournalLeg>& legs, 
+                                                      const std::string& description) {
+    OperationScope scope(ServiceOperation::JOURNAL);
     
-    if (success) {
-        std::lock_guard<std::mutex> lock(service_mutex);
-        completed_transactions.push_back(transaction);
-        // Remove from pending
-        pending_transactions.erase(
-            std::remove(pending_transactions.begin(), pending_transactions.end(), transaction),
-            pending_transactions.end()
-        );
+    // One service record per leg, completed or failed together; the
+    // accounts' histories hold the same objects
+    std::string entry_desc = description.empty() ? "Journal entry" : description;
+    std::vector<std::shared_ptr<Transaction>> records;
+    records.reserve(legs.size());
+    for (const auto& leg : legs) {
+        records.push_back(beginTransaction(
+            leg.account ? leg.account->getAccountId() : -1,
+            std::abs(leg.amount),
+            leg.amount < 0 ? TransactionType::TRANSFER_OUT : TransactionType::TRANSFER_IN,
+            TransactionCategory::OTHER,
+            leg.description.empty() ? entry_desc : leg.description,
+            ""
+        ));
     }
     
-    return success;
-}
-
-bool TransactionService::processTransfer(std::shared_ptr<Account> from_account, 
-                                       std::shared_ptr<Account> to_account, 
-                                       double amount, const std::string& description) {
-    if (!from_account || !to_account) {
-        std::cerr << "Error: Invalid accounts for transfer" << std::endl;
-        return false;
+    TransactionResult result = Account::tryPost(legs, description, nullptr, &records);
+    for (const auto& record : records) {
+        finishTransaction(record, result.ok());
     }
+    
+    if (!records.empty()) {
+        result.transaction_id = records.front()->getTransactionId();
+    }
+    return scope.finish(result);
+}
 
-    // Create transaction
+std::shared_ptr<Transaction> TransactionService::beginTransaction(int account_id, double amount, TransactionType type,
+                                                                  TransactionCategory category, 
+                                                                  const std::string& description,
+                                                                  const std::string& location) {
     auto transaction = std::make_shared<Transaction>(
         getNextTransactionId(),
-        from_account->getAccountId(),
+        account_id,
         amount,
-        TransactionType::TRANSFER_OUT,
-        TransactionCategory::OTHER,
+        type,
+        category,
         description
     );
     
-    transaction->setToAccountId(to_account->getAccountId());
+    transaction->setLocation(location);
     transaction->setStatus(TransactionStatus::PENDING);
     
-    // Add to pending transactions
-    {
-        std::lock_guard<std::mutex> lock(service_mutex);
-        pending_transactions.push_back(transaction);
-    }
-    
-    // Process the transfer
-    bool success = from_account->transfer(to_account, amount, description);
-    
-    // Update transaction status
+    std::lock_guard<ProfiledMutex> lock(service_mutex);
+    pending_transactions.emplace(transaction->getTransactionId(), transaction);
+    return transaction;
+}
+
+void TransactionService::finishTransaction(const std::shared_ptr<Transaction>& transaction, bool success) {
     transaction->setStatus(success ? TransactionStatus::COMPLETED : TransactionStatus::FAILED);
     
+    // O(1) either way: pending is keyed by transaction id
+    std::lock_guard<ProfiledMutex> lock(service_mutex);
+    pending_transactions.erase(transaction->getTransactionId());
     if (success) {
-        std::lock_guard<std::mutex> lock(service_mutex);
-        completed_transactions.push_back(transaction);
-        // Remove from pending
-        pending_transactions.erase(
-            std::remove(pending_transactions.begin(), pending_transactions.end(), transaction),
-            pending_transactions.end()
-        );
+        recent_completed.push_back(transaction);
+        if (recent_completed.size() > kRecentCompleted) {
+            recent_completed.pop_front();
+        }
+        ++completed_count;
+        completed_volume += transaction->getAmount();
+        
+        using days = std::chrono::duration<std::int64_t, std::ratio<86400>>;
+        std::int64_t day = std::chrono::time_point_cast<days>(transaction->getTimestamp()).time_since_epoch().count();
+        auto& volume = daily_volume[transaction->getAccountId()];
+        if (volume.first != day) {
+            volume = {day, 0.0};
+        }
+        volume.second += transaction->getAmount();
+    } else {
+        ++failed_transaction_count;
     }
-    
-    return success;
+}
+
+void TransactionService::registerBudgetManager(std::shared_ptr<BudgetManager> budget_manager) {
+    budget_directory.addManager(std::move(budget_manager));
+}
+
+void TransactionService::unregisterBudgetManager(int user_id) {
+    budget_directory.removeManager(user_id);
+}
+
+BudgetDirectory& TransactionService::getBudgetDirectory() {
+    return budget_directory;
+}
+
+IdempotencyCache& TransactionService::getIdempotencyCache() {
+    return idempotency_cache;
+}
+
+const SpendingRollups& TransactionService::getSpendingRollups() const {
+    return spending_rollups;
+}
+
+std::size_t TransactionService::rebuildSpendingRollups(const std::vector<std::shared_ptr<Account>>& accounts,
+                                                       unsigned int thread_count) {
+    // Rebuild from a snapshot; debits completing meanwhile are still added
+    // incrementally but may be replaced by the rebuilt totals
+    std::vector<std::shared_ptr<Transaction>> ledger;
+    std::unordered_map<int, int> account_owners; // account_id -> user_id
+    for (const auto& account : accounts) {
+        if (!account) continue;
+        account_owners[account->getAccountId()] = account->getUserId();
+        std::vector<std::shared_ptr<Transaction>> history = account->getTransactionHistory();
+        ledger.insert(ledger.end(), history.begin(), history.end());
+    }
+    return spending_rollups.rebuild(ledger, account_owners, thread_count);
 }
 
 std::vector<std::shared_ptr<Transaction>> TransactionService::getTransactionHistory(int account_id) {
-    std::lock_guard<std::mutex> lock(service_mutex);
+    std::lock_guard<ProfiledMutex> lock(service_mutex);
     std::vector<std::shared_ptr<Transaction>> account_transactions;
     
-    for (const auto& transaction : completed_transactions) {
+    for (const auto& transaction : recent_completed) {
         if (transaction->getAccountId() == account_id || 
             transaction->getToAccountId() == account_id) {
             account_transactions.push_back(transaction);
@@ -161,15 +344,32 @@ std::vector<std::shared_ptr<Transaction>> TransactionService::getTransactionHist
 }
 
 std::vector<std::shared_ptr<Transaction>> TransactionService::getPendingTransactions() {
-    std::lock_guard<std::mutex> lock(service_mutex);
-    return pending_transactions;
+    std::vector<std::shared_ptr<Transaction>> pending;
+    {
+        std::lock_guard<ProfiledMutex> lock(service_mutex);
+        pending.reserve(pending_transactions.size());
+        for (const auto& pair : pending_transactions) {
+            pending.push_back(pair.second);
+        }
+    }
+    
+    std::sort(pending.begin(), pending.end(), 
+        [](const std::shared_ptr<Transaction>& a, const std::shared_ptr<Transaction>& b) {
+            return a->getTransactionId() < b->getTransactionId();
+        });
+    return pending;
+}
+
+std::size_t TransactionService::getFailedTransactionCount() {
+    std::lock_guard<ProfiledMutex> lock(service_mutex);
+    return failed_transaction_count;
 }
 
 std::vector<std::shared_ptr<Transaction>> TransactionService::getSuspiciousTransactions() {
-    std::lock_guard<std::mutex> lock(service_mutex);
+    std::lock_guard<ProfiledMutex> lock(service_mutex);
     std::vector<std::shared_ptr<Transaction>> suspicious;
     
-    for (const auto& transaction : completed_transactions) {
+    for (const auto& transaction : recent_completed) {
         if (transaction->isSuspicious()) {
             suspicious.push_back(transaction);
         }
@@ -178,81 +378,90 @@ std::vector<std::shared_ptr<Transaction>> TransactionService::getSuspiciousTrans
     return suspicious;
 }
 
-void TransactionService::processTransactionsBatch(const std::vector<TransactionRequest>& requests) {
-    std::vector<std::future<bool>> futures;
+std::vector<TransactionResult> TransactionService::processTransactionsBatch(const std::vector<TransactionRequest>& requests) {
+    std::vector<TransactionResult> results(requests.size(), 
+        TransactionResult::failure(TransactionOutcome::INVALID_AMOUNT, "Unsupported transaction type"));
     
-    for (const auto& request : requests) {
-        auto future = std::async(std::launch::async, [this, request]() {
+    // A bounded set of workers pulls requests from a shared cursor instead
+    // of one thread per request
+    std::atomic<std::size_t> next_request{0};
+    auto worker = [this, &requests, &results, &next_request]() {
+        for (std::size_t i = next_request++; i < requests.size(); i = next_request++) {
+            const TransactionRequest& request = requests[i];
             switch (request.type) {
                 case TransactionType::DEPOSIT:
-                    return processDeposit(request.account, request.amount, 
-                                        request.description, request.location);
+                    results[i] = processDeposit(request.account, request.amount, 
+                                                request.description, request.location, request.idempotency_key);
+                    break;
                 case TransactionType::WITHDRAWAL:
-                    return processWithdrawal(request.account, request.amount, 
-                                           request.description, request.location);
+                    results[i] = processWithdrawal(request.account, request.amount, request.description,
+                                                   request.location, request.category, request.idempotency_key);
+                    break;
+                case TransactionType::PAYMENT:
+                    results[i] = processPayment(request.account, request.amount, request.category,
+                                                request.description, request.location, request.idempotency_key);
+                    break;
                 case TransactionType::TRANSFER_OUT:
-                    return processTransfer(request.account, request.to_account, 
-                                         request.amount, request.description);
+                    results[i] = processTransfer(request.account, request.to_account, 
+                                                 request.amount, request.description, request.idempotency_key);
+                    break;
                 default:
-                    return false;
+                    break;
             }
-        });
-        
-        futures.push_back(std::move(future));
+        }
+    };
+    
+    std::size_t worker_count = std::min<std::size_t>(requests.size(), 
+                                                     std::max(1u, std::thread::hardware_concurrency()));
+    std::vector<std::future<void>> futures;
+    for (std::size_t i = 1; i < worker_count; ++i) {
+        futures.push_back(std::async(std::launch::async, worker));
     }
+    worker(); // The calling thread works too
     
     // Wait for all transactions to complete
     for (auto& future : futures) {
         future.get();
     }
     
-    std::cout << "Batch processing completed for " << requests.size() << " transactions" << std::endl;
+    std::size_t declined = std::count_if(results.begin(), results.end(), 
+                                         [](const TransactionResult& result) { return !result.ok(); });
+    logInfo("batch_processed", "Batch processing completed",
+            {{"transactions", requests.size()}, {"declined", declined}});
+    return results;
 }
 
 double TransactionService::calculateDailyVolume(int account_id) {
-    std::lock_guard<std::mutex> lock(service_mutex);
-    double volume = 0.0;
-    auto now = std::chrono::system_clock::now();
-    auto today = std::chrono::time_point_cast<std::chrono::days>(now);
+    using days = std::chrono::duration<std::int64_t, std::ratio<86400>>;
+    std::int64_t today = std::chrono::time_point_cast<days>(std::chrono::system_clock::now()).time_since_epoch().count();
     
-    for (const auto& transaction : completed_transactions) {
-        if (transaction->getAccountId() == account_id) {
-            auto tx_time = std::chrono::time_point_cast<std::chrono::days>(transaction->getTimestamp());
-            if (tx_time == today) {
-                volume += transaction->getAmount();
-            }
-        }
-    }
-    
-    return volume;
+    std::lock_guard<ProfiledMutex> lock(service_mutex);
+    auto volume = daily_volume.find(account_id);
+    return volume != daily_volume.end() && volume->second.first == today ? volume->second.second : 0.0;
 }
 
 void TransactionService::displayTransactionSummary() {
-    std::lock_guard<std::mutex> lock(service_mutex);
+    std::lock_guard<ProfiledMutex> lock(service_mutex);
     
     std::cout << "\n=== Transaction Service Summary ===" << std::endl;
-    std::cout << "Total Completed Transactions: " << completed_transactions.size() << std::endl;
+    std::cout << "Total Completed Transactions: " << completed_count << std::endl;
     std::cout << "Pending Transactions: " << pending_transactions.size() << std::endl;
+    std::cout << "Failed Transactions: " << failed_transaction_count << std::endl;
     
     int suspicious_count = 0;
-    for (const auto& transaction : completed_transactions) {
+    for (const auto& transaction : recent_completed) {
         if (transaction->isSuspicious()) {
             suspicious_count++;
         }
     }
-    std::cout << "Suspicious Transactions: " << suspicious_count << std::endl;
-    
-    double total_volume = 0.0;
-    for (const auto& transaction : completed_transactions) {
-        total_volume += transaction->getAmount();
-    }
+    std::cout << "Suspicious Transactions (last " << recent_completed.size() << "): " << suspicious_count << std::endl;
     std::cout << "Total Transaction Volume: $" << std::fixed << std::setprecision(2) 
-              << total_volume << std::endl;
+              << completed_volume << std::endl;
     
     std::cout << "===================================" << std::endl;
 }
 
 int TransactionService::getNextTransactionId() {
-    std::lock_guard<std::mutex> lock(service_mutex);
+    std::lock_guard<ProfiledMutex> lock(service_mutex);
     return next_transaction_id++;
 }
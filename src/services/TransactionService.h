@@ -6,55 +6,125 @@
 #include <mutex>
 #include <string>
 #include <future>
+#include <unordered_map>
+#include <deque>
+#include <cstdint>
 #include "../models/Transaction.h"
+#include "BudgetDirectory.h"
+#include "SpendingRollups.h"
+#include "IdempotencyCache.h"
+#include "../utils/LockProfiler.h"
 
 class Account;
+struct JournalLeg;
 
 struct TransactionRequest {
     std::shared_ptr<Account> account;
     std::shared_ptr<Account> to_account;  // For transfers
     double amount;
     TransactionType type;
+    TransactionCategory category;
     std::string description;
     std::string location;
+    std::string idempotency_key; // Optional; a retry with the same key gets the original result
     
     TransactionRequest(std::shared_ptr<Account> acc, double amt, TransactionType t, 
-                      const std::string& desc = "", const std::string& loc = "")
-        : account(acc), to_account(nullptr), amount(amt), type(t), description(desc), location(loc) {}
+                      const std::string& desc = "", const std::string& loc = "",
+                      TransactionCategory cat = TransactionCategory::OTHER)
+        : account(acc), to_account(nullptr), amount(amt), type(t), category(cat), description(desc), location(loc) {}
         
     TransactionRequest(std::shared_ptr<Account> from_acc, std::shared_ptr<Account> to_acc, 
                       double amt, const std::string& desc = "")
         : account(from_acc), to_account(to_acc), amount(amt), type(TransactionType::TRANSFER_OUT), 
-          description(desc), location("") {}
+          category(TransactionCategory::OTHER), description(desc), location("") {}
 };
 
 class TransactionService {
+public:
+    static constexpr std::size_t kRecentCompleted = 16384;
+
 private:
-    std::vector<std::shared_ptr<Transaction>> pending_transactions;
-    std::vector<std::shared_ptr<Transaction>> completed_transactions;
-    std::mutex service_mutex;
+    std::unordered_map<int, std::shared_ptr<Transaction>> pending_transactions; // Keyed by transaction id
+    // The most recent kRecentCompleted completed records, oldest first. The
+    // full log lives in each account's tiered TransactionHistory, so the
+    // service's memory does not grow with its age.
+    std::deque<std::shared_ptr<Transaction>> recent_completed;
+    std::size_t completed_count;
+    double completed_volume;
+    std::unordered_map<int, std::pair<std::int64_t, double>> daily_volume; // account_id -> (epoch day, volume)
+    ProfiledMutex service_mutex{"TransactionService::service_mutex"};
     int next_transaction_id;
+    std::size_t failed_transaction_count;
+    
+    BudgetDirectory budget_directory; // Budgets charged by completed withdrawals and payments
+    SpendingRollups spending_rollups; // Monthly per-category history of the same debits
+    IdempotencyCache idempotency_cache; // Results by client idempotency key
+    
+    TransactionResult processDebit(std::shared_ptr<Account> account, double amount, TransactionType type,
+                                   TransactionCategory category, const std::string& description, 
+                                   const std::string& location, const std::string& idempotency_key,
+                                   std::shared_ptr<Transaction>* recorded);
+    std::shared_ptr<Transaction> beginTransaction(int account_id, double amount, TransactionType type,
+                                                  TransactionCategory category, const std::string& description,
+                                                  const std::string& location);
+    void finishTransaction(const std::shared_ptr<Transaction>& transaction, bool success);
 
 public:
     // Constructor and Destructor
     TransactionService();
     ~TransactionService();
     
-    // Transaction processing
-    bool processDeposit(std::shared_ptr<Account> account, double amount, 
-                       const std::string& description = "", const std::string& location = "");
-    bool processWithdrawal(std::shared_ptr<Account> account, double amount, 
-                          const std::string& description = "", const std::string& location = "");
-    bool processTransfer(std::shared_ptr<Account> from_account, std::shared_ptr<Account> to_account, 
-                        double amount, const std::string& description = "");
+    // Transaction processing. Declines and invalid input come back in the
+    // result and leave the transaction FAILED; nothing is thrown. With an
+    // idempotency key, a retry within the cache's TTL returns the first
+    // attempt's result (marked replayed) and changes nothing; the key reused
+    // for a different operation, account or amount fails with
+    // IDEMPOTENCY_CONFLICT. recorded receives the service's record of a
+    // completed operation (not of a replay); the account's history holds the
+    // same object.
+    TransactionResult processDeposit(std::shared_ptr<Account> account, double amount, 
+                                     const std::string& description = "", const std::string& location = "",
+                                     const std::string& idempotency_key = "",
+                                     std::shared_ptr<Transaction>* recorded = nullptr);
+    TransactionResult processWithdrawal(std::shared_ptr<Account> account, double amount, 
+                                        const std::string& description = "", const std::string& location = "",
+                                        TransactionCategory category = TransactionCategory::OTHER,
+                                        const std::string& idempotency_key = "",
+                                        std::shared_ptr<Transaction>* recorded = nullptr);
+    TransactionResult processPayment(std::shared_ptr<Account> account, double amount, TransactionCategory category,
+                                     const std::string& description = "", const std::string& location = "",
+                                     const std::string& idempotency_key = "",
+                                     std::shared_ptr<Transaction>* recorded = nullptr);
+    TransactionResult processTransfer(std::shared_ptr<Account> from_account, std::shared_ptr<Account> to_account, 
+                                      double amount, const std::string& description = "",
+                                      const std::string& idempotency_key = "",
+                                      std::shared_ptr<Transaction>* recorded = nullptr);
+    // Split payments, fee-bearing transfers: every leg commits or none does
+    TransactionResult postJournalEntry(const std::vector<JournalLeg>& legs, const std::string& description = "");
+    
+    // Budget tracking
+    void registerBudgetManager(std::shared_ptr<BudgetManager> budget_manager);
+    void unregisterBudgetManager(int user_id);
+    BudgetDirectory& getBudgetDirectory();
+    
+    // Idempotency keys
+    IdempotencyCache& getIdempotencyCache();
+    
+    // Spending history
+    const SpendingRollups& getSpendingRollups() const;
+    // Recomputes the rollups from the accounts' own histories; run after an
+    // import rather than under live traffic
+    std::size_t rebuildSpendingRollups(const std::vector<std::shared_ptr<Account>>& accounts,
+                                       unsigned int thread_count = 0);
     
     // Batch processing
-    void processTransactionsBatch(const std::vector<TransactionRequest>& requests);
+    std::vector<TransactionResult> processTransactionsBatch(const std::vector<TransactionRequest>& requests); // In request order
     
     // Query operations
-    std::vector<std::shared_ptr<Transaction>> getTransactionHistory(int account_id);
-    std::vector<std::shared_ptr<Transaction>> getPendingTransactions();
-    std::vector<std::shared_ptr<Transaction>> getSuspiciousTransactions();
+    std::vector<std::shared_ptr<Transaction>> getTransactionHistory(int account_id); // Recent records only; see Account
+    std::vector<std::shared_ptr<Transaction>> getPendingTransactions(); // Oldest first
+    std::size_t getFailedTransactionCount();
+    std::vector<std::shared_ptr<Transaction>> getSuspiciousTransactions(); // Among recent records
     
     // Analytics
     double calculateDailyVolume(int account_id);
@@ -0,0 +1,447 @@
+#include "TransferGraph.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace {
+    constexpr std::size_t kMergeScanLimit = 16;   // Edges checked for an existing (peer, bucket) entry
+    constexpr std::size_t kDetectBatchSize = 256; // Accounts examined per shared-lock hold
+    constexpr std::size_t kMaxFanAccounts = 64;   // Counterparties listed in a fan alert
+    constexpr std::size_t kMaxCyclesPerAccount = 8;
+    constexpr std::size_t kMaxChainLength = 16;   // Accounts, origin included
+    constexpr std::size_t kMinReportedPrune = 4096;
+
+    // One step of a cycle search: `node` is reached through `via`
+    struct PathStep {
+        std::uint32_t node;
+        std::uint32_t via;
+    };
+
+    bool byNode(const PathStep& a, const PathStep& b) {
+        return a.node < b.node;
+    }
+
+    std::uint64_t mixHash(std::uint64_t hash, std::uint64_t value) {
+        // FNV-1a over the 8 bytes of value
+        for (int i = 0; i < 8; ++i) {
+            hash ^= (value >> (i * 8)) & 0xff;
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+}
+
+TransferGraph::TransferGraph(TransferGraphOptions options)
+    : options(options), current_bucket(0), edge_count(0), sweep_cursor(0),
+      reported_prune_at(kMinReportedPrune) {
+    if (options.bucket_seconds <= 0 || options.window_buckets == 0) {
+        throw std::invalid_argument("Transfer graph needs a positive bucket size and window");
+    }
+    if (options.fan_window_buckets > options.window_buckets) {
+        throw std::invalid_argument("Fan window cannot exceed the graph window");
+    }
+}
+
+void TransferGraph::recordTransfer(int from_account_id, int to_account_id, double amount, std::int64_t epoch_seconds) {
+    if (from_account_id == to_account_id || amount <= 0.0) return;
+
+    std::uint32_t bucket = static_cast<std::uint32_t>(std::max<std::int64_t>(0, epoch_seconds) / options.bucket_seconds);
+
+    std::unique_lock<std::shared_mutex> lock(graph_mutex);
+    current_bucket = std::max(current_bucket, bucket);
+
+    std::uint32_t cutoff = cutoffBucket(options.window_buckets);
+    if (bucket < cutoff) return; // Arrived after it would already have expired
+
+    std::uint32_t from = indexFor(from_account_id);
+    std::uint32_t to = indexFor(to_account_id);
+
+    std::vector<Edge>& out_edges = nodes[from].out_edges;
+    edge_count -= pruneEdges(out_edges, cutoff);
+    std::size_t before = out_edges.size();
+    addEdge(out_edges, to, bucket, static_cast<float>(amount));
+    edge_count += out_edges.size() - before;
+
+    pruneEdges(nodes[to].in_edges, cutoff);
+    addEdge(nodes[to].in_edges, from, bucket, static_cast<float>(amount));
+
+    markDirty(from);
+    markDirty(to);
+}
+
+std::vector<FraudRingAlert> TransferGraph::detect(std::size_t max_accounts) {
+    std::lock_guard<std::mutex> detect_lock(detect_mutex);
+    std::vector<std::uint32_t> work;
+
+    {
+        std::unique_lock<std::shared_mutex> lock(graph_mutex);
+        std::size_t take = (max_accounts == 0) ? dirty_nodes.size() : std::min(max_accounts, dirty_nodes.size());
+        work.assign(dirty_nodes.begin(), dirty_nodes.begin() + take);
+        dirty_nodes.erase(dirty_nodes.begin(), dirty_nodes.begin() + take);
+        for (std::uint32_t node : work) {
+            nodes[node].dirty = false;
+        }
+
+        // Reclaim edges on accounts that stopped transacting, a slice at a time
+        sweepExpired(std::max(kDetectBatchSize, work.size()));
+
+        // Forget expired alerts once the table doubles, keeping pruning amortised
+        if (reported.size() >= reported_prune_at) {
+            std::uint32_t cutoff = cutoffBucket(options.window_buckets);
+            for (auto it = reported.begin(); it != reported.end(); ) {
+                it = (it->second < cutoff) ? reported.erase(it) : std::next(it);
+            }
+            reported_prune_at = std::max(kMinReportedPrune, 2 * reported.size());
+        }
+    }
+
+    std::vector<FraudRingAlert> alerts;
+    std::vector<FraudRingAlert> candidates;
+
+    for (std::size_t start = 0; start < work.size(); start += kDetectBatchSize) {
+        std::size_t end = std::min(work.size(), start + kDetectBatchSize);
+        std::shared_lock<std::shared_mutex> lock(graph_mutex);
+
+        for (std::size_t i = start; i < end; ++i) {
+            candidates.clear();
+            detectFans(work[i], candidates);
+            detectCycles(work[i], candidates);
+            detectMuleChains(work[i], candidates);
+
+            for (auto& candidate : candidates) {
+                if (claimAlert(candidate)) {
+                    alerts.push_back(std::move(candidate));
+                }
+            }
+        }
+    }
+
+    return alerts;
+}
+
+// Getters
+const TransferGraphOptions& TransferGraph::getOptions() const {
+    return options;
+}
+
+std::size_t TransferGraph::accountCount() const {
+    std::shared_lock<std::shared_mutex> lock(graph_mutex);
+    return nodes.size();
+}
+
+std::size_t TransferGraph::edgeCount() const {
+    std::shared_lock<std::shared_mutex> lock(graph_mutex);
+    return edge_count;
+}
+
+std::size_t TransferGraph::pendingAccounts() const {
+    std::shared_lock<std::shared_mutex> lock(graph_mutex);
+    return dirty_nodes.size();
+}
+
+std::string TransferGraph::patternToString(FraudRingPattern pattern) {
+    switch (pattern) {
+        case FraudRingPattern::FAN_IN: return "Fan-In";
+        case FraudRingPattern::FAN_OUT: return "Fan-Out";
+        case FraudRingPattern::CYCLE: return "Cycle";
+        case FraudRingPattern::MULE_CHAIN: return "Mule Chain";
+        default: return "Unknown";
+    }
+}
+
+// Private methods
+std::uint32_t TransferGraph::indexFor(int account_id) {
+    // find() first: emplace() would allocate a map node even for known accounts
+    auto it = account_index.find(account_id);
+    if (it != account_index.end()) return it->second;
+    
+    std::uint32_t index = static_cast<std::uint32_t>(nodes.size());
+    account_index.emplace(account_id, index);
+    nodes.emplace_back(account_id);
+    return index;
+}
+
+void TransferGraph::addEdge(std::vector<Edge>& edges, std::uint32_t peer, std::uint32_t bucket, float amount) {
+    // Edges arrive roughly in bucket order, so a repeat transfer to the same
+    // peer in the same bucket is found within the last few entries
+    std::size_t scanned = 0;
+    for (auto it = edges.rbegin(); it != edges.rend() && scanned < kMergeScanLimit; ++it, ++scanned) {
+        if (it->bucket < bucket) break;
+        if (it->bucket == bucket && it->peer == peer) {
+            it->amount += amount;
+            ++it->count;
+            return;
+        }
+    }
+    edges.push_back(Edge{peer, bucket, amount, 1});
+}
+
+std::size_t TransferGraph::pruneEdges(std::vector<Edge>& edges, std::uint32_t cutoff) {
+    if (edges.empty() || edges.front().bucket >= cutoff) return 0;
+
+    std::size_t before = edges.size();
+    edges.erase(std::remove_if(edges.begin(), edges.end(),
+        [cutoff](const Edge& edge) { return edge.bucket < cutoff; }), edges.end());
+    if (edges.empty()) {
+        edges.shrink_to_fit();
+    }
+    return before - edges.size();
+}
+
+void TransferGraph::markDirty(std::uint32_t node) {
+    if (!nodes[node].dirty) {
+        nodes[node].dirty = true;
+        dirty_nodes.push_back(node);
+    }
+}
+
+void TransferGraph::sweepExpired(std::size_t max_nodes) {
+    if (nodes.empty()) return;
+
+    std::uint32_t cutoff = cutoffBucket(options.window_buckets);
+    std::size_t count = std::min(max_nodes, nodes.size());
+    for (std::size_t i = 0; i < count; ++i) {
+        if (sweep_cursor >= nodes.size()) sweep_cursor = 0;
+        Node& node = nodes[sweep_cursor++];
+        edge_count -= pruneEdges(node.out_edges, cutoff);
+        pruneEdges(node.in_edges, cutoff);
+    }
+}
+
+std::uint32_t TransferGraph::cutoffBucket(std::uint32_t window) const {
+    return (current_bucket >= window) ? current_bucket - window + 1 : 0;
+}
+
+void TransferGraph::detectFans(std::uint32_t node, std::vector<FraudRingAlert>& alerts) const {
+    std::uint32_t cutoff = cutoffBucket(options.fan_window_buckets);
+    std::vector<std::uint32_t> peers;
+
+    for (int direction = 0; direction < 2; ++direction) {
+        const std::vector<Edge>& edges = (direction == 0) ? nodes[node].out_edges : nodes[node].in_edges;
+        if (edges.size() < options.fan_threshold) continue;
+
+        peers.clear();
+        double total = 0.0;
+        std::uint32_t first_bucket = current_bucket;
+        std::uint32_t last_bucket = 0;
+        for (const auto& edge : edges) {
+            if (edge.bucket < cutoff) continue;
+            peers.push_back(edge.peer);
+            total += edge.amount;
+            first_bucket = std::min(first_bucket, edge.bucket);
+            last_bucket = std::max(last_bucket, edge.bucket);
+        }
+
+        std::sort(peers.begin(), peers.end());
+        peers.erase(std::unique(peers.begin(), peers.end()), peers.end());
+        if (peers.size() < options.fan_threshold) continue;
+
+        if (peers.size() > kMaxFanAccounts) peers.resize(kMaxFanAccounts);
+        peers.insert(peers.begin(), node);
+        alerts.push_back(makeAlert(direction == 0 ? FraudRingPattern::FAN_OUT : FraudRingPattern::FAN_IN,
+                                   peers, total, first_bucket, last_bucket));
+    }
+}
+
+void TransferGraph::detectCycles(std::uint32_t node, std::vector<FraudRingAlert>& alerts) const {
+    std::uint32_t cutoff = cutoffBucket(options.window_buckets);
+
+    // Distinct recent neighbours of `from` in one direction, excluding `node`
+    auto neighbours = [&](std::uint32_t from, bool outgoing, std::vector<PathStep>& result) {
+        const std::vector<Edge>& edges = outgoing ? nodes[from].out_edges : nodes[from].in_edges;
+        std::size_t begin = result.size();
+        std::size_t taken = 0;
+        for (auto it = edges.rbegin(); it != edges.rend() && taken < options.max_search_edges; ++it) {
+            if (it->bucket < cutoff || it->peer == node || it->peer == from) continue;
+            result.push_back(PathStep{it->peer, from});
+            ++taken;
+        }
+        std::sort(result.begin() + begin, result.end(), byNode);
+        result.erase(std::unique(result.begin() + begin, result.end(),
+            [](const PathStep& a, const PathStep& b) { return a.node == b.node; }), result.end());
+    };
+
+    // Meet in the middle: node -> a -> x and x -> b -> node give cycles of 3 and 4 accounts
+    std::vector<PathStep> forward1, backward1, forward2, backward2;
+    neighbours(node, true, forward1);
+    if (forward1.empty()) return;
+    neighbours(node, false, backward1);
+    if (backward1.empty()) return;
+    for (const auto& step : forward1) neighbours(step.node, true, forward2);
+    for (const auto& step : backward1) neighbours(step.node, false, backward2);
+    std::sort(forward2.begin(), forward2.end(), byNode);
+    std::sort(backward2.begin(), backward2.end(), byNode);
+
+    std::size_t found = 0;
+    std::vector<std::uint32_t> cycle;
+    auto consider = [&]() {
+        double amount;
+        std::uint32_t first_bucket, last_bucket;
+        if (isMoneyLoop(cycle, amount, first_bucket, last_bucket)) {
+            alerts.push_back(makeAlert(FraudRingPattern::CYCLE, cycle, amount, first_bucket, last_bucket));
+            ++found;
+        }
+    };
+
+    // 3 accounts: node -> a -> x -> node
+    auto back = backward1.begin();
+    for (const auto& step : forward2) {
+        if (found >= kMaxCyclesPerAccount) return;
+        while (back != backward1.end() && back->node < step.node) ++back;
+        if (back != backward1.end() && back->node == step.node) {
+            cycle.assign({node, step.via, step.node});
+            consider();
+        }
+    }
+
+    // 4 accounts: node -> a -> x -> b -> node
+    auto lower = backward2.begin();
+    for (const auto& step : forward2) {
+        while (lower != backward2.end() && lower->node < step.node) ++lower;
+        for (auto it = lower; it != backward2.end() && it->node == step.node; ++it) {
+            if (found >= kMaxCyclesPerAccount) return;
+            if (it->via == step.via) continue; // a == b is not a simple cycle
+            cycle.assign({node, step.via, step.node, it->via});
+            consider();
+        }
+    }
+}
+
+bool TransferGraph::isMoneyLoop(const std::vector<std::uint32_t>& cycle, double& loop_amount,
+                                std::uint32_t& first_bucket, std::uint32_t& last_bucket) const {
+    // Random graphs are full of short cycles; a laundering loop moves a similar
+    // amount round every hop, in order. Require hop totals within the
+    // pass-through ratio of each other and a rotation whose first transfers
+    // happen in non-decreasing time.
+    std::uint32_t cutoff = cutoffBucket(options.window_buckets);
+    std::size_t length = cycle.size();
+    double hop_amount[4];
+    std::uint32_t hop_bucket[4];
+
+    first_bucket = current_bucket;
+    last_bucket = 0;
+    for (std::size_t i = 0; i < length; ++i) {
+        std::uint32_t to = cycle[(i + 1) % length];
+        hop_amount[i] = 0.0;
+        hop_bucket[i] = current_bucket;
+        for (const auto& edge : nodes[cycle[i]].out_edges) {
+            if (edge.peer != to || edge.bucket < cutoff) continue;
+            hop_amount[i] += edge.amount;
+            hop_bucket[i] = std::min(hop_bucket[i], edge.bucket);
+            last_bucket = std::max(last_bucket, edge.bucket);
+        }
+        first_bucket = std::min(first_bucket, hop_bucket[i]);
+    }
+
+    double smallest = *std::min_element(hop_amount, hop_amount + length);
+    double largest = *std::max_element(hop_amount, hop_amount + length);
+    double tolerance = std::pow(options.chain_pass_through_ratio, static_cast<double>(length - 1));
+    if (smallest <= 0.0 || smallest < largest * tolerance) return false;
+
+    for (std::size_t start = 0; start < length; ++start) {
+        bool ordered = true;
+        for (std::size_t i = 1; i < length && ordered; ++i) {
+            ordered = hop_bucket[(start + i) % length] >= hop_bucket[(start + i - 1) % length];
+        }
+        if (ordered) {
+            loop_amount = smallest;
+            return true;
+        }
+    }
+    return false;
+}
+
+void TransferGraph::detectMuleChains(std::uint32_t node, std::vector<FraudRingAlert>& alerts) const {
+    std::uint32_t recent = cutoffBucket(options.chain_max_hop_buckets);
+    std::uint32_t cutoff = cutoffBucket(options.window_buckets);
+    const std::vector<Edge>& out_edges = nodes[node].out_edges;
+    std::vector<std::uint32_t> path;
+
+    std::size_t taken = 0;
+    for (auto out = out_edges.rbegin(); out != out_edges.rend() && taken < options.max_search_edges; ++out, ++taken) {
+        if (out->bucket < recent) continue;
+
+        // Walk upstream while each account passed on most of what it received.
+        // A mule's inflow around the hop is essentially the one deposit it
+        // forwards, which rules out busy accounts that happen to match amounts.
+        path.assign({out->peer, node});
+        std::uint32_t current = node;
+        float forwarded = out->amount;
+        std::uint32_t bucket = out->bucket;
+
+        while (path.size() < kMaxChainLength) {
+            const Edge* best = nullptr;
+            float inflow = 0.0f;
+            const std::vector<Edge>& in_edges = nodes[current].in_edges;
+            std::size_t scanned = 0;
+            for (auto in = in_edges.rbegin(); in != in_edges.rend() && scanned < options.max_search_edges; ++in, ++scanned) {
+                if (in->bucket > bucket || in->bucket < cutoff) continue;
+                if (in->bucket + options.chain_max_hop_buckets < bucket) continue;
+                inflow += in->amount;
+                if (forwarded > in->amount || forwarded < in->amount * options.chain_pass_through_ratio) continue;
+                if (std::find(path.begin(), path.end(), in->peer) != path.end()) continue;
+                if (!best || in->bucket > best->bucket) best = &*in;
+            }
+            if (!best || forwarded < inflow * options.chain_pass_through_ratio) break;
+
+            path.push_back(best->peer);
+            current = best->peer;
+            forwarded = best->amount;
+            bucket = best->bucket;
+        }
+
+        if (path.size() - 1 >= options.min_chain_hops) {
+            std::reverse(path.begin(), path.end());
+            alerts.push_back(makeAlert(FraudRingPattern::MULE_CHAIN, path, forwarded, bucket, out->bucket));
+        }
+    }
+}
+
+FraudRingAlert TransferGraph::makeAlert(FraudRingPattern pattern, const std::vector<std::uint32_t>& path,
+                                        double total_amount, std::uint32_t first_bucket, std::uint32_t last_bucket) const {
+    FraudRingAlert alert;
+    alert.pattern = pattern;
+    alert.account_ids.reserve(path.size());
+    for (std::uint32_t node : path) {
+        alert.account_ids.push_back(nodes[node].account_id);
+    }
+    alert.total_amount = total_amount;
+    alert.first_seen_epoch = static_cast<std::int64_t>(first_bucket) * options.bucket_seconds;
+    alert.last_seen_epoch = static_cast<std::int64_t>(last_bucket) * options.bucket_seconds;
+    return alert;
+}
+
+bool TransferGraph::claimAlert(const FraudRingAlert& alert) {
+    // Identify the pattern independently of where detection started: fans by
+    // their hub, chains by their first hop, cycles by their smallest rotation
+    std::uint64_t key = mixHash(14695981039346656037ull, static_cast<std::uint64_t>(alert.pattern));
+    const std::vector<int>& ids = alert.account_ids;
+
+    switch (alert.pattern) {
+        case FraudRingPattern::FAN_IN:
+        case FraudRingPattern::FAN_OUT:
+            key = mixHash(key, static_cast<std::uint32_t>(ids[0]));
+            break;
+        case FraudRingPattern::MULE_CHAIN:
+            key = mixHash(key, static_cast<std::uint32_t>(ids[0]));
+            key = mixHash(key, static_cast<std::uint32_t>(ids[1]));
+            break;
+        case FraudRingPattern::CYCLE: {
+            std::size_t start = std::min_element(ids.begin(), ids.end()) - ids.begin();
+            for (std::size_t i = 0; i < ids.size(); ++i) {
+                key = mixHash(key, static_cast<std::uint32_t>(ids[(start + i) % ids.size()]));
+            }
+            break;
+        }
+        default:
+            break;
+    }
+
+    std::uint32_t cutoff = cutoffBucket(options.window_buckets);
+    auto result = reported.emplace(key, current_bucket);
+    if (!result.second) {
+        if (result.first->second >= cutoff) return false;
+        result.first->second = current_bucket;
+    }
+    return true;
+}
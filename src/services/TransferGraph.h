@@ -0,0 +1,112 @@
+#ifndef TRANSFER_GRAPH_H
+#define TRANSFER_GRAPH_H
+
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <cstdint>
+#include <mutex>
+#include <shared_mutex>
+
+enum class FraudRingPattern {
+    FAN_IN,     // Many distinct senders into one account in a short window
+    FAN_OUT,    // One account paying many distinct receivers in a short window
+    CYCLE,      // Money returning to its origin through 2-3 other accounts
+    MULE_CHAIN  // Funds forwarded hop by hop, each hop passing most of it on
+};
+
+struct FraudRingAlert {
+    FraudRingPattern pattern;
+    std::vector<int> account_ids;  // Hub first for fan patterns, path order for cycles and chains
+    double total_amount;
+    std::int64_t first_seen_epoch; // Start of the earliest bucket involved
+    std::int64_t last_seen_epoch;  // Start of the latest bucket involved
+};
+
+struct TransferGraphOptions {
+    std::int64_t bucket_seconds = 3600;       // Edge time granularity
+    std::uint32_t window_buckets = 72;        // Edges older than this are dropped
+    std::size_t fan_threshold = 10;           // Distinct counterparties for a fan alert
+    std::uint32_t fan_window_buckets = 24;
+    std::size_t min_chain_hops = 4;
+    double chain_pass_through_ratio = 0.85;   // Forwarded / received for a mule hop
+    std::uint32_t chain_max_hop_buckets = 6;  // Max delay between receiving and forwarding
+    std::size_t max_search_edges = 64;        // Most recent edges followed per account in searches
+};
+
+// Account-to-account transfer graph maintained incrementally as transfers
+// arrive. Accounts are mapped to dense indices and each keeps compact in/out
+// edge lists aggregated per (peer, time bucket). Recording a transfer only
+// touches its two endpoints and marks them dirty; detect() then examines just
+// the dirty neighbourhoods, so scan cost follows the update rate rather than
+// the size of the graph.
+class TransferGraph {
+public:
+    explicit TransferGraph(TransferGraphOptions options = TransferGraphOptions());
+
+    void recordTransfer(int from_account_id, int to_account_id, double amount, std::int64_t epoch_seconds);
+
+    // Examines accounts touched since the last call (at most max_accounts,
+    // 0 = all) and returns patterns not already reported in the current window.
+    std::vector<FraudRingAlert> detect(std::size_t max_accounts = 0);
+
+    // Getters
+    const TransferGraphOptions& getOptions() const;
+    std::size_t accountCount() const;
+    std::size_t edgeCount() const;
+    std::size_t pendingAccounts() const;
+
+    static std::string patternToString(FraudRingPattern pattern);
+
+private:
+    struct Edge {
+        std::uint32_t peer;   // Dense index of the counterparty
+        std::uint32_t bucket; // epoch_seconds / bucket_seconds
+        float amount;         // Sum of transfers in this bucket
+        std::uint32_t count;
+    };
+
+    struct Node {
+        int account_id;
+        bool dirty;
+        std::vector<Edge> out_edges; // Roughly bucket-ordered (appended as they arrive)
+        std::vector<Edge> in_edges;
+
+        explicit Node(int id) : account_id(id), dirty(false) {}
+    };
+
+    TransferGraphOptions options;
+    std::unordered_map<int, std::uint32_t> account_index; // account_id -> dense index
+    std::vector<Node> nodes;
+    std::vector<std::uint32_t> dirty_nodes;
+    std::uint32_t current_bucket;
+    std::size_t edge_count;
+    std::size_t sweep_cursor;
+    mutable std::shared_mutex graph_mutex;
+
+    // Patterns already raised -> bucket they were raised in; touched only by detect()
+    std::unordered_map<std::uint64_t, std::uint32_t> reported;
+    std::size_t reported_prune_at;
+    std::mutex detect_mutex;
+
+    // Expect graph_mutex to be held exclusively
+    std::uint32_t indexFor(int account_id);
+    void addEdge(std::vector<Edge>& edges, std::uint32_t peer, std::uint32_t bucket, float amount);
+    std::size_t pruneEdges(std::vector<Edge>& edges, std::uint32_t cutoff); // Returns edges removed
+    void markDirty(std::uint32_t node);
+    void sweepExpired(std::size_t max_nodes);
+
+    // Expect graph_mutex to be held shared
+    std::uint32_t cutoffBucket(std::uint32_t window) const;
+    void detectFans(std::uint32_t node, std::vector<FraudRingAlert>& alerts) const;
+    void detectCycles(std::uint32_t node, std::vector<FraudRingAlert>& alerts) const;
+    bool isMoneyLoop(const std::vector<std::uint32_t>& cycle, double& loop_amount,
+                     std::uint32_t& first_bucket, std::uint32_t& last_bucket) const;
+    void detectMuleChains(std::uint32_t node, std::vector<FraudRingAlert>& alerts) const;
+    FraudRingAlert makeAlert(FraudRingPattern pattern, const std::vector<std::uint32_t>& path,
+                             double total_amount, std::uint32_t first_bucket, std::uint32_t last_bucket) const;
+
+    bool claimAlert(const FraudRingAlert& alert);
+};
+
+#endif // TRANSFER_GRAPH_H
@@ -0,0 +1,224 @@
+#include "UserDirectory.h"
+#include "../exceptions.h"
+#include <mutex>
+#include <stdexcept>
+
+// ShardedIndex implementation
+template <typename Key, typename Value>
+bool UserDirectory::ShardedIndex<Key, Value>::insert(const Key& key, const Value& value) {
+    Shard& shard = shardFor(key);
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    return shard.map.insert(key, value);
+}
+
+template <typename Key, typename Value>
+bool UserDirectory::ShardedIndex<Key, Value>::erase(const Key& key) {
+    Shard& shard = shardFor(key);
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    return shard.map.erase(key);
+}
+
+template <typename Key, typename Value>
+Value UserDirectory::ShardedIndex<Key, Value>::find(const Key& key) const {
+    const Shard& shard = shardFor(key);
+    std::shared_lock<std::shared_mutex> lock(shard.mutex);
+    const Value* value = shard.map.find(key);
+    return value ? *value : Value();
+}
+
+template <typename Key, typename Value>
+bool UserDirectory::ShardedIndex<Key, Value>::contains(const Key& key) const {
+    const Shard& shard = shardFor(key);
+    std::shared_lock<std::shared_mutex> lock(shard.mutex);
+    return shard.map.contains(key);
+}
+
+template <typename Key, typename Value>
+std::size_t UserDirectory::ShardedIndex<Key, Value>::size() const {
+    std::size_t total = 0;
+    for (const auto& shard : shards) {
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        total += shard.map.size();
+    }
+    return total;
+}
+
+template <typename Key, typename Value>
+template <typename Fn>
+auto UserDirectory::ShardedIndex<Key, Value>::update(const Key& key, Fn fn)
+    -> decltype(fn(static_cast<Value*>(nullptr))) {
+    Shard& shard = shardFor(key);
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    return fn(shard.map.find(key));
+}
+
+template <typename Key, typename Value>
+template <typename Fn>
+auto UserDirectory::ShardedIndex<Key, Value>::read(const Key& key, Fn fn) const
+    -> decltype(fn(static_cast<const Value*>(nullptr))) {
+    const Shard& shard = shardFor(key);
+    std::shared_lock<std::shared_mutex> lock(shard.mutex);
+    return fn(shard.map.find(key));
+}
+
+template <typename Key, typename Value>
+typename UserDirectory::ShardedIndex<Key, Value>::Shard&
+UserDirectory::ShardedIndex<Key, Value>::shardFor(const Key& key) {
+    // Low bits pick the shard; the maps probe with the high bits
+    return shards[OpenAddressingHash<Key>()(key) % kShardCount];
+}
+
+template <typename Key, typename Value>
+const typename UserDirectory::ShardedIndex<Key, Value>::Shard&
+UserDirectory::ShardedIndex<Key, Value>::shardFor(const Key& key) const {
+    return shards[OpenAddressingHash<Key>()(key) % kShardCount];
+}
+
+// UserDirectory implementation
+UserDirectory::UserDirectory() : next_user_id(1), next_account_id(1) {}
+
+// Users
+std::shared_ptr<User> UserDirectory::createUser(const std::string& name, const std::string& email,
+                                                const std::string& password_hash) {
+    auto user = std::make_shared<User>(next_user_id.fetch_add(1), name, email, password_hash);
+    if (!addUser(user)) {
+        throw std::invalid_argument("A user with this email already exists");
+    }
+    return user;
+}
+
+bool UserDirectory::addUser(std::shared_ptr<User> user) {
+    if (!user) {
+        throw std::invalid_argument("User cannot be null");
+    }
+
+    // The email index decides uniqueness; back out if the ID turns out to be taken
+    if (!users_by_email.insert(user->getEmail(), user)) {
+        return false;
+    }
+    if (!users_by_id.insert(user->getUserId(), user)) {
+        users_by_email.erase(user->getEmail());
+        return false;
+    }
+    reserveIds(user->getUserId(), 0);
+
+    for (const auto& account : user->getAccounts()) {
+        accounts_by_id.insert(account->getAccountId(), account);
+        reserveIds(0, account->getAccountId());
+    }
+    return true;
+}
+
+bool UserDirectory::removeUser(int user_id) {
+    auto user = users_by_id.update(user_id, [this](std::shared_ptr<User>* entry) {
+        if (!entry) return std::shared_ptr<User>();
+        for (const auto& account : (*entry)->getAccounts()) {
+            accounts_by_id.erase(account->getAccountId());
+        }
+        return *entry;
+    });
+    if (!user) return false;
+
+    users_by_id.erase(user_id);
+    users_by_email.erase(user->getEmail());
+    return true;
+}
+
+// Accounts
+std::shared_ptr<Account> UserDirectory::createAccount(int user_id, AccountType type, double initial_balance) {
+    auto account = std::make_shared<Account>(next_account_id.fetch_add(1), user_id, type, initial_balance);
+    addAccount(account);
+    return account;
+}
+
+void UserDirectory::addAccount(std::shared_ptr<Account> account) {
+    if (!account) {
+        throw InvalidAccountException("Cannot add null account");
+    }
+
+    // Lock order is always user shard, then account shard
+    int account_id = account->getAccountId();
+    users_by_id.update(account->getUserId(), [&](std::shared_ptr<User>* user) {
+        if (!user) {
+            throw InvalidAccountException("Account owner is not registered");
+        }
+        if (!accounts_by_id.insert(account_id, account)) {
+            throw InvalidAccountException("Account ID already registered");
+        }
+        try {
+            (*user)->addAccount(account);
+        } catch (...) {
+            accounts_by_id.erase(account_id);
+            throw;
+        }
+    });
+    reserveIds(0, account_id);
+    if (ledger) {
+        account->attachLedger(ledger);
+    }
+}
+
+void UserDirectory::removeAccount(int account_id) {
+    auto account = accounts_by_id.find(account_id);
+    if (!account) {
+        throw InvalidAccountException("Account not found");
+    }
+
+    users_by_id.update(account->getUserId(), [&](std::shared_ptr<User>* user) {
+        accounts_by_id.erase(account_id);
+        if (user && (*user)->hasAccount(account_id)) {
+            (*user)->removeAccount(account_id);
+        }
+    });
+}
+
+// Lookups
+std::shared_ptr<User> UserDirectory::findUser(int user_id) const {
+    return users_by_id.find(user_id);
+}
+
+std::shared_ptr<User> UserDirectory::findUserByEmail(const std::string& email) const {
+    return users_by_email.find(email);
+}
+
+std::shared_ptr<Account> UserDirectory::findAccount(int account_id) const {
+    return accounts_by_id.find(account_id);
+}
+
+std::vector<std::shared_ptr<Account>> UserDirectory::getUserAccounts(int user_id) const {
+    // Account lists change under the user's shard lock, so copy under it too
+    return users_by_id.read(user_id, [](const std::shared_ptr<User>* user) {
+        return user ? (*user)->getAccounts() : std::vector<std::shared_ptr<Account>>();
+    });
+}
+
+bool UserDirectory::hasEmail(const std::string& email) const {
+    return users_by_email.contains(email);
+}
+
+// Getters
+std::size_t UserDirectory::userCount() const {
+    return users_by_id.size();
+}
+
+std::size_t UserDirectory::accountCount() const {
+    return accounts_by_id.size();
+}
+
+void UserDirectory::setLedger(std::shared_ptr<Ledger> ledger) {
+    this->ledger = std::move(ledger);
+}
+
+std::shared_ptr<Ledger> UserDirectory::getLedger() const {
+    return ledger;
+}
+
+// Private methods
+void UserDirectory::reserveIds(int user_id, int account_id) {
+    int next = next_user_id.load();
+    while (user_id >= next && !next_user_id.compare_exchange_weak(next, user_id + 1)) {
+    }
+    next = next_account_id.load();
+    while (account_id >= next && !next_account_id.compare_exchange_weak(next, account_id + 1)) {
+    }
+}
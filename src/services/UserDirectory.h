@@ -0,0 +1,97 @@
+#ifndef USER_DIRECTORY_H
+#define USER_DIRECTORY_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <array>
+#include <atomic>
+#include <shared_mutex>
+#include "../models/User.h"
+#include "../models/Account.h"
+#include "../models/Ledger.h"
+#include "../utils/OpenAddressingMap.h"
+
+// Thread-safe registry of users and accounts, indexed by email, user ID and
+// account ID. Each index is split into independently locked shards of flat
+// open-addressing tables, so lookups from concurrent request threads are a
+// shared lock plus an O(1) probe and rarely contend.
+//
+// Account lists on User are not synchronised themselves: add and remove
+// accounts through the directory, which serialises changes per user.
+class UserDirectory {
+public:
+    static constexpr std::size_t kShardCount = 16;
+
+    UserDirectory();
+
+    UserDirectory(const UserDirectory&) = delete;
+    UserDirectory& operator=(const UserDirectory&) = delete;
+
+    // Users
+    std::shared_ptr<User> createUser(const std::string& name, const std::string& email,
+                                     const std::string& password_hash); // Throws if the email is taken
+    bool addUser(std::shared_ptr<User> user); // False if the ID or email is already registered
+    bool removeUser(int user_id);              // Also drops the user's accounts from the index
+
+    // Accounts
+    std::shared_ptr<Account> createAccount(int user_id, AccountType type, double initial_balance = 0.0);
+    void addAccount(std::shared_ptr<Account> account);
+    void removeAccount(int account_id);
+
+    // Lookups
+    std::shared_ptr<User> findUser(int user_id) const;
+    std::shared_ptr<User> findUserByEmail(const std::string& email) const;
+    std::shared_ptr<Account> findAccount(int account_id) const;
+    std::vector<std::shared_ptr<Account>> getUserAccounts(int user_id) const; // Snapshot; empty for unknown users
+    bool hasEmail(const std::string& email) const;
+
+    // Getters
+    std::size_t userCount() const;
+    std::size_t accountCount() const;
+
+    // Accounts added after this are attached to the ledger. Set it before
+    // the directory is shared between threads. The ledger is optional and
+    // keeps every balance change until Ledger::compact() is called.
+    void setLedger(std::shared_ptr<Ledger> ledger);
+    std::shared_ptr<Ledger> getLedger() const;
+
+private:
+    template <typename Key, typename Value>
+    class ShardedIndex {
+    public:
+        bool insert(const Key& key, const Value& value);
+        bool erase(const Key& key);
+        Value find(const Key& key) const; // Value() when absent
+        bool contains(const Key& key) const;
+        std::size_t size() const;
+
+        // Runs fn(value_or_null) with the key's shard locked exclusively
+        template <typename Fn>
+        auto update(const Key& key, Fn fn) -> decltype(fn(static_cast<Value*>(nullptr)));
+        // Runs fn(value_or_null) with the key's shard locked shared
+        template <typename Fn>
+        auto read(const Key& key, Fn fn) const -> decltype(fn(static_cast<const Value*>(nullptr)));
+
+    private:
+        struct Shard {
+            OpenAddressingMap<Key, Value> map;
+            mutable std::shared_mutex mutex;
+        };
+        std::array<Shard, kShardCount> shards;
+
+        Shard& shardFor(const Key& key);
+        const Shard& shardFor(const Key& key) const;
+    };
+
+    ShardedIndex<std::string, std::shared_ptr<User>> users_by_email;
+    ShardedIndex<int, std::shared_ptr<User>> users_by_id;
+    ShardedIndex<int, std::shared_ptr<Account>> accounts_by_id;
+    std::atomic<int> next_user_id;
+    std::atomic<int> next_account_id;
+    std::shared_ptr<Ledger> ledger;
+
+    void reserveIds(int user_id, int account_id); // Keep generated IDs above externally added ones
+};
+
+#endif // USER_DIRECTORY_H
@@ -0,0 +1,84 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include "services/FraudBacktester.h"
+#include "utils/TimeZone.h"
+
+namespace {
+    void printUsage(const char* program) {
+        std::cerr << "Usage: " << program << " <ledger.csv | -> [options]\n"
+                  << "\n"
+                  << "Replays a historical ledger through the fraud rules and compares rule sets.\n"
+                  << "\n"
+                  << "Options:\n"
+                  << "  --ruleset NAME:SPEC   Candidate rule set, e.g.\n"
+                  << "                        \"strict:High Value Transaction=2000,Unusual Time=off\"\n"
+                  << "                        (repeatable; rules not listed keep their defaults)\n"
+                  << "  --workers N           Worker threads (default: hardware threads)\n"
+                  << "  --batch-size N        Rows per worker batch (default: 4096)\n"
+                  << "  --timezone ZONE       Zone used for time-of-day rules (default: UTC)\n"
+                  << "\n"
+                  << "Ledger columns:\n"
+                  << "  transaction_id,account_id,to_account_id,amount,type,category,timestamp,location,label\n";
+    }
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    std::string input_path = argv[1];
+    std::vector<FraudRuleSet> rule_sets;
+    BacktestOptions options;
+
+    try {
+        rule_sets.push_back(FraudBacktester::parseRuleSet("baseline"));
+
+        for (int i = 2; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (i + 1 >= argc) {
+                printUsage(argv[0]);
+                return 1;
+            }
+            std::string value = argv[++i];
+
+            if (arg == "--ruleset") {
+                rule_sets.push_back(FraudBacktester::parseRuleSet(value));
+            } else if (arg == "--workers") {
+                options.worker_count = static_cast<unsigned>(std::strtoul(value.c_str(), nullptr, 10));
+            } else if (arg == "--batch-size") {
+                options.batch_size = std::strtoull(value.c_str(), nullptr, 10);
+            } else if (arg == "--timezone") {
+                options.time_zone = TimeZone::get(value);
+            } else {
+                printUsage(argv[0]);
+                return 1;
+            }
+        }
+
+        FraudBacktester backtester(rule_sets, options);
+        BacktestReport report;
+
+        if (input_path == "-") {
+            report = backtester.run(std::cin);
+        } else {
+            std::ifstream input(input_path);
+            if (!input) {
+                std::cerr << "Error: cannot open " << input_path << "\n";
+                return 1;
+            }
+            report = backtester.run(input);
+        }
+
+        FraudBacktester::printReport(report, std::cout);
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,192 @@
+#include <array>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <cstdlib>
+#include "services/LoadGenerator.h"
+#include "utils/Metrics.h"
+#include "utils/Logger.h"
+#include "utils/LockProfiler.h"
+#include "models/Ledger.h"
+
+namespace {
+    void printUsage(const char* program) {
+        std::cerr << "Usage: " << program << " [options]\n"
+                  << "\n"
+                  << "Drives the transaction and fraud services open-loop with synthetic traffic\n"
+                  << "and reports throughput and latency percentiles.\n"
+                  << "\n"
+                  << "Options:\n"
+                  << "  --users N             Synthetic users (default: 1000)\n"
+                  << "  --accounts-per-user N Accounts per user (default: 2)\n"
+                  << "  --balance AMOUNT      Opening balance per account (default: 5000)\n"
+                  << "  --zipf S              Account popularity skew, 0 = uniform (default: 1.1)\n"
+                  << "  --mix D,W,T           Deposit, withdrawal, transfer weights (default: 40,35,25)\n"
+                  << "  --amounts MIN,MAX     Log-uniform amount range (default: 1,500)\n"
+                  << "  --remote FRACTION     Share of operations away from home (default: 0.02)\n"
+                  << "  --rate N              Mean offered operations per second (default: 20000)\n"
+                  << "  --duration SECS       Length of the schedule (default: 10)\n"
+                  << "  --operations N        Schedule exactly N operations instead\n"
+                  << "  --burst F,PERIOD,DUTY Rate x F for DUTY of every PERIOD seconds (default: off)\n"
+                  << "  --workers N           Worker threads (default: hardware threads)\n"
+                  << "  --no-fraud            Skip fraud screening of completed operations\n"
+                  << "  --seed N              Schedule seed (default: 1)\n"
+                  << "  --metrics FILE        Record engine metrics and write them to FILE (Prometheus text)\n"
+                  << "  --log FILE            Append the engine's JSON log lines to FILE (default: off)\n"
+                  << "  --log-level LEVEL     debug, info, warn or error (default: warn)\n"
+                  << "  --ledger FILE         Record every balance change and write the event log to FILE\n"
+                  << "                        (replay it with fintrack_replay)\n"
+                  << "  --locks N             Report lock contention and the N hottest account locks\n"
+                  << "                        (needs a -DFINTRACK_LOCK_PROFILING=ON build)\n";
+    }
+
+    // Fills up to values.size() comma-separated numbers; false if any is missing
+    template <std::size_t N>
+    bool parseList(const std::string& text, std::array<double, N>& values) {
+        const char* cursor = text.c_str();
+        for (std::size_t i = 0; i < N; ++i) {
+            char* end = nullptr;
+            values[i] = std::strtod(cursor, &end);
+            if (end == cursor || (i + 1 < N ? *end != ',' : *end != '\0')) {
+                return false;
+            }
+            cursor = end + 1;
+        }
+        return true;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    LoadProfile profile;
+    std::string metrics_path;
+    std::string log_path;
+    std::string ledger_path;
+    LogLevel log_level = LogLevel::WARN;
+    std::size_t lock_report_keys = 0;
+    bool lock_report = false;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--no-fraud") {
+            profile.fraud_screening = false;
+            continue;
+        }
+        if (arg == "--help" || arg == "-h" || i + 1 >= argc) {
+            printUsage(argv[0]);
+            return arg == "--help" || arg == "-h" ? 0 : 1;
+        }
+        std::string value = argv[++i];
+        bool valid = true;
+
+        if (arg == "--users") {
+            profile.users = std::strtoull(value.c_str(), nullptr, 10);
+        } else if (arg == "--accounts-per-user") {
+            profile.accounts_per_user = std::strtoull(value.c_str(), nullptr, 10);
+        } else if (arg == "--balance") {
+            profile.initial_balance = std::strtod(value.c_str(), nullptr);
+        } else if (arg == "--zipf") {
+            profile.zipf_exponent = std::strtod(value.c_str(), nullptr);
+        } else if (arg == "--mix") {
+            valid = parseList(value, profile.mix);
+        } else if (arg == "--amounts") {
+            std::array<double, 2> range{};
+            valid = parseList(value, range);
+            profile.min_amount = range[0];
+            profile.max_amount = range[1];
+        } else if (arg == "--remote") {
+            profile.remote_share = std::strtod(value.c_str(), nullptr);
+        } else if (arg == "--rate") {
+            profile.rate = std::strtod(value.c_str(), nullptr);
+        } else if (arg == "--duration") {
+            profile.duration_seconds = std::strtod(value.c_str(), nullptr);
+        } else if (arg == "--operations") {
+            profile.operations = std::strtoull(value.c_str(), nullptr, 10);
+        } else if (arg == "--burst") {
+            std::array<double, 3> burst{};
+            valid = parseList(value, burst);
+            profile.burst_factor = burst[0];
+            profile.burst_period_seconds = burst[1];
+            profile.burst_duty = burst[2];
+        } else if (arg == "--workers") {
+            profile.worker_count = static_cast<unsigned>(std::strtoul(value.c_str(), nullptr, 10));
+        } else if (arg == "--seed") {
+            profile.seed = std::strtoull(value.c_str(), nullptr, 10);
+        } else if (arg == "--metrics") {
+            metrics_path = value;
+        } else if (arg == "--ledger") {
+            ledger_path = value;
+        } else if (arg == "--locks") {
+            lock_report = true;
+            lock_report_keys = std::strtoull(value.c_str(), nullptr, 10);
+        } else if (arg == "--log") {
+            log_path = value;
+        } else if (arg == "--log-level") {
+            try {
+                log_level = Logger::stringToLogLevel(value);
+            } catch (const std::invalid_argument&) {
+                valid = false;
+            }
+        } else {
+            valid = false;
+        }
+
+        if (!valid) {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    try {
+        LoadGenerator generator(profile);
+        MetricsRegistry::setEnabled(!metrics_path.empty());
+        std::shared_ptr<Ledger> ledger;
+        if (!ledger_path.empty()) {
+            ledger = std::make_shared<Ledger>();
+            generator.setLedger(ledger);
+        }
+
+        // Engine log lines (fraud alerts, batch reports) would bury the report,
+        // so they are off unless sent to a file
+        Logger& logger = Logger::instance();
+        if (log_path.empty()) {
+            logger.setLevel(LogLevel::OFF);
+        } else if (logger.setOutputFile(log_path)) {
+            logger.setLevel(log_level);
+        } else {
+            std::cerr << "Error: cannot open " << log_path << "\n";
+            return 1;
+        }
+
+        std::cerr << "Scheduled " << generator.getScheduledCount() << " operations; running..." << std::endl;
+        LoadReport report = generator.run();
+        logger.flush();
+        if (logger.getDroppedCount() > 0) {
+            std::cerr << "Warning: " << logger.getDroppedCount() << " log lines dropped\n";
+        }
+
+        LoadGenerator::printReport(report, std::cout);
+        if (lock_report) {
+            std::cout << "\n";
+            LockProfiler::instance().writeReport(std::cout, lock_report_keys);
+        }
+        if (ledger) {
+            std::ofstream ledger_file(ledger_path);
+            ledger->writeLog(ledger_file);
+            if (!ledger_file) {
+                std::cerr << "Error: cannot write " << ledger_path << "\n";
+                return 1;
+            }
+        }
+        if (!metrics_path.empty() && !MetricsRegistry::instance().writePrometheusFile(metrics_path)) {
+            std::cerr << "Error: cannot write " << metrics_path << "\n";
+            return 1;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+
+    return 0;
+}
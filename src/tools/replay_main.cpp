@@ -0,0 +1,94 @@
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include "models/Ledger.h"
+#include "services/LedgerReplayer.h"
+
+namespace {
+    void printUsage(const char* program) {
+        std::cerr << "Usage: " << program << " <ledger.csv | -> [options]\n"
+                  << "\n"
+                  << "Rebuilds account state from a ledger event log (as written by\n"
+                  << "fintrack_loadgen --ledger) and prints its state digest.\n"
+                  << "\n"
+                  << "Options:\n"
+                  << "  --workers N           Worker threads (default: hardware threads)\n"
+                  << "  --account ID          Also print this account's balance at --at\n"
+                  << "  --at EPOCH_SECONDS    Point in time for --account (default: now)\n";
+    }
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    std::string input_path = argv[1];
+    unsigned int worker_count = 0;
+    int account_id = -1;
+    auto at = std::chrono::system_clock::now();
+
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            printUsage(argv[0]);
+            return 1;
+        }
+        std::string value = argv[++i];
+
+        if (arg == "--workers") {
+            worker_count = static_cast<unsigned>(std::strtoul(value.c_str(), nullptr, 10));
+        } else if (arg == "--account") {
+            account_id = std::atoi(value.c_str());
+        } else if (arg == "--at") {
+            at = std::chrono::system_clock::time_point(std::chrono::duration_cast<std::chrono::system_clock::duration>(
+                std::chrono::duration<double>(std::strtod(value.c_str(), nullptr))));
+        } else {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    try {
+        std::vector<LedgerEvent> events;
+        if (input_path == "-") {
+            events = Ledger::readLog(std::cin);
+        } else {
+            std::ifstream input(input_path);
+            if (!input) {
+                std::cerr << "Error: cannot open " << input_path << "\n";
+                return 1;
+            }
+            events = Ledger::readLog(input);
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        LedgerReplayResult result = LedgerReplayer::replay(events, worker_count);
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        std::cout << "Replayed " << result.events << " events into " << result.accounts.size() << " accounts in "
+                  << std::fixed << std::setprecision(3) << elapsed * 1000.0 << " ms ("
+                  << std::setprecision(0) << (elapsed > 0.0 ? result.events / elapsed : 0.0) << " events/s)\n"
+                  << "Total balance: " << std::setprecision(2) << result.total_balance << "\n"
+                  << "State digest: " << std::hex << std::setw(16) << std::setfill('0') << result.digest
+                  << std::dec << std::setfill(' ') << "\n";
+
+        if (account_id >= 0) {
+            Ledger ledger;
+            ledger.load(events);
+            std::cout << "Account " << account_id << " balance at "
+                      << std::chrono::duration_cast<std::chrono::seconds>(at.time_since_epoch()).count() << ": "
+                      << ledger.getBalanceAt(account_id, at) << "\n";
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+
+    return 0;
+}
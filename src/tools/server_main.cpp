@@ -0,0 +1,131 @@
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <cstdlib>
+#include <stdexcept>
+#include <csignal>
+#include <pthread.h>
+#include "server/HttpServer.h"
+#include "server/FinTrackApi.h"
+#include "services/UserDirectory.h"
+#include "services/TransactionService.h"
+#include "services/FraudDetectionService.h"
+#include "utils/Metrics.h"
+#include "utils/Logger.h"
+
+namespace {
+    void printUsage(const char* program) {
+        std::cerr << "Usage: " << program << " [options]\n"
+                  << "\n"
+                  << "Serves the FinTrack engine as an HTTP/JSON API until interrupted.\n"
+                  << "\n"
+                  << "Options:\n"
+                  << "  --host ADDRESS        Address to listen on (default: 127.0.0.1)\n"
+                  << "  --port N              Port to listen on (default: 8080)\n"
+                  << "  --workers N           Request worker threads (default: hardware threads)\n"
+                  << "  --queue N             Requests waiting for a worker before 503s (default: 1024)\n"
+                  << "  --idle-timeout SECS   Close idle keep-alive connections (default: 60)\n"
+                  << "  --idempotency-keys N  Idempotency keys remembered, 40 bytes each (default: 1048576)\n"
+                  << "  --idempotency-ttl SECS\n"
+                  << "                        How long a key's result is replayed (default: 86400)\n"
+                  << "  --no-metrics          Stop recording the metrics served at /metrics\n"
+                  << "  --log FILE            Append JSON log lines to FILE (default: stderr)\n"
+                  << "  --log-level LEVEL     debug, info, warn, error or off (default: info)\n";
+    }
+}
+
+int main(int argc, char* argv[]) {
+    HttpServerOptions options;
+    bool metrics = true;
+    std::string log_path;
+    LogLevel log_level = LogLevel::INFO;
+    std::size_t idempotency_keys = IdempotencyCache::kDefaultCapacity;
+    std::chrono::seconds idempotency_ttl = IdempotencyCache::kDefaultTtl;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--no-metrics") {
+            metrics = false;
+            continue;
+        }
+        if (arg == "--help" || arg == "-h" || i + 1 >= argc) {
+            printUsage(argv[0]);
+            return arg == "--help" || arg == "-h" ? 0 : 1;
+        }
+        std::string value = argv[++i];
+
+        if (arg == "--host") {
+            options.host = value;
+        } else if (arg == "--port") {
+            options.port = static_cast<std::uint16_t>(std::strtoul(value.c_str(), nullptr, 10));
+        } else if (arg == "--workers") {
+            options.worker_threads = static_cast<unsigned>(std::strtoul(value.c_str(), nullptr, 10));
+        } else if (arg == "--queue") {
+            options.queue_capacity = std::strtoull(value.c_str(), nullptr, 10);
+        } else if (arg == "--idle-timeout") {
+            options.idle_timeout_seconds = std::atoi(value.c_str());
+        } else if (arg == "--idempotency-keys") {
+            idempotency_keys = std::strtoull(value.c_str(), nullptr, 10);
+        } else if (arg == "--idempotency-ttl") {
+            idempotency_ttl = std::chrono::seconds(std::strtoll(value.c_str(), nullptr, 10));
+        } else if (arg == "--log") {
+            log_path = value;
+        } else if (arg == "--log-level") {
+            try {
+                log_level = Logger::stringToLogLevel(value);
+            } catch (const std::invalid_argument&) {
+                printUsage(argv[0]);
+                return 1;
+            }
+        } else {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    // Block the shutdown signals before any thread starts so that only the
+    // sigwait below ever receives them
+    sigset_t shutdown_signals;
+    sigemptyset(&shutdown_signals);
+    sigaddset(&shutdown_signals, SIGINT);
+    sigaddset(&shutdown_signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &shutdown_signals, nullptr);
+    MetricsRegistry::setEnabled(metrics);
+
+    // After the mask, so the logger's writer thread inherits it
+    Logger& logger = Logger::instance();
+    logger.setLevel(log_level);
+    if (!log_path.empty() && !logger.setOutputFile(log_path)) {
+        std::cerr << "Error: cannot open " << log_path << "\n";
+        return 1;
+    }
+
+    try {
+        UserDirectory user_directory;
+        TransactionService transaction_service;
+        transaction_service.getIdempotencyCache().resize(idempotency_keys, idempotency_ttl);
+        FraudDetectionService fraud_service;
+        FinTrackApi api(user_directory, transaction_service, fraud_service);
+
+        HttpServer server(options, [&api](const HttpRequest& request) { return api.handle(request); });
+        fraud_service.startService();
+        server.start();
+        std::cout << "FinTrack API listening on http://" << options.host << ":" << server.getPort() << std::endl;
+
+        int received = 0;
+        sigwait(&shutdown_signals, &received);
+
+        std::cout << "\nShutting down..." << std::endl;
+        server.stop();
+        fraud_service.stopService();
+
+        HttpServerStats stats = server.getStats();
+        std::cout << "Served " << stats.requests_handled << " requests on " << stats.connections_accepted
+                  << " connections (" << stats.requests_rejected << " rejected while busy)" << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+
+    return 0;
+}
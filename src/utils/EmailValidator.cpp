@@ -0,0 +1,72 @@
+#include "EmailValidator.h"
+#include <array>
+#include <cstdint>
+#include <cstring>
+
+namespace {
+    enum CharClass : std::uint8_t {
+        kLocal = 1,  // [a-zA-Z0-9._%+-]
+        kDomain = 2, // [a-zA-Z0-9.-]
+        kAlpha = 4   // [a-zA-Z]
+    };
+
+    constexpr std::array<std::uint8_t, 256> buildClassTable() {
+        std::array<std::uint8_t, 256> table{};
+        for (int c = 'a'; c <= 'z'; ++c) table[c] = kLocal | kDomain | kAlpha;
+        for (int c = 'A'; c <= 'Z'; ++c) table[c] = kLocal | kDomain | kAlpha;
+        for (int c = '0'; c <= '9'; ++c) table[c] = kLocal | kDomain;
+        table['.'] = kLocal | kDomain;
+        table['-'] = kLocal | kDomain;
+        table['_'] = kLocal;
+        table['%'] = kLocal;
+        table['+'] = kLocal;
+        return table;
+    }
+
+    constexpr std::array<std::uint8_t, 256> kClassTable = buildClassTable();
+
+    bool isAscii(const char* data, std::size_t length) {
+        constexpr std::uint64_t kHighBits = 0x8080808080808080ull;
+        std::size_t i = 0;
+        for (; i + 8 <= length; i += 8) {
+            std::uint64_t word;
+            std::memcpy(&word, data + i, sizeof(word));
+            if (word & kHighBits) return false;
+        }
+        for (; i < length; ++i) {
+            if (static_cast<unsigned char>(data[i]) & 0x80) return false;
+        }
+        return true;
+    }
+}
+
+bool EmailValidator::isValid(std::string_view email) {
+    const char* data = email.data();
+    std::size_t length = email.size();
+    // Shortest match is "a@b.cc"
+    if (length < 6 || !isAscii(data, length)) return false;
+
+    // Local part: one or more local characters up to the '@'
+    std::size_t i = 0;
+    while (i < length && (kClassTable[static_cast<unsigned char>(data[i])] & kLocal)) ++i;
+    if (i == 0 || i == length || data[i] != '@') return false;
+
+    // Domain: only domain characters; the last '.' must have at least one
+    // character before it and two or more letters after it
+    std::size_t domain_start = ++i;
+    std::size_t last_dot = std::string_view::npos;
+    std::uint8_t tld_classes = kAlpha;
+    for (; i < length; ++i) {
+        std::uint8_t classes = kClassTable[static_cast<unsigned char>(data[i])];
+        if (!(classes & kDomain)) return false;
+        if (data[i] == '.') {
+            last_dot = i;
+            tld_classes = kAlpha;
+        } else {
+            tld_classes &= classes;
+        }
+    }
+
+    return last_dot != std::string_view::npos && last_dot > domain_start &&
+           length - last_dot - 1 >= 2 && (tld_classes & kAlpha);
+}
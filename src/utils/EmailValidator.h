@@ -0,0 +1,17 @@
+#ifndef EMAIL_VALIDATOR_H
+#define EMAIL_VALIDATOR_H
+
+#include <string_view>
+
+// Hand-written matcher for the address pattern users have always been held to:
+//   [a-zA-Z0-9._%+-]+@[a-zA-Z0-9.-]+\.[a-zA-Z]{2,}
+// It accepts exactly the strings std::regex_match accepts for that pattern,
+// using one character-class table lookup per byte and no allocation. The
+// pattern is pure ASCII, so input containing any byte >= 0x80 is rejected
+// eight bytes at a time before the per-character pass.
+class EmailValidator {
+public:
+    static bool isValid(std::string_view email);
+};
+
+#endif // EMAIL_VALIDATOR_H
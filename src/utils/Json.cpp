@@ -0,0 +1,354 @@
+#include "Json.h"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+
+// JsonWriter implementation
+JsonWriter& JsonWriter::beginObject() {
+    separate();
+    out.push_back('{');
+    need_comma = false;
+    return *this;
+}
+
+JsonWriter& JsonWriter::endObject() {
+    out.push_back('}');
+    need_comma = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::beginArray() {
+    separate();
+    out.push_back('[');
+    need_comma = false;
+    return *this;
+}
+
+JsonWriter& JsonWriter::endArray() {
+    out.push_back(']');
+    need_comma = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::key(std::string_view name) {
+    separate();
+    appendEscaped(out, name);
+    out.push_back(':');
+    need_comma = false;
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(std::string_view text) {
+    separate();
+    appendEscaped(out, text);
+    need_comma = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(const char* text) {
+    return value(std::string_view(text));
+}
+
+JsonWriter& JsonWriter::value(double number) {
+    separate();
+    if (std::isfinite(number)) {
+        char buffer[32];
+        int length = std::snprintf(buffer, sizeof(buffer), "%.15g", number);
+        out.append(buffer, static_cast<std::size_t>(length));
+    } else {
+        out.append("null"); // JSON has no NaN or infinity
+    }
+    need_comma = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(std::int64_t number) {
+    separate();
+    out.append(std::to_string(number));
+    need_comma = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(int number) {
+    return value(static_cast<std::int64_t>(number));
+}
+
+JsonWriter& JsonWriter::value(std::uint64_t number) {
+    separate();
+    out.append(std::to_string(number));
+    need_comma = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(bool flag) {
+    separate();
+    out.append(flag ? "true" : "false");
+    need_comma = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::null() {
+    separate();
+    out.append("null");
+    need_comma = true;
+    return *this;
+}
+
+const std::string& JsonWriter::str() const {
+    return out;
+}
+
+std::string JsonWriter::take() {
+    need_comma = false;
+    return std::move(out);
+}
+
+void JsonWriter::appendEscaped(std::string& out, std::string_view text) {
+    out.push_back('"');
+    for (char c : text) {
+        switch (c) {
+            case '"': out.append("\\\""); break;
+            case '\\': out.append("\\\\"); break;
+            case '\n': out.append("\\n"); break;
+            case '\r': out.append("\\r"); break;
+            case '\t': out.append("\\t"); break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char buffer[8];
+                    std::snprintf(buffer, sizeof(buffer), "\\u%04x", static_cast<unsigned>(c));
+                    out.append(buffer);
+                } else {
+                    out.push_back(c);
+                }
+        }
+    }
+    out.push_back('"');
+}
+
+void JsonWriter::separate() {
+    if (need_comma) {
+        out.push_back(',');
+    }
+}
+
+// JsonObject implementation
+namespace {
+    class FlatParser {
+    public:
+        explicit FlatParser(std::string_view input) : input(input), position(0) {}
+
+        void skipSpace() {
+            while (position < input.size() && (input[position] == ' ' || input[position] == '\t' ||
+                                               input[position] == '\n' || input[position] == '\r')) {
+                ++position;
+            }
+        }
+
+        bool consume(char expected) {
+            skipSpace();
+            if (position < input.size() && input[position] == expected) {
+                ++position;
+                return true;
+            }
+            return false;
+        }
+
+        void expect(char expected) {
+            if (!consume(expected)) fail("expected '" + std::string(1, expected) + "'");
+        }
+
+        bool atEnd() {
+            skipSpace();
+            return position == input.size();
+        }
+
+        std::string parseString() {
+            skipSpace();
+            if (position >= input.size() || input[position] != '"') fail("expected string");
+            ++position;
+
+            std::string result;
+            while (position < input.size()) {
+                char c = input[position++];
+                if (c == '"') return result;
+                if (c != '\\') {
+                    result.push_back(c);
+                    continue;
+                }
+                if (position >= input.size()) break;
+                char escape = input[position++];
+                switch (escape) {
+                    case '"': result.push_back('"'); break;
+                    case '\\': result.push_back('\\'); break;
+                    case '/': result.push_back('/'); break;
+                    case 'b': result.push_back('\b'); break;
+                    case 'f': result.push_back('\f'); break;
+                    case 'n': result.push_back('\n'); break;
+                    case 'r': result.push_back('\r'); break;
+                    case 't': result.push_back('\t'); break;
+                    case 'u': appendCodePoint(result); break;
+                    default: fail("bad escape");
+                }
+            }
+            fail("unterminated string");
+            return result;
+        }
+
+        JsonValue parseScalar() {
+            skipSpace();
+            JsonValue value;
+            if (position >= input.size()) fail("expected value");
+
+            char c = input[position];
+            if (c == '"') {
+                value.type = JsonValue::Type::STRING;
+                value.text = parseString();
+            } else if (matchWord("true")) {
+                value.type = JsonValue::Type::BOOLEAN;
+                value.boolean = true;
+            } else if (matchWord("false")) {
+                value.type = JsonValue::Type::BOOLEAN;
+            } else if (matchWord("null")) {
+                value.type = JsonValue::Type::NUL;
+            } else if (c == '-' || (c >= '0' && c <= '9')) {
+                std::string number;
+                while (position < input.size() && std::string_view("+-.eE0123456789").find(input[position]) !=
+                                                  std::string_view::npos) {
+                    number.push_back(input[position++]);
+                }
+                char* end = nullptr;
+                value.number = std::strtod(number.c_str(), &end);
+                if (end != number.c_str() + number.size()) fail("bad number");
+                value.type = JsonValue::Type::NUMBER;
+            } else {
+                fail("expected a string, number, boolean or null");
+            }
+            return value;
+        }
+
+        [[noreturn]] void fail(const std::string& what) const {
+            throw std::invalid_argument("Invalid JSON at offset " + std::to_string(position) + ": " + what);
+        }
+
+    private:
+        std::string_view input;
+        std::size_t position;
+
+        bool matchWord(std::string_view word) {
+            if (input.substr(position, word.size()) == word) {
+                position += word.size();
+                return true;
+            }
+            return false;
+        }
+
+        unsigned parseHex4() {
+            if (position + 4 > input.size()) fail("bad \\u escape");
+            unsigned code = 0;
+            for (int i = 0; i < 4; ++i) {
+                char h = input[position++];
+                code <<= 4;
+                if (h >= '0' && h <= '9') code |= static_cast<unsigned>(h - '0');
+                else if (h >= 'a' && h <= 'f') code |= static_cast<unsigned>(h - 'a' + 10);
+                else if (h >= 'A' && h <= 'F') code |= static_cast<unsigned>(h - 'A' + 10);
+                else fail("bad \\u escape");
+            }
+            return code;
+        }
+
+        void appendCodePoint(std::string& out) {
+            unsigned code = parseHex4();
+            if (code >= 0xDC00 && code <= 0xDFFF) fail("unpaired surrogate");
+            if (code >= 0xD800 && code <= 0xDBFF) {
+                // Half a pair would encode as invalid UTF-8
+                if (input.substr(position, 2) != "\\u") fail("unpaired surrogate");
+                position += 2;
+                unsigned low = parseHex4();
+                if (low < 0xDC00 || low > 0xDFFF) fail("bad surrogate pair");
+                code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+            }
+            // UTF-8 encode
+            if (code < 0x80) {
+                out.push_back(static_cast<char>(code));
+            } else if (code < 0x800) {
+                out.push_back(static_cast<char>(0xC0 | (code >> 6)));
+                out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+            } else if (code < 0x10000) {
+                out.push_back(static_cast<char>(0xE0 | (code >> 12)));
+                out.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
+                out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+            } else {
+                out.push_back(static_cast<char>(0xF0 | (code >> 18)));
+                out.push_back(static_cast<char>(0x80 | ((code >> 12) & 0x3F)));
+                out.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
+                out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+            }
+        }
+    };
+}
+
+JsonObject JsonObject::parse(std::string_view input) {
+    JsonObject object;
+    FlatParser parser(input);
+
+    parser.expect('{');
+    if (!parser.consume('}')) {
+        do {
+            std::string name = parser.parseString();
+            parser.expect(':');
+            object.fields[name] = parser.parseScalar();
+        } while (parser.consume(','));
+        parser.expect('}');
+    }
+    if (!parser.atEnd()) {
+        parser.fail("trailing data");
+    }
+    return object;
+}
+
+bool JsonObject::has(const std::string& name) const {
+    auto it = fields.find(name);
+    return it != fields.end() && it->second.type != JsonValue::Type::NUL;
+}
+
+std::string JsonObject::getString(const std::string& name, const std::string& fallback) const {
+    auto it = fields.find(name);
+    if (it == fields.end() || it->second.type == JsonValue::Type::NUL) return fallback;
+    if (it->second.type != JsonValue::Type::STRING) {
+        throw std::invalid_argument("Field '" + name + "' must be a string");
+    }
+    return it->second.text;
+}
+
+double JsonObject::getNumber(const std::string& name) const {
+    auto it = fields.find(name);
+    if (it == fields.end() || it->second.type != JsonValue::Type::NUMBER) {
+        throw std::invalid_argument("Field '" + name + "' must be a number");
+    }
+    if (!std::isfinite(it->second.number)) {
+        throw std::invalid_argument("Field '" + name + "' is out of range");
+    }
+    return it->second.number;
+}
+
+double JsonObject::getNumber(const std::string& name, double fallback) const {
+    return has(name) ? getNumber(name) : fallback;
+}
+
+int JsonObject::getInt(const std::string& name) const {
+    double number = getNumber(name);
+    if (number != std::trunc(number) || number < -2147483648.0 || number > 2147483647.0) {
+        throw std::invalid_argument("Field '" + name + "' must be an integer");
+    }
+    return static_cast<int>(number);
+}
+
+bool JsonObject::getBool(const std::string& name, bool fallback) const {
+    auto it = fields.find(name);
+    if (it == fields.end() || it->second.type == JsonValue::Type::NUL) return fallback;
+    if (it->second.type != JsonValue::Type::BOOLEAN) {
+        throw std::invalid_argument("Field '" + name + "' must be true or false");
+    }
+    return it->second.boolean;
+}
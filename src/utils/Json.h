@@ -0,0 +1,75 @@
+#ifndef JSON_H
+#define JSON_H
+
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <cstdint>
+
+// Streaming JSON writer. Commas and escaping are handled here; callers
+// only nest begin/end calls correctly.
+class JsonWriter {
+public:
+    JsonWriter& beginObject();
+    JsonWriter& endObject();
+    JsonWriter& beginArray();
+    JsonWriter& endArray();
+    JsonWriter& key(std::string_view name);
+
+    JsonWriter& value(std::string_view text);
+    JsonWriter& value(const char* text);
+    JsonWriter& value(double number);
+    JsonWriter& value(std::int64_t number);
+    JsonWriter& value(int number);
+    JsonWriter& value(std::uint64_t number);
+    JsonWriter& value(bool flag);
+    JsonWriter& null();
+
+    // key(name).value(v) in one call
+    template <typename T>
+    JsonWriter& field(std::string_view name, const T& v) {
+        key(name);
+        return value(v);
+    }
+
+    const std::string& str() const;
+    std::string take();
+
+    static void appendEscaped(std::string& out, std::string_view text);
+
+private:
+    std::string out;
+    bool need_comma = false;
+
+    void separate();
+};
+
+// A scalar from a flat JSON object
+struct JsonValue {
+    enum class Type { NUL, BOOLEAN, NUMBER, STRING };
+
+    Type type = Type::NUL;
+    bool boolean = false;
+    double number = 0.0;
+    std::string text;
+};
+
+// Request bodies are flat objects of scalars, e.g. {"amount": 12.5,
+// "description": "Lunch"}. Anything else (nesting, trailing data, bad
+// escapes) is rejected with std::invalid_argument.
+class JsonObject {
+public:
+    static JsonObject parse(std::string_view input);
+
+    bool has(const std::string& name) const;
+    std::string getString(const std::string& name, const std::string& fallback = "") const;
+    double getNumber(const std::string& name) const; // Throws if missing or not a finite number
+    double getNumber(const std::string& name, double fallback) const;
+    int getInt(const std::string& name) const; // Throws unless a whole number within int range
+    bool getBool(const std::string& name, bool fallback) const;
+
+private:
+    std::unordered_map<std::string, JsonValue> fields;
+};
+
+#endif // JSON_H
@@ -0,0 +1,226 @@
+#include "LatencyHistogram.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace {
+    // Position of the highest set bit; value must be non-zero
+    int highestBit(std::uint64_t value) {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanReverse64(&index, value);
+        return static_cast<int>(index);
+#else
+        return 63 - __builtin_clzll(value);
+#endif
+    }
+}
+
+LatencyHistogram::LatencyHistogram(std::int64_t highest_trackable, int significant_digits)
+    : highest_trackable(highest_trackable), significant_digits(significant_digits),
+      total_count(0), min_value(std::numeric_limits<std::int64_t>::max()), max_value(0), total_sum(0.0) {
+    if (highest_trackable < 2) {
+        throw std::invalid_argument("Highest trackable value must be at least 2");
+    }
+    if (significant_digits < 1 || significant_digits > 5) {
+        throw std::invalid_argument("Significant digits must be between 1 and 5");
+    }
+
+    // Enough linear sub-buckets that adjacent values differ by at most one
+    // part in 10^digits
+    std::int64_t single_unit_resolution = 2 * static_cast<std::int64_t>(std::pow(10, significant_digits));
+    int sub_bucket_count_magnitude = highestBit(static_cast<std::uint64_t>(single_unit_resolution - 1)) + 1;
+    sub_bucket_half_count_magnitude = sub_bucket_count_magnitude - 1;
+    std::int64_t sub_bucket_count = std::int64_t(1) << sub_bucket_count_magnitude;
+    sub_bucket_half_count = sub_bucket_count / 2;
+    sub_bucket_mask = sub_bucket_count - 1;
+
+    // Each further bucket doubles the covered range
+    std::size_t bucket_count = 1;
+    std::int64_t smallest_untrackable = sub_bucket_count;
+    while (smallest_untrackable <= highest_trackable) {
+        if (smallest_untrackable > std::numeric_limits<std::int64_t>::max() / 2) {
+            ++bucket_count;
+            break;
+        }
+        smallest_untrackable <<= 1;
+        ++bucket_count;
+    }
+
+    counts_length = (bucket_count + 1) * static_cast<std::size_t>(sub_bucket_half_count);
+    counts.reset(new std::atomic<std::uint64_t>[counts_length]);
+    for (std::size_t i = 0; i < counts_length; ++i) {
+        counts[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+LatencyHistogram::LatencyHistogram(const LatencyHistogram& other)
+    : LatencyHistogram(other.highest_trackable, other.significant_digits) {
+    merge(other);
+}
+
+LatencyHistogram& LatencyHistogram::operator=(const LatencyHistogram& other) {
+    if (this != &other) {
+        if (other.highest_trackable != highest_trackable || other.significant_digits != significant_digits) {
+            LatencyHistogram copy(other.highest_trackable, other.significant_digits);
+            highest_trackable = copy.highest_trackable;
+            significant_digits = copy.significant_digits;
+            sub_bucket_half_count_magnitude = copy.sub_bucket_half_count_magnitude;
+            sub_bucket_half_count = copy.sub_bucket_half_count;
+            sub_bucket_mask = copy.sub_bucket_mask;
+            counts_length = copy.counts_length;
+            counts = std::move(copy.counts);
+        }
+        reset();
+        merge(other);
+    }
+    return *this;
+}
+
+void LatencyHistogram::record(std::int64_t value) {
+    value = clamp(value);
+    auto& slot = counts[indexFor(value)];
+    slot.store(slot.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    total_count.store(total_count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    total_sum.store(total_sum.load(std::memory_order_relaxed) + static_cast<double>(value), std::memory_order_relaxed);
+    if (value < min_value.load(std::memory_order_relaxed)) min_value.store(value, std::memory_order_relaxed);
+    if (value > max_value.load(std::memory_order_relaxed)) max_value.store(value, std::memory_order_relaxed);
+}
+
+void LatencyHistogram::recordShared(std::int64_t value) {
+    value = clamp(value);
+    counts[indexFor(value)].fetch_add(1, std::memory_order_relaxed);
+    total_count.fetch_add(1, std::memory_order_relaxed);
+
+    double sum = total_sum.load(std::memory_order_relaxed);
+    while (!total_sum.compare_exchange_weak(sum, sum + static_cast<double>(value), std::memory_order_relaxed)) {
+    }
+    std::int64_t current = min_value.load(std::memory_order_relaxed);
+    while (value < current && !min_value.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+    current = max_value.load(std::memory_order_relaxed);
+    while (value > current && !max_value.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other) {
+    if (other.highest_trackable != highest_trackable || other.significant_digits != significant_digits) {
+        throw std::invalid_argument("Cannot merge histograms with different configurations");
+    }
+
+    std::uint64_t merged = 0;
+    for (std::size_t i = 0; i < counts_length; ++i) {
+        std::uint64_t value = other.counts[i].load(std::memory_order_relaxed);
+        if (value != 0) {
+            counts[i].fetch_add(value, std::memory_order_relaxed);
+            merged += value;
+        }
+    }
+    // Use the per-slot total so count() always matches the slots, even when
+    // the source was being written to during the merge
+    total_count.fetch_add(merged, std::memory_order_relaxed);
+
+    double other_sum = other.total_sum.load(std::memory_order_relaxed);
+    double sum = total_sum.load(std::memory_order_relaxed);
+    while (!total_sum.compare_exchange_weak(sum, sum + other_sum, std::memory_order_relaxed)) {
+    }
+    std::int64_t other_min = other.min_value.load(std::memory_order_relaxed);
+    std::int64_t current = min_value.load(std::memory_order_relaxed);
+    while (other_min < current && !min_value.compare_exchange_weak(current, other_min, std::memory_order_relaxed)) {
+    }
+    std::int64_t other_max = other.max_value.load(std::memory_order_relaxed);
+    current = max_value.load(std::memory_order_relaxed);
+    while (other_max > current && !max_value.compare_exchange_weak(current, other_max, std::memory_order_relaxed)) {
+    }
+}
+
+void LatencyHistogram::reset() {
+    for (std::size_t i = 0; i < counts_length; ++i) {
+        counts[i].store(0, std::memory_order_relaxed);
+    }
+    total_count.store(0, std::memory_order_relaxed);
+    total_sum.store(0.0, std::memory_order_relaxed);
+    min_value.store(std::numeric_limits<std::int64_t>::max(), std::memory_order_relaxed);
+    max_value.store(0, std::memory_order_relaxed);
+}
+
+// Queries
+std::uint64_t LatencyHistogram::count() const {
+    return total_count.load(std::memory_order_relaxed);
+}
+
+std::int64_t LatencyHistogram::min() const {
+    return count() == 0 ? 0 : min_value.load(std::memory_order_relaxed);
+}
+
+std::int64_t LatencyHistogram::max() const {
+    return max_value.load(std::memory_order_relaxed);
+}
+
+double LatencyHistogram::mean() const {
+    std::uint64_t total = count();
+    return total == 0 ? 0.0 : total_sum.load(std::memory_order_relaxed) / static_cast<double>(total);
+}
+
+std::int64_t LatencyHistogram::valueAtPercentile(double percentile) const {
+    std::uint64_t total = 0;
+    for (std::size_t i = 0; i < counts_length; ++i) {
+        total += counts[i].load(std::memory_order_relaxed);
+    }
+    if (total == 0) return 0;
+
+    percentile = std::min(std::max(percentile, 0.0), 100.0);
+    auto target = static_cast<std::uint64_t>(std::ceil(percentile / 100.0 * static_cast<double>(total)));
+    target = std::max<std::uint64_t>(target, 1);
+
+    std::uint64_t cumulative = 0;
+    for (std::size_t i = 0; i < counts_length; ++i) {
+        cumulative += counts[i].load(std::memory_order_relaxed);
+        if (cumulative >= target) {
+            return std::min(highestEquivalent(i), max());
+        }
+    }
+    return max();
+}
+
+std::int64_t LatencyHistogram::getHighestTrackable() const {
+    return highest_trackable;
+}
+
+int LatencyHistogram::getSignificantDigits() const {
+    return significant_digits;
+}
+
+// Private methods
+std::size_t LatencyHistogram::indexFor(std::int64_t value) const {
+    int bucket_index = highestBit(static_cast<std::uint64_t>(value | sub_bucket_mask)) - sub_bucket_half_count_magnitude;
+    std::int64_t sub_bucket_index = value >> bucket_index;
+    return (static_cast<std::size_t>(bucket_index) << sub_bucket_half_count_magnitude) +
+           static_cast<std::size_t>(sub_bucket_index);
+}
+
+std::int64_t LatencyHistogram::valueAt(std::size_t index) const {
+    auto bucket_index = static_cast<std::int64_t>(index >> sub_bucket_half_count_magnitude) - 1;
+    std::int64_t sub_bucket_index = static_cast<std::int64_t>(index & static_cast<std::size_t>(sub_bucket_half_count - 1)) +
+                                    sub_bucket_half_count;
+    if (bucket_index < 0) {
+        sub_bucket_index -= sub_bucket_half_count;
+        bucket_index = 0;
+    }
+    return sub_bucket_index << bucket_index;
+}
+
+std::int64_t LatencyHistogram::highestEquivalent(std::size_t index) const {
+    auto bucket_index = static_cast<std::int64_t>(index >> sub_bucket_half_count_magnitude) - 1;
+    if (bucket_index < 0) bucket_index = 0;
+    return valueAt(index) + (std::int64_t(1) << bucket_index) - 1;
+}
+
+std::int64_t LatencyHistogram::clamp(std::int64_t value) const {
+    if (value < 0) return 0;
+    return value > highest_trackable ? highest_trackable : value;
+}
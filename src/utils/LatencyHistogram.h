@@ -0,0 +1,60 @@
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+#include <atomic>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+
+// High-dynamic-range histogram of non-negative integer values (latencies
+// in nanoseconds, typically). Buckets double in width while each keeps a
+// fixed number of linear sub-buckets, so any recorded value is reported
+// within the configured number of significant decimal digits, from 1 ns up
+// to highest_trackable, in a few tens of KB.
+//
+// record() is meant for a single writer (one histogram per thread) and
+// costs an index computation plus an uncontended increment; readers can
+// merge or query concurrently and see a slightly stale but valid view.
+// recordShared() may be called from any number of threads.
+class LatencyHistogram {
+public:
+    explicit LatencyHistogram(std::int64_t highest_trackable = 3600LL * 1000000000LL, // One hour in ns
+                              int significant_digits = 3);
+
+    LatencyHistogram(const LatencyHistogram& other);
+    LatencyHistogram& operator=(const LatencyHistogram& other);
+
+    void record(std::int64_t value);       // Single writer; values are clamped to the trackable range
+    void recordShared(std::int64_t value); // Any thread
+    void merge(const LatencyHistogram& other); // Histograms must share their configuration
+    void reset();
+
+    // Queries
+    std::uint64_t count() const;
+    std::int64_t min() const;
+    std::int64_t max() const;
+    double mean() const;
+    std::int64_t valueAtPercentile(double percentile) const; // percentile in [0, 100]
+    std::int64_t getHighestTrackable() const;
+    int getSignificantDigits() const;
+
+private:
+    std::int64_t highest_trackable;
+    int significant_digits;
+    int sub_bucket_half_count_magnitude;
+    std::int64_t sub_bucket_half_count;
+    std::int64_t sub_bucket_mask;
+    std::size_t counts_length;
+    std::unique_ptr<std::atomic<std::uint64_t>[]> counts;
+    std::atomic<std::uint64_t> total_count;
+    std::atomic<std::int64_t> min_value;
+    std::atomic<std::int64_t> max_value;
+    std::atomic<double> total_sum; // Double, since sums of ns values overflow int64 after a few hours of samples
+
+    std::size_t indexFor(std::int64_t value) const;
+    std::int64_t valueAt(std::size_t index) const;        // Lowest value in the slot
+    std::int64_t highestEquivalent(std::size_t index) const; // Highest value in the slot
+    std::int64_t clamp(std::int64_t value) const;
+};
+
+#endif // LATENCY_HISTOGRAM_H
@@ -0,0 +1,321 @@
+#include "LockProfiler.h"
+#include <algorithm>
+#include <cstdio>
+
+#ifdef FINTRACK_LOCK_PROFILING
+
+#include <array>
+#include <unordered_map>
+#include <unordered_set>
+#include "LatencyHistogram.h"
+#include "Metrics.h"
+
+namespace {
+    constexpr std::int64_t kHighestTrackable = 100LL * 1000000000LL; // 100 s
+    constexpr int kSignificantDigits = 2;
+
+    void raiseTo(std::atomic<std::int64_t>& maximum, std::int64_t value) {
+        std::int64_t current = maximum.load(std::memory_order_relaxed);
+        while (value > current && !maximum.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+        }
+    }
+
+    std::int64_t elapsedSince(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+// Statistics for every mutex declared with one site name. Site totals are
+// sharded by thread like the metrics counters; keyed locks are tracked
+// while alive and folded into `retired` by key when destroyed, so accounts
+// torn down at the end of a run still appear in the report.
+class LockSite {
+public:
+    explicit LockSite(std::string name) : name(std::move(name)) {}
+
+    const std::string& getName() const { return name; }
+
+    void recordAcquire(ProfiledMutex& mutex, bool was_contended, std::int64_t waited) {
+        Shard& shard = shards[metrics_detail::threadShard()];
+        shard.acquisitions.fetch_add(1, std::memory_order_relaxed);
+        if (was_contended) {
+            shard.contended.fetch_add(1, std::memory_order_relaxed);
+            shard.wait_ns.fetch_add(waited, std::memory_order_relaxed);
+            raiseTo(shard.max_wait_ns, waited);
+            shard.wait.recordShared(waited);
+        }
+        if (mutex.key < 0) return;
+
+        mutex.acquisitions.fetch_add(1, std::memory_order_relaxed);
+        if (was_contended) {
+            mutex.contended.fetch_add(1, std::memory_order_relaxed);
+            mutex.wait_ns.fetch_add(waited, std::memory_order_relaxed);
+            raiseTo(mutex.max_wait_ns, waited);
+        }
+    }
+
+    void recordRelease(ProfiledMutex& mutex, std::int64_t held) {
+        Shard& shard = shards[metrics_detail::threadShard()];
+        shard.hold_ns.fetch_add(held, std::memory_order_relaxed);
+        shard.hold.recordShared(held);
+        if (mutex.key >= 0) mutex.hold_ns.fetch_add(held, std::memory_order_relaxed);
+    }
+
+    void attach(ProfiledMutex* mutex) {
+        std::lock_guard<std::mutex> lock(keyed_mutex);
+        live.insert(mutex);
+    }
+
+    void detach(ProfiledMutex* mutex) {
+        std::lock_guard<std::mutex> lock(keyed_mutex);
+        live.erase(mutex);
+        if (mutex->acquisitions.load(std::memory_order_relaxed) > 0) {
+            accumulate(retired[mutex->key], keyedStats(*mutex));
+        }
+    }
+
+    LockStats stats() const {
+        LockStats total;
+        total.site = name;
+        LatencyHistogram wait(kHighestTrackable, kSignificantDigits);
+        LatencyHistogram hold(kHighestTrackable, kSignificantDigits);
+        for (const Shard& shard : shards) {
+            total.acquisitions += shard.acquisitions.load(std::memory_order_relaxed);
+            total.contended += shard.contended.load(std::memory_order_relaxed);
+            total.wait_ns += shard.wait_ns.load(std::memory_order_relaxed);
+            total.max_wait_ns = std::max(total.max_wait_ns, shard.max_wait_ns.load(std::memory_order_relaxed));
+            total.hold_ns += shard.hold_ns.load(std::memory_order_relaxed);
+            wait.merge(shard.wait);
+            hold.merge(shard.hold);
+        }
+        total.wait_p50_ns = wait.valueAtPercentile(50.0);
+        total.wait_p99_ns = wait.valueAtPercentile(99.0);
+        total.hold_p50_ns = hold.valueAtPercentile(50.0);
+        total.hold_p99_ns = hold.valueAtPercentile(99.0);
+        return total;
+    }
+
+    void collectKeyed(std::vector<LockStats>& out) const {
+        std::unordered_map<std::int64_t, LockStats> by_key;
+        {
+            std::lock_guard<std::mutex> lock(keyed_mutex);
+            by_key = retired;
+            for (const ProfiledMutex* mutex : live) {
+                if (mutex->acquisitions.load(std::memory_order_relaxed) > 0) {
+                    accumulate(by_key[mutex->key], keyedStats(*mutex));
+                }
+            }
+        }
+        for (auto& entry : by_key) {
+            entry.second.site = name;
+            entry.second.key = entry.first;
+            out.push_back(std::move(entry.second));
+        }
+    }
+
+    void reset() {
+        for (Shard& shard : shards) {
+            shard.acquisitions.store(0, std::memory_order_relaxed);
+            shard.contended.store(0, std::memory_order_relaxed);
+            shard.wait_ns.store(0, std::memory_order_relaxed);
+            shard.max_wait_ns.store(0, std::memory_order_relaxed);
+            shard.hold_ns.store(0, std::memory_order_relaxed);
+            shard.wait.reset();
+            shard.hold.reset();
+        }
+        std::lock_guard<std::mutex> lock(keyed_mutex);
+        retired.clear();
+        for (ProfiledMutex* mutex : live) {
+            mutex->acquisitions.store(0, std::memory_order_relaxed);
+            mutex->contended.store(0, std::memory_order_relaxed);
+            mutex->wait_ns.store(0, std::memory_order_relaxed);
+            mutex->max_wait_ns.store(0, std::memory_order_relaxed);
+            mutex->hold_ns.store(0, std::memory_order_relaxed);
+        }
+    }
+
+private:
+    struct alignas(64) Shard {
+        std::atomic<std::uint64_t> acquisitions{0};
+        std::atomic<std::uint64_t> contended{0};
+        std::atomic<std::int64_t> wait_ns{0};
+        std::atomic<std::int64_t> max_wait_ns{0};
+        std::atomic<std::int64_t> hold_ns{0};
+        LatencyHistogram wait{kHighestTrackable, kSignificantDigits};
+        LatencyHistogram hold{kHighestTrackable, kSignificantDigits};
+    };
+
+    std::string name;
+    std::array<Shard, metrics_detail::kShardCount> shards;
+
+    mutable std::mutex keyed_mutex;
+    std::unordered_set<ProfiledMutex*> live;
+    std::unordered_map<std::int64_t, LockStats> retired; // Destroyed keyed locks, by key
+
+    static LockStats keyedStats(const ProfiledMutex& mutex) {
+        LockStats stats;
+        stats.acquisitions = mutex.acquisitions.load(std::memory_order_relaxed);
+        stats.contended = mutex.contended.load(std::memory_order_relaxed);
+        stats.wait_ns = mutex.wait_ns.load(std::memory_order_relaxed);
+        stats.max_wait_ns = mutex.max_wait_ns.load(std::memory_order_relaxed);
+        stats.hold_ns = mutex.hold_ns.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+    static void accumulate(LockStats& into, const LockStats& from) {
+        into.acquisitions += from.acquisitions;
+        into.contended += from.contended;
+        into.wait_ns += from.wait_ns;
+        into.max_wait_ns = std::max(into.max_wait_ns, from.max_wait_ns);
+        into.hold_ns += from.hold_ns;
+    }
+};
+
+// ProfiledMutex implementation
+ProfiledMutex::ProfiledMutex(const char* site_name, std::int64_t key)
+    : site(LockProfiler::instance().site(site_name)), key(key) {
+    if (key >= 0) site.attach(this);
+}
+
+ProfiledMutex::~ProfiledMutex() {
+    if (key >= 0) site.detach(this);
+}
+
+void ProfiledMutex::lock() {
+    if (mutex.try_lock()) {
+        acquired_at = std::chrono::steady_clock::now();
+        site.recordAcquire(*this, false, 0);
+        return;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    mutex.lock();
+    acquired_at = std::chrono::steady_clock::now();
+    site.recordAcquire(*this, true,
+                       std::chrono::duration_cast<std::chrono::nanoseconds>(acquired_at - start).count());
+}
+
+bool ProfiledMutex::try_lock() {
+    if (!mutex.try_lock()) return false;
+    acquired_at = std::chrono::steady_clock::now();
+    site.recordAcquire(*this, false, 0);
+    return true;
+}
+
+void ProfiledMutex::unlock() {
+    // Recorded while still held: once unlocked, the owner of the mutex may
+    // destroy it
+    site.recordRelease(*this, elapsedSince(acquired_at));
+    mutex.unlock();
+}
+
+#endif
+
+namespace {
+    // Microseconds with one decimal
+    std::string formatMicros(std::int64_t nanoseconds) {
+        char buffer[32];
+        std::snprintf(buffer, sizeof(buffer), "%.1f", static_cast<double>(nanoseconds) / 1000.0);
+        return buffer;
+    }
+
+#ifdef FINTRACK_LOCK_PROFILING
+    bool byTotalWait(const LockStats& a, const LockStats& b) {
+        if (a.wait_ns != b.wait_ns) return a.wait_ns > b.wait_ns;
+        if (a.contended != b.contended) return a.contended > b.contended;
+        return a.acquisitions > b.acquisitions;
+    }
+#endif
+}
+
+// LockProfiler implementation
+LockProfiler& LockProfiler::instance() {
+    // Never destroyed, so mutexes in other statics can use it while exiting
+    static LockProfiler* profiler = new LockProfiler();
+    return *profiler;
+}
+
+#ifdef FINTRACK_LOCK_PROFILING
+LockSite& LockProfiler::site(const char* name) {
+    std::lock_guard<std::mutex> lock(sites_mutex);
+    for (LockSite* existing : registered) {
+        if (existing->getName() == name) return *existing;
+    }
+    registered.push_back(new LockSite(name));
+    return *registered.back();
+}
+#endif
+
+std::vector<LockStats> LockProfiler::sites() const {
+    std::vector<LockStats> result;
+#ifdef FINTRACK_LOCK_PROFILING
+    std::lock_guard<std::mutex> lock(sites_mutex);
+    for (const LockSite* site : registered) {
+        result.push_back(site->stats());
+    }
+    std::sort(result.begin(), result.end(), byTotalWait);
+#endif
+    return result;
+}
+
+std::vector<LockStats> LockProfiler::hottest(std::size_t count) const {
+    std::vector<LockStats> result;
+#ifdef FINTRACK_LOCK_PROFILING
+    {
+        std::lock_guard<std::mutex> lock(sites_mutex);
+        for (const LockSite* site : registered) {
+            site->collectKeyed(result);
+        }
+    }
+    std::sort(result.begin(), result.end(), byTotalWait);
+    if (result.size() > count) result.resize(count);
+#else
+    (void)count;
+#endif
+    return result;
+}
+
+void LockProfiler::writeReport(std::ostream& out, std::size_t top_keys) const {
+    if (!kCompiledIn) {
+        out << "Lock profiling is not compiled in (configure with -DFINTRACK_LOCK_PROFILING=ON)\n";
+        return;
+    }
+
+    char line[256];
+    out << "Lock contention by site (most total wait first; times in us)\n";
+    std::snprintf(line, sizeof(line), "%-38s %12s %10s %12s %10s %10s %10s %10s %10s\n", "Site", "Acquired",
+                  "Contended", "Wait total", "Wait p50", "Wait p99", "Wait max", "Hold p50", "Hold p99");
+    out << line;
+    for (const LockStats& stats : sites()) {
+        std::snprintf(line, sizeof(line), "%-38s %12llu %9.2f%% %12s %10s %10s %10s %10s %10s\n",
+                      stats.site.c_str(), static_cast<unsigned long long>(stats.acquisitions),
+                      stats.contentionRate() * 100.0, formatMicros(stats.wait_ns).c_str(),
+                      formatMicros(stats.wait_p50_ns).c_str(), formatMicros(stats.wait_p99_ns).c_str(),
+                      formatMicros(stats.max_wait_ns).c_str(), formatMicros(stats.hold_p50_ns).c_str(),
+                      formatMicros(stats.hold_p99_ns).c_str());
+        out << line;
+    }
+
+    std::vector<LockStats> keyed = hottest(top_keys);
+    if (keyed.empty()) return;
+    out << "\nHottest keyed locks (key = account ID)\n";
+    std::snprintf(line, sizeof(line), "%-38s %10s %12s %10s %12s %10s %12s\n", "Site", "Key", "Acquired",
+                  "Contended", "Wait total", "Wait max", "Hold total");
+    out << line;
+    for (const LockStats& stats : keyed) {
+        std::snprintf(line, sizeof(line), "%-38s %10lld %12llu %9.2f%% %12s %10s %12s\n", stats.site.c_str(),
+                      static_cast<long long>(stats.key), static_cast<unsigned long long>(stats.acquisitions),
+                      stats.contentionRate() * 100.0, formatMicros(stats.wait_ns).c_str(),
+                      formatMicros(stats.max_wait_ns).c_str(), formatMicros(stats.hold_ns).c_str());
+        out << line;
+    }
+}
+
+void LockProfiler::reset() {
+#ifdef FINTRACK_LOCK_PROFILING
+    std::lock_guard<std::mutex> lock(sites_mutex);
+    for (LockSite* site : registered) {
+        site->reset();
+    }
+#endif
+}
@@ -0,0 +1,117 @@
+#ifndef LOCK_PROFILER_H
+#define LOCK_PROFILER_H
+
+#include <cstdint>
+#include <cstddef>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+#ifdef FINTRACK_LOCK_PROFILING
+#include <atomic>
+#include <chrono>
+#endif
+
+// Lock contention profiling, compiled in with -DFINTRACK_LOCK_PROFILING=ON.
+//
+// Hot engine mutexes are declared as ProfiledMutex with a site name and,
+// for per-account locks, a key. In normal builds ProfiledMutex is a plain
+// std::mutex and the name and key are discarded, so there is no cost at
+// all. In profiling builds every acquisition is counted and timed: waits
+// (contended acquisitions only) and hold times go into per-site
+// histograms, and keyed locks also keep their own totals so the report can
+// name the hottest accounts.
+
+class LockSite;
+
+#ifdef FINTRACK_LOCK_PROFILING
+
+class ProfiledMutex {
+public:
+    explicit ProfiledMutex(const char* site_name, std::int64_t key = -1);
+    ~ProfiledMutex();
+
+    ProfiledMutex(const ProfiledMutex&) = delete;
+    ProfiledMutex& operator=(const ProfiledMutex&) = delete;
+
+    void lock();
+    bool try_lock(); // A failed attempt is not counted
+    void unlock();
+
+private:
+    friend class LockSite;
+
+    std::mutex mutex;
+    LockSite& site;
+    std::int64_t key;
+    std::chrono::steady_clock::time_point acquired_at; // Written by the holder only
+
+    // Per-instance totals, kept for keyed locks
+    std::atomic<std::uint64_t> acquisitions{0};
+    std::atomic<std::uint64_t> contended{0};
+    std::atomic<std::int64_t> wait_ns{0};
+    std::atomic<std::int64_t> max_wait_ns{0};
+    std::atomic<std::int64_t> hold_ns{0};
+};
+
+#else
+
+class ProfiledMutex : public std::mutex {
+public:
+    explicit ProfiledMutex(const char*, std::int64_t = -1) noexcept {}
+};
+
+static_assert(sizeof(ProfiledMutex) == sizeof(std::mutex), "Unprofiled builds must keep the plain mutex layout");
+
+#endif
+
+// Totals for one lock site, or for one keyed lock within a site
+struct LockStats {
+    std::string site;
+    std::int64_t key = -1; // Account ID for keyed locks; -1 for a whole site
+    std::uint64_t acquisitions = 0;
+    std::uint64_t contended = 0;
+    std::int64_t wait_ns = 0; // Total time spent waiting
+    std::int64_t max_wait_ns = 0;
+    std::int64_t hold_ns = 0; // Total time held
+    // Site rows only
+    std::int64_t wait_p50_ns = 0;
+    std::int64_t wait_p99_ns = 0;
+    std::int64_t hold_p50_ns = 0;
+    std::int64_t hold_p99_ns = 0;
+
+    double contentionRate() const { return acquisitions ? static_cast<double>(contended) / acquisitions : 0.0; }
+};
+
+// Process-wide view of every lock site. All queries are empty (and the
+// report says so) unless profiling is compiled in.
+class LockProfiler {
+public:
+#ifdef FINTRACK_LOCK_PROFILING
+    static constexpr bool kCompiledIn = true;
+#else
+    static constexpr bool kCompiledIn = false;
+#endif
+
+    static LockProfiler& instance();
+
+    std::vector<LockStats> sites() const;                    // Most total wait first
+    std::vector<LockStats> hottest(std::size_t count) const; // Keyed locks, most total wait first
+    void writeReport(std::ostream& out, std::size_t top_keys = 10) const;
+
+    void reset(); // Zeroes every site and keyed lock; call while the engine is idle
+
+#ifdef FINTRACK_LOCK_PROFILING
+    LockSite& site(const char* name); // Registered on first use, then lives until exit
+#endif
+
+private:
+#ifdef FINTRACK_LOCK_PROFILING
+    mutable std::mutex sites_mutex;
+    std::vector<LockSite*> registered;
+#endif
+
+    LockProfiler() = default;
+};
+
+#endif // LOCK_PROFILER_H
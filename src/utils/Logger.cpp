@@ -0,0 +1,342 @@
+#include "Logger.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <stdexcept>
+#include "Json.h"
+#include "TimeZone.h"
+
+namespace {
+    constexpr std::chrono::milliseconds kWriterInterval(20);
+    constexpr std::size_t kWriteChunkBytes = 64 * 1024;
+
+    void appendNumber(std::string& out, const char* format, double value) {
+        char buffer[32];
+        int length = std::snprintf(buffer, sizeof(buffer), format, value);
+        out.append(buffer, static_cast<std::size_t>(std::max(length, 0)));
+    }
+
+    void appendInteger(std::string& out, std::int64_t value) {
+        out += std::to_string(value);
+    }
+
+    // 2026-10-18T14:54:19.123456Z
+    void appendTimestamp(std::string& out, std::chrono::system_clock::time_point now) {
+        std::int64_t micros = std::chrono::duration_cast<std::chrono::microseconds>(now.time_since_epoch()).count();
+        std::int64_t seconds = micros >= 0 ? micros / 1000000 : (micros - 999999) / 1000000;
+        std::int64_t days = seconds >= 0 ? seconds / 86400 : (seconds - 86399) / 86400;
+        std::int64_t second_of_day = seconds - days * 86400;
+        int year, month, day;
+        TimeZone::civilFromDays(days, year, month, day);
+
+        char buffer[40];
+        int length = std::snprintf(buffer, sizeof(buffer), "%04d-%02d-%02dT%02d:%02d:%02d.%06dZ",
+                                   year, month, day,
+                                   static_cast<int>(second_of_day / 3600),
+                                   static_cast<int>(second_of_day / 60 % 60),
+                                   static_cast<int>(second_of_day % 60),
+                                   static_cast<int>(micros - seconds * 1000000));
+        out.append(buffer, static_cast<std::size_t>(std::max(length, 0)));
+    }
+
+    void appendKey(std::string& out, std::string_view name) {
+        out += ',';
+        JsonWriter::appendEscaped(out, name);
+        out += ':';
+    }
+}
+
+// Single-producer, single-consumer ring owned by one logging thread and
+// drained by the writer. Slots keep their capacity between uses, so a
+// steady stream of lines stops allocating once the ring has warmed up.
+struct Logger::ThreadRing {
+    std::uint32_t thread_number;
+    std::unique_ptr<std::string[]> slots;
+    alignas(64) std::atomic<std::uint64_t> head{0}; // Next slot the writer reads
+    alignas(64) std::atomic<std::uint64_t> tail{0}; // Next slot the thread fills
+    std::atomic<bool> retired{false};               // Thread exited; remove once drained
+
+    explicit ThreadRing(std::uint32_t thread_number)
+        : thread_number(thread_number), slots(new std::string[kRingCapacity]) {}
+};
+
+// Marks the ring retired when its thread exits
+struct ThreadRingHandle {
+    std::shared_ptr<Logger::ThreadRing> ring;
+
+    ~ThreadRingHandle() {
+        if (ring) ring->retired.store(true, std::memory_order_release);
+    }
+};
+
+// LogRateLimiter implementation
+LogRateLimiter::LogRateLimiter(double per_second, double burst)
+    : theoretical_arrival(std::numeric_limits<std::int64_t>::min() / 2), suppressed_count(0) {
+    if (!(per_second > 0.0) || !(burst >= 1.0)) {
+        throw std::invalid_argument("Rate limit needs a positive rate and a burst of at least 1");
+    }
+    interval_ns = std::max<std::int64_t>(1, static_cast<std::int64_t>(1e9 / per_second));
+    tolerance_ns = static_cast<std::int64_t>((burst - 1.0) * static_cast<double>(interval_ns));
+}
+
+bool LogRateLimiter::tryAcquire(std::uint64_t& suppressed) {
+    std::int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    std::int64_t arrival = theoretical_arrival.load(std::memory_order_relaxed);
+    while (true) {
+        std::int64_t base = std::max(arrival, now);
+        if (base - now > tolerance_ns) {
+            suppressed_count.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        if (theoretical_arrival.compare_exchange_weak(arrival, base + interval_ns, std::memory_order_relaxed)) {
+            break;
+        }
+    }
+    suppressed = suppressed_count.exchange(0, std::memory_order_relaxed);
+    return true;
+}
+
+// Logger implementation
+Logger& Logger::instance() {
+    // Never destroyed: services that log from their destructors may outlive
+    // any static. The atexit handler drains the rings and stops the writer;
+    // later lines are written directly.
+    static Logger* logger = [] {
+        Logger* created = new Logger();
+        std::atexit([] { Logger::instance().shutdown(); });
+        return created;
+    }();
+    return *logger;
+}
+
+Logger::Logger()
+    : min_level(static_cast<int>(LogLevel::INFO)), dropped(0), dropped_reported(0), next_thread_number(1),
+      output(stderr), owns_output(false), flush_requested(0), flush_completed(0), stopping(false), stopped(false) {
+    writer = std::thread(&Logger::writerLoop, this);
+}
+
+void Logger::shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(writer_mutex);
+        if (stopping) return;
+        stopping = true;
+    }
+    writer_cv.notify_all();
+    if (writer.joinable()) writer.join();
+    stopped.store(true, std::memory_order_release);
+
+    // Lines that raced with the writer's last pass
+    std::string batch;
+    drainOnce(batch);
+}
+
+void Logger::setLevel(LogLevel level) {
+    min_level.store(static_cast<int>(level), std::memory_order_relaxed);
+}
+
+LogLevel Logger::getLevel() const {
+    return static_cast<LogLevel>(min_level.load(std::memory_order_relaxed));
+}
+
+bool Logger::setOutputFile(const std::string& path) {
+    std::FILE* file = std::fopen(path.c_str(), "a");
+    if (!file) return false;
+
+    flush();
+    std::lock_guard<std::mutex> lock(output_mutex);
+    if (owns_output) std::fclose(output);
+    output = file;
+    owns_output = true;
+    return true;
+}
+
+void Logger::useStandardError() {
+    flush();
+    std::lock_guard<std::mutex> lock(output_mutex);
+    if (owns_output) std::fclose(output);
+    output = stderr;
+    owns_output = false;
+}
+
+void Logger::log(LogLevel level, std::string_view event, std::string_view message,
+                 std::initializer_list<LogField> fields) {
+    if (!isEnabled(level)) return;
+
+    ThreadRing& ring = ringForThisThread();
+
+    // Formatted into a per-thread scratch string, then copied into a slot
+    // that already has the capacity
+    thread_local std::string line;
+    line.clear();
+    line += "{\"ts\":\"";
+    appendTimestamp(line, std::chrono::system_clock::now());
+    line += "\",\"level\":\"";
+    line += logLevelToString(level);
+    line += "\",\"thread\":";
+    appendInteger(line, ring.thread_number);
+    appendKey(line, "event");
+    JsonWriter::appendEscaped(line, event);
+    appendKey(line, "msg");
+    JsonWriter::appendEscaped(line, message);
+    for (const LogField& field : fields) {
+        appendKey(line, field.name);
+        switch (field.type) {
+            case LogField::Type::STRING: JsonWriter::appendEscaped(line, field.text); break;
+            case LogField::Type::SIGNED: appendInteger(line, field.signed_value); break;
+            case LogField::Type::UNSIGNED: line += std::to_string(field.unsigned_value); break;
+            case LogField::Type::REAL:
+                if (std::isfinite(field.real_value)) {
+                    appendNumber(line, "%.15g", field.real_value);
+                } else {
+                    line += "null";
+                }
+                break;
+            case LogField::Type::BOOLEAN: line += field.flag ? "true" : "false"; break;
+        }
+    }
+    line += '}';
+
+    if (stopped.load(std::memory_order_acquire)) {
+        writeBatch(line + "\n");
+        return;
+    }
+
+    std::uint64_t tail = ring.tail.load(std::memory_order_relaxed);
+    std::uint64_t used = tail - ring.head.load(std::memory_order_acquire);
+    if (used >= kRingCapacity) {
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    ring.slots[tail % kRingCapacity].assign(line);
+    ring.tail.store(tail + 1, std::memory_order_release);
+
+    if (used + 1 == kRingCapacity / 2) {
+        writer_cv.notify_one(); // Filling faster than the writer's interval
+    }
+}
+
+void Logger::flush() {
+    if (stopped.load(std::memory_order_acquire)) {
+        std::lock_guard<std::mutex> lock(output_mutex);
+        std::fflush(output);
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(writer_mutex);
+    std::uint64_t target = ++flush_requested;
+    writer_cv.notify_all();
+    flushed_cv.wait(lock, [this, target] { return flush_completed >= target || stopping; });
+}
+
+std::uint64_t Logger::getDroppedCount() const {
+    return dropped.load(std::memory_order_relaxed);
+}
+
+const char* Logger::logLevelToString(LogLevel level) {
+    switch (level) {
+        case LogLevel::DEBUG: return "debug";
+        case LogLevel::INFO: return "info";
+        case LogLevel::WARN: return "warn";
+        case LogLevel::ERROR: return "error";
+        case LogLevel::OFF: return "off";
+        default: return "unknown";
+    }
+}
+
+LogLevel Logger::stringToLogLevel(std::string_view text) {
+    if (text == "debug") return LogLevel::DEBUG;
+    if (text == "info") return LogLevel::INFO;
+    if (text == "warn") return LogLevel::WARN;
+    if (text == "error") return LogLevel::ERROR;
+    if (text == "off") return LogLevel::OFF;
+    throw std::invalid_argument("Unknown log level: " + std::string(text));
+}
+
+// Private methods
+Logger::ThreadRing& Logger::ringForThisThread() {
+    thread_local ThreadRingHandle handle;
+    if (!handle.ring) {
+        handle.ring = std::make_shared<ThreadRing>(next_thread_number.fetch_add(1, std::memory_order_relaxed));
+        std::lock_guard<std::mutex> lock(rings_mutex);
+        rings.push_back(handle.ring);
+    }
+    return *handle.ring;
+}
+
+void Logger::writerLoop() {
+    std::string batch;
+    std::unique_lock<std::mutex> lock(writer_mutex);
+    while (true) {
+        writer_cv.wait_for(lock, kWriterInterval, [this] { return stopping || flush_requested != flush_completed; });
+        std::uint64_t target = flush_requested;
+        bool stop = stopping;
+        lock.unlock();
+
+        while (drainOnce(batch)) {
+        }
+
+        lock.lock();
+        flush_completed = target;
+        flushed_cv.notify_all();
+        if (stop) return;
+    }
+}
+
+bool Logger::drainOnce(std::string& batch) {
+    std::vector<std::shared_ptr<ThreadRing>> snapshot;
+    {
+        std::lock_guard<std::mutex> lock(rings_mutex);
+        snapshot = rings;
+    }
+
+    batch.clear();
+    bool wrote = false;
+    for (const auto& ring : snapshot) {
+        std::uint64_t head = ring->head.load(std::memory_order_relaxed);
+        std::uint64_t tail = ring->tail.load(std::memory_order_acquire);
+        for (; head != tail; ++head) {
+            batch += ring->slots[head % kRingCapacity];
+            batch += '\n';
+            if (batch.size() >= kWriteChunkBytes) {
+                ring->head.store(head + 1, std::memory_order_release);
+                writeBatch(batch);
+                batch.clear();
+                wrote = true;
+            }
+        }
+        ring->head.store(tail, std::memory_order_release);
+    }
+
+    // Report losses once per pass rather than per line
+    std::uint64_t lost = dropped.load(std::memory_order_relaxed);
+    if (lost != dropped_reported) {
+        batch += "{\"ts\":\"";
+        appendTimestamp(batch, std::chrono::system_clock::now());
+        batch += "\",\"level\":\"warn\",\"thread\":0,\"event\":\"log_lines_dropped\","
+                 "\"msg\":\"Log rings were full\",\"count\":";
+        batch += std::to_string(lost - dropped_reported);
+        batch += "}\n";
+        dropped_reported = lost;
+    }
+
+    if (!batch.empty()) {
+        writeBatch(batch);
+        wrote = true;
+    }
+
+    std::lock_guard<std::mutex> lock(rings_mutex);
+    rings.erase(std::remove_if(rings.begin(), rings.end(), [](const std::shared_ptr<ThreadRing>& ring) {
+        return ring->retired.load(std::memory_order_acquire) &&
+               ring->head.load(std::memory_order_relaxed) == ring->tail.load(std::memory_order_acquire);
+    }), rings.end());
+    return wrote;
+}
+
+void Logger::writeBatch(const std::string& batch) {
+    std::lock_guard<std::mutex> lock(output_mutex);
+    std::fwrite(batch.data(), 1, batch.size(), output);
+    std::fflush(output);
+}
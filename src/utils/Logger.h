@@ -0,0 +1,156 @@
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+enum class LogLevel {
+    DEBUG,
+    INFO,
+    WARN,
+    ERROR,
+    OFF
+};
+
+// One key/value pair of a structured log line. Strings are referenced, not
+// copied, so fields must not outlive the log() call they are passed to.
+struct LogField {
+    enum class Type { STRING, SIGNED, UNSIGNED, REAL, BOOLEAN };
+
+    const char* name;
+    Type type;
+    std::string_view text;
+    std::int64_t signed_value = 0;
+    std::uint64_t unsigned_value = 0;
+    double real_value = 0.0;
+    bool flag = false;
+
+    LogField(const char* name, std::string_view value) : name(name), type(Type::STRING), text(value) {}
+    LogField(const char* name, const std::string& value) : name(name), type(Type::STRING), text(value) {}
+    LogField(const char* name, const char* value) : name(name), type(Type::STRING), text(value) {}
+    LogField(const char* name, double value) : name(name), type(Type::REAL), real_value(value) {}
+    LogField(const char* name, bool value) : name(name), type(Type::BOOLEAN), flag(value) {}
+
+    template <typename T, typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value &&
+                                                  std::is_signed<T>::value, int>::type = 0>
+    LogField(const char* name, T value) : name(name), type(Type::SIGNED), signed_value(value) {}
+
+    template <typename T, typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value &&
+                                                  std::is_unsigned<T>::value, int>::type = 0>
+    LogField(const char* name, T value) : name(name), type(Type::UNSIGNED), unsigned_value(value) {}
+};
+
+// Lets through at most `per_second` messages on average with bursts of up
+// to `burst`, and counts the rest. Lock-free (one CAS per call), so it can
+// sit on a hot path in front of a repetitive alert.
+class LogRateLimiter {
+public:
+    LogRateLimiter(double per_second, double burst);
+
+    // True if the message may be logged; suppressed is then set to the
+    // number of messages dropped since the last one let through
+    bool tryAcquire(std::uint64_t& suppressed);
+
+private:
+    std::int64_t interval_ns;  // Cost of one message
+    std::int64_t tolerance_ns; // How far ahead of schedule a burst may run
+    std::atomic<std::int64_t> theoretical_arrival; // Generic cell rate algorithm state
+    std::atomic<std::uint64_t> suppressed_count;
+};
+
+// Process-wide structured logger. log() formats one JSON line on the
+// calling thread and hands it to that thread's own ring buffer without
+// taking a lock; a background thread drains every ring into the output in
+// batches. Nothing on the logging path flushes or waits for I/O: when a
+// ring is full the line is dropped and counted, and the writer reports the
+// loss. Output goes to stderr until setOutputFile() is called.
+//
+//   {"ts":"2026-10-18T14:54:19.123456Z","level":"warn","thread":3,"event":"fraud_alert",
+//    "msg":"Transaction flagged","transaction_id":42,"checks":"High Value"}
+class Logger {
+public:
+    static constexpr std::size_t kRingCapacity = 4096; // Lines buffered per thread
+
+    static Logger& instance(); // Lives until exit; remaining lines are written by an atexit handler
+
+    Logger(const Logger&) = delete;
+    Logger& operator=(const Logger&) = delete;
+
+    void setLevel(LogLevel level);
+    LogLevel getLevel() const;
+    bool isEnabled(LogLevel level) const {
+        int current = min_level.load(std::memory_order_relaxed);
+        return level != LogLevel::OFF && static_cast<int>(level) >= current;
+    }
+
+    bool setOutputFile(const std::string& path); // Appends; false (output unchanged) if it cannot be opened
+    void useStandardError();
+
+    void log(LogLevel level, std::string_view event, std::string_view message,
+             std::initializer_list<LogField> fields = {});
+
+    void flush(); // Returns once every line logged before the call has been written
+    std::uint64_t getDroppedCount() const;
+
+    static const char* logLevelToString(LogLevel level);
+    static LogLevel stringToLogLevel(std::string_view text); // Throws std::invalid_argument
+
+private:
+    struct ThreadRing;
+    friend struct ThreadRingHandle;
+
+    std::atomic<int> min_level;
+    std::atomic<std::uint64_t> dropped;
+    std::uint64_t dropped_reported;
+    std::atomic<std::uint32_t> next_thread_number;
+
+    std::mutex rings_mutex; // Registration only
+    std::vector<std::shared_ptr<ThreadRing>> rings;
+
+    std::mutex output_mutex;
+    std::FILE* output;
+    bool owns_output;
+
+    std::mutex writer_mutex;
+    std::condition_variable writer_cv;
+    std::condition_variable flushed_cv;
+    std::uint64_t flush_requested;
+    std::uint64_t flush_completed;
+    bool stopping;
+    std::atomic<bool> stopped; // Writer gone; log() then writes directly
+    std::thread writer;
+
+    Logger();
+    void shutdown();
+
+    ThreadRing& ringForThisThread();
+    void writerLoop();
+    bool drainOnce(std::string& batch); // True if anything was written
+    void writeBatch(const std::string& batch);
+};
+
+// Shorthands for Logger::instance().log(...)
+inline void logDebug(std::string_view event, std::string_view message, std::initializer_list<LogField> fields = {}) {
+    Logger::instance().log(LogLevel::DEBUG, event, message, fields);
+}
+inline void logInfo(std::string_view event, std::string_view message, std::initializer_list<LogField> fields = {}) {
+    Logger::instance().log(LogLevel::INFO, event, message, fields);
+}
+inline void logWarn(std::string_view event, std::string_view message, std::initializer_list<LogField> fields = {}) {
+    Logger::instance().log(LogLevel::WARN, event, message, fields);
+}
+inline void logError(std::string_view event, std::string_view message, std::initializer_list<LogField> fields = {}) {
+    Logger::instance().log(LogLevel::ERROR, event, message, fields);
+}
+
+#endif // LOGGER_H
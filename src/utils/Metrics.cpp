@@ -0,0 +1,250 @@
+#include "Metrics.h"
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+
+namespace metrics_detail {
+    std::atomic<bool> metrics_enabled{false};
+
+    std::size_t threadShard() {
+        static std::atomic<std::size_t> next_shard{0};
+        thread_local const std::size_t shard = next_shard.fetch_add(1, std::memory_order_relaxed) % kShardCount;
+        return shard;
+    }
+}
+
+namespace {
+    void appendNumber(std::string& out, double value) {
+        char buffer[32];
+        std::snprintf(buffer, sizeof(buffer), "%.9g", value);
+        out += buffer;
+    }
+
+    void appendSample(std::string& out, const std::string& name, const std::string& labels, double value) {
+        out += name;
+        if (!labels.empty()) {
+            out += '{';
+            out += labels;
+            out += '}';
+        }
+        out += ' ';
+        appendNumber(out, value);
+        out += '\n';
+    }
+
+    std::string withLabel(const std::string& labels, const char* extra) {
+        return labels.empty() ? std::string(extra) : labels + "," + extra;
+    }
+}
+
+// Counter
+std::uint64_t Counter::value() const {
+    std::uint64_t total = 0;
+    for (const auto& shard : shards) {
+        total += shard.value.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+void Counter::reset() {
+    for (auto& shard : shards) {
+        shard.value.store(0, std::memory_order_relaxed);
+    }
+}
+
+// Gauge
+void Gauge::add(double delta) {
+    double value = current.load(std::memory_order_relaxed);
+    while (!current.compare_exchange_weak(value, value + delta, std::memory_order_relaxed)) {
+    }
+}
+
+// LatencySummary
+LatencySummary::LatencySummary() {
+    for (auto& shard : shards) {
+        shard.store(nullptr, std::memory_order_relaxed);
+    }
+}
+
+LatencySummary::~LatencySummary() {
+    for (auto& shard : shards) {
+        delete shard.load(std::memory_order_relaxed);
+    }
+}
+
+LatencyHistogram* LatencySummary::allocateShard(std::size_t shard) {
+    auto* fresh = new LatencyHistogram(kHighestTrackable, kSignificantDigits);
+    LatencyHistogram* expected = nullptr;
+    if (!shards[shard].compare_exchange_strong(expected, fresh, std::memory_order_acq_rel)) {
+        delete fresh; // Another thread on the same shard got there first
+        return expected;
+    }
+    return fresh;
+}
+
+LatencyHistogram LatencySummary::snapshot() const {
+    LatencyHistogram merged(kHighestTrackable, kSignificantDigits);
+    for (const auto& shard : shards) {
+        if (const LatencyHistogram* histogram = shard.load(std::memory_order_acquire)) {
+            merged.merge(*histogram);
+        }
+    }
+    return merged;
+}
+
+void LatencySummary::reset() {
+    for (auto& shard : shards) {
+        if (LatencyHistogram* histogram = shard.load(std::memory_order_acquire)) {
+            histogram->reset();
+        }
+    }
+}
+
+// MetricsRegistry
+const char* MetricsRegistry::kPrometheusContentType = "text/plain; version=0.0.4; charset=utf-8";
+
+MetricsRegistry& MetricsRegistry::instance() {
+    // Never destroyed, so metrics cached in function-local statics stay
+    // valid while other statics are torn down
+    static MetricsRegistry* registry = new MetricsRegistry();
+    return *registry;
+}
+
+void MetricsRegistry::setEnabled(bool enabled) {
+    metrics_detail::metrics_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+Counter& MetricsRegistry::counter(const std::string& name, const std::string& help, const MetricLabels& labels) {
+    return *findOrCreate(name, help, MetricType::COUNTER, labels).counter;
+}
+
+Gauge& MetricsRegistry::gauge(const std::string& name, const std::string& help, const MetricLabels& labels) {
+    return *findOrCreate(name, help, MetricType::GAUGE, labels).gauge;
+}
+
+LatencySummary& MetricsRegistry::latency(const std::string& name, const std::string& help,
+                                         const MetricLabels& labels) {
+    return *findOrCreate(name, help, MetricType::SUMMARY, labels).summary;
+}
+
+MetricsRegistry::Series& MetricsRegistry::findOrCreate(const std::string& name, const std::string& help,
+                                                       MetricType type, const MetricLabels& labels) {
+    if (!isValidName(name)) {
+        throw std::invalid_argument("Invalid metric name: " + name);
+    }
+    std::string rendered = renderLabels(labels);
+
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    auto it = families.find(name);
+    if (it == families.end()) {
+        it = families.emplace(name, Family{help, type, {}}).first;
+    } else if (it->second.type != type) {
+        throw std::invalid_argument("Metric " + name + " is already registered with another type");
+    }
+
+    Family& family = it->second;
+    for (auto& series : family.series) {
+        if (series->labels == rendered) return *series;
+    }
+
+    auto series = std::make_unique<Series>();
+    series->labels = std::move(rendered);
+    switch (type) {
+        case MetricType::COUNTER: series->counter = std::make_unique<Counter>(); break;
+        case MetricType::GAUGE: series->gauge = std::make_unique<Gauge>(); break;
+        case MetricType::SUMMARY: series->summary = std::make_unique<LatencySummary>(); break;
+    }
+    family.series.push_back(std::move(series));
+    return *family.series.back();
+}
+
+std::string MetricsRegistry::renderPrometheus() const {
+    static const std::pair<double, const char*> kQuantiles[] = {
+        {50.0, "quantile=\"0.5\""}, {90.0, "quantile=\"0.9\""},
+        {99.0, "quantile=\"0.99\""}, {99.9, "quantile=\"0.999\""}};
+
+    std::string out;
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    for (const auto& [name, family] : families) {
+        out += "# HELP " + name + " " + family.help + "\n";
+        out += "# TYPE " + name + " ";
+        out += family.type == MetricType::COUNTER ? "counter\n" : family.type == MetricType::GAUGE ? "gauge\n" : "summary\n";
+
+        for (const auto& series : family.series) {
+            switch (family.type) {
+                case MetricType::COUNTER:
+                    appendSample(out, name, series->labels, static_cast<double>(series->counter->value()));
+                    break;
+                case MetricType::GAUGE:
+                    appendSample(out, name, series->labels, series->gauge->value());
+                    break;
+                case MetricType::SUMMARY: {
+                    LatencyHistogram merged = series->summary->snapshot();
+                    for (const auto& [percentile, label] : kQuantiles) {
+                        appendSample(out, name, withLabel(series->labels, label),
+                                     merged.valueAtPercentile(percentile) / 1e9);
+                    }
+                    appendSample(out, name + "_sum", series->labels, merged.mean() * merged.count() / 1e9);
+                    appendSample(out, name + "_count", series->labels, static_cast<double>(merged.count()));
+                    break;
+                }
+            }
+        }
+    }
+    return out;
+}
+
+bool MetricsRegistry::writePrometheusFile(const std::string& path) const {
+    // Write beside the target and rename over it, so a scraper never reads
+    // a half-written dump
+    std::string temporary = path + ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::trunc);
+        if (!file) return false;
+        file << renderPrometheus();
+        if (!file.flush()) return false;
+    }
+    return std::rename(temporary.c_str(), path.c_str()) == 0;
+}
+
+void MetricsRegistry::reset() {
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    for (auto& entry : families) {
+        for (auto& series : entry.second.series) {
+            if (series->counter) series->counter->reset();
+            if (series->summary) series->summary->reset();
+        }
+    }
+}
+
+std::string MetricsRegistry::renderLabels(const MetricLabels& labels) {
+    std::string out;
+    for (const auto& [key, value] : labels) {
+        if (!isValidName(key)) {
+            throw std::invalid_argument("Invalid metric label: " + key);
+        }
+        if (!out.empty()) out += ',';
+        out += key;
+        out += "=\"";
+        for (char c : value) {
+            switch (c) {
+                case '\\': out += "\\\\"; break;
+                case '"': out += "\\\""; break;
+                case '\n': out += "\\n"; break;
+                default: out += c; break;
+            }
+        }
+        out += '"';
+    }
+    return out;
+}
+
+bool MetricsRegistry::isValidName(const std::string& name) {
+    if (name.empty()) return false;
+    for (std::size_t i = 0; i < name.size(); ++i) {
+        char c = name[i];
+        bool letter = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_' || c == ':';
+        if (!letter && !(i > 0 && c >= '0' && c <= '9')) return false;
+    }
+    return true;
+}
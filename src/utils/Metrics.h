@@ -0,0 +1,175 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+#include "LatencyHistogram.h"
+
+using MetricLabels = std::vector<std::pair<std::string, std::string>>;
+
+namespace metrics_detail {
+    // Writers are spread over this many slots by thread, so each thread
+    // normally increments its own cache line and reads sum the slots
+    constexpr std::size_t kShardCount = 16;
+
+    std::size_t threadShard(); // Stable per thread
+
+    extern std::atomic<bool> metrics_enabled;
+
+    inline bool enabled() {
+        return metrics_enabled.load(std::memory_order_relaxed);
+    }
+}
+
+// Monotonic count. increment() is dropped while metrics are disabled.
+class Counter {
+public:
+    void increment(std::uint64_t amount = 1) {
+        if (!metrics_detail::enabled()) return;
+        shards[metrics_detail::threadShard()].value.fetch_add(amount, std::memory_order_relaxed);
+    }
+
+    std::uint64_t value() const;
+    void reset();
+
+private:
+    struct alignas(64) Shard {
+        std::atomic<std::uint64_t> value{0};
+    };
+    std::array<Shard, metrics_detail::kShardCount> shards;
+};
+
+// Current level of something (open connections, queued requests). Unlike
+// the other metrics it is updated even while disabled, so it is still
+// right when metrics are switched on; keep it off hot paths.
+class Gauge {
+public:
+    void set(double value) { current.store(value, std::memory_order_relaxed); }
+    void add(double delta);
+    double value() const { return current.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<double> current{0.0};
+};
+
+// Latency distribution in nanoseconds, exposed as a Prometheus summary in
+// seconds. Each shard is an HDR histogram allocated the first time a thread
+// mapped to it records, so idle summaries cost a few hundred bytes.
+class LatencySummary {
+public:
+    static constexpr std::int64_t kHighestTrackable = 100LL * 1000000000LL; // 100 s
+    static constexpr int kSignificantDigits = 2;
+
+    LatencySummary();
+    ~LatencySummary();
+
+    LatencySummary(const LatencySummary&) = delete;
+    LatencySummary& operator=(const LatencySummary&) = delete;
+
+    void record(std::int64_t nanoseconds) {
+        if (!metrics_detail::enabled()) return;
+        std::size_t shard = metrics_detail::threadShard();
+        LatencyHistogram* histogram = shards[shard].load(std::memory_order_acquire);
+        if (!histogram) histogram = allocateShard(shard);
+        histogram->recordShared(nanoseconds);
+    }
+
+    LatencyHistogram snapshot() const; // Merge of every shard
+    void reset();
+
+private:
+    std::array<std::atomic<LatencyHistogram*>, metrics_detail::kShardCount> shards;
+
+    LatencyHistogram* allocateShard(std::size_t shard);
+};
+
+// Times a scope into a LatencySummary. Reads no clock while metrics are off.
+class ScopedLatency {
+public:
+    explicit ScopedLatency(LatencySummary& summary)
+        : summary(summary), running(metrics_detail::enabled()) {
+        if (running) start = std::chrono::steady_clock::now();
+    }
+
+    ~ScopedLatency() {
+        if (running) {
+            summary.record(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start).count());
+        }
+    }
+
+    ScopedLatency(const ScopedLatency&) = delete;
+    ScopedLatency& operator=(const ScopedLatency&) = delete;
+
+private:
+    LatencySummary& summary;
+    bool running;
+    std::chrono::steady_clock::time_point start;
+};
+
+// Process-wide set of named metrics. Metrics are registered once, usually
+// into a function-local static at the call site, and live until exit; the
+// references handed out stay valid. Recording is lock-free, and costs one
+// relaxed load and a branch while metrics are disabled (the default).
+class MetricsRegistry {
+public:
+    static MetricsRegistry& instance();
+
+    static bool isEnabled() { return metrics_detail::enabled(); }
+    static void setEnabled(bool enabled);
+
+    // Same name and labels return the same metric; a name keeps the type
+    // it was first registered with (std::invalid_argument otherwise)
+    Counter& counter(const std::string& name, const std::string& help, const MetricLabels& labels = {});
+    Gauge& gauge(const std::string& name, const std::string& help, const MetricLabels& labels = {});
+    LatencySummary& latency(const std::string& name, const std::string& help, const MetricLabels& labels = {});
+
+    // Prometheus text exposition format, version 0.0.4
+    std::string renderPrometheus() const;
+    bool writePrometheusFile(const std::string& path) const; // Replaces the file atomically
+
+    void reset(); // Zeroes counters and summaries; gauges keep their level
+
+    static const char* kPrometheusContentType;
+
+private:
+    enum class MetricType {
+        COUNTER,
+        GAUGE,
+        SUMMARY
+    };
+
+    struct Series {
+        std::string labels; // Rendered, e.g. operation="deposit"
+        std::unique_ptr<Counter> counter;
+        std::unique_ptr<Gauge> gauge;
+        std::unique_ptr<LatencySummary> summary;
+    };
+
+    struct Family {
+        std::string help;
+        MetricType type;
+        std::vector<std::unique_ptr<Series>> series;
+    };
+
+    mutable std::mutex registry_mutex;
+    std::map<std::string, Family> families; // Sorted, so dumps are stable
+
+    MetricsRegistry() = default;
+
+    Series& findOrCreate(const std::string& name, const std::string& help, MetricType type,
+                         const MetricLabels& labels);
+    static std::string renderLabels(const MetricLabels& labels);
+    static bool isValidName(const std::string& name);
+};
+
+#endif // METRICS_H
@@ -0,0 +1,166 @@
+#ifndef OPEN_ADDRESSING_MAP_H
+#define OPEN_ADDRESSING_MAP_H
+
+#include <vector>
+#include <string>
+#include <utility>
+#include <functional>
+#include <cstdint>
+#include <cstddef>
+
+// Hashes for OpenAddressingMap. Integer keys are mixed so sequential ids
+// spread across the table; strings use FNV-1a.
+template <typename Key>
+struct OpenAddressingHash {
+    std::uint64_t operator()(const Key& key) const {
+        return static_cast<std::uint64_t>(std::hash<Key>()(key)) * 0x9E3779B97F4A7C15ull;
+    }
+};
+
+template <>
+struct OpenAddressingHash<std::string> {
+    std::uint64_t operator()(const std::string& key) const {
+        std::uint64_t hash = 0xcbf29ce484222325ull;
+        for (unsigned char c : key) {
+            hash = (hash ^ c) * 0x100000001b3ull;
+        }
+        return hash;
+    }
+};
+
+// Flat hash map with linear probing and backward-shift deletion (no
+// tombstones). Entries live in one contiguous array, so a lookup is a hash
+// and usually a single cache line. Key and Value must be default
+// constructible. Not synchronised; callers provide locking.
+template <typename Key, typename Value, typename Hash = OpenAddressingHash<Key>>
+class OpenAddressingMap {
+public:
+    OpenAddressingMap() : count(0), mask(0) {}
+
+    Value* find(const Key& key) {
+        std::size_t slot = locate(key);
+        return slot == kNotFound ? nullptr : &slots[slot].value;
+    }
+
+    const Value* find(const Key& key) const {
+        std::size_t slot = locate(key);
+        return slot == kNotFound ? nullptr : &slots[slot].value;
+    }
+
+    bool contains(const Key& key) const {
+        return locate(key) != kNotFound;
+    }
+
+    // Returns false (leaving the map unchanged) if the key is already present
+    bool insert(const Key& key, Value value) {
+        if (locate(key) != kNotFound) return false;
+        growIfNeeded();
+        place(key, std::move(value));
+        return true;
+    }
+
+    void insertOrAssign(const Key& key, Value value) {
+        std::size_t slot = locate(key);
+        if (slot != kNotFound) {
+            slots[slot].value = std::move(value);
+            return;
+        }
+        growIfNeeded();
+        place(key, std::move(value));
+    }
+
+    bool erase(const Key& key) {
+        std::size_t hole = locate(key);
+        if (hole == kNotFound) return false;
+
+        // Shift later members of the probe run back so lookups never need tombstones
+        std::size_t next = (hole + 1) & mask;
+        while (slots[next].occupied) {
+            std::size_t home = homeSlot(slots[next].key);
+            if (((next - home) & mask) >= ((next - hole) & mask)) {
+                slots[hole] = std::move(slots[next]);
+                hole = next;
+            }
+            next = (next + 1) & mask;
+        }
+        slots[hole] = Slot();
+        --count;
+        return true;
+    }
+
+    void clear() {
+        slots.assign(slots.size(), Slot());
+        count = 0;
+    }
+
+    void reserve(std::size_t entries) {
+        std::size_t capacity = 16;
+        while (capacity * kMaxLoadNum < entries * kMaxLoadDen) capacity *= 2;
+        if (capacity > slots.size()) rehash(capacity);
+    }
+
+    std::size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    // Calls visit(key, value) for every entry, in table order
+    template <typename Visitor>
+    void forEach(Visitor visit) const {
+        for (const Slot& slot : slots) {
+            if (slot.occupied) visit(slot.key, slot.value);
+        }
+    }
+
+private:
+    struct Slot {
+        bool occupied = false;
+        Key key{};
+        Value value{};
+    };
+
+    static constexpr std::size_t kNotFound = static_cast<std::size_t>(-1);
+    static constexpr std::size_t kMaxLoadNum = 7; // Grow past 70% full
+    static constexpr std::size_t kMaxLoadDen = 10;
+
+    std::vector<Slot> slots; // Power-of-two size
+    std::size_t count;
+    std::size_t mask;
+
+    std::size_t homeSlot(const Key& key) const {
+        return static_cast<std::size_t>(Hash()(key) >> 20) & mask;
+    }
+
+    std::size_t locate(const Key& key) const {
+        if (count == 0) return kNotFound;
+        for (std::size_t slot = homeSlot(key); slots[slot].occupied; slot = (slot + 1) & mask) {
+            if (slots[slot].key == key) return slot;
+        }
+        return kNotFound;
+    }
+
+    void place(const Key& key, Value value) {
+        std::size_t slot = homeSlot(key);
+        while (slots[slot].occupied) slot = (slot + 1) & mask;
+        slots[slot].occupied = true;
+        slots[slot].key = key;
+        slots[slot].value = std::move(value);
+        ++count;
+    }
+
+    void growIfNeeded() {
+        if ((count + 1) * kMaxLoadDen > slots.size() * kMaxLoadNum) {
+            rehash(slots.empty() ? 16 : slots.size() * 2);
+        }
+    }
+
+    void rehash(std::size_t capacity) {
+        std::vector<Slot> old(capacity);
+        old.swap(slots);
+        mask = capacity - 1;
+        count = 0;
+        for (Slot& slot : old) {
+            if (slot.occupied) place(slot.key, std::move(slot.value));
+        }
+    }
+};
+
+#endif // OPEN_ADDRESSING_MAP_H
@@ -0,0 +1,186 @@
+#include "PeriodCalendar.h"
+#include <algorithm>
+#include <array>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+namespace {
+    constexpr int kFirstYear = 1970;  // Period 0
+    constexpr int kTableYears = 230;  // Boundaries precomputed through 2199
+    constexpr std::size_t kMaxCalendars = 4096;
+
+    // Interned calendars plus the thread that rolls them over at month ends
+    struct CalendarRegistry {
+        std::mutex mutex;
+        std::condition_variable changed;
+        std::map<const TimeZone*, std::shared_ptr<const PeriodCalendar>> calendars;
+        std::array<std::atomic<const PeriodCalendar*>, kMaxCalendars> by_id{};
+        std::uint16_t next_id = 1;
+        std::thread scheduler;
+        bool stopping = false;
+
+        ~CalendarRegistry() {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stopping = true;
+            }
+            changed.notify_all();
+            if (scheduler.joinable()) {
+                scheduler.join();
+            }
+        }
+    };
+
+    CalendarRegistry& calendarRegistry() {
+        static CalendarRegistry registry;
+        return registry;
+    }
+
+    void runScheduler(CalendarRegistry& registry) {
+        std::unique_lock<std::mutex> lock(registry.mutex);
+        while (!registry.stopping) {
+            auto next = PeriodCalendar::time_point::max();
+            for (const auto& pair : registry.calendars) {
+                next = std::min(next, pair.second->nextBoundary());
+            }
+
+            // Woken early when a calendar is added or on shutdown; advancing is idempotent
+            if (next == PeriodCalendar::time_point::max()) {
+                registry.changed.wait(lock);
+            } else {
+                registry.changed.wait_until(lock, next);
+            }
+            if (registry.stopping) break;
+
+            auto now = std::chrono::system_clock::now();
+            for (const auto& pair : registry.calendars) {
+                pair.second->advanceTo(now);
+            }
+        }
+    }
+
+    std::int64_t toEpochSeconds(PeriodCalendar::time_point timestamp) {
+        return std::chrono::duration_cast<std::chrono::seconds>(timestamp.time_since_epoch()).count();
+    }
+}
+
+PeriodCalendar::PeriodCalendar(std::shared_ptr<const TimeZone> time_zone, std::uint16_t id)
+    : time_zone(std::move(time_zone)), id(id), current_period(0), next_boundary(0) {
+    period_starts.reserve(kTableYears * 12 + 1);
+    for (int i = 0; i <= kTableYears * 12; ++i) {
+        auto start = this->time_zone->fromLocal(kFirstYear + i / 12, i % 12 + 1, 1);
+        period_starts.push_back(toEpochSeconds(start));
+    }
+    advanceTo(std::chrono::system_clock::now());
+}
+
+std::shared_ptr<const PeriodCalendar> PeriodCalendar::forTimeZone(std::shared_ptr<const TimeZone> time_zone) {
+    if (!time_zone) {
+        throw std::invalid_argument("Time zone cannot be null");
+    }
+
+    CalendarRegistry& registry = calendarRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    auto it = registry.calendars.find(time_zone.get());
+    if (it != registry.calendars.end()) {
+        return it->second;
+    }
+
+    if (registry.next_id >= kMaxCalendars) {
+        throw std::runtime_error("Too many distinct time zones for budget periods");
+    }
+    std::uint16_t id = registry.next_id++;
+    std::shared_ptr<const PeriodCalendar> calendar(new PeriodCalendar(time_zone, id));
+    registry.calendars.emplace(time_zone.get(), calendar);
+    registry.by_id[id].store(calendar.get(), std::memory_order_release);
+
+    if (!registry.scheduler.joinable()) {
+        registry.scheduler = std::thread(runScheduler, std::ref(registry));
+    } else {
+        registry.changed.notify_all();
+    }
+    return calendar;
+}
+
+std::shared_ptr<const PeriodCalendar> PeriodCalendar::local() {
+    static const std::shared_ptr<const PeriodCalendar> calendar = forTimeZone(TimeZone::local());
+    return calendar;
+}
+
+const PeriodCalendar* PeriodCalendar::byId(std::uint16_t id) {
+    if (id == kNoCalendar || id >= kMaxCalendars) return nullptr;
+    return calendarRegistry().by_id[id].load(std::memory_order_acquire);
+}
+
+void PeriodCalendar::advanceAll(time_point now) {
+    CalendarRegistry& registry = calendarRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    for (const auto& pair : registry.calendars) {
+        pair.second->advanceTo(now);
+    }
+    registry.changed.notify_all();
+}
+
+// Getters
+const std::shared_ptr<const TimeZone>& PeriodCalendar::getTimeZone() const {
+    return time_zone;
+}
+
+std::uint16_t PeriodCalendar::getId() const {
+    return id;
+}
+
+PeriodCalendar::time_point PeriodCalendar::nextBoundary() const {
+    return time_point(std::chrono::seconds(next_boundary.load(std::memory_order_relaxed)));
+}
+
+// Period arithmetic
+std::uint32_t PeriodCalendar::periodAt(time_point timestamp) const {
+    std::int64_t seconds = toEpochSeconds(timestamp);
+    if (seconds < period_starts.front()) return 0;
+
+    if (seconds < period_starts.back()) {
+        auto it = std::upper_bound(period_starts.begin(), period_starts.end(), seconds);
+        return static_cast<std::uint32_t>((it - period_starts.begin()) - 1);
+    }
+
+    std::tm local = time_zone->toLocalTm(timestamp);
+    return static_cast<std::uint32_t>((local.tm_year + 1900 - kFirstYear) * 12 + local.tm_mon);
+}
+
+PeriodCalendar::time_point PeriodCalendar::periodStart(std::uint32_t period) const {
+    return time_point(std::chrono::seconds(startSeconds(period)));
+}
+
+PeriodCalendar::time_point PeriodCalendar::periodEnd(std::uint32_t period) const {
+    return time_point(std::chrono::seconds(startSeconds(period + 1) - 1));
+}
+
+void PeriodCalendar::advanceTo(time_point now) const {
+    std::uint32_t period = periodAt(now);
+    std::uint32_t current = current_period.load(std::memory_order_relaxed);
+
+    // Periods only move forward, whoever advances first
+    while (period > current && !current_period.compare_exchange_weak(current, period, std::memory_order_acq_rel)) {
+    }
+    next_boundary.store(startSeconds(std::max(period, current) + 1), std::memory_order_relaxed);
+}
+
+int PeriodCalendar::periodYear(std::uint32_t period) {
+    return kFirstYear + static_cast<int>(period / 12);
+}
+
+int PeriodCalendar::periodMonth(std::uint32_t period) {
+    return static_cast<int>(period % 12) + 1;
+}
+
+// Private methods
+std::int64_t PeriodCalendar::startSeconds(std::uint32_t period) const {
+    if (period < period_starts.size()) {
+        return period_starts[period];
+    }
+    return toEpochSeconds(time_zone->fromLocal(periodYear(period), periodMonth(period), 1));
+}
@@ -0,0 +1,63 @@
+#ifndef PERIOD_CALENDAR_H
+#define PERIOD_CALENDAR_H
+
+#include <vector>
+#include <memory>
+#include <chrono>
+#include <atomic>
+#include <cstdint>
+#include "TimeZone.h"
+
+// Monthly budget periods for one time zone. Periods are numbered as months
+// since January 1970 (so the same number means the same calendar month in
+// every zone) and their boundaries are computed once when the calendar is
+// created. Each calendar also tracks the current period; a scheduler thread
+// bumps it at each month boundary, so readers learn the period with a single
+// atomic load instead of querying the clock and converting dates.
+class PeriodCalendar {
+public:
+    using time_point = std::chrono::system_clock::time_point;
+
+    static constexpr std::uint16_t kNoCalendar = 0; // Never a valid id
+
+    // Factories; calendars are interned per zone and live for the process
+    static std::shared_ptr<const PeriodCalendar> forTimeZone(std::shared_ptr<const TimeZone> time_zone);
+    static std::shared_ptr<const PeriodCalendar> local();
+    static const PeriodCalendar* byId(std::uint16_t id); // Null for unknown ids
+
+    // Moves every calendar to the period containing now. Called by the
+    // scheduler at month boundaries; exposed for replays and clock changes.
+    static void advanceAll(time_point now);
+
+    // Getters
+    const std::shared_ptr<const TimeZone>& getTimeZone() const;
+    std::uint16_t getId() const;
+    std::uint32_t currentPeriod() const;
+    time_point nextBoundary() const;
+
+    // Period arithmetic
+    std::uint32_t periodAt(time_point timestamp) const;
+    time_point periodStart(std::uint32_t period) const;
+    time_point periodEnd(std::uint32_t period) const; // Last second of the period
+    void advanceTo(time_point now) const;
+
+    static int periodYear(std::uint32_t period);
+    static int periodMonth(std::uint32_t period); // 1-12
+
+private:
+    std::shared_ptr<const TimeZone> time_zone;
+    std::uint16_t id;
+    std::vector<std::int64_t> period_starts; // Epoch seconds, indexed by period
+    mutable std::atomic<std::uint32_t> current_period;
+    mutable std::atomic<std::int64_t> next_boundary; // Start of current_period + 1
+
+    PeriodCalendar(std::shared_ptr<const TimeZone> time_zone, std::uint16_t id);
+
+    std::int64_t startSeconds(std::uint32_t period) const;
+};
+
+inline std::uint32_t PeriodCalendar::currentPeriod() const {
+    return current_period.load(std::memory_order_acquire);
+}
+
+#endif // PERIOD_CALENDAR_H
@@ -0,0 +1,507 @@
+#include "TimeZone.h"
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+    constexpr std::int64_t kMinTime = std::numeric_limits<std::int64_t>::min();
+    constexpr std::int64_t kMaxTime = std::numeric_limits<std::int64_t>::max();
+
+    // Years covered when a zone has to be derived from rules or the C library
+    constexpr int kFirstProbeYear = 1970;
+    constexpr int kLastRuleYear = 2100;
+    constexpr int kLastProbeYear = 2070;
+
+    std::mutex registry_mutex;
+    std::map<std::string, std::shared_ptr<const TimeZone>>& registry() {
+        static std::map<std::string, std::shared_ptr<const TimeZone>> zones;
+        return zones;
+    }
+
+    bool systemLocalTime(std::time_t time, std::tm& result) {
+#ifdef _WIN32
+        return localtime_s(&result, &time) == 0;
+#else
+        return localtime_r(&time, &result) != nullptr;
+#endif
+    }
+
+    std::string zoneInfoDirectory() {
+        const char* tzdir = std::getenv("TZDIR");
+        return (tzdir && *tzdir) ? tzdir : "/usr/share/zoneinfo";
+    }
+
+    bool readFile(const std::string& path, std::string& contents) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file) return false;
+        contents.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        return true;
+    }
+
+    std::uint32_t readBigEndian32(const std::string& data, std::size_t pos) {
+        return (static_cast<std::uint32_t>(static_cast<unsigned char>(data[pos])) << 24) |
+               (static_cast<std::uint32_t>(static_cast<unsigned char>(data[pos + 1])) << 16) |
+               (static_cast<std::uint32_t>(static_cast<unsigned char>(data[pos + 2])) << 8) |
+               static_cast<std::uint32_t>(static_cast<unsigned char>(data[pos + 3]));
+    }
+
+    std::int64_t readBigEndian64(const std::string& data, std::size_t pos) {
+        std::uint64_t high = readBigEndian32(data, pos);
+        std::uint64_t low = readBigEndian32(data, pos + 4);
+        return static_cast<std::int64_t>((high << 32) | low);
+    }
+
+    std::string formatOffsetName(int utc_offset_seconds) {
+        int magnitude = std::abs(utc_offset_seconds);
+        std::ostringstream oss;
+        oss << "UTC" << (utc_offset_seconds < 0 ? '-' : '+')
+            << (magnitude / 36000) << ((magnitude / 3600) % 10) << ':'
+            << ((magnitude % 3600) / 600) << ((magnitude / 60) % 10);
+        return oss.str();
+    }
+
+    // Parses "+hh[:mm[:ss]]" / "-hh..." / "hh..." and returns seconds
+    bool parseClock(const std::string& text, std::size_t& pos, int& seconds) {
+        int sign = 1;
+        if (pos < text.size() && (text[pos] == '+' || text[pos] == '-')) {
+            sign = (text[pos] == '-') ? -1 : 1;
+            pos++;
+        }
+        int parts[3] = {0, 0, 0};
+        for (int part = 0; part < 3; ++part) {
+            if (part > 0) {
+                if (pos >= text.size() || text[pos] != ':') break;
+                pos++;
+            }
+            std::size_t start = pos;
+            while (pos < text.size() && text[pos] >= '0' && text[pos] <= '9') {
+                parts[part] = parts[part] * 10 + (text[pos] - '0');
+                pos++;
+            }
+            if (pos == start) return false;
+        }
+        seconds = sign * (parts[0] * 3600 + parts[1] * 60 + parts[2]);
+        return true;
+    }
+
+    bool parseZoneAbbreviation(const std::string& text, std::size_t& pos) {
+        if (pos < text.size() && text[pos] == '<') {
+            std::size_t close = text.find('>', pos);
+            if (close == std::string::npos) return false;
+            pos = close + 1;
+            return true;
+        }
+        std::size_t start = pos;
+        while (pos < text.size() && ((text[pos] >= 'A' && text[pos] <= 'Z') || (text[pos] >= 'a' && text[pos] <= 'z'))) {
+            pos++;
+        }
+        return pos - start >= 3;
+    }
+
+    struct PosixDateRule {
+        char kind; // 'M' (month.week.day), 'J' (Julian, no leap day) or 'D' (zero-based day of year)
+        int month;
+        int week;
+        int day;
+        int time_seconds;
+    };
+
+    bool parseDateRule(const std::string& text, std::size_t& pos, PosixDateRule& rule) {
+        rule = PosixDateRule{'D', 0, 0, 0, 7200};
+        auto readNumber = [&](int& value) {
+            std::size_t start = pos;
+            value = 0;
+            while (pos < text.size() && text[pos] >= '0' && text[pos] <= '9') {
+                value = value * 10 + (text[pos] - '0');
+                pos++;
+            }
+            return pos > start;
+        };
+
+        if (pos < text.size() && text[pos] == 'M') {
+            rule.kind = 'M';
+            pos++;
+            if (!readNumber(rule.month) || pos >= text.size() || text[pos++] != '.') return false;
+            if (!readNumber(rule.week) || pos >= text.size() || text[pos++] != '.') return false;
+            if (!readNumber(rule.day)) return false;
+        } else if (pos < text.size() && text[pos] == 'J') {
+            rule.kind = 'J';
+            pos++;
+            if (!readNumber(rule.day)) return false;
+        } else if (!readNumber(rule.day)) {
+            return false;
+        }
+
+        if (pos < text.size() && text[pos] == '/') {
+            pos++;
+            return parseClock(text, pos, rule.time_seconds);
+        }
+        return true;
+    }
+
+    bool isLeapYear(int year) {
+        return (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+    }
+
+    // Local wall-clock seconds (relative to the epoch) at which the rule fires in the given year
+    std::int64_t ruleLocalSeconds(const PosixDateRule& rule, int year) {
+        std::int64_t days = 0;
+        if (rule.kind == 'M') {
+            std::int64_t first_of_month = TimeZone::daysFromCivil(year, rule.month, 1);
+            int first_weekday = static_cast<int>(((first_of_month + 4) % 7 + 7) % 7);
+            int day_of_month = 1 + (rule.day - first_weekday + 7) % 7 + (rule.week - 1) * 7;
+            static const int kMonthDays[12] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+            int month_length = kMonthDays[rule.month - 1] + ((rule.month == 2 && isLeapYear(year)) ? 1 : 0);
+            while (day_of_month > month_length) day_of_month -= 7;
+            days = first_of_month + day_of_month - 1;
+        } else if (rule.kind == 'J') {
+            days = TimeZone::daysFromCivil(year, 1, 1) + rule.day - 1;
+            if (isLeapYear(year) && rule.day >= 60) days++;
+        } else {
+            days = TimeZone::daysFromCivil(year, 1, 1) + rule.day;
+        }
+        return days * 86400 + rule.time_seconds;
+    }
+}
+
+TimeZone::TimeZone(const std::string& name, std::vector<Transition> transitions)
+    : name(name), transitions(std::move(transitions)), hot_begin(0), hot_end(0), hot_offset(0) {
+    if (this->transitions.empty()) {
+        this->transitions.push_back(Transition{kMinTime, 0, false});
+    }
+    this->transitions.front().utc_seconds = kMinTime;
+
+    auto now = toEpochSeconds(std::chrono::system_clock::now());
+    auto it = std::upper_bound(this->transitions.begin(), this->transitions.end(), now,
+        [](std::int64_t value, const Transition& t) { return value < t.utc_seconds; });
+    auto current = std::prev(it);
+    hot_begin = current->utc_seconds;
+    hot_end = (it != this->transitions.end()) ? it->utc_seconds : kMaxTime;
+    hot_offset = current->offset_seconds;
+}
+
+std::shared_ptr<const TimeZone> TimeZone::utc() {
+    static const std::shared_ptr<const TimeZone> zone(new TimeZone("UTC", {}));
+    return zone;
+}
+
+std::shared_ptr<const TimeZone> TimeZone::local() {
+    static const std::shared_ptr<const TimeZone> zone = []() -> std::shared_ptr<const TimeZone> {
+        const char* tz = std::getenv("TZ");
+        std::string tz_name = tz ? tz : "";
+        if (!tz_name.empty() && tz_name[0] == ':') tz_name.erase(0, 1);
+
+        std::shared_ptr<const TimeZone> loaded;
+        if (!tz_name.empty() && tz_name.find("..") == std::string::npos) {
+            std::string path = (tz_name[0] == '/') ? tz_name : zoneInfoDirectory() + "/" + tz_name;
+            loaded = loadTzif("local", path);
+        } else if (tz_name.empty()) {
+            loaded = loadTzif("local", "/etc/localtime");
+        }
+        return loaded ? loaded : probeSystemLocal();
+    }();
+    return zone;
+}
+
+std::shared_ptr<const TimeZone> TimeZone::fixed(int utc_offset_seconds) {
+    if (utc_offset_seconds == 0) return utc();
+    if (utc_offset_seconds <= -86400 || utc_offset_seconds >= 86400) {
+        throw std::invalid_argument("UTC offset must be less than a day");
+    }
+
+    std::string zone_name = formatOffsetName(utc_offset_seconds);
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    auto& zones = registry();
+    auto it = zones.find(zone_name);
+    if (it != zones.end()) return it->second;
+
+    std::shared_ptr<const TimeZone> zone(
+        new TimeZone(zone_name, {Transition{kMinTime, utc_offset_seconds, false}}));
+    zones.emplace(zone_name, zone);
+    return zone;
+}
+
+std::shared_ptr<const TimeZone> TimeZone::get(const std::string& name) {
+    if (name.empty() || name == "UTC" || name == "Etc/UTC" || name == "GMT") return utc();
+    if (name == "local") return local();
+
+    if (name.size() > 3 && name.compare(0, 3, "UTC") == 0 && (name[3] == '+' || name[3] == '-')) {
+        std::size_t pos = 3;
+        int offset = 0;
+        if (!parseClock(name, pos, offset) || pos != name.size()) {
+            throw std::invalid_argument("Invalid UTC offset: " + name);
+        }
+        return fixed(offset);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(registry_mutex);
+        auto& zones = registry();
+        auto it = zones.find(name);
+        if (it != zones.end()) return it->second;
+    }
+
+    if (name.find("..") != std::string::npos || name[0] == '/') {
+        throw std::invalid_argument("Invalid time zone name: " + name);
+    }
+
+    auto zone = loadTzif(name, zoneInfoDirectory() + "/" + name);
+    if (!zone) {
+        throw std::invalid_argument("Unknown time zone: " + name);
+    }
+
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    return registry().emplace(name, zone).first->second;
+}
+
+const std::string& TimeZone::getName() const {
+    return name;
+}
+
+int TimeZone::utcOffsetAt(std::int64_t epoch_seconds) const {
+    if (epoch_seconds >= hot_begin && epoch_seconds < hot_end) {
+        return hot_offset;
+    }
+    return transitionAt(epoch_seconds).offset_seconds;
+}
+
+std::tm TimeZone::toLocalTm(time_point timestamp) const {
+    std::int64_t epoch_seconds = toEpochSeconds(timestamp);
+    const Transition& transition = transitionAt(epoch_seconds);
+    std::int64_t local = epoch_seconds + transition.offset_seconds;
+    std::int64_t days = (local >= 0) ? local / 86400 : (local - 86399) / 86400;
+    std::int64_t second_of_day = local - days * 86400;
+
+    int year = 0, month = 0, day = 0;
+    civilFromDays(days, year, month, day);
+
+    std::tm tm{};
+    tm.tm_year = year - 1900;
+    tm.tm_mon = month - 1;
+    tm.tm_mday = day;
+    tm.tm_hour = static_cast<int>(second_of_day / 3600);
+    tm.tm_min = static_cast<int>((second_of_day % 3600) / 60);
+    tm.tm_sec = static_cast<int>(second_of_day % 60);
+    tm.tm_wday = static_cast<int>(((days + 4) % 7 + 7) % 7);
+    tm.tm_yday = static_cast<int>(days - daysFromCivil(year, 1, 1));
+    tm.tm_isdst = transition.is_dst ? 1 : 0;
+    return tm;
+}
+
+TimeZone::time_point TimeZone::fromLocal(int year, int month, int day, int hour, int minute, int second) const {
+    // Normalise month overflow so callers can ask for "month 13" etc.
+    int month_index = month - 1;
+    year += (month_index >= 0) ? month_index / 12 : (month_index - 11) / 12;
+    month_index = ((month_index % 12) + 12) % 12;
+
+    std::int64_t local = daysFromCivil(year, month_index + 1, 1) * 86400 +
+                         static_cast<std::int64_t>(day - 1) * 86400 +
+                         hour * 3600 + minute * 60 + second;
+
+    // Two passes settle on the offset in effect at the resulting instant
+    std::int64_t guess = local - utcOffsetAt(local);
+    std::int64_t utc_seconds = local - utcOffsetAt(guess);
+    return time_point(std::chrono::duration_cast<time_point::duration>(std::chrono::seconds(utc_seconds)));
+}
+
+std::int64_t TimeZone::daysFromCivil(int year, int month, int day) {
+    std::int64_t y = year - (month <= 2 ? 1 : 0);
+    std::int64_t era = (y >= 0 ? y : y - 399) / 400;
+    std::int64_t year_of_era = y - era * 400;
+    std::int64_t day_of_year = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    std::int64_t day_of_era = year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year;
+    return era * 146097 + day_of_era - 719468;
+}
+
+void TimeZone::civilFromDays(std::int64_t days, int& year, int& month, int& day) {
+    days += 719468;
+    std::int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+    std::int64_t day_of_era = days - era * 146097;
+    std::int64_t year_of_era = (day_of_era - day_of_era / 1460 + day_of_era / 36524 - day_of_era / 146096) / 365;
+    std::int64_t day_of_year = day_of_era - (365 * year_of_era + year_of_era / 4 - year_of_era / 100);
+    std::int64_t mp = (5 * day_of_year + 2) / 153;
+    day = static_cast<int>(day_of_year - (153 * mp + 2) / 5 + 1);
+    month = static_cast<int>(mp < 10 ? mp + 3 : mp - 9);
+    year = static_cast<int>(year_of_era + era * 400 + (month <= 2 ? 1 : 0));
+}
+
+const TimeZone::Transition& TimeZone::transitionAt(std::int64_t epoch_seconds) const {
+    auto it = std::upper_bound(transitions.begin(), transitions.end(), epoch_seconds,
+        [](std::int64_t value, const Transition& t) { return value < t.utc_seconds; });
+    return *std::prev(it);
+}
+
+// Reads a TZif file (RFC 8536). Version 2+ files carry 64-bit transition times
+// and a POSIX TZ footer, which is used to extend the table past the last
+// explicit transition.
+std::shared_ptr<const TimeZone> TimeZone::loadTzif(const std::string& name, const std::string& path) {
+    std::string data;
+    if (!readFile(path, data) || data.size() < 44 || data.compare(0, 4, "TZif") != 0) {
+        return nullptr;
+    }
+
+    char version = data[4];
+    std::size_t header = 0;
+    std::size_t time_size = 4;
+
+    auto blockSize = [&](std::size_t at, std::size_t tsize) {
+        std::uint32_t isutcnt = readBigEndian32(data, at + 20);
+        std::uint32_t isstdcnt = readBigEndian32(data, at + 24);
+        std::uint32_t leapcnt = readBigEndian32(data, at + 28);
+        std::uint32_t timecnt = readBigEndian32(data, at + 32);
+        std::uint32_t typecnt = readBigEndian32(data, at + 36);
+        std::uint32_t charcnt = readBigEndian32(data, at + 40);
+        return static_cast<std::size_t>(timecnt) * tsize + timecnt + typecnt * 6 + charcnt +
+               leapcnt * (tsize + 4) + isstdcnt + isutcnt;
+    };
+
+    if (version >= '2') {
+        header = 44 + blockSize(0, 4);
+        time_size = 8;
+        if (data.size() < header + 44 || data.compare(header, 4, "TZif") != 0) {
+            return nullptr;
+        }
+    }
+
+    std::uint32_t timecnt = readBigEndian32(data, header + 32);
+    std::uint32_t typecnt = readBigEndian32(data, header + 36);
+    std::size_t body = header + 44;
+    std::size_t end = body + blockSize(header, time_size);
+    if (typecnt == 0 || data.size() < end) {
+        return nullptr;
+    }
+
+    std::size_t times_at = body;
+    std::size_t indices_at = times_at + timecnt * time_size;
+    std::size_t types_at = indices_at + timecnt;
+
+    auto typeAt = [&](std::size_t index, std::int32_t& offset, bool& is_dst) {
+        std::size_t at = types_at + index * 6;
+        offset = static_cast<std::int32_t>(readBigEndian32(data, at));
+        is_dst = data[at + 4] != 0;
+    };
+
+    std::vector<Transition> transitions;
+    std::int32_t offset = 0;
+    bool is_dst = false;
+    typeAt(0, offset, is_dst);
+    transitions.push_back(Transition{kMinTime, offset, is_dst});
+
+    for (std::uint32_t i = 0; i < timecnt; ++i) {
+        std::int64_t at = (time_size == 8)
+            ? readBigEndian64(data, times_at + i * 8)
+            : static_cast<std::int32_t>(readBigEndian32(data, times_at + i * 4));
+        std::size_t type_index = static_cast<unsigned char>(data[indices_at + i]);
+        if (type_index >= typecnt) return nullptr;
+        typeAt(type_index, offset, is_dst);
+
+        if (transitions.back().offset_seconds == offset && transitions.back().is_dst == is_dst) continue;
+        transitions.push_back(Transition{at, offset, is_dst});
+    }
+
+    if (version >= '2' && end < data.size() && data[end] == '\n') {
+        std::size_t footer_end = data.find('\n', end + 1);
+        if (footer_end != std::string::npos) {
+            appendPosixRule(data.substr(end + 1, footer_end - end - 1), transitions);
+        }
+    }
+
+    return std::shared_ptr<const TimeZone>(new TimeZone(name, std::move(transitions)));
+}
+
+// Extends the table with yearly DST transitions described by a POSIX TZ
+// string such as "EST5EDT,M3.2.0,M11.1.0". Zones without DST rules keep the
+// last explicit offset.
+bool TimeZone::appendPosixRule(const std::string& rule, std::vector<Transition>& transitions) {
+    std::size_t pos = 0;
+    int std_offset = 0;
+    if (!parseZoneAbbreviation(rule, pos) || !parseClock(rule, pos, std_offset)) return false;
+    std_offset = -std_offset; // POSIX offsets are west-positive
+
+    if (pos >= rule.size()) {
+        if (transitions.back().offset_seconds != std_offset || transitions.back().is_dst) {
+            std::int64_t at = (transitions.size() > 1) ? transitions.back().utc_seconds + 1 : kMinTime;
+            transitions.push_back(Transition{at, std_offset, false});
+        }
+        return true;
+    }
+
+    if (!parseZoneAbbreviation(rule, pos)) return false;
+    int dst_offset = std_offset + 3600;
+    if (pos < rule.size() && rule[pos] != ',') {
+        if (!parseClock(rule, pos, dst_offset)) return false;
+        dst_offset = -dst_offset;
+    }
+
+    PosixDateRule start_rule{}, end_rule{};
+    if (pos >= rule.size() || rule[pos++] != ',' || !parseDateRule(rule, pos, start_rule)) return false;
+    if (pos >= rule.size() || rule[pos++] != ',' || !parseDateRule(rule, pos, end_rule)) return false;
+
+    std::int64_t last = transitions.back().utc_seconds;
+    int first_year = kFirstProbeYear;
+    if (last != kMinTime) {
+        int month = 0, day = 0;
+        civilFromDays(last / 86400, first_year, month, day);
+    }
+
+    for (int year = first_year; year <= kLastRuleYear; ++year) {
+        Transition to_dst{ruleLocalSeconds(start_rule, year) - std_offset, dst_offset, true};
+        Transition to_std{ruleLocalSeconds(end_rule, year) - dst_offset, std_offset, false};
+        if (to_std.utc_seconds < to_dst.utc_seconds) std::swap(to_dst, to_std);
+
+        for (const Transition& t : {to_dst, to_std}) {
+            if (t.utc_seconds <= transitions.back().utc_seconds) continue;
+            if (t.offset_seconds == transitions.back().offset_seconds && t.is_dst == transitions.back().is_dst) continue;
+            transitions.push_back(t);
+        }
+    }
+    return true;
+}
+
+// Fallback for platforms without a tz database: sample the C library once per
+// day and bisect each change down to the second.
+std::shared_ptr<const TimeZone> TimeZone::probeSystemLocal() {
+    auto offsetAt = [](std::int64_t epoch_seconds, bool& is_dst) {
+        std::tm tm{};
+        if (!systemLocalTime(static_cast<std::time_t>(epoch_seconds), tm)) {
+            is_dst = false;
+            return 0;
+        }
+        is_dst = tm.tm_isdst > 0;
+        std::int64_t local = daysFromCivil(tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday) * 86400 +
+                             tm.tm_hour * 3600 + tm.tm_min * 60 + tm.tm_sec;
+        return static_cast<int>(local - epoch_seconds);
+    };
+
+    std::vector<Transition> transitions;
+    std::int64_t begin = daysFromCivil(kFirstProbeYear, 1, 1) * 86400;
+    std::int64_t end = daysFromCivil(kLastProbeYear, 1, 1) * 86400;
+
+    bool is_dst = false;
+    int offset = offsetAt(begin, is_dst);
+    transitions.push_back(Transition{kMinTime, offset, is_dst});
+
+    for (std::int64_t t = begin + 86400; t <= end; t += 86400) {
+        bool next_dst = false;
+        int next_offset = offsetAt(t, next_dst);
+        if (next_offset == offset && next_dst == is_dst) continue;
+
+        std::int64_t low = t - 86400, high = t;
+        while (high - low > 1) {
+            std::int64_t mid = low + (high - low) / 2;
+            bool mid_dst = false;
+            if (offsetAt(mid, mid_dst) == offset && mid_dst == is_dst) low = mid; else high = mid;
+        }
+        transitions.push_back(Transition{high, next_offset, next_dst});
+        offset = next_offset;
+        is_dst = next_dst;
+    }
+
+    return std::shared_ptr<const TimeZone>(new TimeZone("local", std::move(transitions)));
+}
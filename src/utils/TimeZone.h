@@ -0,0 +1,104 @@
+#ifndef TIME_ZONE_H
+#define TIME_ZONE_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+
+struct LocalTimeParts {
+    int hour;
+    int day_of_week; // 0 = Sunday, matching std::tm::tm_wday
+};
+
+// Immutable UTC offset table for a single time zone. Offsets are precomputed
+// once (from the tz database or by probing the C library) so conversions are
+// lock-free, thread-safe and never touch global libc state. Instances are
+// interned by name and live for the rest of the process.
+class TimeZone {
+public:
+    using time_point = std::chrono::system_clock::time_point;
+
+    // Factories
+    static std::shared_ptr<const TimeZone> utc();
+    static std::shared_ptr<const TimeZone> local();
+    static std::shared_ptr<const TimeZone> fixed(int utc_offset_seconds);
+    static std::shared_ptr<const TimeZone> get(const std::string& name); // "UTC", "local", "UTC+05:30" or an IANA name
+
+    // Getters
+    const std::string& getName() const;
+    int utcOffsetAt(std::int64_t epoch_seconds) const;
+
+    // Conversions
+    int hourOfDay(time_point timestamp) const;
+    int dayOfWeek(time_point timestamp) const;
+    LocalTimeParts localParts(time_point timestamp) const;
+    std::tm toLocalTm(time_point timestamp) const;
+    time_point fromLocal(int year, int month, int day, int hour = 0, int minute = 0, int second = 0) const; // month is 1-12
+
+    // Calendar helpers shared with other modules
+    static std::int64_t daysFromCivil(int year, int month, int day);
+    static void civilFromDays(std::int64_t days, int& year, int& month, int& day);
+
+private:
+    struct Transition {
+        std::int64_t utc_seconds; // First instant this offset applies
+        std::int32_t offset_seconds;
+        bool is_dst;
+    };
+
+    std::string name;
+    std::vector<Transition> transitions; // Sorted; transitions[0] covers all earlier times
+
+    // Segment containing "now" at construction, checked before any search
+    std::int64_t hot_begin;
+    std::int64_t hot_end;
+    std::int32_t hot_offset;
+
+    TimeZone(const std::string& name, std::vector<Transition> transitions);
+
+    const Transition& transitionAt(std::int64_t epoch_seconds) const;
+
+    static std::int64_t toEpochSeconds(time_point timestamp) {
+        return std::chrono::duration_cast<std::chrono::seconds>(timestamp.time_since_epoch()).count();
+    }
+
+    std::int64_t toLocalSeconds(std::int64_t epoch_seconds) const {
+        if (epoch_seconds >= hot_begin && epoch_seconds < hot_end) {
+            return epoch_seconds + hot_offset;
+        }
+        return epoch_seconds + transitionAt(epoch_seconds).offset_seconds;
+    }
+
+    // Loaders
+    static std::shared_ptr<const TimeZone> loadTzif(const std::string& name, const std::string& path);
+    static std::shared_ptr<const TimeZone> probeSystemLocal();
+    static bool appendPosixRule(const std::string& rule, std::vector<Transition>& transitions);
+};
+
+inline int TimeZone::hourOfDay(time_point timestamp) const {
+    std::int64_t local = toLocalSeconds(toEpochSeconds(timestamp));
+    std::int64_t second_of_day = local % 86400;
+    if (second_of_day < 0) second_of_day += 86400;
+    return static_cast<int>(second_of_day / 3600);
+}
+
+inline int TimeZone::dayOfWeek(time_point timestamp) const {
+    std::int64_t local = toLocalSeconds(toEpochSeconds(timestamp));
+    std::int64_t days = (local >= 0) ? local / 86400 : (local - 86399) / 86400;
+    std::int64_t weekday = (days + 4) % 7; // 1970-01-01 was a Thursday
+    return static_cast<int>(weekday < 0 ? weekday + 7 : weekday);
+}
+
+inline LocalTimeParts TimeZone::localParts(time_point timestamp) const {
+    std::int64_t local = toLocalSeconds(toEpochSeconds(timestamp));
+    std::int64_t days = (local >= 0) ? local / 86400 : (local - 86399) / 86400;
+    std::int64_t second_of_day = local - days * 86400;
+    std::int64_t weekday = (days + 4) % 7;
+    return LocalTimeParts{static_cast<int>(second_of_day / 3600),
+                          static_cast<int>(weekday < 0 ? weekday + 7 : weekday)};
+}
+
+#endif // TIME_ZONE_H
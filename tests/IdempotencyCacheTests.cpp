@@ -0,0 +1,222 @@
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include "models/Account.h"
+#include "services/IdempotencyCache.h"
+#include "services/TransactionService.h"
+#include "TestSupport.h"
+
+// IdempotencyCache: a key runs its operation once, retries get the stored
+// result, and the cache's limits (TTL, capacity, a key reused for another
+// request) behave as documented. The last cases check the same guarantees
+// through TransactionService, where the request fingerprint is built.
+
+namespace {
+    // Counts how often the cache actually ran the operation
+    struct Operation {
+        std::atomic<int> runs{0};
+        int transaction_id;
+
+        explicit Operation(int id) : transaction_id(id) {}
+
+        TransactionResult operator()() {
+            runs.fetch_add(1);
+            return TransactionResult::success(transaction_id);
+        }
+    };
+}
+
+TEST_CASE(retriesReplayTheFirstResult) {
+    IdempotencyCache cache(1024);
+    Operation operation(17);
+
+    TransactionResult first = cache.run("key-1", 1, [&] { return operation(); });
+    TransactionResult retry = cache.run("key-1", 1, [&] { return operation(); });
+
+    CHECK_EQ(operation.runs.load(), 1);
+    CHECK(first.ok() && !first.replayed);
+    CHECK(retry.ok() && retry.replayed);
+    CHECK_EQ(retry.transaction_id, 17);
+    CHECK_EQ(cache.getStats().hits, std::uint64_t(1));
+    CHECK_EQ(cache.getStats().misses, std::uint64_t(1));
+}
+
+TEST_CASE(failuresAreReplayedToo) {
+    IdempotencyCache cache(1024);
+    int runs = 0;
+    auto decline = [&] {
+        ++runs;
+        return TransactionResult::failure(TransactionOutcome::INSUFFICIENT_FUNDS, "Insufficient funds", 5);
+    };
+
+    cache.run("key-1", 1, decline);
+    TransactionResult retry = cache.run("key-1", 1, decline);
+
+    CHECK_EQ(runs, 1);
+    CHECK(retry.outcome == TransactionOutcome::INSUFFICIENT_FUNDS);
+    CHECK_EQ(std::string(retry.reason), std::string("Insufficient funds"));
+    CHECK_EQ(retry.transaction_id, 5);
+    CHECK(retry.replayed);
+}
+
+TEST_CASE(aKeyReusedForAnotherRequestConflicts) {
+    IdempotencyCache cache(1024);
+    Operation operation(3);
+
+    cache.run("key-1", 1, [&] { return operation(); });
+    TransactionResult reused = cache.run("key-1", 2, [&] { return operation(); });
+
+    CHECK_EQ(operation.runs.load(), 1);
+    CHECK(reused.outcome == TransactionOutcome::IDEMPOTENCY_CONFLICT);
+    CHECK(!reused.replayed);
+    CHECK_EQ(cache.getStats().conflicts, std::uint64_t(1));
+
+    // The original request still replays
+    CHECK(cache.run("key-1", 1, [&] { return operation(); }).replayed);
+}
+
+TEST_CASE(anEmptyKeyAlwaysRuns) {
+    IdempotencyCache cache(1024);
+    Operation operation(1);
+
+    cache.run("", 1, [&] { return operation(); });
+    TransactionResult second = cache.run("", 1, [&] { return operation(); });
+
+    CHECK_EQ(operation.runs.load(), 2);
+    CHECK(!second.replayed);
+    CHECK_EQ(cache.getStats().misses, std::uint64_t(0));
+}
+
+TEST_CASE(expiredKeysRunAgain) {
+    IdempotencyCache cache(1024, std::chrono::seconds(1));
+    Operation operation(9);
+
+    cache.run("key-1", 1, [&] { return operation(); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+    TransactionResult later = cache.run("key-1", 2, [&] { return operation(); }); // No conflict once expired
+
+    CHECK_EQ(operation.runs.load(), 2);
+    CHECK(later.ok() && !later.replayed);
+    CHECK_EQ(cache.getStats().evictions, std::uint64_t(0));
+}
+
+TEST_CASE(memoryStaysWithinCapacity) {
+    IdempotencyCache cache(1); // Rounded up to one bucket per shard
+    const std::size_t capacity = cache.getCapacity();
+    CHECK_EQ(capacity, IdempotencyCache::kShardCount * IdempotencyCache::kWays);
+
+    Operation operation(1);
+    const std::size_t keys = capacity * 4;
+    for (std::size_t i = 0; i < keys; ++i) {
+        cache.run("key-" + std::to_string(i), 1, [&] { return operation(); });
+    }
+
+    IdempotencyStats stats = cache.getStats();
+    CHECK_EQ(stats.misses, std::uint64_t(keys));
+    CHECK(stats.evictions >= keys - capacity);
+    CHECK(stats.memory_bytes <= capacity * IdempotencyCache::kSlotBytes);
+
+    // The newest key is always still held
+    int before = operation.runs.load();
+    CHECK(cache.run("key-" + std::to_string(keys - 1), 1, [&] { return operation(); }).replayed);
+    CHECK_EQ(operation.runs.load(), before);
+}
+
+TEST_CASE(concurrentRetriesRunOnce) {
+    IdempotencyCache cache(1024);
+    std::atomic<int> runs{0};
+    std::atomic<int> replayed{0};
+    auto slow = [&] {
+        runs.fetch_add(1);
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        return TransactionResult::success(42);
+    };
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 8; ++i) {
+        threads.emplace_back([&] {
+            TransactionResult result = cache.run("key-1", 1, slow);
+            if (result.replayed) replayed.fetch_add(1);
+            if (result.transaction_id != 42) runs.fetch_add(100); // Fails the check below
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    CHECK_EQ(runs.load(), 1);
+    CHECK_EQ(replayed.load(), 7);
+}
+
+TEST_CASE(aThrowingOperationLetsTheRetryRun) {
+    IdempotencyCache cache(1024);
+    CHECK_THROWS(cache.run("key-1", 1, []() -> TransactionResult { throw std::runtime_error("lost"); }),
+                 std::runtime_error);
+
+    Operation operation(8);
+    TransactionResult retry = cache.run("key-1", 1, [&] { return operation(); });
+    CHECK_EQ(operation.runs.load(), 1);
+    CHECK(retry.ok() && !retry.replayed);
+}
+
+TEST_CASE(clearAndResizeDropEveryKey) {
+    IdempotencyCache cache(1024);
+    Operation operation(2);
+
+    cache.run("key-1", 1, [&] { return operation(); });
+    cache.clear();
+    cache.run("key-1", 1, [&] { return operation(); });
+    cache.resize(4096, std::chrono::seconds(60));
+    cache.run("key-1", 1, [&] { return operation(); });
+
+    CHECK_EQ(operation.runs.load(), 3);
+    CHECK(cache.getCapacity() >= std::size_t(4096));
+    CHECK(cache.getTtl() == std::chrono::seconds(60));
+}
+
+TEST_CASE(serviceRetriesDoNotMoveMoneyTwice) {
+    TransactionService service;
+    auto account = std::make_shared<Account>(1, 1, AccountType::CHECKING, 100.0);
+
+    TransactionResult first = service.processDeposit(account, 10.0, "Salary", "", "deposit-1");
+    TransactionResult retry = service.processDeposit(account, 10.0, "Salary", "", "deposit-1");
+
+    CHECK(first.ok() && !first.replayed);
+    CHECK(retry.ok() && retry.replayed);
+    CHECK_EQ(retry.transaction_id, first.transaction_id);
+    CHECK_NEAR(account->getBalance(), 110.0, 1e-9);
+
+    // A declined withdrawal stays declined on retry, even once funds arrive
+    TransactionResult declined = service.processWithdrawal(account, 500.0, "", "", TransactionCategory::OTHER,
+                                                           "withdraw-1");
+    service.processDeposit(account, 1000.0);
+    TransactionResult declined_retry = service.processWithdrawal(account, 500.0, "", "",
+                                                                 TransactionCategory::OTHER, "withdraw-1");
+    CHECK(declined.outcome == TransactionOutcome::INSUFFICIENT_FUNDS);
+    CHECK(declined_retry.outcome == TransactionOutcome::INSUFFICIENT_FUNDS && declined_retry.replayed);
+    CHECK_NEAR(account->getBalance(), 1110.0, 1e-9);
+}
+
+TEST_CASE(serviceKeysReusedForAnotherRequestConflict) {
+    TransactionService service;
+    auto account = std::make_shared<Account>(1, 1, AccountType::CHECKING, 100.0);
+    auto other = std::make_shared<Account>(2, 1, AccountType::SAVINGS, 0.0);
+
+    service.processDeposit(account, 10.0, "", "", "key-1");
+    TransactionResult amount = service.processDeposit(account, 20.0, "", "", "key-1");
+    TransactionResult target = service.processDeposit(other, 10.0, "", "", "key-1");
+    TransactionResult operation = service.processWithdrawal(account, 10.0, "", "", TransactionCategory::OTHER,
+                                                            "key-1");
+
+    CHECK(amount.outcome == TransactionOutcome::IDEMPOTENCY_CONFLICT);
+    CHECK(target.outcome == TransactionOutcome::IDEMPOTENCY_CONFLICT);
+    CHECK(operation.outcome == TransactionOutcome::IDEMPOTENCY_CONFLICT);
+    CHECK_NEAR(account->getBalance(), 110.0, 1e-9);
+    CHECK_NEAR(other->getBalance(), 0.0, 1e-9);
+}
+
+TEST_MAIN()
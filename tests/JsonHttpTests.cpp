@@ -0,0 +1,309 @@
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include "server/HttpServer.h"
+#include "utils/Json.h"
+#include "TestSupport.h"
+
+// Request parsing at the API's edge: JsonObject on request bodies,
+// JsonWriter on responses, and HttpServer's request parser, driven over a
+// loopback socket with raw bytes so malformed and split requests reach it
+// exactly as a client would send them.
+
+namespace {
+    // Echoes what the parser made of the request
+    HttpResponse echo(const HttpRequest& request) {
+        JsonWriter writer;
+        writer.beginObject()
+            .field("method", request.method)
+            .field("path", request.path)
+            .field("query", request.query)
+            .field("name", request.queryParam("name", "-"))
+            .field("client", request.header("x-client"))
+            .field("body", request.body)
+            .endObject();
+        return HttpResponse::json(200, writer.take());
+    }
+
+    struct Response {
+        int status = 0;
+        std::string connection; // Connection header
+        std::string body;
+    };
+
+    class Client {
+    public:
+        explicit Client(std::uint16_t port) : fd(socket(AF_INET, SOCK_STREAM, 0)) {
+            timeval timeout{2, 0};
+            setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+            sockaddr_in address{};
+            address.sin_family = AF_INET;
+            address.sin_port = htons(port);
+            address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            if (connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+                throw std::runtime_error("connect failed");
+            }
+        }
+        ~Client() { close(fd); }
+
+        void send(const std::string& bytes) {
+            ::send(fd, bytes.data(), bytes.size(), MSG_NOSIGNAL);
+        }
+
+        // One response; status 0 if the server closed the connection first
+        Response read() {
+            Response response;
+            std::size_t header_end;
+            while ((header_end = buffer.find("\r\n\r\n")) == std::string::npos) {
+                if (!fill()) return response;
+            }
+            std::string head = buffer.substr(0, header_end);
+            response.status = std::stoi(head.substr(9, 3));
+            response.connection = headerValue(head, "Connection");
+            std::size_t length = std::stoul(headerValue(head, "Content-Length"));
+            while (buffer.size() < header_end + 4 + length) {
+                if (!fill()) return Response{};
+            }
+            response.body = buffer.substr(header_end + 4, length);
+            buffer.erase(0, header_end + 4 + length);
+            return response;
+        }
+
+        bool closedByServer() {
+            return buffer.empty() && !fill();
+        }
+
+    private:
+        int fd;
+        std::string buffer;
+
+        bool fill() {
+            char chunk[4096];
+            ssize_t received = recv(fd, chunk, sizeof(chunk), 0);
+            if (received <= 0) return false;
+            buffer.append(chunk, static_cast<std::size_t>(received));
+            return true;
+        }
+
+        static std::string headerValue(const std::string& head, const std::string& name) {
+            std::size_t start = head.find("\r\n" + name + ": ");
+            if (start == std::string::npos) return "";
+            start += name.size() + 4;
+            return head.substr(start, head.find("\r\n", start) - start);
+        }
+    };
+
+    // A server on a free port for the duration of a case
+    struct TestServer {
+        HttpServer server;
+
+        TestServer() : server(options(), echo) { server.start(); }
+        ~TestServer() { server.stop(); }
+
+        static HttpServerOptions options() {
+            HttpServerOptions options;
+            options.port = 0;
+            options.worker_threads = 2;
+            options.max_header_bytes = 1024;
+            options.max_body_bytes = 4096;
+            return options;
+        }
+    };
+
+    std::string field(const std::string& json, const std::string& name) {
+        return JsonObject::parse(json).getString(name);
+    }
+}
+
+TEST_CASE(jsonObjectsParseFlatScalars) {
+    JsonObject object = JsonObject::parse(
+        " {\"amount\": -12.5e1, \"note\": \"a\\\"b\\\\c\\/\\n\\u00e9\\ud83d\\ude00\", \"flag\": true,"
+        " \"off\": false, \"gone\": null, \"id\": 42} ");
+
+    CHECK_EQ(object.getNumber("amount"), -125.0);
+    CHECK_EQ(object.getString("note"), std::string("a\"b\\c/\n\xc3\xa9\xf0\x9f\x98\x80"));
+    CHECK(object.getBool("flag", false));
+    CHECK(!object.getBool("off", true));
+    CHECK(!object.has("gone"));
+    CHECK(!object.has("missing"));
+    CHECK_EQ(object.getString("gone", "fallback"), std::string("fallback"));
+    CHECK_EQ(object.getNumber("gone", 7.0), 7.0);
+    CHECK_EQ(object.getInt("id"), 42);
+    CHECK(!JsonObject::parse("{}").has("anything"));
+}
+
+TEST_CASE(malformedJsonIsRejected) {
+    const char* inputs[] = {
+        "",
+        "[1, 2]",
+        "{\"a\": 1",
+        "{\"a\": 1,}",
+        "{\"a\": {\"nested\": 1}}",
+        "{\"a\": [1]}",
+        "{\"a\": 1} trailing",
+        "{a: 1}",
+        "{\"a\": \"unterminated}",
+        "{\"a\": \"bad \\x escape\"}",
+        "{\"a\": \"\\u12\"}",
+        "{\"a\": \"\\ud83d\\u0041\"}", // High surrogate followed by a non-surrogate
+        "{\"a\": \"\\ud83d\"}",        // Unpaired high surrogate
+        "{\"a\": \"\\ude00\"}",        // Unpaired low surrogate
+        "{\"a\": nan}",
+        "{\"a\": -}",
+        "{\"a\": 1e5e5}",
+        "{\"a\": truth}",
+    };
+    for (const char* input : inputs) {
+        bool rejected = false;
+        try {
+            JsonObject::parse(input);
+        } catch (const std::invalid_argument&) {
+            rejected = true;
+        }
+        if (!rejected) testing_support::fail(__FILE__, __LINE__, std::string("accepted ") + input);
+    }
+}
+
+TEST_CASE(numbersAreValidatedBeforeUse) {
+    JsonObject object = JsonObject::parse(
+        "{\"huge\": 1e999, \"big\": 3000000000, \"fraction\": 1.5, \"min\": -2147483648,"
+        " \"max\": 2147483647, \"text\": \"12\", \"flag\": true}");
+
+    CHECK_THROWS(object.getNumber("huge"), std::invalid_argument);
+    CHECK_THROWS(object.getNumber("huge", 0.0), std::invalid_argument);
+    CHECK_THROWS(object.getInt("huge"), std::invalid_argument);
+    CHECK_THROWS(object.getInt("big"), std::invalid_argument);
+    CHECK_THROWS(object.getInt("fraction"), std::invalid_argument);
+    CHECK_THROWS(object.getNumber("text"), std::invalid_argument);
+    CHECK_THROWS(object.getNumber("missing"), std::invalid_argument);
+    CHECK_THROWS(object.getString("flag"), std::invalid_argument);
+    CHECK_THROWS(object.getBool("text", false), std::invalid_argument);
+    CHECK_EQ(object.getInt("min"), -2147483647 - 1);
+    CHECK_EQ(object.getInt("max"), 2147483647);
+    CHECK_EQ(object.getNumber("big"), 3000000000.0);
+}
+
+TEST_CASE(jsonWriterEscapesAndSeparates) {
+    JsonWriter writer;
+    writer.beginObject()
+        .field("text", std::string("quote\" slash\\ \n\r\t\x01 \xc3\xa9"))
+        .field("nan", std::nan(""))
+        .field("inf", 1e308 * 10)
+        .field("count", 3)
+        .field("big", std::uint64_t(18446744073709551615ULL))
+        .field("ok", true)
+        .key("list").beginArray().value(1.5).value("x").null().endArray()
+        .key("empty").beginObject().endObject()
+        .endObject();
+
+    const std::string expected =
+        "{\"text\":\"quote\\\" slash\\\\ \\n\\r\\t\\u0001 \xc3\xa9\",\"nan\":null,\"inf\":null,\"count\":3,"
+        "\"big\":18446744073709551615,\"ok\":true,\"list\":[1.5,\"x\",null],\"empty\":{}}";
+    CHECK_EQ(writer.str(), expected);
+
+    // What the writer escapes, the parser reads back
+    JsonObject parsed = JsonObject::parse(writer.str().substr(0, writer.str().find(",\"nan\"")) + "}");
+    CHECK_EQ(parsed.getString("text"), std::string("quote\" slash\\ \n\r\t\x01 \xc3\xa9"));
+}
+
+TEST_CASE(requestsAreParsedWholeOrSplit) {
+    TestServer test;
+    Client client(test.server.getPort());
+
+    client.send("GET /users/7/accounts?name=J%C3%B6rg+Smith&x=1 HTTP/1.1\r\nHost: a\r\nX-Client: tests\r\n\r\n");
+    Response get = client.read();
+    CHECK_EQ(get.status, 200);
+    CHECK_EQ(get.connection, std::string("keep-alive"));
+    CHECK_EQ(field(get.body, "method"), std::string("GET"));
+    CHECK_EQ(field(get.body, "path"), std::string("/users/7/accounts"));
+    CHECK_EQ(field(get.body, "query"), std::string("name=J%C3%B6rg+Smith&x=1"));
+    CHECK_EQ(field(get.body, "name"), std::string("J\xc3\xb6rg Smith"));
+    CHECK_EQ(field(get.body, "client"), std::string("tests"));
+
+    // Headers, then the body in two pieces, on the same connection
+    client.send("POST /deposit HTTP/1.1\r\nContent-Length: 11\r\n");
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    client.send("\r\n{\"amount\":");
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    client.send("5}");
+    Response post = client.read();
+    CHECK_EQ(post.status, 200);
+    CHECK_EQ(field(post.body, "body"), std::string("{\"amount\":5}").substr(0, 11));
+}
+
+TEST_CASE(pipelinedRequestsAreAnsweredInOrder) {
+    TestServer test;
+    Client client(test.server.getPort());
+
+    client.send("GET /first HTTP/1.1\r\n\r\n"
+                "POST /second HTTP/1.1\r\nContent-Length: 2\r\n\r\nhi"
+                "GET /third HTTP/1.1\r\nConnection: close\r\n\r\n");
+    Response first = client.read();
+    Response second = client.read();
+    Response third = client.read();
+
+    CHECK_EQ(field(first.body, "path"), std::string("/first"));
+    CHECK_EQ(field(second.body, "path"), std::string("/second"));
+    CHECK_EQ(field(second.body, "body"), std::string("hi"));
+    CHECK_EQ(field(third.body, "path"), std::string("/third"));
+    CHECK_EQ(third.connection, std::string("close"));
+    CHECK(client.closedByServer());
+}
+
+TEST_CASE(http10ClosesUnlessAskedToKeepAlive) {
+    TestServer test;
+    {
+        Client client(test.server.getPort());
+        client.send("GET / HTTP/1.0\r\n\r\n");
+        CHECK_EQ(client.read().connection, std::string("close"));
+    }
+    {
+        Client client(test.server.getPort());
+        client.send("GET / HTTP/1.0\r\nConnection: Keep-Alive\r\n\r\n");
+        CHECK_EQ(client.read().connection, std::string("keep-alive"));
+    }
+}
+
+TEST_CASE(badRequestsGetAnErrorAndAClose) {
+    TestServer test;
+    struct Case {
+        std::string bytes;
+        int status;
+    };
+    const Case cases[] = {
+        {"GARBAGE\r\n\r\n", 400},
+        {" / HTTP/1.1\r\n\r\n", 400},
+        {"GET  HTTP/1.1\r\n\r\n", 400},
+        {"GET / HTTP/2.0\r\n\r\n", 505},
+        {"GET / HTTP/1.1\r\nNoColon\r\n\r\n", 400},
+        {"GET / HTTP/1.1\r\n: empty name\r\n\r\n", 400},
+        {"POST / HTTP/1.1\r\nContent-Length: -1\r\n\r\n", 400},
+        {"POST / HTTP/1.1\r\nContent-Length: 12abc\r\n\r\n", 400},
+        {"POST / HTTP/1.1\r\nContent-Length: 99999999999999999999\r\n\r\n", 400},
+        {"POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n", 501},
+        {"POST / HTTP/1.1\r\nContent-Length: 5000\r\n\r\n", 413},
+        {"GET / HTTP/1.1\r\nX-Padding: " + std::string(2000, 'a') + "\r\n\r\n", 431},
+        {"GET / HTTP/1.1\r\nX-Padding: " + std::string(2000, 'a'), 431}, // Still no end of headers
+    };
+    for (const Case& c : cases) {
+        Client client(test.server.getPort());
+        client.send(c.bytes);
+        Response response = client.read();
+        if (response.status != c.status) {
+            testing_support::fail(__FILE__, __LINE__,
+                                  testing_support::describe(c.bytes.substr(0, 40).c_str(), response.status, c.status));
+        }
+        CHECK_EQ(response.connection, std::string("close"));
+        CHECK(JsonObject::parse(response.body).has("error"));
+        CHECK(client.closedByServer());
+    }
+}
+
+TEST_MAIN()
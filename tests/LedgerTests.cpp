@@ -0,0 +1,228 @@
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+#include "exceptions.h"
+#include "models/Account.h"
+#include "models/Ledger.h"
+#include "services/LedgerReplayer.h"
+#include "TestSupport.h"
+
+// Ledger and LedgerReplayer: replaying a log must rebuild the live accounts
+// exactly, whatever the worker count; point-in-time balances must match a
+// running total on both sides of every checkpoint; and the log file must
+// read back to the same events.
+
+namespace {
+    constexpr std::int64_t kSecond = 1000000000;
+    constexpr std::int64_t kStart = 1750000000 * kSecond;
+
+    std::chrono::system_clock::time_point timeAt(std::int64_t ns) {
+        return std::chrono::system_clock::time_point(
+            std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds(ns)));
+    }
+
+    bool sameBits(double a, double b) {
+        return std::memcmp(&a, &b, sizeof(double)) == 0;
+    }
+
+    LedgerEvent event(int account_id, LedgerEventType type, double amount, std::int64_t timestamp_ns) {
+        LedgerEvent e;
+        e.account_id = account_id;
+        e.type = type;
+        e.amount = amount;
+        e.timestamp_ns = timestamp_ns;
+        return e;
+    }
+
+    // Accounts attached to one ledger, after a run of operations whose
+    // amounts do not add up exactly in binary
+    std::vector<std::shared_ptr<Account>> busyAccounts(const std::shared_ptr<Ledger>& ledger) {
+        std::vector<std::shared_ptr<Account>> accounts;
+        for (int id = 1; id <= 150; ++id) {
+            auto account = std::make_shared<Account>(id, 1000 + id % 7, static_cast<AccountType>(id % 3), 0.1 * id);
+            account->attachLedger(ledger);
+            accounts.push_back(account);
+        }
+        for (int i = 0; i < 6000; ++i) {
+            Account& account = *accounts[(i * 31) % accounts.size()];
+            switch (i % 4) {
+                case 0: account.tryDeposit(0.1 + 0.01 * (i % 13)); break;
+                case 1: account.tryWithdraw(0.3 * (i % 5 + 1)); break; // Some decline
+                default:
+                    account.tryTransfer(accounts[(i * 17 + 1) % accounts.size()], 0.07 * (i % 11 + 1));
+                    break;
+            }
+        }
+        return accounts;
+    }
+}
+
+TEST_CASE(replayRebuildsTheLiveAccounts) {
+    auto ledger = std::make_shared<Ledger>();
+    auto accounts = busyAccounts(ledger);
+    const std::uint64_t live = LedgerReplayer::stateDigest(accounts);
+
+    for (unsigned workers : {1u, 2u, 3u, 8u}) {
+        LedgerReplayResult result = LedgerReplayer::replay(ledger->getEvents(), workers);
+        CHECK_EQ(result.digest, live);
+        CHECK_EQ(result.events, ledger->getEventCount());
+        CHECK_EQ(result.accounts.size(), accounts.size());
+        for (std::size_t i = 0; i < result.accounts.size() && i < accounts.size(); ++i) {
+            CHECK_EQ(result.accounts[i]->getAccountId(), accounts[i]->getAccountId());
+            CHECK(sameBits(result.accounts[i]->getBalance(), accounts[i]->getBalance()));
+        }
+    }
+}
+
+TEST_CASE(replayRejectsEventsForUnopenedAccounts) {
+    std::vector<LedgerEvent> events{event(5, LedgerEventType::DEPOSIT, 10.0, kStart)};
+    events[0].sequence = 1;
+    CHECK_THROWS(LedgerReplayer::replay(events, 1), std::invalid_argument);
+}
+
+TEST_CASE(balancesAtEveryPointInTime) {
+    Ledger ledger;
+    const int account = 9;
+    LedgerEvent opened = event(account, LedgerEventType::OPENED, 50.0, kStart);
+    opened.related_id = 1;
+    ledger.append(opened);
+
+    // Several checkpoints' worth, two events per timestamp, one adjustment
+    std::vector<std::pair<std::int64_t, double>> expected{{kStart, 50.0}};
+    double balance = 50.0;
+    const std::size_t events = Ledger::kCheckpointInterval * 4 + 10;
+    for (std::size_t i = 1; i < events; ++i) {
+        std::int64_t time = kStart + static_cast<std::int64_t>((i + 1) / 2) * kSecond;
+        LedgerEvent e = i == 150 ? event(account, LedgerEventType::ADJUSTMENT, 1234.5, time)
+                                 : event(account, i % 3 ? LedgerEventType::DEPOSIT : LedgerEventType::WITHDRAWAL,
+                                         i % 3 ? 0.1 * static_cast<double>(i) : -0.3, time);
+        ledger.append(e);
+        balance = e.apply(balance);
+        if (!expected.empty() && expected.back().first == time) {
+            expected.back().second = balance;
+        } else {
+            expected.emplace_back(time, balance);
+        }
+    }
+
+    for (const auto& point : expected) {
+        CHECK(sameBits(ledger.getBalanceAt(account, timeAt(point.first)), point.second));
+        CHECK(sameBits(ledger.getBalanceAt(account, timeAt(point.first + kSecond / 2)), point.second));
+    }
+    CHECK_EQ(ledger.getBalanceAt(account, timeAt(kStart - 1)), 0.0);
+    CHECK(sameBits(ledger.getBalance(account), balance));
+    CHECK_THROWS(ledger.getBalanceAt(404, timeAt(kStart)), InvalidAccountException);
+}
+
+TEST_CASE(timestampsNeverGoBackwardsWithinAnAccount) {
+    Ledger ledger;
+    ledger.append(event(1, LedgerEventType::OPENED, 0.0, kStart + 10 * kSecond));
+    ledger.append(event(1, LedgerEventType::DEPOSIT, 5.0, kStart)); // Clock stepped back
+    ledger.append(event(2, LedgerEventType::OPENED, 0.0, kStart));  // Other accounts are independent
+
+    auto events = ledger.getAccountEvents(1);
+    CHECK_EQ(events.size(), std::size_t(2));
+    if (events.size() == 2) {
+        CHECK_EQ(events[1].timestamp_ns, kStart + 10 * kSecond);
+        CHECK(events[1].sequence > events[0].sequence);
+    }
+    std::int64_t other_time = ledger.getAccountEvents(2).front().timestamp_ns;
+    CHECK_EQ(other_time, kStart);
+    CHECK_EQ(ledger.getBalanceAt(1, timeAt(kStart + 10 * kSecond)), 5.0);
+}
+
+TEST_CASE(logFilesReadBackExactly) {
+    auto ledger = std::make_shared<Ledger>();
+    auto accounts = busyAccounts(ledger);
+
+    std::stringstream file;
+    ledger->writeLog(file);
+    std::vector<LedgerEvent> original = ledger->getEvents();
+    std::vector<LedgerEvent> read = Ledger::readLog(file);
+
+    CHECK_EQ(read.size(), original.size());
+    bool identical = read.size() == original.size();
+    for (std::size_t i = 0; identical && i < read.size(); ++i) {
+        identical = read[i].sequence == original[i].sequence && read[i].timestamp_ns == original[i].timestamp_ns &&
+                    read[i].account_id == original[i].account_id && read[i].type == original[i].type &&
+                    sameBits(read[i].amount, original[i].amount) && read[i].related_id == original[i].related_id &&
+                    (read[i].type != LedgerEventType::OPENED || read[i].account_type == original[i].account_type);
+    }
+    CHECK(identical);
+
+    // Loading keeps the numbering going after the log's last sequence
+    Ledger loaded;
+    loaded.load(read);
+    CHECK_EQ(loaded.getEventCount(), original.size());
+    for (const auto& account : accounts) {
+        CHECK(sameBits(loaded.getBalance(account->getAccountId()), account->getBalance()));
+    }
+    CHECK(loaded.append(event(1, LedgerEventType::DEPOSIT, 1.0, kStart)) > original.back().sequence);
+}
+
+TEST_CASE(compactionKeepsReplayAndLaterBalances) {
+    Ledger ledger;
+    const int account = 3;
+    LedgerEvent opened = event(account, LedgerEventType::OPENED, 10.0, kStart);
+    opened.related_id = 77;
+    opened.account_type = AccountType::SAVINGS;
+    ledger.append(opened);
+    ledger.append(event(account + 1, LedgerEventType::OPENED, 0.0, kStart)); // Too few events to fold
+
+    std::vector<double> balances{10.0};
+    const std::size_t events = Ledger::kCheckpointInterval * 3 + 5;
+    for (std::size_t i = 1; i < events; ++i) {
+        LedgerEvent e = event(account, LedgerEventType::DEPOSIT, 0.1 * static_cast<double>(i),
+                              kStart + static_cast<std::int64_t>(i) * kSecond);
+        ledger.append(e);
+        balances.push_back(e.apply(balances.back()));
+    }
+    const std::uint64_t digest = LedgerReplayer::replay(ledger.getEvents(), 1).digest;
+
+    // Folds up to the second checkpoint (event 127), the last one before the cutoff
+    const std::size_t cutoff = Ledger::kCheckpointInterval * 2 + 20;
+    const std::size_t folded = Ledger::kCheckpointInterval * 2 - 1;
+    CHECK_EQ(ledger.compact(timeAt(kStart + static_cast<std::int64_t>(cutoff) * kSecond)), folded);
+    CHECK_EQ(ledger.getEventCount(), events + 1 - folded);
+    CHECK_EQ(ledger.compact(timeAt(kStart + static_cast<std::int64_t>(cutoff) * kSecond)), std::size_t(0));
+
+    std::vector<LedgerEvent> kept = ledger.getAccountEvents(account);
+    CHECK(kept.front().type == LedgerEventType::OPENED);
+    CHECK_EQ(kept.front().related_id, 77);
+    CHECK(kept.front().account_type == AccountType::SAVINGS);
+    CHECK_EQ(LedgerReplayer::replay(ledger.getEvents(), 2).digest, digest);
+
+    for (std::size_t i = folded; i < events; ++i) {
+        CHECK(sameBits(ledger.getBalanceAt(account, timeAt(kStart + static_cast<std::int64_t>(i) * kSecond)),
+                       balances[i]));
+    }
+    CHECK_EQ(ledger.getBalanceAt(account, timeAt(kStart + static_cast<std::int64_t>(folded - 1) * kSecond)), 0.0);
+
+    // Appends carry on from the folded stream
+    ledger.append(event(account, LedgerEventType::WITHDRAWAL, -1.0, kStart + 1000 * kSecond));
+    CHECK(sameBits(ledger.getBalance(account), balances.back() - 1.0));
+    CHECK(sameBits(ledger.getBalanceAt(account, timeAt(kStart + 1000 * kSecond)), balances.back() - 1.0));
+}
+
+TEST_CASE(malformedLogsAreRejected) {
+    std::istringstream bad_amount("1,1750000000000000000,1,opened,12.5x,7,CHECKING\n");
+    CHECK_THROWS(Ledger::readLog(bad_amount), std::invalid_argument);
+
+    std::istringstream bad_type("1,1750000000000000000,1,refund,12.5,7,\n");
+    CHECK_THROWS(Ledger::readLog(bad_type), std::invalid_argument);
+
+    std::istringstream short_line("1,1750000000000000000,1,deposit,12.5\n");
+    CHECK_THROWS(Ledger::readLog(short_line), std::invalid_argument);
+
+    std::vector<LedgerEvent> out_of_order{event(1, LedgerEventType::OPENED, 0.0, kStart),
+                                          event(1, LedgerEventType::DEPOSIT, 1.0, kStart)};
+    out_of_order[0].sequence = 2;
+    out_of_order[1].sequence = 1;
+    Ledger ledger;
+    CHECK_THROWS(ledger.load(out_of_order), std::invalid_argument);
+}
+
+TEST_MAIN()
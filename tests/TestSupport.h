@@ -0,0 +1,113 @@
+#ifndef TEST_SUPPORT_H
+#define TEST_SUPPORT_H
+
+#include <cmath>
+#include <exception>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Just enough of a test harness for the behaviour tests: each tests/*.cpp
+// builds into its own executable, registers cases with TEST_CASE and ends
+// with TEST_MAIN(). A failed CHECK reports and carries on with the case; an
+// exception ends the case. The exit status is non-zero if anything failed,
+// which is all CTest looks at.
+
+namespace testing_support {
+    struct TestCase {
+        const char* name;
+        void (*run)();
+    };
+
+    inline std::vector<TestCase>& registry() {
+        static std::vector<TestCase> cases;
+        return cases;
+    }
+
+    inline int& failures() {
+        static int count = 0;
+        return count;
+    }
+
+    struct Registration {
+        Registration(const char* name, void (*run)()) { registry().push_back(TestCase{name, run}); }
+    };
+
+    inline void fail(const char* file, int line, const std::string& message) {
+        ++failures();
+        std::cerr << file << ":" << line << ": check failed: " << message << "\n";
+    }
+
+    template <typename A, typename B>
+    std::string describe(const char* expression, const A& actual, const B& expected) {
+        std::ostringstream out;
+        out << expression << " (got " << actual << ", expected " << expected << ")";
+        return out.str();
+    }
+
+    inline int runAll() {
+        int failed_cases = 0;
+        for (const TestCase& test : registry()) {
+            int before = failures();
+            try {
+                test.run();
+            } catch (const std::exception& e) {
+                ++failures();
+                std::cerr << test.name << ": unexpected exception: " << e.what() << "\n";
+            }
+            bool passed = failures() == before;
+            if (!passed) ++failed_cases;
+            std::cout << (passed ? "[ PASS ] " : "[ FAIL ] ") << test.name << "\n";
+        }
+        std::cout << registry().size() - static_cast<std::size_t>(failed_cases) << "/" << registry().size()
+                  << " cases passed\n";
+        return failed_cases == 0 ? 0 : 1;
+    }
+}
+
+#define TEST_CASE(name)                                                                   \
+    static void name();                                                                   \
+    static const testing_support::Registration name##_registration(#name, name);          \
+    static void name()
+
+#define TEST_MAIN() \
+    int main() { return testing_support::runAll(); }
+
+#define CHECK(condition)                                                                  \
+    do {                                                                                  \
+        if (!(condition)) testing_support::fail(__FILE__, __LINE__, #condition);          \
+    } while (0)
+
+#define CHECK_EQ(actual, expected)                                                        \
+    do {                                                                                  \
+        const auto& check_actual = (actual);                                              \
+        const auto& check_expected = (expected);                                          \
+        if (!(check_actual == check_expected)) {                                          \
+            testing_support::fail(__FILE__, __LINE__,                                     \
+                testing_support::describe(#actual " == " #expected, check_actual, check_expected)); \
+        }                                                                                 \
+    } while (0)
+
+#define CHECK_NEAR(actual, expected, tolerance)                                           \
+    do {                                                                                  \
+        double check_actual = (actual);                                                   \
+        double check_expected = (expected);                                               \
+        if (!(std::fabs(check_actual - check_expected) <= (tolerance))) {                 \
+            testing_support::fail(__FILE__, __LINE__,                                     \
+                testing_support::describe(#actual " ~= " #expected, check_actual, check_expected)); \
+        }                                                                                 \
+    } while (0)
+
+#define CHECK_THROWS(statement, exception_type)                                           \
+    do {                                                                                  \
+        bool check_threw = false;                                                         \
+        try {                                                                             \
+            statement;                                                                    \
+        } catch (const exception_type&) {                                                 \
+            check_threw = true;                                                           \
+        }                                                                                 \
+        if (!check_threw) testing_support::fail(__FILE__, __LINE__, #statement " throws " #exception_type); \
+    } while (0)
+
+#endif // TEST_SUPPORT_H
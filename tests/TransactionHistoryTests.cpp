@@ -0,0 +1,332 @@
+#include <filesystem>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include "models/TransactionHistory.h"
+#include "TestSupport.h"
+
+// TransactionHistory round trips: every field of an archived entry must come
+// back exactly as appended, whether the segment stayed in memory or was
+// spilled, and pages, ranges and summaries must agree with a plain scan of
+// the appended records whichever tier the entries are in.
+
+namespace {
+    using time_point = std::chrono::system_clock::time_point;
+
+    const time_point kBase = std::chrono::system_clock::from_time_t(1750000000);
+
+    time_point at(std::size_t second) {
+        return kBase + std::chrono::seconds(second) + std::chrono::microseconds(second % 997);
+    }
+
+    // Exercises every encoding path: raw-double amounts, non-monotonic ids,
+    // repeated strings (dictionary back-references), empty strings and all
+    // flag combinations
+    std::shared_ptr<Transaction> makeRecord(std::size_t i, time_point timestamp) {
+        double amount;
+        switch (i % 5) {
+            case 0: amount = 0.001 * static_cast<double>(i + 1); break; // Not whole cents
+            case 1: amount = 1e17 + static_cast<double>(i); break;      // Too large for cents
+            case 2: amount = 12.34; break;
+            case 3: amount = 1e-9; break;
+            default: amount = static_cast<double>(i % 1000) * 0.01 + 0.01; break;
+        }
+        std::string description = i % 3 == 0 ? "Rent" : i % 3 == 1 ? "Unique " + std::to_string(i) : "";
+
+        auto record = std::make_shared<Transaction>(static_cast<int>(1000 + i * 7 - (i % 3) * 5), 42, amount,
+                                                    static_cast<TransactionType>(i % 6),
+                                                    static_cast<TransactionCategory>(i % kTransactionCategoryCount),
+                                                    description);
+        record->setToAccountId(i % 4 == 0 ? -1 : static_cast<int>(100 + i % 9));
+        record->setStatus(static_cast<TransactionStatus>(i % 4));
+        record->setSuspiciousFlag(i % 7 == 0);
+        record->setLocation(i % 2 ? "New York" : "Lagos");
+        record->setIpAddress(i % 10 == 0 ? "10.0.0." + std::to_string(i % 256) : "");
+        record->setTimestamp(timestamp);
+        return record;
+    }
+
+    std::vector<std::shared_ptr<Transaction>> makeRecords(std::size_t count, bool in_order) {
+        std::vector<std::shared_ptr<Transaction>> records;
+        for (std::size_t i = 0; i < count; ++i) {
+            records.push_back(makeRecord(i, at(in_order ? i : (i * 7919) % count)));
+        }
+        return records;
+    }
+
+    bool sameRecord(const Transaction& a, const Transaction& b) {
+        return a.getTransactionId() == b.getTransactionId() && a.getAccountId() == b.getAccountId() &&
+               a.getToAccountId() == b.getToAccountId() && a.getAmount() == b.getAmount() &&
+               a.getType() == b.getType() && a.getCategory() == b.getCategory() &&
+               a.getStatus() == b.getStatus() && a.isSuspicious() == b.isSuspicious() &&
+               a.getDescription() == b.getDescription() && a.getLocation() == b.getLocation() &&
+               a.getIpAddress() == b.getIpAddress() && a.getTimestamp() == b.getTimestamp();
+    }
+
+    HistoryTieringPolicy smallSegments(const std::string& spill_directory = "") {
+        HistoryTieringPolicy policy;
+        policy.hot_entries = 256;
+        policy.segment_entries = 256;
+        policy.auto_compact = false;
+        policy.spill_directory = spill_directory;
+        return policy;
+    }
+
+    void fill(TransactionHistory& history, const std::vector<std::shared_ptr<Transaction>>& records) {
+        for (const auto& record : records) {
+            history.append(record);
+        }
+    }
+
+    // Positions before cursor with a timestamp in [from, to], newest first
+    std::vector<int> scan(const std::vector<std::shared_ptr<Transaction>>& records, time_point from, time_point to,
+                          std::size_t cursor) {
+        std::vector<int> ids;
+        for (std::size_t i = std::min(cursor, records.size()); i > 0; --i) {
+            const Transaction& record = *records[i - 1];
+            if (record.getTimestamp() >= from && record.getTimestamp() <= to) {
+                ids.push_back(record.getTransactionId());
+            }
+        }
+        return ids;
+    }
+
+    std::vector<int> collectRange(const TransactionHistory& history, time_point from, time_point to,
+                                  std::size_t cursor, std::size_t limit) {
+        std::vector<int> ids;
+        TransactionPage page;
+        do {
+            page = history.range(from, to, cursor, limit);
+            CHECK(page.transactions.size() <= limit);
+            for (const Transaction* transaction : page.transactions) {
+                ids.push_back(transaction->getTransactionId());
+            }
+            cursor = page.next_cursor;
+        } while (page.has_more);
+        return ids;
+    }
+
+    std::size_t filesIn(const std::filesystem::path& directory) {
+        std::size_t files = 0;
+        for (const auto& entry : std::filesystem::directory_iterator(directory)) {
+            (void)entry;
+            ++files;
+        }
+        return files;
+    }
+
+    // A fresh directory, removed with everything in it at scope exit
+    struct ScratchDirectory {
+        std::filesystem::path path;
+
+        ScratchDirectory() {
+            path = std::filesystem::temp_directory_path() /
+                   ("fintrack_history_test_" + std::to_string(std::random_device()()));
+            std::filesystem::create_directories(path);
+        }
+        ~ScratchDirectory() {
+            std::error_code ignored;
+            std::filesystem::remove_all(path, ignored);
+        }
+    };
+}
+
+TEST_CASE(archivedEntriesDecodeToTheOriginals) {
+    auto records = makeRecords(2000, true);
+    TransactionHistory history;
+    history.setPolicy(smallSegments(), "test");
+    fill(history, records);
+
+    CHECK_EQ(history.compact(), std::size_t(1536));
+    CHECK_EQ(history.archivedCount(), std::size_t(1536));
+    CHECK_EQ(history.segmentCount(), std::size_t(6));
+    CHECK(history.archivedBytes() > 0);
+
+    auto restored = history.toVector();
+    CHECK_EQ(restored.size(), records.size());
+    for (std::size_t i = 0; i < records.size() && i < restored.size(); ++i) {
+        if (!sameRecord(*restored[i], *records[i])) {
+            CHECK(sameRecord(*restored[i], *records[i]));
+            std::cerr << "  first mismatch at position " << i << "\n";
+            break;
+        }
+    }
+}
+
+TEST_CASE(autoCompactionKeepsTheHotTierBounded) {
+    HistoryTieringPolicy policy = smallSegments();
+    policy.auto_compact = true;
+    TransactionHistory history;
+    history.setPolicy(policy, "test");
+    fill(history, makeRecords(5000, true));
+
+    CHECK_EQ(history.size(), std::size_t(5000));
+    CHECK(history.size() - history.archivedCount() < policy.hot_entries + policy.segment_entries);
+}
+
+TEST_CASE(spilledSegmentsReloadAndAreRemoved) {
+    ScratchDirectory directory;
+    auto records = makeRecords(2000, true);
+    {
+        TransactionHistory first;
+        TransactionHistory second; // Same prefix: must not share files with the first
+        first.setPolicy(smallSegments(directory.path.string()), "account_7");
+        second.setPolicy(smallSegments(directory.path.string()), "account_7");
+        fill(first, records);
+        fill(second, records);
+        first.compact();
+        second.compact();
+        CHECK_EQ(filesIn(directory.path), first.segmentCount() + second.segmentCount());
+
+        {
+            TransactionHistory third;
+            third.setPolicy(smallSegments(directory.path.string()), "account_7");
+            fill(third, records);
+            third.compact();
+        }
+        CHECK_EQ(filesIn(directory.path), first.segmentCount() + second.segmentCount());
+
+        auto restored = first.toVector();
+        bool all_match = restored.size() == records.size();
+        for (std::size_t i = 0; all_match && i < records.size(); ++i) {
+            all_match = sameRecord(*restored[i], *records[i]);
+        }
+        CHECK(all_match);
+    }
+    CHECK_EQ(filesIn(directory.path), std::size_t(0));
+}
+
+TEST_CASE(pagesWalkEveryTierNewestFirst) {
+    auto records = makeRecords(2000, true);
+    TransactionHistory history;
+    history.setPolicy(smallSegments(), "test");
+    fill(history, records);
+    history.compact();
+
+    std::vector<int> ids;
+    std::size_t cursor = TransactionPage::kNewest;
+    TransactionPage page;
+    do {
+        page = history.page(cursor, 99);
+        for (const Transaction* transaction : page.transactions) {
+            ids.push_back(transaction->getTransactionId());
+        }
+        cursor = page.next_cursor;
+    } while (page.has_more);
+
+    CHECK_EQ(ids.size(), records.size());
+    bool newest_first = ids.size() == records.size();
+    for (std::size_t i = 0; newest_first && i < ids.size(); ++i) {
+        newest_first = ids[i] == records[records.size() - 1 - i]->getTransactionId();
+    }
+    CHECK(newest_first);
+
+    // A cursor in the middle of an archived segment
+    page = history.page(300, 10);
+    CHECK_EQ(page.transactions.size(), std::size_t(10));
+    CHECK_EQ(page.next_cursor, std::size_t(290));
+    CHECK(page.has_more);
+    CHECK(!page.pins.empty());
+    if (page.transactions.size() == 10) {
+        CHECK(sameRecord(*page.transactions.front(), *records[299]));
+        CHECK(sameRecord(*page.transactions.back(), *records[290]));
+    }
+}
+
+TEST_CASE(pagesStayValidWhileTheHistoryCompacts) {
+    auto records = makeRecords(2000, true);
+    TransactionHistory history;
+    history.setPolicy(smallSegments(), "test");
+    fill(history, records);
+
+    TransactionPage page = history.page(1000, 50); // Hot now, archived below
+    history.compact();
+    records.clear(); // The page's pins must be what keeps the entries alive
+
+    auto expected = makeRecords(2000, true);
+    CHECK_EQ(page.transactions.size(), std::size_t(50));
+    for (std::size_t i = 0; i < page.transactions.size(); ++i) {
+        CHECK(sameRecord(*page.transactions[i], *expected[999 - i]));
+    }
+}
+
+TEST_CASE(rangesAcrossTiersMatchAScan) {
+    auto records = makeRecords(2000, true);
+    TransactionHistory history;
+    history.setPolicy(smallSegments(), "test");
+    fill(history, records);
+    history.compact(); // Segments hold positions [0, 1536)
+
+    struct Window { std::size_t from, to; };
+    const Window windows[] = {
+        {0, 1999},    // Everything
+        {10, 200},    // Inside the first segment
+        {250, 900},   // Across several segments
+        {1400, 1700}, // Across the archive boundary
+        {1600, 1999}, // Hot tier only
+        {2500, 3000}, // After everything
+    };
+    const std::size_t cursors[] = {TransactionPage::kNewest, 700, 1536, 1800};
+    for (const Window& window : windows) {
+        for (std::size_t cursor : cursors) {
+            CHECK(collectRange(history, at(window.from), at(window.to), cursor, 37) ==
+                  scan(records, at(window.from), at(window.to), cursor));
+        }
+    }
+}
+
+TEST_CASE(outOfOrderImportsStillMatchAScan) {
+    auto records = makeRecords(2000, false);
+    TransactionHistory history;
+    history.setPolicy(smallSegments(), "test");
+    fill(history, records);
+    history.compact();
+
+    CHECK(collectRange(history, at(300), at(900), TransactionPage::kNewest, 64) ==
+          scan(records, at(300), at(900), TransactionPage::kNewest));
+    CHECK(collectRange(history, at(0), at(1999), 1000, 64) == scan(records, at(0), at(1999), 1000));
+
+    HistorySummary summary = history.summarize(at(300), at(900));
+    std::size_t count = 0;
+    double total = 0.0;
+    for (const auto& record : records) {
+        if (record->getTimestamp() >= at(300) && record->getTimestamp() <= at(900)) {
+            ++count;
+            total += record->getAmount();
+        }
+    }
+    CHECK_EQ(summary.count, count);
+    CHECK_NEAR(summary.total_amount, total, total * 1e-12);
+}
+
+TEST_CASE(summariesMatchAcrossTiers) {
+    auto records = makeRecords(2000, true);
+    TransactionHistory history;
+    history.setPolicy(smallSegments(), "test");
+    fill(history, records);
+    history.compact();
+
+    double total = 0.0;
+    std::size_t food = 0;
+    for (const auto& record : records) {
+        total += record->getAmount();
+        if (record->getCategory() == TransactionCategory::FOOD) ++food;
+    }
+    HistorySummary summary = history.summarize();
+    CHECK_EQ(summary.count, records.size());
+    CHECK_NEAR(summary.total_amount, total, total * 1e-12);
+    CHECK_EQ(summary.categories[static_cast<std::size_t>(TransactionCategory::FOOD)].count, food);
+    CHECK(summary.first_timestamp == records.front()->getTimestamp());
+    CHECK(summary.last_timestamp == records.back()->getTimestamp());
+
+    // Partly covered segments are decoded, whole ones answer from their summary
+    HistorySummary window = history.summarize(at(100), at(1700));
+    std::size_t count = 0;
+    for (const auto& record : records) {
+        if (record->getTimestamp() >= at(100) && record->getTimestamp() <= at(1700)) ++count;
+    }
+    CHECK_EQ(window.count, count);
+}
+
+TEST_MAIN()